@@ -0,0 +1,312 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  kshim.c
+ *
+ *      \author  thomas schnuerer
+ *
+ *       \brief  Kernel API used by the benchmarked paths of serial_m77.c:
+ *               port registration, the tty flip buffer and locking.
+ *               Single threaded, locks are no-ops. Received chars end
+ *               in kshim_rx.
+ *
+ *     Switches: -
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdarg.h>
+#include <time.h>
+
+#include "kshim.h"
+
+/*-----------------------------+
+|   GLOBALS                    |
++-----------------------------*/
+struct kshim_rx kshim_rx;
+int kshim_verbose;
+unsigned long volatile jiffies;
+struct ktermios tty_std_termios = {
+	.c_cflag	= CS8 | CREAD | HUPCL,
+	.c_ispeed	= 9600,
+	.c_ospeed	= 9600,
+};
+
+static char G_dummyDev;					/* returned by device_create()	*/
+
+
+/*******************************************************************/
+/** Called by the generated stubs of kernel functions not implemented
+ *
+ * \param name		\IN function name
+ *
+ * \return 			does not return
+ */
+void kshim_trap(const char *name)
+{
+	fprintf(stderr, "*** kshim: %s() called, not implemented\n", name);
+	abort();
+}
+
+/*-----------------------------+
+|   printk, memory, strings    |
++-----------------------------*/
+int printk(const char *fmt, ...)
+{
+	va_list ap;
+	int n = 0;
+
+	if (kshim_verbose) {
+		va_start(ap, fmt);
+		n = vfprintf(stderr, fmt, ap);
+		va_end(ap);
+	}
+	return n;
+}
+
+void *kmalloc(size_t s, gfp_t f)				{ return malloc(s); }
+void *kzalloc(size_t s, gfp_t f)				{ return calloc(1, s); }
+void *kcalloc(size_t n, size_t s, gfp_t f)		{ return calloc(n, s); }
+void *kmalloc_array(size_t n, size_t s, gfp_t f){ return malloc(n * s); }
+void kfree(const void *p)						{ free((void *)p); }
+void *vmalloc(unsigned long s)					{ return malloc(s); }
+void *vzalloc(unsigned long s)					{ return calloc(1, s); }
+void *vmalloc_user(unsigned long s)				{ return calloc(1, s); }
+void vfree(const void *p)						{ free((void *)p); }
+char *kstrdup(const char *s, gfp_t f)			{ return s ? strdup(s) : NULL; }
+
+/*-----------------------------+
+|   lists                      |
++-----------------------------*/
+void list_add(struct list_head *n, struct list_head *h)
+{
+	n->next = h->next;
+	n->prev = h;
+	h->next->prev = n;
+	h->next = n;
+}
+
+void list_add_tail(struct list_head *n, struct list_head *h)
+{
+	list_add(n, h->prev);
+}
+
+void list_del(struct list_head *e)
+{
+	e->prev->next = e->next;
+	e->next->prev = e->prev;
+	e->next = e->prev = NULL;
+}
+
+void list_add_rcu(struct list_head *n, struct list_head *h)		{ list_add(n, h); }
+void list_add_tail_rcu(struct list_head *n, struct list_head *h){ list_add_tail(n, h); }
+void list_del_rcu(struct list_head *e)							{ list_del(e); }
+int list_empty(const struct list_head *h)		{ return h->next == h; }
+
+/*-----------------------------+
+|   locking, bits, RCU         |
++-----------------------------*/
+void spin_lock_init(spinlock_t *l)				{ }
+void spin_lock(spinlock_t *l)					{ }
+void spin_unlock(spinlock_t *l)					{ }
+int spin_trylock(spinlock_t *l)					{ return 1; }
+void spin_lock_irq(spinlock_t *l)				{ }
+void spin_unlock_irq(spinlock_t *l)				{ }
+void spin_lock_bh(spinlock_t *l)				{ }
+void spin_unlock_bh(spinlock_t *l)				{ }
+void mutex_init(struct mutex *m)				{ }
+void mutex_lock(struct mutex *m)				{ }
+int mutex_lock_interruptible(struct mutex *m)	{ return 0; }
+void mutex_unlock(struct mutex *m)				{ }
+void mutex_destroy(struct mutex *m)				{ }
+void rcu_read_lock(void)						{ }
+void rcu_read_unlock(void)						{ }
+void synchronize_rcu(void)						{ }
+
+int test_and_set_bit(long nr, volatile unsigned long *addr)
+{
+	int old = !!(*addr & (1UL << nr));
+
+	*addr |= 1UL << nr;
+	return old;
+}
+
+int test_bit(long nr, const volatile unsigned long *addr)
+{
+	return !!(*addr & (1UL << nr));
+}
+
+void set_bit(long nr, volatile unsigned long *addr)		{ *addr |= 1UL << nr; }
+void clear_bit(long nr, volatile unsigned long *addr)	{ *addr &= ~(1UL << nr); }
+
+void static_branch_inc(struct static_key_false *k)		{ k->enabled++; }
+void static_branch_dec(struct static_key_false *k)		{ k->enabled--; }
+
+/*-----------------------------+
+|   time, wait queues, work    |
++-----------------------------*/
+u64 ktime_get_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+ktime_t ktime_get(void)							{ return ktime_get_ns(); }
+u64 local_clock(void)							{ return ktime_get_ns(); }
+s64 ktime_to_ns(ktime_t k)						{ return k; }
+s64 ktime_to_us(ktime_t k)						{ return k / 1000; }
+s64 ktime_us_delta(ktime_t a, ktime_t b)		{ return (a - b) / 1000; }
+ktime_t ktime_sub(ktime_t a, ktime_t b)			{ return a - b; }
+u64 div_u64(u64 dividend, u32 divisor)			{ return dividend / divisor; }
+u64 div64_u64(u64 dividend, u64 divisor)		{ return dividend / divisor; }
+unsigned long msecs_to_jiffies(unsigned int m)	{ return m * HZ / 1000; }
+
+void init_waitqueue_head(wait_queue_head_t *w)	{ }
+void wake_up_interruptible(wait_queue_head_t *w){ }
+void wake_up_interruptible_all(wait_queue_head_t *w){ }
+void wake_up(wait_queue_head_t *w)				{ }
+void wake_up_all(wait_queue_head_t *w)			{ }
+
+bool schedule_work(struct work_struct *w)		{ return true; }
+bool cancel_work_sync(struct work_struct *w)	{ return false; }
+bool flush_work(struct work_struct *w)			{ return false; }
+
+/*-----------------------------+
+|   devices                    |
++-----------------------------*/
+struct device *device_create(struct class *c, struct device *parent, dev_t d,
+							 void *drvdata, const char *fmt, ...)
+{
+	return (struct device *)&G_dummyDev;
+}
+
+void device_destroy(struct class *c, dev_t d)	{ }
+struct device_node *of_find_node_by_path(const char *path) { return NULL; }
+
+/* debugfs is not needed, the driver ignores its errors */
+struct dentry *debugfs_create_dir(const char *name, struct dentry *parent)
+{
+	return NULL;
+}
+
+struct dentry *debugfs_create_file(const char *name, umode_t mode,
+								   struct dentry *parent, void *data,
+								   const struct file_operations *fops)
+{
+	return NULL;
+}
+
+void debugfs_remove_recursive(struct dentry *d)	{ }
+void free_percpu(void *p)						{ free(p); }
+
+/*-----------------------------+
+|   serial core, tty           |
++-----------------------------*/
+int uart_add_one_port(struct uart_driver *reg, struct uart_port *port)
+{
+	struct uart_state *state = calloc(1, sizeof(*state));
+	struct tty_struct *tty = calloc(1, sizeof(*tty));
+
+	if (!state || !tty)
+		return -ENOMEM;
+
+	state->xmit.buf = calloc(1, UART_XMIT_SIZE);
+	if (!state->xmit.buf)
+		return -ENOMEM;
+	tty->port = &state->port;
+	state->port.tty = tty;
+	state->uart_port = port;
+	port->state = state;
+	return 0;
+}
+
+int uart_remove_one_port(struct uart_driver *reg, struct uart_port *port)
+{
+	struct uart_state *state = port->state;
+
+	if (state) {
+		free(state->port.tty);
+		free(state->xmit.buf);
+		free(state);
+		port->state = NULL;
+	}
+	return 0;
+}
+
+int uart_tx_stopped(struct uart_port *port)		{ return port->hw_stopped; }
+void uart_write_wakeup(struct uart_port *port)	{ }
+int uart_handle_break(struct uart_port *port)	{ return 0; }
+int uart_handle_sysrq_char(struct uart_port *port, unsigned int ch) { return 0; }
+void uart_handle_dcd_change(struct uart_port *port, unsigned int status) { }
+void uart_handle_cts_change(struct uart_port *port, unsigned int status) { }
+void uart_update_timeout(struct uart_port *port, unsigned int cflag,
+						 unsigned int baud) { }
+
+void uart_insert_char(struct uart_port *port, unsigned int status,
+					  unsigned int overrun, unsigned int ch, unsigned int flag)
+{
+	kshim_rx.chars++;
+	kshim_rx.sum += ch & 0xff;
+	if (flag != TTY_NORMAL)
+		kshim_rx.errors++;
+}
+
+unsigned int uart_get_baud_rate(struct uart_port *port,
+								struct ktermios *termios,
+								const struct ktermios *old,
+								unsigned int min, unsigned int max)
+{
+	unsigned int baud = termios->c_ospeed ? termios->c_ospeed : 9600;
+
+	if (baud < min)
+		baud = min;
+	if (max && baud > max)
+		baud = max;
+	return baud;
+}
+
+unsigned int uart_get_divisor(struct uart_port *port, unsigned int baud)
+{
+	return (port->uartclk + 8 * baud) / (16 * baud);
+}
+
+void tty_flip_buffer_push(struct tty_port *port)	{ kshim_rx.pushes++; }
+
+int tty_insert_flip_string(struct tty_port *port, const unsigned char *chars,
+						   size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		kshim_rx.sum += chars[i];
+	kshim_rx.chars += size;
+	return size;
+}
+
+int tty_insert_flip_char(struct tty_port *port, unsigned char ch, char flag)
+{
+	kshim_rx.chars++;
+	kshim_rx.sum += ch;
+	if (flag != TTY_NORMAL)
+		kshim_rx.errors++;
+	return 1;
+}
+
+void tty_port_tty_wakeup(struct tty_port *p)	{ }
@@ -0,0 +1,824 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  kshim.h
+ *
+ *      \author  thomas schnuerer
+ *
+ *       \brief  Kernel and MDIS API of serial_m77.c for the user space
+ *               build of m77_regbench. Every <linux/...>, <MEN/...> and
+ *               <asm/...> header included by the driver is a generated
+ *               wrapper of this file (see Makefile), except
+ *               <linux/serial_reg.h> which is taken from the host.
+ *
+ *               Declarations only, the functions used by the benchmarked
+ *               paths are implemented in kshim.c. All other functions
+ *               are generated stubs which abort when called.
+ *               MREAD_D16/MWRITE_D16 access the register model.
+ *
+ *     Switches: -
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef _KSHIM_H
+#define _KSHIM_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include "regmodel.h"
+#define ENOIOCTLCMD 515
+#define __iomem
+#define __init
+#define __exit
+#define __user
+#define __percpu
+#define __rcu
+#define __force
+#define __must_check
+#define likely(x) (x)
+#define unlikely(x) (x)
+#define noinline __attribute__((noinline))
+#define ____cacheline_aligned __attribute__((aligned(64)))
+#define __aligned(x) __attribute__((aligned(x)))
+#define ____cacheline_aligned_in_smp __attribute__((aligned(64)))
+#define L1_CACHE_BYTES 64
+#define SMP_CACHE_BYTES 64
+#define PAGE_SIZE 4096UL
+#define PAGE_SHIFT 12
+#define PAGE_ALIGN(x) (((x)+PAGE_SIZE-1)&~(PAGE_SIZE-1))
+#define KERNEL_VERSION(a,b,c) (((a) << 16) + ((b) << 8) + (c))
+#ifndef LINUX_VERSION_CODE
+#define LINUX_VERSION_CODE KERNEL_VERSION(6,10,0)
+#endif
+#define THIS_MODULE ((struct module *)0)
+#define KERN_INFO "" 
+#define KERN_ERR ""
+#define KERN_WARNING ""
+#define KERN_DEBUG ""
+#define KERN_NOTICE ""
+int printk(const char *fmt, ...);
+#define pr_debug(...) printk(__VA_ARGS__)
+#define pr_info(...) printk(__VA_ARGS__)
+#define pr_err(...) printk(__VA_ARGS__)
+#define pr_warn(...) printk(__VA_ARGS__)
+#define ARRAY_SIZE(a) (sizeof(a)/sizeof((a)[0]))
+#define container_of(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define min_t(t,a,b) ((t)(a)<(t)(b)?(t)(a):(t)(b))
+#define max_t(t,a,b) ((t)(a)>(t)(b)?(t)(a):(t)(b))
+#define clamp_t(t,v,lo,hi) min_t(t, max_t(t, v, lo), hi)
+#define BUILD_BUG_ON(c) ((void)sizeof(char[1 - 2*!!(c)]))
+#define READ_ONCE(x) (x)
+#define WRITE_ONCE(x, v) ((x) = (v))
+#define smp_wmb() do {} while (0)
+#define smp_rmb() do {} while (0)
+#define smp_mb() do {} while (0)
+#define smp_store_release(p, v) (*(p) = (v))
+#define smp_load_acquire(p) (*(p))
+#define __stringify(x) #x
+#define MENT_XSTR(s) MENT_STR(s)
+#define MENT_STR(s) #s
+#define DIV_ROUND_UP(n,d) (((n) + (d) - 1) / (d))
+#define BITS_PER_LONG 64
+#define BIT(n) (1UL << (n))
+#define IS_ERR(p) ((unsigned long)(p) > (unsigned long)-4096)
+#define PTR_ERR(p) ((long)(p))
+#define ERR_PTR(e) ((void *)(long)(e))
+#define IS_ERR_OR_NULL(p) (!(p) || IS_ERR(p))
+#define EXPORT_SYMBOL(x)
+#define EXPORT_SYMBOL_GPL(x)
+#define MODULE_LICENSE(x)
+#define MODULE_DESCRIPTION(x)
+#define MODULE_AUTHOR(x)
+#define MODULE_VERSION(x)
+#define MODULE_PARM_DESC(a,b)
+#define module_init(x)
+#define module_exit(x)
+#define __FUNCTION__ __func__
+typedef uint8_t u8; typedef uint16_t u16; typedef uint32_t u32; typedef uint64_t u64;
+typedef int8_t s8; typedef int16_t s16; typedef int32_t s32; typedef int64_t s64;
+typedef u8 __u8; typedef u16 __u16; typedef u32 __u32; typedef u64 __u64;
+typedef u16 __le16; typedef u32 __le32;
+typedef unsigned int gfp_t;
+typedef unsigned int fmode_t;
+typedef unsigned short umode_t;
+typedef unsigned int __poll_t;
+typedef long long ktime_t;
+typedef unsigned long long cycles_t;
+typedef struct { int counter; } atomic_t;
+typedef struct { long counter; } atomic64_t;
+typedef struct { long counter; } atomic_long_t;
+typedef struct { int x; } spinlock_t;
+typedef struct { int x; } raw_spinlock_t;
+typedef struct { atomic_t refs; } refcount_t;
+struct module;
+struct device;
+struct kref { refcount_t refcount; };
+#define GFP_KERNEL 0u
+#define GFP_ATOMIC 1u
+#define __GFP_ZERO 2u
+/* MDIS */
+typedef uint8_t u_int8; typedef uint16_t u_int16; typedef uint32_t u_int32; typedef int32_t int32;
+typedef void *MACCESS;
+#define MREAD_D16(ma,offs) rm_read16((char *)(ma)+(offs))
+#define MWRITE_D16(ma,offs,val) rm_write16((char *)(ma)+(offs), (val))
+#define LL_IRQ_DEV_NOT 0
+#define LL_IRQ_DEVICE 1
+#define MDIS_MA08 1
+#define MDIS_MD08 1
+int mdis_open_external_dev(char *devName, char *brdName, int slotNo, int addrMode, int dataMode, int size, void **memBase, void *irqInfo, void **devP);
+int mdis_close_external_dev(void *dev);
+int mdis_install_external_irq(void *dev, int (*handler)(void *), void *data);
+int mdis_remove_external_irq(void *dev);
+int mdis_enable_external_irq(void *dev);
+int mdis_disable_external_irq(void *dev);
+int m_getmodinfo(unsigned long addr, u_int32 *modtype, u_int32 *devid, u_int32 *devrev, char *devname);
+/* lists */
+struct list_head { struct list_head *next, *prev; };
+#define LIST_HEAD(n) struct list_head n = { &(n), &(n) }
+static inline void INIT_LIST_HEAD(struct list_head *l) { l->next = l->prev = l; }
+void list_add(struct list_head *n, struct list_head *h);
+void list_add_tail(struct list_head *n, struct list_head *h);
+void list_del(struct list_head *e);
+void list_add_rcu(struct list_head *n, struct list_head *h);
+void list_add_tail_rcu(struct list_head *n, struct list_head *h);
+void list_del_rcu(struct list_head *e);
+int list_empty(const struct list_head *h);
+#define list_entry(ptr, type, member) container_of(ptr, type, member)
+#define list_first_entry(ptr, type, member) list_entry((ptr)->next, type, member)
+#define list_for_each(pos, head) for (pos = (head)->next; pos != (head); pos = pos->next)
+#define list_for_each_safe(pos, n, head) for (pos = (head)->next, n = pos->next; pos != (head); pos = n, n = pos->next)
+#define list_for_each_entry(pos, head, member) for (pos = list_entry((head)->next, __typeof__(*pos), member); &pos->member != (head); pos = list_entry(pos->member.next, __typeof__(*pos), member))
+#define list_for_each_entry_rcu(pos, head, member) list_for_each_entry(pos, head, member)
+#define list_for_each_entry_safe(pos, n, head, member) for (pos = list_entry((head)->next, __typeof__(*pos), member), n = list_entry(pos->member.next, __typeof__(*pos), member); &pos->member != (head); pos = n, n = list_entry(n->member.next, __typeof__(*n), member))
+/* memory */
+void *kmalloc(size_t s, gfp_t f);
+void *kzalloc(size_t s, gfp_t f);
+void *kcalloc(size_t n, size_t s, gfp_t f);
+void *krealloc(const void *p, size_t s, gfp_t f);
+void *kmalloc_array(size_t n, size_t s, gfp_t f);
+void kfree(const void *p);
+char *kstrdup(const char *s, gfp_t f);
+char *kstrndup(const char *s, size_t n, gfp_t f);
+void *vmalloc(unsigned long s);
+void *vzalloc(unsigned long s);
+void *vmalloc_user(unsigned long s);
+void vfree(const void *p);
+/* strings */
+int kstrtoint(const char *s, unsigned int base, int *res);
+int kstrtouint(const char *s, unsigned int base, unsigned int *res);
+int kstrtoul(const char *s, unsigned int base, unsigned long *res);
+int kstrtobool(const char *s, bool *res);
+char *strsep(char **s, const char *ct);
+char *skip_spaces(const char *);
+char *strim(char *);
+int sprintf(char *buf, const char *fmt, ...);
+int snprintf(char *buf, size_t size, const char *fmt, ...);
+int scnprintf(char *buf, size_t size, const char *fmt, ...);
+/* locking */
+#define DEFINE_SPINLOCK(x) spinlock_t x
+void spin_lock_init(spinlock_t *l);
+void spin_lock(spinlock_t *l);
+#define spin_lock_nest_lock(l, n) spin_lock(l)
+void spin_unlock(spinlock_t *l);
+int spin_trylock(spinlock_t *l);
+#define spin_lock_irqsave(l, f) do { (void)(l); (f) = 0; } while (0)
+#define spin_unlock_irqrestore(l, f) do { (void)(l); (void)(f); } while (0)
+#define local_irq_save(f) do { (f) = 0; } while (0)
+#define local_irq_restore(f) do { (void)(f); } while (0)
+void spin_lock_irq(spinlock_t *l);
+void spin_unlock_irq(spinlock_t *l);
+void spin_lock_bh(spinlock_t *l);
+void spin_unlock_bh(spinlock_t *l);
+struct semaphore { int count; };
+#define DEFINE_SEMAPHORE(n) struct semaphore n
+void down(struct semaphore *s);
+void up(struct semaphore *s);
+struct mutex { int x; };
+#define DEFINE_MUTEX(n) struct mutex n
+void mutex_init(struct mutex *m);
+void mutex_lock(struct mutex *m);
+int mutex_lock_interruptible(struct mutex *m);
+void mutex_unlock(struct mutex *m);
+void mutex_destroy(struct mutex *m);
+int atomic_read(const atomic_t *a);
+void atomic_set(atomic_t *a, int i);
+void atomic_inc(atomic_t *a);
+void atomic_dec(atomic_t *a);
+int atomic_inc_return(atomic_t *a);
+int atomic_dec_and_test(atomic_t *a);
+int atomic_cmpxchg(atomic_t *a, int o, int n);
+/* single threaded: M77_MMIO_STATS counters and per CPU data */
+#define atomic_long_read(a)			((a)->counter)
+#define atomic_long_set(a, i)		((a)->counter = (i))
+#define atomic_long_inc(a)			((a)->counter++)
+#define DEFINE_PER_CPU(type, name)	__typeof__(type) name
+#define this_cpu_read(v)			(v)
+#define this_cpu_xchg(v, n)			({ __typeof__(v) __o = (v); (v) = (n); __o; })
+void atomic_add(int i, atomic_t *a);
+long atomic64_read(const atomic64_t *a);
+void atomic64_add(long i, atomic64_t *a);
+void atomic64_inc(atomic64_t *a);
+void atomic64_set(atomic64_t *a, long i);
+#define ATOMIC_INIT(i) { (i) }
+int test_and_set_bit(long nr, volatile unsigned long *addr);
+int test_bit(long nr, const volatile unsigned long *addr);
+void set_bit(long nr, volatile unsigned long *addr);
+void clear_bit(long nr, volatile unsigned long *addr);
+void clear_bit_unlock(long nr, volatile unsigned long *addr);
+int test_and_set_bit_lock(long nr, volatile unsigned long *addr);
+#define BITS_TO_LONGS(n) DIV_ROUND_UP(n, BITS_PER_LONG)
+#define DECLARE_BITMAP(n, bits) unsigned long n[BITS_TO_LONGS(bits)]
+unsigned long *bitmap_zalloc(unsigned int nbits, gfp_t flags);
+void bitmap_free(const unsigned long *bitmap);
+void rcu_read_lock(void);
+void rcu_read_unlock(void);
+void synchronize_rcu(void);
+#define rcu_dereference(p) (p)
+#define rcu_assign_pointer(p, v) ((p) = (v))
+#define RCU_INIT_POINTER(p, v) ((p) = (v))
+#define rcu_access_pointer(p) (p)
+#define rcu_dereference_protected(p, c) (p)
+/* time */
+ktime_t ktime_get(void);
+u64 ktime_get_ns(void);
+s64 ktime_to_ns(ktime_t k);
+s64 ktime_to_us(ktime_t k);
+s64 ktime_us_delta(ktime_t a, ktime_t b);
+ktime_t ktime_sub(ktime_t a, ktime_t b);
+u64 local_clock(void);
+extern unsigned long volatile jiffies;
+#define HZ 250
+unsigned long msecs_to_jiffies(unsigned int m);
+unsigned int jiffies_to_msecs(unsigned long j);
+#define time_after(a,b) ((long)((b) - (a)) < 0)
+#define time_before(a,b) time_after(b,a)
+void udelay(unsigned long us);
+void ndelay(unsigned long ns);
+void msleep(unsigned int ms);
+int msleep_interruptible(unsigned int ms);
+void usleep_range(unsigned long min, unsigned long max);
+u64 div_u64(u64 dividend, u32 divisor);
+u64 div64_u64(u64 dividend, u64 divisor);
+/* module params */
+struct kernel_param;
+struct kernel_param_ops {
+	unsigned int flags;
+	int (*set)(const char *val, const struct kernel_param *kp);
+	int (*get)(char *buffer, const struct kernel_param *kp);
+	void (*free)(void *arg);
+};
+struct kernel_param { const char *name; struct module *mod; const struct kernel_param_ops *ops; u16 perm; s8 level; u8 flags; union { void *arg; }; };
+int param_get_uint(char *buffer, const struct kernel_param *kp);
+#define module_param_array(name, type, nump, perm) static void *__mpa_##name __attribute__((unused)) = (void *)(nump)
+#define module_param(name, type, perm) static void *__mp_##name __attribute__((unused)) = (void *)&(name)
+#define module_param_named(n, name, type, perm) static void *__mp_##n __attribute__((unused)) = (void *)&(name)
+#define module_param_cb(name, ops, arg, perm) static const struct kernel_param __param_##name __attribute__((unused)) = { #name, 0, ops, perm, 0, 0, { arg } }
+/* tty / serial */
+struct ktermios { unsigned int c_iflag, c_oflag, c_cflag, c_lflag; unsigned char c_line; unsigned char c_cc[19]; unsigned int c_ispeed, c_ospeed; };
+#define CSIZE 0000060
+#define CS5 0000000
+#define CS6 0000020
+#define CS7 0000040
+#define CS8 0000060
+#define CSTOPB 0000100
+#define CREAD 0000200
+#define PARENB 0000400
+#define PARODD 0001000
+#define HUPCL 0002000
+#define CLOCAL 0004000
+#define CBAUD 0010017
+#define BOTHER 0010000
+#define B9600 0000015
+#define B115200 0010002
+#define CRTSCTS 020000000000
+#define INPCK 0000020
+#define BRKINT 0000002
+#define PARMRK 0000010
+#define IGNPAR 0000004
+#define IGNBRK 0000001
+#define IXON 0002000
+#define IXOFF 0010000
+#define TIOCSER_TEMT 0x01
+#define TIOCM_LE 0x001
+#define TIOCM_DTR 0x002
+#define TIOCM_RTS 0x004
+#define TIOCM_CTS 0x020
+#define TIOCM_CAR 0x040
+#define TIOCM_RNG 0x080
+#define TIOCM_DSR 0x100
+#define TIOCM_OUT1 0x2000
+#define TIOCM_OUT2 0x4000
+#define TIOCM_LOOP 0x8000
+#define TTY_NORMAL 0
+#define TTY_BREAK 1
+#define TTY_FRAME 2
+#define TTY_PARITY 3
+#define TTY_OVERRUN 4
+#define _IOC(d,t,nr,s) (((d##U)<<30)|((s)<<16)|((t)<<8)|(nr))
+#define _IO(t,nr) _IOC(0,(t),(nr),0)
+#define _IOR(t,nr,sz) _IOC(2,(t),(nr),sizeof(sz))
+#define _IOW(t,nr,sz) _IOC(1,(t),(nr),sizeof(sz))
+#define _IOWR(t,nr,sz) _IOC(3,(t),(nr),sizeof(sz))
+struct circ_buf { char *buf; int head; int tail; };
+#define CIRC_CNT(head,tail,size) (((head) - (tail)) & ((size)-1))
+#define CIRC_SPACE(head,tail,size) CIRC_CNT((tail),((head)+1),(size))
+#define CIRC_CNT_TO_END(head,tail,size) ({int end = (size) - (tail); int n = ((head) + end) & ((size)-1); n < end ? n : end;})
+#define CIRC_SPACE_TO_END(head,tail,size) ({int end = (size) - 1 - (head); int n = (end + (tail)) & ((size)-1); n <= end ? n : end+1;})
+struct wait_queue_head { int x; };
+typedef struct wait_queue_head wait_queue_head_t;
+void init_waitqueue_head(wait_queue_head_t *w);
+#define DECLARE_WAIT_QUEUE_HEAD(n) wait_queue_head_t n
+void wake_up_interruptible(wait_queue_head_t *w);
+void wake_up_interruptible_all(wait_queue_head_t *w);
+void wake_up(wait_queue_head_t *w);
+void wake_up_all(wait_queue_head_t *w);
+#define wait_event_interruptible(wq, cond) ({ (void)(wq); (cond) ? 0 : -ERESTARTSYS; })
+#define wait_event_interruptible_timeout(wq, cond, t) ({ (void)(wq); (cond) ? (long)(t) : 0L; })
+#define wait_event_timeout(wq, cond, t) ({ (void)(wq); (cond) ? (long)(t) : 0L; })
+#define ERESTARTSYS 512
+struct tty_struct;
+struct tty_port { const struct tty_port_operations *ops; struct tty_struct *tty; wait_queue_head_t delta_msr_wait; unsigned long flags; const struct tty_port_client_operations *client_ops; void *client_data; };
+struct async_icount { u32 cts, dsr, rng, dcd, tx, rx, frame, parity, overrun, brk, buf_overrun; };
+struct uart_icount { u32 cts, dsr, rng, dcd, rx, tx, frame, overrun, parity, brk, buf_overrun; };
+struct uart_state { struct tty_port port; int pm_state; struct circ_buf xmit; struct uart_port *uart_port; };
+struct uart_ops;
+struct serial_struct;
+struct attribute { const char *name; umode_t mode; };
+struct attribute_group { const char *name; struct attribute **attrs; };
+struct device_attribute {
+	struct attribute attr;
+	ssize_t (*show)(struct device *dev, struct device_attribute *attr, char *buf);
+	ssize_t (*store)(struct device *dev, struct device_attribute *attr, const char *buf, size_t count);
+};
+#define DEVICE_ATTR(_name, _mode, _show, _store) \
+	struct device_attribute dev_attr_##_name = { { #_name, _mode }, _show, _store }
+#ifndef NSEC_PER_SEC
+#define NSEC_PER_SEC 1000000000L
+#endif
+int sscanf(const char *buf, const char *fmt, ...);
+typedef unsigned int upf_t;
+typedef unsigned int upstat_t;
+struct uart_port {
+	spinlock_t lock;
+	unsigned long iobase;
+	unsigned char __iomem *membase;
+	unsigned int (*serial_in)(struct uart_port *, int);
+	void (*serial_out)(struct uart_port *, int, int);
+	unsigned int irq;
+	unsigned long irqflags;
+	unsigned int uartclk;
+	unsigned int fifosize;
+	unsigned char x_char;
+	unsigned char regshift;
+	unsigned char iotype;
+	unsigned char quirks;
+	unsigned int read_status_mask;
+	unsigned int ignore_status_mask;
+	struct uart_state *state;
+	struct uart_icount icount;
+	struct console *cons;
+	upf_t flags;
+	upstat_t status;
+	int hw_stopped;
+	unsigned int mctrl;
+	unsigned int timeout;
+	unsigned int frame_time;
+	unsigned int type;
+	const struct uart_ops *ops;
+	unsigned int custom_divisor;
+	unsigned int line;
+	unsigned int minor;
+	unsigned long mapbase;
+	unsigned long mapsize;
+	struct device *dev;
+	unsigned char hub6;
+	const struct attribute_group *attr_group;
+	const struct attribute_group **tty_groups;
+	void *private_data;
+};
+struct uart_ops {
+	unsigned int (*tx_empty)(struct uart_port *);
+	void (*set_mctrl)(struct uart_port *, unsigned int mctrl);
+	unsigned int (*get_mctrl)(struct uart_port *);
+	void (*stop_tx)(struct uart_port *);
+	void (*start_tx)(struct uart_port *);
+	void (*throttle)(struct uart_port *);
+	void (*unthrottle)(struct uart_port *);
+	void (*send_xchar)(struct uart_port *, char ch);
+	void (*stop_rx)(struct uart_port *);
+	void (*enable_ms)(struct uart_port *);
+	void (*break_ctl)(struct uart_port *, int ctl);
+	int (*startup)(struct uart_port *);
+	void (*shutdown)(struct uart_port *);
+	void (*flush_buffer)(struct uart_port *);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,1,0)
+	void (*set_termios)(struct uart_port *, struct ktermios *new, const struct ktermios *old);
+#else
+	void (*set_termios)(struct uart_port *, struct ktermios *new, struct ktermios *old);
+#endif
+	void (*set_ldisc)(struct uart_port *, struct ktermios *);
+	void (*pm)(struct uart_port *, unsigned int state, unsigned int oldstate);
+	const char *(*type)(struct uart_port *);
+	void (*release_port)(struct uart_port *);
+	int (*request_port)(struct uart_port *);
+	void (*config_port)(struct uart_port *, int);
+	int (*verify_port)(struct uart_port *, struct serial_struct *);
+	int (*ioctl)(struct uart_port *, unsigned int, unsigned long);
+};
+struct tty_driver;
+struct uart_driver { struct module *owner; const char *driver_name; const char *dev_name; int major; int minor; int nr; struct console *cons; struct uart_state *state; struct tty_driver *tty_driver; };
+#define UPF_SHARE_IRQ (1u<<24)
+#define UPF_BOOT_AUTOCONF (1u<<28)
+#define UPF_FIXED_TYPE (1u<<27)
+#define UPF_SKIP_TEST (1u<<6)
+#define UPIO_MEM 2
+#define PORT_UNKNOWN 0
+#define PORT_8250 1
+#define PORT_16450 2
+#define PORT_16550 3
+#define PORT_16550A 4
+#define PORT_CIRRUS 5
+#define PORT_16650 6
+#define PORT_16650V2 7
+#define PORT_16750 8
+#define PORT_STARTECH 9
+#define PORT_16C950 10
+#define PORT_16654 11
+#define PORT_16850 12
+#define PORT_RSA 13
+#define PORT_NS16550A 14
+#define PORT_XSCALE 15
+#define UART_NATSEMI (1 << 9)
+#define UART_CONFIG_TYPE (1 << 0)
+#define UART_XMIT_SIZE PAGE_SIZE
+#define WAKEUP_CHARS 256
+#define uart_circ_empty(circ) ((circ)->head == (circ)->tail)
+#define uart_circ_clear(circ) ((circ)->head = (circ)->tail = 0)
+#define uart_circ_chars_pending(circ) (CIRC_CNT((circ)->head, (circ)->tail, UART_XMIT_SIZE))
+#define uart_circ_chars_free(circ) (CIRC_SPACE((circ)->head, (circ)->tail, UART_XMIT_SIZE))
+#define UART_ENABLE_MS(port,cflag) ((port)->flags & 0 || !((cflag) & CLOCAL))
+int uart_tx_stopped(struct uart_port *port);
+void uart_write_wakeup(struct uart_port *port);
+int uart_handle_break(struct uart_port *port);
+int uart_handle_sysrq_char(struct uart_port *port, unsigned int ch);
+void uart_insert_char(struct uart_port *port, unsigned int status, unsigned int overrun, unsigned int ch, unsigned int flag);
+void uart_handle_dcd_change(struct uart_port *port, unsigned int status);
+void uart_handle_cts_change(struct uart_port *port, unsigned int status);
+unsigned int uart_get_baud_rate(struct uart_port *port, struct ktermios *termios, const struct ktermios *old, unsigned int min, unsigned int max);
+unsigned int uart_get_divisor(struct uart_port *port, unsigned int baud);
+void uart_update_timeout(struct uart_port *port, unsigned int cflag, unsigned int baud);
+int uart_add_one_port(struct uart_driver *reg, struct uart_port *port);
+int uart_remove_one_port(struct uart_driver *reg, struct uart_port *port);
+int uart_register_driver(struct uart_driver *uart);
+void uart_unregister_driver(struct uart_driver *uart);
+void tty_flip_buffer_push(struct tty_port *port);
+int tty_insert_flip_string(struct tty_port *port, const unsigned char *chars, size_t size);
+int tty_insert_flip_char(struct tty_port *port, unsigned char ch, char flag);
+struct pt_regs;
+struct tty_struct { struct tty_port *port; int index; void *driver_data; struct ktermios termios; };
+struct timer_list { void (*function)(struct timer_list *); unsigned long expires; };
+void timer_setup(struct timer_list *t, void (*fn)(struct timer_list *), unsigned int flags);
+int mod_timer(struct timer_list *t, unsigned long expires);
+int del_timer_sync(struct timer_list *t);
+#define from_timer(var, t, field) container_of(t, __typeof__(*var), field)
+/* async */
+typedef unsigned long long async_cookie_t;
+struct async_domain { int x; };
+#define ASYNC_DOMAIN_EXCLUSIVE(n) struct async_domain n
+typedef void (*async_func_t)(void *data, async_cookie_t cookie);
+async_cookie_t async_schedule_domain(async_func_t fn, void *data, struct async_domain *d);
+void async_synchronize_full_domain(struct async_domain *d);
+/* fs / cdev / device / poll / mm */
+struct inode { dev_t i_rdev; void *i_private; };
+struct file { void *private_data; unsigned int f_flags; fmode_t f_mode; struct inode *f_inode; };
+typedef unsigned long pgprot_t;
+struct vm_area_struct { unsigned long vm_start, vm_end, vm_pgoff, vm_flags; void *vm_private_data; pgprot_t vm_page_prot; };
+#define pgprot_noncached(p) (p)
+int io_remap_pfn_range(struct vm_area_struct *, unsigned long, unsigned long, unsigned long, pgprot_t);
+struct poll_table_struct;
+typedef struct poll_table_struct poll_table;
+void poll_wait(struct file *f, wait_queue_head_t *w, poll_table *p);
+#define POLLIN 0x0001
+#define POLLPRI 0x0002
+#define POLLOUT 0x0004
+#define POLLERR 0x0008
+#define POLLHUP 0x0010
+#define POLLRDNORM 0x0040
+#define POLLWRNORM 0x0100
+#define EPOLLIN POLLIN
+#define EPOLLOUT POLLOUT
+#define EPOLLRDNORM POLLRDNORM
+#define EPOLLWRNORM POLLWRNORM
+#define EPOLLERR POLLERR
+#define EPOLLHUP POLLHUP
+#define O_NONBLOCK 04000
+struct pipe_inode_info;
+struct file_operations {
+	struct module *owner;
+	loff_t (*llseek)(struct file *, loff_t, int);
+	ssize_t (*read)(struct file *, char __user *, size_t, loff_t *);
+	ssize_t (*write)(struct file *, const char __user *, size_t, loff_t *);
+	__poll_t (*poll)(struct file *, poll_table *);
+	long (*unlocked_ioctl)(struct file *, unsigned int, unsigned long);
+	long (*compat_ioctl)(struct file *, unsigned int, unsigned long);
+	int (*mmap)(struct file *, struct vm_area_struct *);
+	int (*open)(struct inode *, struct file *);
+	int (*release)(struct inode *, struct file *);
+	ssize_t (*splice_write)(struct pipe_inode_info *, struct file *, loff_t *, size_t, unsigned int);
+};
+loff_t noop_llseek(struct file *f, loff_t o, int w);
+loff_t no_llseek(struct file *f, loff_t o, int w);
+int nonseekable_open(struct inode *i, struct file *f);
+struct cdev { struct module *owner; const struct file_operations *ops; };
+void cdev_init(struct cdev *c, const struct file_operations *f);
+int cdev_add(struct cdev *c, dev_t d, unsigned int n);
+void cdev_del(struct cdev *c);
+int alloc_chrdev_region(dev_t *d, unsigned int first, unsigned int n, const char *name);
+void unregister_chrdev_region(dev_t d, unsigned int n);
+#define MINORBITS 20
+#define MAJOR(d) ((unsigned int)((d) >> MINORBITS))
+#define MINOR(d) ((unsigned int)((d) & ((1U << MINORBITS) - 1)))
+#define MKDEV(ma,mi) (((ma) << MINORBITS) | (mi))
+unsigned int iminor(const struct inode *i);
+struct class;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,4,0)
+struct class *class_create(const char *name);
+#else
+struct class *__class_create(struct module *o, const char *name);
+#define class_create(o, n) __class_create(o, n)
+#endif
+void class_destroy(struct class *c);
+struct device *device_create(struct class *c, struct device *parent, dev_t d, void *drvdata, const char *fmt, ...);
+void device_destroy(struct class *c, dev_t d);
+void *dev_get_drvdata(const struct device *d);
+int remap_vmalloc_range(struct vm_area_struct *vma, void *addr, unsigned long pgoff);
+unsigned long copy_to_user(void __user *to, const void *from, unsigned long n);
+unsigned long copy_from_user(void *to, const void __user *from, unsigned long n);
+#define put_user(x, p) ({ *(p) = (x); 0; })
+#define get_user(x, p) ({ (x) = *(p); 0; })
+#define waitqueue_active(w) (1)
+/* misc */
+#define MISC_DYNAMIC_MINOR 255
+struct miscdevice { int minor; const char *name; const struct file_operations *fops; struct device *this_device; const struct attribute_group **groups; umode_t mode; };
+int misc_register(struct miscdevice *m);
+void misc_deregister(struct miscdevice *m);
+#define EAGAIN 11
+/* jump label */
+struct static_key_false { int enabled; };
+#define DEFINE_STATIC_KEY_FALSE(n) struct static_key_false n
+#define DEFINE_STATIC_KEY_TRUE(n) struct static_key_false n = { 1 }
+#define static_branch_unlikely(k) ((k)->enabled)
+#define static_branch_likely(k) ((k)->enabled)
+void static_branch_inc(struct static_key_false *k);
+void static_branch_dec(struct static_key_false *k);
+void static_branch_enable(struct static_key_false *k);
+void static_branch_disable(struct static_key_false *k);
+#define static_key_enabled(k) ((k)->enabled)
+/* tracepoints, never enabled */
+#define TP_PROTO(args...) args
+#define TP_ARGS(args...) args
+#define DECLARE_EVENT_CLASS(name, proto, args, tstruct, assign, print)
+#define DEFINE_EVENT(cls, name, proto, args) \
+	static inline void trace_##name(proto) { } \
+	static inline bool trace_##name##_enabled(void) { return false; }
+#define TRACE_EVENT(name, proto, args, tstruct, assign, print) \
+	static inline void trace_##name(proto) { } \
+	static inline bool trace_##name##_enabled(void) { return false; }
+/* percpu, single CPU */
+void *__alloc_percpu(size_t size);
+#define alloc_percpu(type) ((type *)__alloc_percpu(sizeof(type)))
+void free_percpu(void *p);
+#define per_cpu_ptr(p, cpu) ((void)(cpu), (p))
+#define for_each_possible_cpu(cpu) for ((cpu) = 0; (cpu) < 1; (cpu)++)
+#define __this_cpu_inc(v) ((v)++)
+#define fls64(x) ((x) ? 64 - __builtin_clzll(x) : 0)
+/* debugfs, seq_file */
+struct dentry;
+struct dentry *debugfs_create_dir(const char *name, struct dentry *parent);
+struct dentry *debugfs_create_file(const char *name, umode_t mode, struct dentry *parent, void *data, const struct file_operations *fops);
+void debugfs_remove_recursive(struct dentry *d);
+struct seq_file { void *private; };
+int seq_printf(struct seq_file *m, const char *fmt, ...);
+int seq_puts(struct seq_file *m, const char *s);
+int single_open(struct file *f, int (*show)(struct seq_file *, void *), void *data);
+int single_release(struct inode *i, struct file *f);
+ssize_t seq_read(struct file *f, char __user *b, size_t n, loff_t *p);
+loff_t seq_lseek(struct file *f, loff_t o, int w);
+loff_t default_llseek(struct file *f, loff_t o, int w);
+struct inode *file_inode(const struct file *f);
+ssize_t simple_read_from_buffer(void __user *to, size_t count, loff_t *ppos, const void *from, size_t available);
+int kstrtobool_from_user(const char __user *s, size_t count, bool *res);
+/* workqueue */
+struct work_struct { void (*func)(struct work_struct *); };
+#define INIT_WORK(w, f) ((w)->func = (f))
+extern bool schedule_work(struct work_struct *w);
+extern bool cancel_work_sync(struct work_struct *w);
+extern bool flush_work(struct work_struct *w);
+/* delayed work, tty driver */
+struct timer_list_stub { int x; };
+struct delayed_work { struct work_struct work; struct timer_list_stub timer; };
+#define INIT_DELAYED_WORK(w, f) INIT_WORK(&(w)->work, (f))
+#define to_delayed_work(w) container_of(w, struct delayed_work, work)
+extern bool schedule_delayed_work(struct delayed_work *w, unsigned long d);
+extern bool cancel_delayed_work_sync(struct delayed_work *w);
+extern unsigned long msecs_to_jiffies(unsigned int m);
+struct tty_port_operations {
+	int (*activate)(struct tty_port *, struct tty_struct *);
+	void (*shutdown)(struct tty_port *);
+};
+struct file;
+struct tty_operations {
+	int (*install)(struct tty_driver *, struct tty_struct *);
+	int (*open)(struct tty_struct *, struct file *);
+	void (*close)(struct tty_struct *, struct file *);
+	void (*hangup)(struct tty_struct *);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,6,0)
+	ssize_t (*write)(struct tty_struct *, const u8 *, size_t);
+#else
+	int (*write)(struct tty_struct *, const unsigned char *, int);
+#endif
+	unsigned int (*write_room)(struct tty_struct *);
+	int (*ioctl)(struct tty_struct *, unsigned int, unsigned long);
+};
+struct tty_driver { const char *driver_name; const char *name; int major; int minor_start; short type, subtype; struct ktermios init_termios; };
+extern struct ktermios tty_std_termios;
+#define TTY_DRIVER_REAL_RAW 4
+#define TTY_DRIVER_DYNAMIC_DEV 8
+#define TTY_DRIVER_TYPE_SERIAL 3
+#define SERIAL_TYPE_NORMAL 1
+#define INT_MAX 0x7fffffff
+#define ULONG_MAX (~0UL)
+#define USHRT_MAX 0xffff
+struct tty_driver *tty_alloc_driver(unsigned int lines, unsigned long flags);
+void tty_set_operations(struct tty_driver *d, const struct tty_operations *op);
+int tty_register_driver(struct tty_driver *d);
+void tty_unregister_driver(struct tty_driver *d);
+void tty_driver_kref_put(struct tty_driver *d);
+void tty_port_init(struct tty_port *p);
+void tty_port_destroy(struct tty_port *p);
+struct device *tty_port_register_device(struct tty_port *p, struct tty_driver *d, unsigned index, struct device *dev);
+void tty_unregister_device(struct tty_driver *d, unsigned index);
+int tty_port_install(struct tty_port *p, struct tty_driver *d, struct tty_struct *t);
+int tty_port_open(struct tty_port *p, struct tty_struct *t, struct file *f);
+void tty_port_close(struct tty_port *p, struct tty_struct *t, struct file *f);
+void tty_port_hangup(struct tty_port *p);
+void tty_port_tty_wakeup(struct tty_port *p);
+/* net */
+struct net_device_stats { unsigned long rx_packets, tx_packets, rx_bytes, tx_bytes, rx_errors, tx_errors, rx_dropped, tx_dropped, rx_length_errors, rx_over_errors, rx_crc_errors, rx_frame_errors; };
+struct net_device;
+struct sk_buff { unsigned char *data; unsigned int len; unsigned short protocol; struct net_device *dev; struct sk_buff *next, *prev; };
+struct sk_buff_head { struct sk_buff *next, *prev; unsigned int qlen; };
+struct napi_struct { int x; };
+typedef int netdev_tx_t;
+#define NETDEV_TX_OK 0
+#define NETDEV_TX_BUSY 16
+struct net_device_ops { int (*ndo_open)(struct net_device *); int (*ndo_stop)(struct net_device *); netdev_tx_t (*ndo_start_xmit)(struct sk_buff *, struct net_device *); };
+struct net_device { char name[16]; const struct net_device_ops *netdev_ops; unsigned short type; unsigned short hard_header_len; unsigned char addr_len; unsigned int mtu, min_mtu, max_mtu; unsigned long tx_queue_len; unsigned int flags; struct net_device_stats stats; };
+#define ARPHRD_NONE 0xfffe
+#define IFF_POINTOPOINT 0x10
+#define IFF_NOARP 0x80
+#define NET_NAME_UNKNOWN 0
+#define NAPI_POLL_WEIGHT 64
+#define ETH_P_IP 0x0800
+#define ETH_P_IPV6 0x86dd
+#define PPP_INITFCS 0xffff
+#define PPP_GOODFCS 0xf0b8
+u16 crc_ccitt(u16 crc, const u8 *buf, size_t len);
+unsigned short htons(unsigned short);
+struct net_device *alloc_netdev(int sizeof_priv, const char *name, unsigned char assign, void (*setup)(struct net_device *));
+void *netdev_priv(const struct net_device *dev);
+int register_netdev(struct net_device *dev);
+void unregister_netdev(struct net_device *dev);
+void free_netdev(struct net_device *dev);
+void netif_napi_add(struct net_device *dev, struct napi_struct *n, int (*poll)(struct napi_struct *, int));
+void netif_napi_del(struct napi_struct *n);
+void napi_enable(struct napi_struct *n);
+void napi_disable(struct napi_struct *n);
+void napi_schedule(struct napi_struct *n);
+bool napi_complete_done(struct napi_struct *n, int work);
+struct sk_buff *napi_alloc_skb(struct napi_struct *n, unsigned int len);
+void *skb_put_data(struct sk_buff *skb, const void *data, unsigned int len);
+void __skb_queue_head_init(struct sk_buff_head *l);
+void __skb_queue_tail(struct sk_buff_head *l, struct sk_buff *skb);
+struct sk_buff *__skb_dequeue(struct sk_buff_head *l);
+void skb_reset_mac_header(struct sk_buff *skb);
+void kfree_skb(struct sk_buff *skb);
+void dev_kfree_skb_any(struct sk_buff *skb);
+void dev_consume_skb_any(struct sk_buff *skb);
+int netif_receive_skb(struct sk_buff *skb);
+void netif_start_queue(struct net_device *dev);
+void netif_stop_queue(struct net_device *dev);
+void netif_wake_queue(struct net_device *dev);
+/* serdev, of */
+struct device_node;
+struct device_stub { struct device_node *of_node; };
+enum serdev_parity { SERDEV_PARITY_NONE, SERDEV_PARITY_EVEN, SERDEV_PARITY_ODD };
+struct serdev_controller;
+struct serdev_controller_ops {
+	ssize_t (*write_buf)(struct serdev_controller *, const u8 *, size_t);
+	void (*write_flush)(struct serdev_controller *);
+	int (*write_room)(struct serdev_controller *);
+	int (*open)(struct serdev_controller *);
+	void (*close)(struct serdev_controller *);
+	void (*set_flow_control)(struct serdev_controller *, bool);
+	int (*set_parity)(struct serdev_controller *, enum serdev_parity);
+	unsigned int (*set_baudrate)(struct serdev_controller *, unsigned int);
+	void (*wait_until_sent)(struct serdev_controller *, long);
+	int (*get_tiocm)(struct serdev_controller *);
+	int (*set_tiocm)(struct serdev_controller *, unsigned int, unsigned int);
+};
+struct serdev_controller { struct device_stub dev; const struct serdev_controller_ops *ops; };
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,8,0)
+struct serdev_controller *serdev_controller_alloc(struct device *host, struct device *parent, size_t size);
+size_t serdev_controller_receive_buf(struct serdev_controller *c, const u8 *d, size_t n);
+#else
+struct serdev_controller *serdev_controller_alloc(struct device *parent, size_t size);
+int serdev_controller_receive_buf(struct serdev_controller *c, const unsigned char *d, size_t n);
+#endif
+void *serdev_controller_get_drvdata(const struct serdev_controller *c);
+int serdev_controller_add(struct serdev_controller *c);
+void serdev_controller_remove(struct serdev_controller *c);
+void serdev_controller_put(struct serdev_controller *c);
+void serdev_controller_write_wakeup(struct serdev_controller *c);
+struct device_node *of_find_node_by_path(const char *path);
+void of_node_put(struct device_node *np);
+const char *dev_name(const void *dev);
+void tty_termios_encode_baud_rate(struct ktermios *t, unsigned int ibaud, unsigned int obaud);
+unsigned int tty_termios_baud_rate(struct ktermios *t);
+void msleep(unsigned int ms);
+
+/* uio */
+#define UIO_IRQ_CUSTOM -1
+#define UIO_MEM_PHYS 1
+struct uio_mem { const char *name; unsigned long addr; unsigned long offs; unsigned long size; int memtype; };
+struct uio_info { const char *name; const char *version; struct uio_mem mem[5]; long irq; void *priv; int (*irqcontrol)(struct uio_info *, s32); int (*mmap)(struct uio_info *, struct vm_area_struct *); };
+int uio_register_device(struct device *, struct uio_info *);
+void uio_unregister_device(struct uio_info *);
+void uio_event_notify(struct uio_info *);
+int is_vmalloc_addr(const void *);
+unsigned long vmalloc_to_pfn(const void *);
+#define PFN_PHYS(x) ((unsigned long)(x) << 12)
+#define offset_in_page(p) ((unsigned long)(p) & (PAGE_SIZE-1))
+void device_unregister(struct device *);
+
+/* bpf */
+struct bpf_prog;
+enum bpf_prog_type { BPF_PROG_TYPE_SOCKET_FILTER = 1 };
+struct bpf_prog *bpf_prog_get_type(u32 ufd, enum bpf_prog_type type);
+void bpf_prog_put(struct bpf_prog *);
+#define CAP_NET_ADMIN 12
+#define CAP_SYS_ADMIN 21
+bool capable(int cap);
+u32 bpf_prog_run_save_cb(const struct bpf_prog *, struct sk_buff *);
+struct sk_buff *alloc_skb(unsigned int size, gfp_t pri);
+void *skb_put(struct sk_buff *, unsigned int);
+void __skb_trim(struct sk_buff *, unsigned int);
+
+/* splice */
+struct pipe_inode_info;
+struct pipe_buffer { struct page *page; unsigned int offset, len; };
+struct splice_desc { size_t total_len; unsigned int len; unsigned int flags; union { void *data; struct file *file; } u; loff_t pos; };
+#define SPLICE_F_NONBLOCK 0x02
+typedef int (splice_actor)(struct pipe_inode_info *, struct pipe_buffer *, struct splice_desc *);
+ssize_t __splice_from_pipe(struct pipe_inode_info *, struct splice_desc *, splice_actor *);
+void pipe_lock(struct pipe_inode_info *);
+void pipe_unlock(struct pipe_inode_info *);
+void *kmap_local_page(struct page *);
+void kunmap_local(void *);
+void get_page(struct page *);
+void put_page(struct page *);
+
+/* kshim.c: sink of the tty layer, checked by the benchmark */
+struct kshim_rx {
+	unsigned long long	chars;		/* uart_insert_char() calls			*/
+	unsigned long long	errors;		/* ... with flag != TTY_NORMAL		*/
+	unsigned long long	pushes;		/* tty_flip_buffer_push() calls		*/
+	unsigned int		sum;		/* sum of all chars					*/
+};
+extern struct kshim_rx kshim_rx;
+extern int kshim_verbose;
+void kshim_trap(const char *name);
+
+#endif /* _KSHIM_H */
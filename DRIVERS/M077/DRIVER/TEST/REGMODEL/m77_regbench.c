@@ -0,0 +1,432 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  m77_regbench.c
+ *
+ *      \author  thomas schnuerer
+ *
+ *       \brief  User space benchmark of the serial_m77.c hot paths
+ *
+ *               serial_m77.c is compiled unchanged into this program, see
+ *               kshim.h. Its register accesses go to the register model
+ *               of MOCK/regmodel.c, which counts them. For 1 to 64 ports on
+ *               M77 (4 per M-Module) or M45N (8 per M-Module) it runs
+ *
+ *               rx      chars put into the RX FIFOs, M77_IrqHandler()
+ *                       called until no interrupt is pending
+ *               tx      the tty xmit buffers filled, start_tx() and
+ *                       M77_IrqHandler() until all is sent, the TX FIFOs
+ *                       are drained completely after each interrupt
+ *               termios set_termios() with alternating baudrates
+ *
+ *               One line per scenario and port count, whitespace
+ *               separated, the header line starts with '#':
+ *
+ *               scenario ports units count isr mmio_rd mmio_wr
+ *               units_per_mmio mmio_per_unit host_ns_per_unit
+ *               bus_ns_per_unit
+ *
+ *               units are bytes for rx/tx and calls for termios.
+ *               host_ns_per_unit is the CPU time of the driver code
+ *               including the register model, only compare it between
+ *               builds on the same host. bus_ns_per_unit is the time
+ *               the accesses would take on the M-Module bus with the
+ *               access times set by -r/-w.
+ *
+ *               Build and run on the development host:
+ *               make && ./m77_regbench
+ *
+ *     Switches: -
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../../serial_m77.c"
+
+#include <unistd.h>
+#include <time.h>
+
+/*-----------------------------+
+|   DEFINES                    |
++-----------------------------*/
+#define MAX_PORTS		64
+#define ISR_LOOP_MAX	10000		/* ISR calls until the IRQ must be gone */
+
+/*-----------------------------+
+|   TYPEDEFS                   |
++-----------------------------*/
+/** result of one scenario */
+struct bench_res {
+	const char			*name;
+	const char			*units;
+	unsigned long long	count;		/* bytes or calls					*/
+	unsigned long long	isr;		/* M77_IrqHandler() calls			*/
+	unsigned long long	hostNs;
+	struct rm_stats		st;
+};
+
+/*-----------------------------+
+|   GLOBALS                    |
++-----------------------------*/
+static unsigned int G_modtype = MOD_M77;
+static unsigned int G_rounds = 200;
+static unsigned int G_burst = 64;
+static unsigned int G_txLen = 2048;
+static unsigned int G_nPorts;
+static struct ox16c954_port *G_port[MAX_PORTS];
+static unsigned int G_portMod[MAX_PORTS];	/* model M-Module of port	*/
+static unsigned int G_portChan[MAX_PORTS];
+static UARTMOD_INFO *G_firstMod;
+
+
+static void usage(void)
+{
+	printf("Usage: m77_regbench [<opts>]\n"
+		   "Benchmark of the serial_m77.c hot paths on a register model\n"
+		   "  -t <type>    m77, m69 or m45 ...................... [m77]\n"
+		   "  -p <list>    port counts, e.g. 1,4,64 ..... [1,2,4,8,16,32,64]\n"
+		   "  -n <n>       rounds per scenario .................. [200]\n"
+		   "  -b <n>       rx: chars per port and round, max. 128 [64]\n"
+		   "  -l <n>       tx: bytes per port and round, max. 4095 [2048]\n"
+		   "  -r <ns>      simulated bus time of a D16 read ..... [500]\n"
+		   "  -w <ns>      simulated bus time of a D16 write .... [250]\n"
+		   "  -v           show driver messages\n");
+}
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*******************************************************************/
+/** Create the M-Modules for nPorts ports and open the ports
+ *
+ * \param nPorts	\IN number of ports used
+ *
+ * \return 			0 or negative error code
+ */
+static int bench_setup(unsigned int nPorts)
+{
+	unsigned int chans = (G_modtype == MOD_M45) ? 8 : 4;
+	unsigned int nMods = (nPorts + chans - 1) / chans;
+	unsigned int i, p = 0;
+	struct ktermios termios;
+	UARTMOD_INFO *mmod;
+	int ret;
+
+	if (rm_init(nMods, G_modtype) < 0)
+		return -ENOMEM;
+
+	for (i = 0; i < nMods; i++) {
+		mmod = kzalloc(sizeof(*mmod), GFP_KERNEL);
+		if (!mmod)
+			return -ENOMEM;
+		mmod->memBase		= rm_mod_base(i);
+		mmod->modtype		= G_modtype;
+		mmod->nrChannels	= chans;
+		mmod->modnum		= i;
+		mmod->lineBase		= i * chans;
+		mutex_init(&mmod->lock);
+		snprintf(mmod->deviceName, ARRLEN, "model_%u", i);
+		list_add_tail(&mmod->head, &G_uartModListHead);
+
+		if ((ret = register_uarts(mmod)) < 0)
+			return ret;
+		smp_store_release(&mmod->ready, 1);
+		if (!i)
+			G_firstMod = mmod;
+
+		for ( ; p < nPorts && p < (i + 1) * chans; p++) {
+			G_port[p]		= &mmod->ports[p - i * chans];
+			G_portMod[p]	= i;
+			G_portChan[p]	= p - i * chans;
+		}
+	}
+
+	memset(&termios, 0, sizeof(termios));
+	termios.c_cflag	 = CS8 | CREAD | CLOCAL;
+	termios.c_ospeed = 115200;
+	for (p = 0; p < nPorts; p++) {
+		if ((ret = men_uart_startup(&G_port[p]->port)) < 0)
+			return ret;
+		men_uart_set_termios(&G_port[p]->port, &termios, NULL);
+	}
+	G_nPorts = nPorts;
+	return 0;
+}
+
+/*******************************************************************/
+/** Close the ports and remove the M-Modules
+ *
+ * \return 			-
+ */
+static void bench_teardown(void)
+{
+	unsigned int p;
+
+	for (p = 0; p < G_nPorts; p++)
+		men_uart_shutdown(&G_port[p]->port);
+	deinit_devices();
+	rm_exit();
+	G_nPorts = 0;
+}
+
+/*******************************************************************/
+/** Call the ISR until the M-Modules release the interrupt
+ *
+ * \param res		\IN scenario result, ISR calls and time are added
+ *
+ * \return 			0 or -1 if the interrupt got stuck
+ */
+static int bench_isr(struct bench_res *res)
+{
+	unsigned long long t0;
+	int loops = 0;
+
+	while (rm_irq_pending()) {
+		if (++loops > ISR_LOOP_MAX) {
+			fprintf(stderr, "*** %s: interrupt stuck\n", res->name);
+			return -1;
+		}
+		t0 = now_ns();
+		M77_IrqHandler(G_firstMod);
+		res->hostNs += now_ns() - t0;
+		res->isr++;
+	}
+	return 0;
+}
+
+/*******************************************************************/
+/** rx: receive G_burst chars per port and round
+ *
+ * \param res		\OUT scenario result
+ *
+ * \return 			0 or -1 on error
+ */
+static int bench_rx(struct bench_res *res)
+{
+	unsigned char buf[RM_FIFO_SIZE];
+	unsigned int r, p, i;
+	unsigned int sum = 0;
+
+	res->name	= "rx";
+	res->units	= "bytes";
+	memset(&kshim_rx, 0, sizeof(kshim_rx));
+	rm_clear_stats();
+
+	for (r = 0; r < G_rounds; r++) {
+		for (p = 0; p < G_nPorts; p++) {
+			for (i = 0; i < G_burst; i++) {
+				buf[i] = (unsigned char)(r + p + i);
+				sum += buf[i];
+			}
+			rm_rx_inject(G_portMod[p], G_portChan[p], buf, G_burst, 0);
+		}
+		res->count += G_nPorts * G_burst;
+		if (bench_isr(res) < 0)
+			return -1;
+	}
+	rm_get_stats(&res->st);
+
+	if (kshim_rx.chars != res->count || kshim_rx.sum != sum) {
+		fprintf(stderr, "*** rx: %llu of %llu chars received, sum %s\n",
+				kshim_rx.chars, res->count,
+				kshim_rx.sum == sum ? "ok" : "wrong");
+		return -1;
+	}
+	return 0;
+}
+
+/*******************************************************************/
+/** tx: send G_txLen bytes per port and round through the xmit buffer
+ *
+ * \param res		\OUT scenario result
+ *
+ * \return 			0 or -1 on error
+ */
+static int bench_tx(struct bench_res *res)
+{
+	struct circ_buf *xmit;
+	unsigned int r, p, i, sent;
+	unsigned long long t0;
+
+	res->name	= "tx";
+	res->units	= "bytes";
+	rm_clear_stats();
+
+	for (r = 0; r < G_rounds; r++) {
+		for (p = 0; p < G_nPorts; p++) {
+			xmit = &G_port[p]->port.state->xmit;
+			for (i = 0; i < G_txLen; i++) {
+				xmit->buf[xmit->head] = (char)(r + i);
+				xmit->head = (xmit->head + 1) & (UART_XMIT_SIZE - 1);
+			}
+			t0 = now_ns();
+			men_uart_start_tx(&G_port[p]->port);
+			res->hostNs += now_ns() - t0;
+		}
+		res->count += G_nPorts * G_txLen;
+
+		/* the line sends a whole FIFO between two interrupts */
+		do {
+			if (bench_isr(res) < 0)
+				return -1;
+			for (p = 0, sent = 0; p < G_nPorts; p++)
+				sent += rm_tx_drain(G_portMod[p], G_portChan[p], NULL,
+									RM_FIFO_SIZE);
+		} while (sent || rm_irq_pending());
+	}
+	rm_get_stats(&res->st);
+
+	if (res->st.txBytes != res->count) {
+		fprintf(stderr, "*** tx: %llu of %llu bytes sent\n",
+				res->st.txBytes, res->count);
+		return -1;
+	}
+	return 0;
+}
+
+/*******************************************************************/
+/** termios: set_termios() with alternating baudrates
+ *
+ * \param res		\OUT scenario result
+ *
+ * \return 			0
+ */
+static int bench_termios(struct bench_res *res)
+{
+	struct ktermios termios;
+	unsigned int r, p;
+	unsigned long long t0;
+
+	res->name	= "termios";
+	res->units	= "calls";
+	rm_clear_stats();
+
+	memset(&termios, 0, sizeof(termios));
+	termios.c_cflag	= CS8 | CREAD | CLOCAL;
+	for (r = 0; r < G_rounds; r++) {
+		termios.c_ospeed = (r & 1) ? 57600 : 115200;
+		for (p = 0; p < G_nPorts; p++) {
+			t0 = now_ns();
+			men_uart_set_termios(&G_port[p]->port, &termios, NULL);
+			res->hostNs += now_ns() - t0;
+		}
+		res->count += G_nPorts;
+	}
+	rm_get_stats(&res->st);
+	return 0;
+}
+
+static void bench_print(struct bench_res *res)
+{
+	unsigned long long mmio = res->st.rd + res->st.wr;
+	double n = res->count ? (double)res->count : 1.0;
+
+	printf("%-8s %5u %-6s %10llu %8llu %10llu %10llu %8.3f %8.3f %10.2f %10.2f\n",
+		   res->name, G_nPorts, res->units, res->count, res->isr,
+		   res->st.rd, res->st.wr,
+		   mmio ? res->count / (double)mmio : 0.0, mmio / n,
+		   res->hostNs / n, res->st.busNs / n);
+}
+
+int main(int argc, char *argv[])
+{
+	static const unsigned int defPorts[] = { 1, 2, 4, 8, 16, 32, 64 };
+	int (*scenario[])(struct bench_res *) = {
+		bench_rx, bench_tx, bench_termios
+	};
+	unsigned int ports[MAX_PORTS], nPortCnt = 0;
+	unsigned int rdNs = 500, wrNs = 250, i, s;
+	struct bench_res res;
+	char *tok;
+	int opt, err = 0;
+
+	while ((opt = getopt(argc, argv, "t:p:n:b:l:r:w:vh")) != -1) {
+		switch (opt) {
+		case 't':
+			if (!strcmp(optarg, "m77"))
+				G_modtype = MOD_M77;
+			else if (!strcmp(optarg, "m69"))
+				G_modtype = MOD_M69;
+			else if (!strcmp(optarg, "m45"))
+				G_modtype = MOD_M45;
+			else {
+				usage();
+				return 1;
+			}
+			break;
+		case 'p':
+			for (tok = strtok(optarg, ","); tok && nPortCnt < MAX_PORTS;
+				 tok = strtok(NULL, ","))
+				ports[nPortCnt++] = strtoul(tok, NULL, 0);
+			break;
+		case 'n':	G_rounds = strtoul(optarg, NULL, 0);	break;
+		case 'b':	G_burst = strtoul(optarg, NULL, 0);		break;
+		case 'l':	G_txLen = strtoul(optarg, NULL, 0);		break;
+		case 'r':	rdNs = strtoul(optarg, NULL, 0);		break;
+		case 'w':	wrNs = strtoul(optarg, NULL, 0);		break;
+		case 'v':	kshim_verbose = 1;						break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+
+	if (!nPortCnt) {
+		memcpy(ports, defPorts, sizeof(defPorts));
+		nPortCnt = ARRAY_SIZE(defPorts);
+	}
+	if (!G_burst || G_burst > RM_FIFO_SIZE || !G_txLen ||
+		G_txLen >= UART_XMIT_SIZE) {
+		usage();
+		return 1;
+	}
+	rm_set_bus_ns(rdNs, wrNs);
+
+	printf("# m77_regbench type=%s rounds=%u burst=%u txlen=%u "
+		   "rd_ns=%u wr_ns=%u\n",
+		   G_modtype == MOD_M45 ? "m45" :
+		   G_modtype == MOD_M69 ? "m69" : "m77",
+		   G_rounds, G_burst, G_txLen, rdNs, wrNs);
+	printf("# scenario ports units count isr mmio_rd mmio_wr "
+		   "units_per_mmio mmio_per_unit host_ns_per_unit bus_ns_per_unit\n");
+
+	for (i = 0; i < nPortCnt && !err; i++) {
+		if (!ports[i] || ports[i] > MAX_PORTS) {
+			fprintf(stderr, "*** invalid port count %u\n", ports[i]);
+			return 1;
+		}
+		if (bench_setup(ports[i]) < 0) {
+			fprintf(stderr, "*** setup of %u ports failed\n", ports[i]);
+			return 1;
+		}
+		for (s = 0; s < ARRAY_SIZE(scenario) && !err; s++) {
+			memset(&res, 0, sizeof(res));
+			if (scenario[s](&res) < 0)
+				err = 1;
+			else
+				bench_print(&res);
+		}
+		bench_teardown();
+	}
+	return err;
+}
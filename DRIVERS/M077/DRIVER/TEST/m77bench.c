@@ -0,0 +1,750 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  m77bench.c
+ *
+ *      \author  thomas schnuerer
+ *
+ *       \brief  Throughput and latency benchmark of the ttyD lines
+ *
+ *               All given lines run concurrently, for each baudrate and
+ *               M77 PHY mode of the lists:
+ *
+ *               latency     single chars sent one after the other, time
+ *                           from write() until read() returns the char
+ *               throughput  for -t seconds each line sends a counting
+ *                           pattern as fast as possible, the receiver
+ *                           checks it
+ *
+ *               The data goes through (-k):
+ *               loop        UART internal loopback (MCR LOOP), no cable
+ *               plug        external loopback plug on each line
+ *               pair        cable between the lines of each pair in the
+ *                           list, e.g. -l 0,1,2,3: 0-1 and 2-3
+ *
+ *               One line per port and run plus one per run for the
+ *               system, whitespace separated, header lines start with
+ *               '#':
+ *
+ *               port baud phy link line bytes bytes_per_s util_pct
+ *               errors overruns lat_p50_us lat_p90_us lat_p99_us
+ *               lat_p999_us lat_max_us gap_p99_us gap_max_us cpu_pct
+ *
+ *               sys baud phy link ports bytes bytes_per_s cpu_busy_pct
+ *               cpu_irq_pct cpu_softirq_pct
+ *
+ *               util_pct is the throughput relative to the line rate
+ *               (10 bits per char). errors are lost latency probes and
+ *               mismatches of the throughput pattern, a lost char counts
+ *               once. overruns are the UART and tty buffer
+ *               overruns of the receiving line (TIOCGICOUNT), -1 if not
+ *               supported. gap is the time between two read() returning
+ *               data while the sender is busy. cpu_pct is the CPU time
+ *               of the sending and receiving thread of the port, the sys
+ *               line shows the load of all CPUs from /proc/stat, the
+ *               interrupt time of the driver is part of cpu_irq_pct.
+ *
+ *               Build on Commandline using:
+ *               gcc -Wall -O2 -pthread -o m77bench m77bench.c
+ *
+ *     Switches: -
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+#include "../serial_m77.h"
+
+/*-----------------------------+
+|   DEFINES                    |
++-----------------------------*/
+#define MAX_PORTS		64
+#define MAX_LIST		16			/* entries of -b/-m lists			*/
+#define LAT_TIMEOUT_MS	1000		/* a latency probe is lost after	*/
+#define DRAIN_MS		500			/* receiver quiet time at the end	*/
+
+#ifndef TIOCM_LOOP
+#define TIOCM_LOOP		0x8000		/* MCR LOOP, asm/termios.h			*/
+#endif
+
+#define LINK_LOOP		0
+#define LINK_PLUG		1
+#define LINK_PAIR		2
+
+/*-----------------------------+
+|   TYPEDEFS                   |
++-----------------------------*/
+/** growing array of durations in ns */
+struct samples {
+	unsigned long long	*v;
+	unsigned int		n;
+	unsigned int		size;
+};
+
+/** one sending line and the line receiving its data */
+struct port {
+	int					line;
+	int					fd;			/* sending line						*/
+	struct port			*rx;		/* receiving line, self or peer		*/
+	struct termios		saved;		/* restored at exit					*/
+	pthread_t			txThr;
+	pthread_t			rxThr;
+
+	/* results of one run */
+	unsigned long long	bytes;		/* received and checked				*/
+	unsigned long long	firstNs;	/* first and last char received		*/
+	unsigned long long	lastNs;
+	unsigned long long	errors;
+	long long			overruns;	/* -1: TIOCGICOUNT not supported	*/
+	unsigned long long	cpuNs;		/* both threads						*/
+	struct samples		lat;
+	struct samples		gap;
+	volatile int		txDone;
+};
+
+/** /proc/stat cpu line */
+struct cpu_stat {
+	unsigned long long	busy;
+	unsigned long long	irq;
+	unsigned long long	softirq;
+	unsigned long long	total;
+};
+
+/*-----------------------------+
+|   GLOBALS                    |
++-----------------------------*/
+static struct port G_port[MAX_PORTS];
+static unsigned int G_nPorts;
+static unsigned int G_baud[MAX_LIST] = { 115200 };
+static unsigned int G_nBaud = 1;
+static int G_phy[MAX_LIST] = { -1 };	/* -1: PHY mode not changed		*/
+static unsigned int G_nPhy = 1;
+static int G_link = LINK_LOOP;
+static unsigned int G_secs = 5;
+static unsigned int G_probes = 200;
+static unsigned int G_block = 256;
+static int G_rtscts;
+static int G_verbose;
+static const char *G_linkName[] = { "loop", "plug", "pair" };
+
+static const struct {
+	unsigned int	baud;
+	speed_t			speed;
+} G_speeds[] = {
+	{ 1200, B1200 },		{ 2400, B2400 },		{ 4800, B4800 },
+	{ 9600, B9600 },		{ 19200, B19200 },		{ 38400, B38400 },
+	{ 57600, B57600 },		{ 115200, B115200 },	{ 230400, B230400 },
+	{ 460800, B460800 },	{ 576000, B576000 },	{ 921600, B921600 },
+	{ 1152000, B1152000 },
+};
+
+
+static void usage(void)
+{
+	printf("Usage: m77bench [<opts>] -l <lines>\n"
+		   "Throughput and latency of ttyD lines, all lines concurrently\n"
+		   "  -l <list>    ttyD lines, e.g. 0-3,8 (pairs for -k pair)\n"
+		   "  -k <link>    loop, plug or pair, see header ...... [loop]\n"
+		   "  -b <list>    baudrates, e.g. 9600,115200,921600 .. [115200]\n"
+		   "  -m <list>    M77 PHY modes 1,2,3,4,7 (M77_PHYS_INT_SET) [unchanged]\n"
+		   "  -t <s>       throughput time per run ............. [5]\n"
+		   "  -n <n>       latency probes per port and run ..... [200]\n"
+		   "  -s <n>       bytes per write() ................... [256]\n"
+		   "  -f           RTS/CTS flow control\n"
+		   "  -v           progress messages to stderr\n");
+}
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static unsigned long long thread_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*******************************************************************/
+/** Parse a list like "0-3,8" into vals
+ *
+ * \param s			\IN list
+ * \param vals		\OUT values
+ * \param max		\IN size of vals
+ *
+ * \return 			number of values or -1 on error
+ */
+static int parse_list(const char *s, int *vals, unsigned int max)
+{
+	unsigned int n = 0;
+	long from, to;
+	char *end;
+
+	while (*s) {
+		from = strtol(s, &end, 0);
+		if (end == s)
+			return -1;
+		to = from;
+		if (*end == '-') {
+			s = end + 1;
+			to = strtol(s, &end, 0);
+			if (end == s || to < from)
+				return -1;
+		}
+		for (; from <= to; from++) {
+			if (n == max)
+				return -1;
+			vals[n++] = from;
+		}
+		s = end;
+		if (*s == ',')
+			s++;
+		else if (*s)
+			return -1;
+	}
+	return n;
+}
+
+static void samples_add(struct samples *s, unsigned long long v)
+{
+	unsigned long long *nv;
+
+	if (s->n == s->size) {
+		nv = realloc(s->v, (s->size ? 2 * s->size : 1024) * sizeof(*nv));
+		if (!nv)
+			return;		/* keep the samples so far */
+		s->v = nv;
+		s->size = s->size ? 2 * s->size : 1024;
+	}
+	s->v[s->n++] = v;
+}
+
+static int cmp_ull(const void *a, const void *b)
+{
+	unsigned long long x = *(const unsigned long long *)a;
+	unsigned long long y = *(const unsigned long long *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/*******************************************************************/
+/** Percentile of sorted samples in us
+ *
+ * \param s			\IN samples, sorted
+ * \param permille	\IN percentile * 10, 1000 = max.
+ *
+ * \return 			us, -1 without samples
+ */
+static double samples_pct(struct samples *s, unsigned int permille)
+{
+	unsigned int i;
+
+	if (!s->n)
+		return -1;
+	i = (unsigned long long)s->n * permille / 1000;
+	if (i >= s->n)
+		i = s->n - 1;
+	return s->v[i] / 1000.0;
+}
+
+static void cpu_stat_read(struct cpu_stat *cs)
+{
+	unsigned long long v[8] = { 0 };
+	FILE *f = fopen("/proc/stat", "r");
+
+	memset(cs, 0, sizeof(*cs));
+	if (!f)
+		return;
+	/* user nice system idle iowait irq softirq steal */
+	if (fscanf(f, "cpu %llu %llu %llu %llu %llu %llu %llu %llu", &v[0],
+			   &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]) == 8) {
+		cs->total	= v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+		cs->busy	= cs->total - v[3] - v[4];
+		cs->irq		= v[5];
+		cs->softirq	= v[6];
+	}
+	fclose(f);
+}
+
+/*******************************************************************/
+/** Sum of the RX overruns of a line
+ *
+ * \param fd		\IN line
+ *
+ * \return 			overrun + buf_overrun or -1
+ */
+static long long line_overruns(int fd)
+{
+	struct serial_icounter_struct ic;
+
+	if (ioctl(fd, TIOCGICOUNT, &ic) < 0)
+		return -1;
+	return (long long)ic.overrun + ic.buf_overrun;
+}
+
+/*******************************************************************/
+/** Set baudrate and raw mode of a line
+ *
+ * \param p			\IN port
+ * \param baud		\IN baudrate
+ *
+ * \return 			0 or -1
+ */
+static int line_setup(struct port *p, unsigned int baud)
+{
+	struct termios t;
+	unsigned int i;
+
+	for (i = 0; i < sizeof(G_speeds) / sizeof(G_speeds[0]); i++)
+		if (G_speeds[i].baud == baud)
+			break;
+	if (i == sizeof(G_speeds) / sizeof(G_speeds[0])) {
+		fprintf(stderr, "*** baudrate %u not supported\n", baud);
+		return -1;
+	}
+
+	if (tcgetattr(p->fd, &t) < 0)
+		return -1;
+	cfmakeraw(&t);
+	t.c_cflag |= CLOCAL | CREAD;
+	t.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+	if (G_rtscts)
+		t.c_cflag |= CRTSCTS;
+	t.c_cc[VMIN]  = 0;
+	t.c_cc[VTIME] = 0;
+	cfsetispeed(&t, G_speeds[i].speed);
+	cfsetospeed(&t, G_speeds[i].speed);
+	if (tcsetattr(p->fd, TCSANOW, &t) < 0)
+		return -1;
+	return tcflush(p->fd, TCIOFLUSH);
+}
+
+/*******************************************************************/
+/** Read available chars of a line, wait up to ms
+ *
+ * \param fd		\IN line
+ * \param buf		\OUT chars
+ * \param len		\IN size of buf
+ * \param ms		\IN timeout
+ *
+ * \return 			number of chars, 0 on timeout, -1 on error
+ */
+static int line_read(int fd, unsigned char *buf, int len, int ms)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	int n;
+
+	n = poll(&pfd, 1, ms);
+	if (n <= 0)
+		return n;
+	n = read(fd, buf, len);
+	if (n < 0 && (errno == EAGAIN || errno == EINTR))
+		return 0;
+	return n;
+}
+
+/*******************************************************************/
+/** Latency thread of a port: one char at a time
+ *
+ * \param arg		\IN port
+ *
+ * \return 			NULL
+ */
+static void *lat_thread(void *arg)
+{
+	struct port *p = arg;
+	unsigned char c, r;
+	unsigned long long t0, t1;
+	unsigned int i;
+	int n;
+
+	for (i = 0; i < G_probes; i++) {
+		c = i;
+		t0 = now_ns();
+		if (write(p->fd, &c, 1) != 1)
+			break;
+		n = line_read(p->rx->fd, &r, 1, LAT_TIMEOUT_MS);
+		t1 = now_ns();
+		if (n != 1 || r != c) {
+			p->errors++;
+			tcflush(p->rx->fd, TCIFLUSH);
+			continue;
+		}
+		samples_add(&p->lat, t1 - t0);
+	}
+	return NULL;
+}
+
+/*******************************************************************/
+/** Sending thread of a port: counting pattern for G_secs seconds
+ *
+ * \param arg		\IN port
+ *
+ * \return 			NULL
+ */
+static void *tx_thread(void *arg)
+{
+	struct port *p = arg;
+	unsigned char *buf = malloc(G_block);
+	unsigned long long cpu0 = thread_ns();
+	unsigned long long end = now_ns() + G_secs * 1000000000ULL;
+	unsigned char seq = 0;
+	unsigned int i;
+	int n;
+
+	if (buf) {
+		while (now_ns() < end) {
+			for (i = 0; i < G_block; i++)
+				buf[i] = seq + i;
+			n = write(p->fd, buf, G_block);
+			if (n < 0 && errno != EINTR)
+				break;
+			if (n > 0)
+				seq += n;
+		}
+		tcdrain(p->fd);
+	}
+	free(buf);
+	__atomic_add_fetch(&p->cpuNs, thread_ns() - cpu0, __ATOMIC_RELAXED);
+	p->txDone = 1;
+	return NULL;
+}
+
+/*******************************************************************/
+/** Receiving thread of a port: check the pattern until the line is quiet
+ *
+ * \param arg		\IN port
+ *
+ * \return 			NULL
+ */
+static void *rx_thread(void *arg)
+{
+	struct port *p = arg;
+	unsigned char buf[4096];
+	unsigned long long cpu0 = thread_ns();
+	unsigned long long t, last = 0;
+	unsigned char expect = 0;
+	int i, n, first = 1;
+
+	for (;;) {
+		n = line_read(p->rx->fd, buf, sizeof(buf), DRAIN_MS);
+		if (n < 0)
+			break;
+		if (n == 0) {
+			if (p->txDone)
+				break;
+			continue;
+		}
+		t = now_ns();
+		if (first) {
+			p->firstNs = t;
+			expect = buf[0];
+			first = 0;
+		} else if (!p->txDone)
+			samples_add(&p->gap, t - last);
+		last = p->lastNs = t;
+
+		for (i = 0; i < n; i++) {
+			if (buf[i] != expect)
+				p->errors++;
+			expect = buf[i] + 1;	/* resync after a lost char */
+		}
+		p->bytes += n;
+	}
+	__atomic_add_fetch(&p->cpuNs, thread_ns() - cpu0, __ATOMIC_RELAXED);
+	return NULL;
+}
+
+static void port_reset(struct port *p)
+{
+	p->bytes	= 0;
+	p->firstNs	= 0;
+	p->lastNs	= 0;
+	p->errors	= 0;
+	p->overruns	= 0;
+	p->cpuNs	= 0;
+	p->lat.n	= 0;
+	p->gap.n	= 0;
+	p->txDone	= 0;
+}
+
+/*******************************************************************/
+/** Run latency and throughput of all ports for one baudrate/PHY mode
+ *
+ * \param baud		\IN baudrate
+ * \param phy		\IN M77 PHY mode, -1: unchanged
+ *
+ * \return 			0 or -1
+ */
+static int bench_run(unsigned int baud, int phy)
+{
+	struct cpu_stat cs0, cs1;
+	unsigned long long t0, t1, sum = 0;
+	long long ovr0[MAX_PORTS];
+	double secs, total;
+	unsigned int i;
+	struct port *p;
+	char phyStr[8];
+
+	for (i = 0; i < G_nPorts; i++) {
+		p = &G_port[i];
+		if (phy >= 0 && ioctl(p->fd, M77_PHYS_INT_SET, phy) < 0) {
+			fprintf(stderr, "*** ttyD%d: PHY mode %d failed: %s\n",
+					p->line, phy, strerror(errno));
+			return -1;
+		}
+		if (line_setup(p, baud) < 0) {
+			fprintf(stderr, "*** ttyD%d: setup failed: %s\n",
+					p->line, strerror(errno));
+			return -1;
+		}
+		port_reset(p);
+	}
+	snprintf(phyStr, sizeof(phyStr), phy >= 0 ? "%d" : "-", phy);
+
+	if (G_verbose)
+		fprintf(stderr, "baud %u phy %s: latency\n", baud, phyStr);
+	for (i = 0; i < G_nPorts; i++)
+		pthread_create(&G_port[i].txThr, NULL, lat_thread, &G_port[i]);
+	for (i = 0; i < G_nPorts; i++)
+		pthread_join(G_port[i].txThr, NULL);
+
+	if (G_verbose)
+		fprintf(stderr, "baud %u phy %s: throughput\n", baud, phyStr);
+	for (i = 0; i < G_nPorts; i++) {
+		p = &G_port[i];
+		tcflush(p->rx->fd, TCIFLUSH);
+		ovr0[i] = line_overruns(p->rx->fd);
+	}
+	cpu_stat_read(&cs0);
+	t0 = now_ns();
+	for (i = 0; i < G_nPorts; i++) {
+		pthread_create(&G_port[i].rxThr, NULL, rx_thread, &G_port[i]);
+		pthread_create(&G_port[i].txThr, NULL, tx_thread, &G_port[i]);
+	}
+	for (i = 0; i < G_nPorts; i++) {
+		pthread_join(G_port[i].txThr, NULL);
+		pthread_join(G_port[i].rxThr, NULL);
+	}
+	t1 = now_ns();
+	cpu_stat_read(&cs1);
+
+	for (i = 0; i < G_nPorts; i++) {
+		p = &G_port[i];
+		p->overruns = line_overruns(p->rx->fd);
+		if (p->overruns >= 0 && ovr0[i] >= 0)
+			p->overruns -= ovr0[i];
+		else
+			p->overruns = -1;
+
+		qsort(p->lat.v, p->lat.n, sizeof(*p->lat.v), cmp_ull);
+		qsort(p->gap.v, p->gap.n, sizeof(*p->gap.v), cmp_ull);
+		secs = p->lastNs > p->firstNs ?
+			(p->lastNs - p->firstNs) / 1e9 : 0;
+		sum += p->bytes;
+
+		printf("port %u %s %s %d %llu %.0f %.1f %llu %lld "
+			   "%.1f %.1f %.1f %.1f %.1f %.1f %.1f %.2f\n",
+			   baud, phyStr, G_linkName[G_link], p->line, p->bytes,
+			   secs ? p->bytes / secs : 0,
+			   secs ? p->bytes / secs * 1000.0 / baud : 0,
+			   p->errors, p->overruns,
+			   samples_pct(&p->lat, 500), samples_pct(&p->lat, 900),
+			   samples_pct(&p->lat, 990), samples_pct(&p->lat, 999),
+			   samples_pct(&p->lat, 1000),
+			   samples_pct(&p->gap, 990), samples_pct(&p->gap, 1000),
+			   p->cpuNs * 100.0 / (t1 - t0));
+	}
+
+	total = cs1.total - cs0.total;
+	printf("sys %u %s %s %u %llu %.0f %.2f %.2f %.2f\n",
+		   baud, phyStr, G_linkName[G_link], G_nPorts, sum,
+		   sum * 1e9 / (t1 - t0),
+		   total ? (cs1.busy - cs0.busy) * 100.0 / total : 0,
+		   total ? (cs1.irq - cs0.irq) * 100.0 / total : 0,
+		   total ? (cs1.softirq - cs0.softirq) * 100.0 / total : 0);
+	fflush(stdout);
+	return 0;
+}
+
+/*******************************************************************/
+/** Open the lines and connect senders and receivers
+ *
+ * \param lines		\IN ttyD lines
+ *
+ * \return 			0 or -1
+ */
+static int bench_open(const int *lines)
+{
+	unsigned int i;
+	struct port *p;
+	char name[32];
+
+	if (G_link == LINK_PAIR && (G_nPorts & 1)) {
+		fprintf(stderr, "*** -k pair needs an even number of lines\n");
+		return -1;
+	}
+
+	for (i = 0; i < G_nPorts; i++) {
+		p = &G_port[i];
+		p->line = lines[i];
+		snprintf(name, sizeof(name), "/dev/ttyD%d", p->line);
+		p->fd = open(name, O_RDWR | O_NOCTTY);
+		if (p->fd < 0 || tcgetattr(p->fd, &p->saved) < 0) {
+			fprintf(stderr, "*** can't open %s: %s\n", name, strerror(errno));
+			return -1;
+		}
+		p->rx = G_link == LINK_PAIR ? &G_port[i ^ 1] : p;
+
+		if (G_link == LINK_LOOP) {
+			int loop = TIOCM_LOOP;
+
+			if (ioctl(p->fd, TIOCMBIS, &loop) < 0) {
+				fprintf(stderr, "*** %s: loopback failed: %s\n", name,
+						strerror(errno));
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+static void bench_close(void)
+{
+	int loop = TIOCM_LOOP;
+	unsigned int i;
+	struct port *p;
+
+	for (i = 0; i < G_nPorts; i++) {
+		p = &G_port[i];
+		if (p->fd < 0)
+			continue;
+		if (G_link == LINK_LOOP)
+			ioctl(p->fd, TIOCMBIC, &loop);
+		tcsetattr(p->fd, TCSANOW, &p->saved);
+		close(p->fd);
+		free(p->lat.v);
+		free(p->gap.v);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int lines[MAX_PORTS], list[MAX_LIST];
+	unsigned int b, m;
+	int opt, n, ret = 0;
+
+	for (n = 0; n < MAX_PORTS; n++)
+		G_port[n].fd = -1;
+
+	while ((opt = getopt(argc, argv, "l:k:b:m:t:n:s:fvh")) != -1) {
+		switch (opt) {
+		case 'l':
+			n = parse_list(optarg, lines, MAX_PORTS);
+			if (n <= 0)
+				goto badarg;
+			G_nPorts = n;
+			break;
+		case 'k':
+			for (n = 0; n < 3; n++)
+				if (!strcmp(optarg, G_linkName[n]))
+					break;
+			if (n == 3)
+				goto badarg;
+			G_link = n;
+			break;
+		case 'b':
+			n = parse_list(optarg, list, MAX_LIST);
+			if (n <= 0)
+				goto badarg;
+			for (G_nBaud = 0; G_nBaud < (unsigned int)n; G_nBaud++)
+				G_baud[G_nBaud] = list[G_nBaud];
+			break;
+		case 'm':
+			n = parse_list(optarg, G_phy, MAX_LIST);
+			if (n <= 0)
+				goto badarg;
+			G_nPhy = n;
+			break;
+		case 't':
+			G_secs = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			G_probes = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			G_block = strtoul(optarg, NULL, 0);
+			if (!G_block)
+				goto badarg;
+			break;
+		case 'f':
+			G_rtscts = 1;
+			break;
+		case 'v':
+			G_verbose = 1;
+			break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if (!G_nPorts) {
+		usage();
+		return 1;
+	}
+
+	if (bench_open(lines) < 0) {
+		bench_close();
+		return 1;
+	}
+
+	printf("# m77bench link=%s secs=%u probes=%u block=%u rtscts=%d\n",
+		   G_linkName[G_link], G_secs, G_probes, G_block, G_rtscts);
+	printf("# port baud phy link line bytes bytes_per_s util_pct errors "
+		   "overruns lat_p50_us lat_p90_us lat_p99_us lat_p999_us "
+		   "lat_max_us gap_p99_us gap_max_us cpu_pct\n");
+	printf("# sys baud phy link ports bytes bytes_per_s cpu_busy_pct "
+		   "cpu_irq_pct cpu_softirq_pct\n");
+
+	for (m = 0; m < G_nPhy && !ret; m++)
+		for (b = 0; b < G_nBaud && !ret; b++)
+			ret = bench_run(G_baud[b], G_phy[m]);
+
+	bench_close();
+	return ret ? 1 : 0;
+
+ badarg:
+	fprintf(stderr, "*** invalid argument '%s' of -%c\n", optarg, opt);
+	return 1;
+}
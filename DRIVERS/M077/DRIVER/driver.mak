@@ -35,12 +35,16 @@ MAK_INCL=$(MEN_INC_DIR)/mdis_com.h   \
          $(MEN_INC_DIR)/maccess.h    \
          $(MEN_INC_DIR)/mdis_api.h   \
 		 $(MEN_MOD_DIR)/serialP_m77.h \
-		 $(MEN_MOD_DIR)/serial_m77.h
+		 $(MEN_MOD_DIR)/serial_m77.h \
+		 $(MEN_MOD_DIR)/serial_m77_trace.h
 
 MAK_OPTIM=$(OPT_1)
 
+# the trace header is pulled in again by <trace/define_trace.h> with
+# TRACE_INCLUDE_PATH ".", so the driver directory must be on the include path
 MAK_SWITCH=$(SW_PREFIX)MAC_MEM_MAPPED  \
-		$(SW_PREFIX)$(DEF_REVISION)
+		$(SW_PREFIX)$(DEF_REVISION) \
+		-I$(MEN_MOD_DIR)
 
 MAK_INP1=serial_m77$(INP_SUFFIX)
 
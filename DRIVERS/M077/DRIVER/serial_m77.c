@@ -11,7 +11,8 @@
  * Features
  * - All standard baudrates up to 1152000 Baud ( only RS422/485 with > 115200 )
  *
- *     Switches: -
+ *     Switches: M77_MOCK	registers on the mock carrier, see MOCK/m77mock.c
+ *               M77_MMIO_STATS	count register accesses per operation
  */
 /*
  *---------------------------------------------------------------------------
@@ -41,6 +42,36 @@
 #include <linux/module.h>
 #include <linux/init.h>
 #include <linux/list.h>			/* linked list functions	*/
+#include <linux/async.h>			/* parallel M-Module probe	*/
+#include <linux/mutex.h>
+#include <linux/ktime.h>
+#include <linux/fs.h>
+#include <linux/cdev.h>
+#include <linux/device.h>
+#include <linux/poll.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
+#include <linux/highmem.h>
+#include <linux/splice.h>
+#include <linux/pipe_fs_i.h>
+#include <linux/miscdevice.h>
+#include <linux/uaccess.h>
+#include <linux/compat.h>
+#include <linux/jump_label.h>
+#include <linux/workqueue.h>
+#include <linux/netdevice.h>
+#include <linux/if_arp.h>
+#include <linux/ppp_defs.h>
+#include <linux/crc-ccitt.h>
+#include <linux/serdev.h>
+#include <linux/of.h>
+#include <linux/delay.h>
+#include <linux/uio_driver.h>
+#include <linux/filter.h>
+#include <linux/capability.h>
+#include <linux/percpu.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include <linux/tty.h>
 #include <linux/tty_flip.h>
 #include "serial_m77.h"
@@ -57,6 +88,15 @@
 #include <MEN/mdis_com.h>
 #include <MEN/modcom.h>
 
+#ifdef M77_MOCK
+/* register accesses go to the mock carrier, see MOCK/m77mock.c */
+#include "../MOCK/m77mock.h"
+#endif
+
+/* last, CREATE_TRACE_POINTS must not reach other trace headers */
+#define CREATE_TRACE_POINTS
+#include "serial_m77_trace.h"
+
 static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 
 /*-----------------------------+
@@ -65,13 +105,44 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 
 
 #define MM_UARTCLK			18432000	/* 18,432 MHz 				 */
-#define	MAX_MODS_SUPPORTED  8			/* up to # Modules supported */
-
-/* This is the total nr. of UARTS, can be e.g. 8xM45N or 8xM77/M69N  */
-#define MAX_SNGL_UARTS				64			
 
 #define UART_NAME_PREFIX	"ttyD"		/* ttyD0 to ttyDnn 			 */
+#define RAW_NAME_PREFIX		"m77raw"	/* raw ring device per ttyD line */
+#define RAW_SPLICE_SEGS		64			/* pages queued by splice(), 2^n */
+#define MUX_NAME			"m77mux"	/* capture multiplexer, all lines */
+#define MUX_RING_SIZE		(256*1024)	/* /dev/m77mux ring, power of 2	 */
+#define TAP_NAME			"m77tap"	/* traffic tap, readers attach	 */
+#define TAP_NSLOTS			1024		/* records per tapped port, 2^n	 */
+#define TAP_READ_BATCH		16			/* max. records per read()		 */
+#define CTL_NAME			"m77ctl"	/* statistics snapshot, all lines */
+#define BRIDGE_STALL_ROOM	128			/* stop bridge RX below this room */
+#define BRIDGE_BLOCK		256			/* max. chars per bridge drain	 */
+#define BOND_NAME			"ttyDB"		/* bonded ttys					 */
+#define BOND_NUM			4			/* nr. of bonded ttys			 */
+#define BOND_WINDOW			64			/* reorder window, frames, 2^n	 */
+#define BOND_GAP_MAX_MS		10000		/* limit of bondGapMs			 */
+#define NET_NAME			"m77n%d"	/* network interfaces			 */
+#define NET_MTU				1500
+#define NET_FLAG			0x7e		/* frame delimiter				 */
+#define NET_ESC				0x7d		/* next char xor 0x20			 */
+#define NET_MAX_FRAME		(NET_MTU + 2)	/* packet + FCS				 */
+#define NET_TX_ROOM			(2 * NET_MAX_FRAME + 2)	/* worst case frame	 */
+#define NET_POLL_CHARS		4096		/* max. chars per NAPI poll		 */
+#define SERDEV_RX_SIZE		4096		/* serdev RX ring, power of 2	 */
+#define UIO_NAME_PREFIX		"m77mod"	/* parent of a user mode uio<n>	 */
+#define UIO_WINDOW_SIZE		0x100		/* M-Module A08 register window	 */
+#define BPF_BLOCK			128			/* max. chars per RX filter run	 */
+#define SELFTEST_MAX_MS		5000		/* longest loopback self-test	 */
+#define SELFTEST_SEED		0x2b5d		/* PRBS15 start value, not 0	 */
+#define HIST_FIFO_BINS		17			/* 8 chars per bin, last >= 128	 */
+#define HIST_LOG_BINS		24			/* bin n: values below 2^n		 */
+#define HIST_DIR_NAME		"m77"		/* /sys/kernel/debug/m77		 */
+#define OVR_RECS			16			/* overrun records per port, 2^n */
+#define OVR_DIR_NAME		"overrun"	/* /sys/kernel/debug/m77/overrun */
+#define CALIB_ROUNDS		16			/* register timing rounds		 */
+#define CALIB_BATCH			32			/* accesses per round, IRQs off	 */
 #define ARRLEN 	16
+#define OX954_CHAN_NUM		4			/* UART channels per OX16C954 */
 
 #define UART_CAP_FIFO		(1 << 8)	/* UART has FIFO 					*/
 #define UART_CAP_EFR		(1 << 9)	/* UART has EFR 					*/
@@ -107,6 +178,24 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 #  define M77DBG3(x...) 		printk(x)
 #endif
 
+/* register access counters, see m77_mmio_op() and m77_mmio_port_op() */
+#ifdef M77_MMIO_STATS
+#  define M77_MMIO_CNT(st, dir)	\
+	atomic_long_inc(&(st)->dir[this_cpu_read(m77_mmioOp)])
+#  define M77_MMIO_PORT_CNT(up, dir)	\
+	atomic_long_inc(&(up)->mmio.dir[m77_mmio_cur(up)])
+#else
+#  define M77_MMIO_CNT(st, dir)	do { } while (0)
+#  define M77_MMIO_PORT_CNT(up, dir)	do { } while (0)
+#endif
+
+/* time the M-Module interrupt was asserted, only the mock carrier knows */
+#ifdef M77_MOCK
+#  define M77_IRQ_ASSERT_NS(mmod)	m77mock_irq_ns((mmod)->memBase)
+#else
+#  define M77_IRQ_ASSERT_NS(mmod)	0
+#endif
+
 #if 0 /* in-ISR debugs, from 8250.c */
 #define DEBUG_INTR(fmt...)	printk(fmt)
 #else
@@ -148,100 +237,593 @@ struct plat_men_uart_port {
 };
 
 
+/*******************************************************************/
+/** Per-channel state used on every interrupt
+ *
+ *  The entries of one M-Module are kcalloc'ed as one array of 4 or 8
+ *  times 16 byte. kmalloc aligns power-of-2 sizes naturally, so the IIR
+ *  scan of a whole M-Module touches one (M77/M69N) or two (M45N) cache
+ *  lines instead of one ox16c954_port per channel.
+ */
+struct m77_chan_hot {
+	unsigned char __iomem	*membase;	/* register base of this channel	*/
+	unsigned short		tx_loadsz;		/* transmit fifo load size 		*/
+	unsigned char		acr;			/* Advanced Control Register	*/ 
+	unsigned char		ier;
+	unsigned char		lcr;
+	unsigned char		mcr;
+} __aligned(16);
+
+
+struct uartmod;
+struct ox16c954_port;
+
+/** page queued by splice() on a raw device */
+struct m77_raw_seg {
+	struct page			*page;		/* referenced until sent			*/
+	unsigned int		off;		/* next byte to send in page		*/
+	unsigned int		len;		/* bytes left						*/
+};
+
+/*******************************************************************/
+/** Raw ring device of one ttyD line, exists while /dev/m77raw<n> is open
+ *
+ *  hdr and both rings are one vmalloc_user'ed area mapped to user
+ *  space. The indices owned by the driver are kept here too, the copies
+ *  in hdr are only published, never read back.
+ */
+struct m77_raw {
+	struct m77_raw_hdr	*hdr;		/* start of the mmap'ed area		*/
+	unsigned char		*rx;		/* RX ring, M77_RAW_RX_SIZE			*/
+	unsigned char		*tx;		/* TX ring, M77_RAW_TX_SIZE			*/
+	unsigned int		rxHead;		/* next RX byte written by ISR		*/
+	unsigned int		txTail;		/* next TX byte sent by ISR			*/
+	wait_queue_head_t	wait;		/* poll(): RX data / TX space		*/
+	struct ox16c954_port *up;
+	/* pages queued by splice(), indices free running */
+	struct mutex		spliceLock;	/* one splice writer at a time		*/
+	struct m77_raw_seg	seg[RAW_SPLICE_SEGS];
+	unsigned int		segHead;	/* splice: next seg, port lock		*/
+	unsigned int		segTail;	/* ISR: seg being sent, port lock	*/
+	unsigned int		segFree;	/* splice: next sent seg to put		*/
+};
+
+/** chars collected within one drain, passed to the tap in one record */
+struct m77_tap_acc {
+	unsigned short		len;
+	unsigned char		flags;		/* M77_MUX_xxx error flags			*/
+	unsigned char		buf[M77_TAP_DATA];
+};
+
+/*******************************************************************/
+/** Traffic tap of one ttyD line, exists while readers are attached
+ */
+struct m77_tap {
+	struct m77_tap_acc	acc[2];		/* M77_TAP_RX/TX drain, port lock	*/
+	spinlock_t			lock;		/* slots, seq; taken in ISR			*/
+	struct m77_tap_rec	*slots;		/* TAP_NSLOTS records, overwritten	*/
+	unsigned int		seq;		/* nr. of records written			*/
+	unsigned int		readers;	/* attached readers, mod->lock		*/
+	wait_queue_head_t	wait;
+};
+
+/** one open /dev/m77tap */
+struct m77_tap_reader {
+	struct ox16c954_port *up;		/* attached port or NULL			*/
+	struct m77_tap		*tap;
+	unsigned int		seq;		/* next record to read				*/
+	struct mutex		lock;
+	struct m77_tap_rec	bounce[TAP_READ_BATCH];
+};
+
+
+/*******************************************************************/
+/** Member of a bonded tty, one ttyD line
+ */
+struct m77_bond_member {
+	struct m77_bond		*bond;
+	struct ox16c954_port *up;
+	/* RX frame parser, used by the ISR of up only */
+	unsigned int		pos;		/* bytes of current frame received	*/
+	unsigned char		sum;		/* payload checksum so far			*/
+	unsigned char		hdr[M77_BOND_HDR];
+	unsigned char		data[M77_BOND_MAX_PAYLOAD];
+	unsigned int		bad;		/* frames with bad header/checksum	*/
+};
+
+/** one frame waiting in the reorder window */
+struct m77_bond_slot {
+	unsigned char		valid;
+	unsigned char		len;
+	unsigned char		data[M77_BOND_MAX_PAYLOAD];
+};
+
+/*******************************************************************/
+/** Bonded tty /dev/ttyDB<n>, stripes its data over several ttyD lines
+ */
+struct m77_bond {
+	struct tty_port		port;
+	/* TX */
+	spinlock_t			txLock;		/* member[], txSeq, before port lock */
+	struct m77_bond_member *member[M77_BOND_MAX_MEMBERS];
+	unsigned int		nMembers;	/* changed with G_bondLock too		*/
+	unsigned short		txSeq;		/* seq of the next frame sent		*/
+	unsigned int		txFrames;
+	/* RX */
+	spinlock_t			rxLock;		/* reorder window, after port lock	*/
+	unsigned char		open;		/* tty open, deliver frames			*/
+	unsigned char		rxSync;		/* rxSeq is valid					*/
+	unsigned short		rxSeq;		/* seq of the next frame delivered	*/
+	unsigned int		rxWaiting;	/* frames in slot[]					*/
+	unsigned int		rxOld;		/* frames behind rxSeq in a row		*/
+	unsigned int		rxFrames;
+	unsigned int		rxLost;		/* frames skipped, never received	*/
+	struct delayed_work	gapWork;	/* m77_bond_gap_work()				*/
+	struct m77_bond_slot slot[BOND_WINDOW];
+};
+
+
+/*******************************************************************/
+/** Network interface on a ttyD line, netdev_priv() of the interface
+ */
+struct m77_net {
+	struct net_device	*dev;
+	struct ox16c954_port *up;
+	struct napi_struct	napi;
+	unsigned char		loop;		/* MCR loopback set by us			*/
+	/* RX deframer, NAPI poll only */
+	unsigned char		rxEsc;		/* last char was NET_ESC			*/
+	unsigned char		rxDiscard;	/* broken frame, wait for NET_FLAG	*/
+	unsigned int		rxLen;
+	unsigned char		rxBuf[NET_MAX_FRAME];
+};
+
+
+/*******************************************************************/
+/** BPF program filtering the RX data of a ttyD line
+ */
+struct m77_bpf {
+	struct bpf_prog		*prog;
+	struct sk_buff		*skb;		/* drained block, reused, port lock	*/
+	struct m77_bpf_stats stats;		/* port lock						*/
+	unsigned char		lsrs[BPF_BLOCK];	/* LSR of each char, ISR	*/
+	unsigned char		redir[BPF_BLOCK];	/* block to redirect, ISR	*/
+};
+
+
+/*******************************************************************/
+/** Loopback self-test running on a ttyD line, see m77_selftest_run()
+ */
+struct m77_selftest {
+	u16					txPrbs;		/* PRBS15 state of the sender		*/
+	u16					rxPrbs;		/* PRBS15 state of the checker		*/
+	unsigned char		rxLast;		/* last char received, for resync	*/
+	unsigned char		rxBad;		/* wrong chars in a row				*/
+	unsigned int		total;		/* chars to send					*/
+	unsigned int		txLeft;		/* chars still to send				*/
+	unsigned int		rxBytes;	/* chars received					*/
+	unsigned int		errors;		/* chars differing from the pattern	*/
+	unsigned int		isrCalls;	/* men_uart_handle_port() calls		*/
+	u64					isrNs;		/* time spent in them				*/
+	u64					lastNs;		/* last char received				*/
+	wait_queue_head_t	wait;		/* all chars received				*/
+};
+
+/** result of the last self-test of a ttyD line, read by sysfs */
+struct m77_selftest_res {
+	unsigned int		baud;		/* 0: no test run yet				*/
+	unsigned int		total;		/* chars to send					*/
+	unsigned int		txBytes;
+	unsigned int		rxBytes;
+	unsigned int		errors;
+	unsigned int		overruns;	/* UART and tty overruns			*/
+	unsigned int		isrCalls;
+	u64					isrNs;
+	u64					ns;			/* first char sent to last received	*/
+};
+
+
+/*******************************************************************/
+/** Receive path men_uart_handle_port() took, see m77_rx_mode()
+ */
+enum m77_rx_mode {
+	M77_RXM_TTY,
+	M77_RXM_SELFTEST,
+	M77_RXM_NET,
+	M77_RXM_SERDEV,
+	M77_RXM_RAW,
+	M77_RXM_MUX,
+	M77_RXM_BRIDGE,
+	M77_RXM_BOND,
+	M77_RXM_BPF,
+	M77_RXM_NUM
+};
+
+/*******************************************************************/
+/** Context of a port service that saw an RX overrun, see m77_ovr_add()
+ */
+struct m77_ovr_rec {
+	u64					ns;			/* ktime_get_ns() at the service	*/
+	u64					sinceNs;	/* since the previous service, 0:	*/
+									/*   none before					*/
+	unsigned int		others;		/* services of other channels of	*/
+									/*   the same M-Module in between	*/
+	unsigned int		baud;		/* baudrate set, 0: unknown			*/
+	unsigned short		rx;			/* chars drained by the service		*/
+	unsigned char		otherMask;	/* its channels serviced in between	*/
+	unsigned char		mode;		/* enum m77_rx_mode					*/
+	unsigned char		trig;		/* RX FIFO trigger level, chars		*/
+	unsigned char		lsr;		/* LSR at entry of the service		*/
+};
+
+
+/*******************************************************************/
+/** Histograms of a ttyD line, one per CPU, see m77_hist_port()
+ */
+struct m77_hist {
+	unsigned long		rxDrain[HIST_FIFO_BINS];/* chars per RX drain		*/
+	unsigned long		txLoad[HIST_FIFO_BINS];	/* chars per TX refill		*/
+	unsigned long		txIdle;					/* refills, line was idle	*/
+	unsigned long		isrBytes[HIST_LOG_BINS];/* chars per port service	*/
+	unsigned long		isrNs[HIST_LOG_BINS];	/* duration of it			*/
+	unsigned long		irqNs[HIST_LOG_BINS];	/* IR asserted to service	*/
+};
+
+
+/*******************************************************************/
+/** serdev controller of a ttyD line, private data of the controller
+ */
+struct m77_serdev {
+	struct serdev_controller *ctrl;
+	struct ox16c954_port *up;
+	struct ktermios		termios;	/* line settings of the consumer	*/
+	struct circ_buf		xmit;		/* TX, while open, port lock		*/
+	unsigned int		rxHead;		/* ISR: next RX byte written		*/
+	unsigned int		rxTail;		/* rxWork: next RX byte passed on	*/
+	unsigned int		rxDropped;	/* RX bytes lost, ring full			*/
+	struct work_struct	rxWork;		/* m77_serdev_rx_work()				*/
+	unsigned char		rx[SERDEV_RX_SIZE];
+};
+
+
+/*******************************************************************/
+/** Driver operations the register accesses are counted for when built
+ *  with M77_MMIO_STATS
+ */
+enum m77_mmio_op {
+	M77_MMIO_OTHER,		/* not listed below: mctrl, start_tx, probe	*/
+	M77_MMIO_RX,		/* ISR: receive path of the port			*/
+	M77_MMIO_TX,		/* ISR: transmit_chars()					*/
+	M77_MMIO_IIR,		/* ISR: IR/IIR scan, LSR, MSR, IR clear		*/
+	M77_MMIO_TERMIOS,	/* men_uart_set_termios()					*/
+	M77_MMIO_STARTUP,	/* UART startup and shutdown				*/
+	M77_MMIO_IOCTL,		/* men_uart_ioctl()							*/
+	M77_MMIO_OPS
+};
+
+#ifdef M77_MMIO_STATS
+/** register reads and writes per operation */
+struct m77_mmio_stats {
+	atomic_long_t		rd[M77_MMIO_OPS];
+	atomic_long_t		wr[M77_MMIO_OPS];
+};
+#endif
+
+
 /*******************************************************************/
 /** The central Oxford 16C950 UART port struct 
+ *
+ *  Only used once a channel has its IIR interrupt pending, the register
+ *  shadows needed by the ISR are kept in hot.
  */
 struct ox16c954_port {
 	struct uart_port	port;
-	struct timer_list	timer;			/* "no irq" timer 				*/
-	struct list_head	list;			/* ports on this IRQ 			*/
+	struct m77_chan_hot	*hot;			/* entry in UARTMOD_INFO hot[]	*/
+	struct uartmod		*mod;			/* M-Module this channel is on	*/
+	struct m77_raw		*raw;			/* raw device open, port lock	*/
+	unsigned char		muxOn;			/* RX goes to /dev/m77mux		*/
+	struct m77_tap		*tap;			/* tap attached, port lock		*/
+	struct ox16c954_port *bridge;		/* RX forwarded to, port lock	*/
+	unsigned char		bridgeStall;	/* RX stopped, peer buffer full	*/
+	unsigned char		opened;			/* ttyD open, port lock			*/
+	struct m77_bond_member *bondMem;	/* RX goes to a bond, port lock	*/
+	struct m77_net		*net;			/* RX goes to a netdev, port lock */
+	struct m77_serdev	*serdev;		/* serdev consumer open, port lock */
+	struct m77_bpf		*bpf;			/* RX filter attached, port lock */
+	struct m77_selftest	*selftest;		/* loopback test runs, port lock */
+	struct m77_hist __percpu *hist;		/* histograms, see m77_hist_key	*/
 	unsigned short		capabilities;	/* port capabilities 			*/
 	unsigned short		bugs;			/* port bugs 					*/
-	unsigned int		tx_loadsz;		/* transmit fifo load size 		*/
-	unsigned char		acr;			/* Advanced Control Register	*/ 
-	unsigned char		ier;
-	unsigned char		lcr;
-	unsigned char		mcr;
 	unsigned char		mcr_mask;		/* mask of user bits 			*/
 	unsigned char		mcr_force;		/* mask of forced bits 			*/
 	unsigned char		lsr_break_flag;
 
-	/* Additional 16C954 & M-Module maintenance stuff */
-	unsigned char		efr;
+	/* Additional 16C954 & M-Module maintenance stuff, config only */
+	unsigned char		efr;		/* EFR last written by set_termios	*/
+	unsigned char		fcr;		/* FCR last written, 0: FIFOs off	*/
+	unsigned char		cfgValid;	/* UART holds the set_termios cfg	*/
+	unsigned char		txenTested;	/* UART_BUG_TXEN in bugs is valid	*/
+	unsigned char		xonSet;		/* XON/XOFF characters programmed	*/
+	unsigned int		quot;		/* baudrate divisor last written	*/
+	struct device		*rawDev;	/* /dev/m77raw<line>				*/
+	struct ox16c954_port *bridgeSrc;/* port forwarding to us, port lock	*/
+	unsigned int		bridgeFlags;/* M77_BRIDGE_xxx					*/
+	unsigned int		bridgeFwd;	/* bytes forwarded to bridge		*/
+	unsigned int		bridgeDrop;	/* bytes dropped, bridge full		*/
+	struct work_struct	bridgeWork;	/* m77_bridge_resume_work()			*/
+	struct m77_net		*netGone;	/* detached, freed by netWork		*/
+	struct work_struct	netWork;	/* m77_net_gone_work()				*/
+	unsigned long		inUse;		/* bit 0: ttyD or serdev has the UART */
+	struct serdev_controller *sdCtrl;/* serdevNode set for this line	*/
 	unsigned int		type;		/* Type MOD_M45N/MOD_M69N/MOD_M77	*/
 	unsigned int		dcrReg;		/* M77:	DCR adress of this Uart		*/
 	unsigned int		tcrReg;		/* M45N: TCR adress of this Uart	*/
 	unsigned int		tcrBit;		/* M45N: TCR Bit for this Channel	*/
 	unsigned int		acrShadow;	/* keep M77 ACR (DTR#) setting		*/
 	unsigned int		m77Mode;	/* M77: PHY Mode setting			*/
-
-	/*
-	 * We provide a per-port pm hook.
-	 */
-	void	(*pm)(struct uart_port *port, 
-				  unsigned int state, unsigned int old);
+	struct m77_selftest_res stRes;	/* last self-test, port lock		*/
+
+	/* line statistics for /dev/m77ctl, port lock */
+	u64					irqs;		/* interrupt services				*/
+	u64					rxBytes;	/* icount.rx, 64 bit, see			*/
+	u64					txBytes;	/* icount.tx  m77_bytes_fold()		*/
+	__u32				rxFold;		/* icount.rx at last fold			*/
+	__u32				txFold;		/* icount.tx at last fold			*/
+	unsigned int		rxHigh;		/* most chars of one RX drain		*/
+	unsigned int		txHigh;		/* most chars of one TX refill		*/
+	unsigned char		ctsFlow;	/* CRTSCTS set by set_termios		*/
+	u64					txStallAt;	/* CTS dropped, 0: TX not stalled	*/
+	u64					txStallNs;	/* TX stalls ended before			*/
+	u64					rxStallAt;	/* bridge stopped RX, 0: running	*/
+	u64					rxStallNs;	/* RX stalls ended before			*/
+
+	/* ISR: last service (only with m77_ovr_key) and the overrun
+	   records, port lock */
+	u64					svcNs;		/* ktime_get_ns() of last service	*/
+	unsigned int		svcSeq;		/* mod->svcSeq of last service		*/
+	unsigned int		ovrCnt;		/* records added, free running		*/
+	struct m77_ovr_rec	ovr[OVR_RECS];
+
+	unsigned char		muxBuf[M77_MUX_MAX_PAYLOAD];	/* RX drain, ISR */
+	unsigned char		bridgeBuf[BRIDGE_BLOCK];		/* RX drain, ISR */
+#ifdef M77_MMIO_STATS
+	struct m77_mmio_stats mmio;		/* UART register accesses			*/
+	unsigned char		mmioOp;		/* process context op, port mutex	*/
+#endif
 };
 
 
 /*******************************************************************/
 /** Maintain central per-M-Module Info about each M45N/M69N/M77
- *  For M77/M69N 4 structs are allocated, for M45N 8
+ *  For M77/M69N 4 ports are allocated, for M45N 8
  */
 typedef struct uartmod {
+	/* fields read by M77_IrqHandler, kept together at the start */
     struct list_head head;			/* for linked list			*/
-	unsigned int  	modnum;			/* nr. in list 				*/
+	void		*memBase;		/* ioremapped address of Module 	*/
+	struct m77_chan_hot *hot;		/* nrChannels ISR entries			*/
+	struct ox16c954_port *ports;	/* nrChannels ports, kcalloc'ed		*/
 	unsigned int  	modtype;		/* MOD_M45, MOD_M69 or MOD_M77		*/
 	unsigned int  	nrChannels;		/* M77/M69N: 4, M45N: 8			*/
+	int				ready;			/* UARTs registered, ISR may scan	*/
+	struct uio_info	*uio;			/* user mode: exported, no ttyDs	*/
+	unsigned int	svcSeq;			/* ISR: port services, free running	*/
+
+	struct mutex	lock;			/* port (un)register, TCR access	*/
+	int				probeErr;		/* result of m77_probe_module()		*/
+	s64				probeUs;		/* duration of m77_probe_module()	*/
+	unsigned int	rdNs;			/* measured register read time		*/
+	unsigned int	wrNs;			/* measured register write time		*/
+	unsigned long	maxBaud;		/* estimated sum of baudrates, see	*/
+									/*   m77_calibrate()				*/
+	unsigned int  	modnum;			/* nr. in list 				*/
 	unsigned int  	irq;			/* (PCI)IRQ of this Modules Carrier	*/
-	unsigned int  	line;			/* UART # from registering UART		*/
+	unsigned int  	lineBase;		/* ttyD line of channel 0			*/
 	unsigned int  	mode[4];		/* M77: PHY mode passed at loading	*/
 	unsigned int  	echo[4];		/* M77: echo on/off (HD modes)		*/
 	char 		brdName[ARRLEN];	/* carrier name e.g. "D201_1" 		*/
 	char 		deviceName[ARRLEN];	/* dev. name e.g. "m45_1" 		*/
 	void 		*mdisDev;		/* from mdis_open_external_device 	*/
-	void		*memBase;		/* ioremapped address of Module 	*/
+	struct device	*uioDev;		/* user mode: parent of uio<n>		*/
+#ifdef M77_MMIO_STATS
+	struct m77_mmio_stats mmio;		/* CPLD register accesses			*/
+#endif
   struct uart_port uart;
-  struct ox16c954_port *port8250[MAX_SNGL_UARTS];
 
 } UARTMOD_INFO;
 
 
+/*******************************************************************/
+/** Comma separated module parameter list. Unlike module_param_array
+ *  the element storage is allocated when the parameter is parsed, so
+ *  the number of M-Modules is not limited at compile time.
+ */
+struct m77_param_list {
+	unsigned int	num;			/* nr. of values passed				*/
+	char			**str;			/* charp lists: kstrdup'ed values	*/
+	int				*val;			/* int lists: parsed values			*/
+};
+
+
 /*-----------------------------+
 |   MODULE PARAMETERS          |
 +-----------------------------*/
 
-static char* brdName[MAX_MODS_SUPPORTED];
-static char* devName[MAX_MODS_SUPPORTED];
-static int   slotNo[MAX_MODS_SUPPORTED];
-static int   mode[MAX_MODS_SUPPORTED*4];
-static int   echo[MAX_MODS_SUPPORTED*4];
+static struct m77_param_list brdName;
+static struct m77_param_list devName;
+static struct m77_param_list slotNo;
+static struct m77_param_list mode;
+static struct m77_param_list echo;
+static struct m77_param_list serdevNode;
+static struct m77_param_list userMode;
+
+static int m77_param_set_charp_list(const char *val,
+									const struct kernel_param *kp);
+static int m77_param_set_int_list(const char *val,
+								  const struct kernel_param *kp);
+static int m77_param_get_list(char *buffer, const struct kernel_param *kp);
+static void m77_param_free_list(void *arg);
+
+static const struct kernel_param_ops m77_param_ops_charp_list = {
+	.set	= m77_param_set_charp_list,
+	.get	= m77_param_get_list,
+	.free	= m77_param_free_list,
+};
 
-/* Array Element count at load time */
-static int   arr_argc = MAX_MODS_SUPPORTED;
+static const struct kernel_param_ops m77_param_ops_int_list = {
+	.set	= m77_param_set_int_list,
+	.get	= m77_param_get_list,
+	.free	= m77_param_free_list,
+};
 
 /* 
  * We have to pass the MDIS Device Names for MDIS_FindDevByName, 
  * called within mdis_open_external_device() 
  */
-module_param_array(devName, charp, 	&arr_argc, 	0 );
+module_param_cb(devName, &m77_param_ops_charp_list, &devName, 0 );
 MODULE_PARM_DESC(devName, "MDIS Descriptor Module Name ('m77_1','m45_2' etc)");
-module_param_array(brdName, charp, 	&arr_argc, 	0 );
+module_param_cb(brdName, &m77_param_ops_charp_list, &brdName, 0 );
 MODULE_PARM_DESC( brdName, 	"MDIS Descriptor Carrier Name, e.g. 'd201_1'");
-module_param_array(slotNo, int, &arr_argc, 	0 );
+module_param_cb(slotNo, &m77_param_ops_int_list, &slotNo, 0 );
 MODULE_PARM_DESC( slotNo, "slot number on carrier board e.g. 0..3 on D201" );
-module_param_array(mode, int, 	&arr_argc, 	0 );
+module_param_cb(mode, &m77_param_ops_int_list, &mode, 0 );
 MODULE_PARM_DESC( mode, "on M77: phy mode of channel 0-3, e.g. '1,1,7,7'" );
-module_param_array(echo, int, &arr_argc, 	0 );
+module_param_cb(echo, &m77_param_ops_int_list, &echo, 0 );
 MODULE_PARM_DESC( echo, "on M77: disable / enable Rx feedback in HD modes");
+module_param_cb(serdevNode, &m77_param_ops_charp_list, &serdevNode, 0 );
+MODULE_PARM_DESC( serdevNode, "per ttyD line: device tree node of its serdev devices, '-' for none");
+
+module_param_cb(userMode, &m77_param_ops_int_list, &userMode, 0 );
+MODULE_PARM_DESC( userMode, "per M-Module: 1 = export to user space as /dev/uio<n>, no ttyDs");
+
+static unsigned int bondGapMs = 50;
+static int m77_bond_gap_set(const char *val, const struct kernel_param *kp);
+
+static const struct kernel_param_ops m77_bond_gap_ops = {
+	.set	= m77_bond_gap_set,
+	.get	= param_get_uint,
+};
+
+module_param_cb( bondGapMs, &m77_bond_gap_ops, &bondGapMs, 0644 );
+MODULE_PARM_DESC( bondGapMs, "ttyDB: ms to wait for a missing frame, 1..10000 (default 50)");
+
+static int fullProbe = 0;
+module_param( fullProbe, int, 0 );
+MODULE_PARM_DESC( fullProbe, "1: run full UART autoconfig on each channel (diagnostics)");
+
+static int ovrTrack = 1;
+module_param( ovrTrack, int, 0 );
+MODULE_PARM_DESC( ovrTrack, "0: no service time per interrupt, overrun records without since_ns/others (default 1)");
+
+static int m77_capacity_get(char *buf, const struct kernel_param *kp);
+
+static const struct kernel_param_ops m77_capacity_ops = {
+	.get	= m77_capacity_get,
+};
+
+module_param_cb( capacity, &m77_capacity_ops, NULL, 0444 );
+MODULE_PARM_DESC( capacity, "per M-Module: read/write ns, est. max. and set sum of baudrates");
+
+#ifdef M77_MMIO_STATS
+static int m77_mmio_stats_get(char *buf, const struct kernel_param *kp);
+static int m77_mmio_stats_set(const char *val, const struct kernel_param *kp);
+
+static const struct kernel_param_ops m77_mmio_stats_ops = {
+	.set	= m77_mmio_stats_set,
+	.get	= m77_mmio_stats_get,
+};
+
+module_param_cb( mmioStats, &m77_mmio_stats_ops, NULL, 0644 );
+MODULE_PARM_DESC( mmioStats, "register accesses per M-Module and operation, write to clear");
+#endif
 
 /*-----------------------------+
 |   GLOBALS                    |
 +-----------------------------*/
 
 /* linked List Anchor */
-static struct list_head		G_uartModListHead;
-
-static DEFINE_SEMAPHORE(serial_sem);
+static LIST_HEAD(G_uartModListHead);
+
+/* next unused ttyD line, lines are handed out module by module */
+static unsigned int			G_nextLine;
+
+/* MDIS device open and IRQ install are serialized between M-Modules */
+static DEFINE_MUTEX(G_mdisLock);
+
+/* M-Modules are probed in parallel, each one within its own async call */
+static ASYNC_DOMAIN_EXCLUSIVE(m77_async_domain);
+
+/* raw ring devices, minor = ttyD line */
+static dev_t				G_rawDevt;
+static struct cdev			G_rawCdev;
+static struct class			*G_rawClass;
+
+/* /dev/m77mux, one record ring for all subscribed lines */
+static struct {
+	spinlock_t			lock;		/* head, tail, buf; taken in ISR	*/
+	unsigned char		*buf;		/* MUX_RING_SIZE, while open		*/
+	unsigned int		head;		/* free running ring indices		*/
+	unsigned int		tail;
+	int					lost;		/* a record did not fit				*/
+	unsigned long		open;		/* bit 0: device is open			*/
+	struct mutex		readLock;
+	wait_queue_head_t	wait;
+} G_mux;
+
+static void m77_mux_copy(unsigned int idx, void *data, unsigned int len,
+						 int in);
+
+/* serializes bridge (un)linking */
+static DEFINE_MUTEX(G_bridgeLock);
+
+static int m77_bridge_ioctl(struct ox16c954_port *ox, unsigned int cmd,
+							unsigned long arg);
+static void m77_bridge_shutdown(struct ox16c954_port *up);
+static int m77_net_attach(struct ox16c954_port *up, unsigned long arg);
+static void m77_net_release(struct ox16c954_port *up);
+static void m77_net_gone_work(struct work_struct *work);
+static void m77_net_detach(struct ox16c954_port *up);
+static int m77_bpf_attach(struct ox16c954_port *up, int fd);
+static int m77_bpf_stats(struct ox16c954_port *up, unsigned long arg);
+static struct ox16c954_port *m77_find_port(unsigned int line);
+static int m77_ctl_init(void);
+static void m77_ctl_exit(void);
+static unsigned int m77_phy_setup(UARTMOD_INFO *mod, unsigned int nrChan);
+
+/* bonded ttys, members changed with G_bondLock */
+static struct tty_driver	*G_bondDrv;
+static struct m77_bond		*G_bond[BOND_NUM];
+static DEFINE_MUTEX(G_bondLock);
+
+/* enabled while any /dev/m77tap reader is attached */
+static DEFINE_STATIC_KEY_FALSE(m77_tap_key);
+
+/* enabled while a loopback self-test runs on any port */
+static DEFINE_STATIC_KEY_FALSE(m77_selftest_key);
+
+/* service time and sequence of each port for the overrun records,
+   disabled with ovrTrack=0 */
+static DEFINE_STATIC_KEY_TRUE(m77_ovr_key);
+
+/* enabled with /sys/kernel/debug/m77/enable, changed with G_histLock */
+static DEFINE_STATIC_KEY_FALSE(m77_hist_key);
+static DEFINE_MUTEX(G_histLock);
+static struct dentry *G_dbgDir;
+static struct dentry *G_ovrDir;
+
+/* serializes /dev/m77ctl readers, see m77_ctl_read() */
+static DEFINE_MUTEX(G_ctlLock);
+
+static const struct attribute_group m77_port_attr_group;
+
+#ifdef M77_MMIO_STATS
+/* operation the register accesses on this CPU are counted for */
+static DEFINE_PER_CPU(unsigned char, m77_mmioOp);
+
+static const char * const G_mmioOpName[M77_MMIO_OPS] = {
+	"other", "rx", "tx", "iir", "termios", "startup", "ioctl"
+};
+#endif
 
 /*-----------------------------+
 |  PROTOTYPES                  |
@@ -258,6 +840,8 @@ static void men_uart_enable_ms(struct uart_port *port);
 static void men_uart_break_ctl(struct uart_port *port, int break_state);
 static int men_uart_startup(struct uart_port *port);
 static void men_uart_shutdown(struct uart_port *port);
+static void men_uart_hw_startup(struct ox16c954_port *up);
+static void men_uart_hw_shutdown(struct ox16c954_port *up);
 
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(6,1,0)
 static void men_uart_set_termios(struct uart_port *port,
@@ -394,6 +978,67 @@ static const struct men_uart_config uart_config[] = {
 
 
 
+/*******************************************************************/
+/** switch the operation the register accesses are counted for, ISR
+ *
+ * \param op		\IN M77_MMIO_xxx
+ *
+ * \brief Kept per CPU, only the ISR switches it and restores the
+ *        operation it interrupted. Outside of it it is M77_MMIO_OTHER.
+ *        Without M77_MMIO_STATS it compiles to nothing.
+ *
+ * \return 			previous operation, pass it again to restore it
+ */
+static inline unsigned int m77_mmio_op(unsigned int op)
+{
+#ifdef M77_MMIO_STATS
+	return this_cpu_xchg(m77_mmioOp, op);
+#else
+	return 0;
+#endif
+}
+
+/*******************************************************************/
+/** switch the operation the register accesses of a port are counted
+ *  for, process context
+ *
+ * \param up		\IN Oxford 16C954 Port Struct
+ * \param op		\IN M77_MMIO_xxx
+ *
+ * \brief Kept in the port, not per CPU: the callers hold the tty port
+ *        mutex and may sleep or move to another CPU.
+ *
+ * \return 			previous operation, pass it again to restore it
+ */
+static inline unsigned int m77_mmio_port_op(struct ox16c954_port *up,
+											unsigned int op)
+{
+#ifdef M77_MMIO_STATS
+	unsigned int prev = up->mmioOp;
+
+	up->mmioOp = op;
+	return prev;
+#else
+	return 0;
+#endif
+}
+
+#ifdef M77_MMIO_STATS
+/*******************************************************************/
+/** operation a register access of a port is counted for
+ *
+ * \return 			op set by the ISR running on this CPU, else the
+ *					process context op of the port
+ */
+static inline unsigned int m77_mmio_cur(struct ox16c954_port *up)
+{
+	unsigned int op = this_cpu_read(m77_mmioOp);
+
+	return op != M77_MMIO_OTHER ? op : up->mmioOp;
+}
+#endif
+
+
 /*******************************************************************/
 /** basic UART Register read function
  *
@@ -406,6 +1051,7 @@ static inline unsigned int serial_in(struct ox16c954_port *up, int offset)
 {
 	unsigned char val = MREAD_D16(up->port.membase, offset << 1 ) & 0x00ff;
 	M77DBG3("serial_in: Adr %02x = %02x\n", offset << 1, val );
+	M77_MMIO_PORT_CNT(up, rd);
 	return val;
 }
 
@@ -425,39 +1071,42 @@ static inline void serial_out(struct ox16c954_port *up, int offset,	int value)
 {
 	M77DBG3("serial_out: wr 0x%02x to adr %02x\n", value, offset<<1);
 	MWRITE_D16(up->port.membase, offset << 1, value); 
+	M77_MMIO_PORT_CNT(up, wr);
 }
 
 
 /*******************************************************************/
-/** basic UART Register read function
+/** basic M-Module control Register read function
  *
- * \param base		\IN  base control register address to read from
- * \param offset	\IN Register offset for this address
+ * \param mod		\IN M-Module
+ * \param offset	\IN Register offset from the M-Module base
  *
  * \return 			Value read from given Register
  */
-static inline unsigned int control_in(char *base, int offset)
+static inline unsigned int control_in(UARTMOD_INFO *mod, int offset)
 {
-	unsigned char val = MREAD_D16(base, offset) & 0x00ff;
+	unsigned char val = MREAD_D16(mod->memBase, offset) & 0x00ff;
 	M77DBG3("control_in: Adr %02x = %02x\n", offset, val );
+	M77_MMIO_CNT(&mod->mmio, rd);
 	return val;
 }
 
 
 
 /*******************************************************************/
-/** basic UART control Register write function
+/** basic M-Module control Register write function
  *
- * \param up		\IN Oxford 16C954 Port Struct
- * \param offset	\IN Register offset for address
+ * \param mod		\IN M-Module
+ * \param offset	\IN Register offset from the M-Module base
  * \param value		\IN Value to write to Register
  *
  * \return 			-
  */
-static inline void control_out(char *base, int offset,	int value)
+static inline void control_out(UARTMOD_INFO *mod, int offset,	int value)
 {
 	M77DBG3("control_out: wr 0x%02x to adr %02x\n", value, offset);
-	MWRITE_D16(base, offset, value); 
+	MWRITE_D16(mod->memBase, offset, value); 
+	M77_MMIO_CNT(&mod->mmio, wr);
 }
 
 
@@ -527,27 +1176,6 @@ static void serial_efr_write(struct ox16c954_port *up, int offset, int value)
 
 
 
-/*******************************************************************/
-/** Control Software XON/XOFF handshaking in EFR
- *
- * \param up		\IN Oxford 16C954 Port Struct
- * \param en		\IN 0: disable XON/XOFF Flowcontrol else enable it
- *
- * \return 			-
- */
-static void set_inband_flowctrl(struct ox16c954_port *up, unsigned char en)
-{
-
-	unsigned char efr = serial_efr_read(up, M77_EFR_OFFSET) & 0xF0;
-	
-	if (en) 
-		efr |=0xa;  /* bits xxxx 1010 enable it*/
-	
-	M77DBG3("set_inband_flowctrl: Setting EFR = 0x%02x\n", efr);
-	serial_efr_write(up, M77_EFR_OFFSET, efr);
-}
-
-
 /*******************************************************************/
 /** Write to 16C950 Indexed Control Register set
  *
@@ -577,10 +1205,10 @@ static unsigned int serial_icr_read(struct ox16c954_port *up, int offset)
 {
 	unsigned int value;
 
-	serial_icr_write(up, UART_ACR, up->acr | UART_ACR_ICRRD);
+	serial_icr_write(up, UART_ACR, up->hot->acr | UART_ACR_ICRRD);
 	serial_out(up, UART_SCR, offset);
 	value = serial_in(up, UART_ICR);
-	serial_icr_write(up, UART_ACR, up->acr );
+	serial_icr_write(up, UART_ACR, up->hot->acr );
 	M77DBG3("%s: read 0x%02x from Reg. 0x%02x\n",__FUNCTION__, value, offset);
 	
 	return value;
@@ -601,6 +1229,7 @@ static inline void men_uart_clear_fifos(struct ox16c954_port *up)
 		serial_out(up, UART_FCR, UART_FCR_ENABLE_FIFO |
 			       UART_FCR_CLEAR_RCVR | UART_FCR_CLEAR_XMIT);
 		serial_out(up, UART_FCR, 0);
+		up->fcr = 0;
 	}
 }
 
@@ -628,7 +1257,7 @@ static struct uart_driver men_uart_reg = {
 	.dev_name		= UART_NAME_PREFIX,
 	.major			= MEN_UART_MAJOR,
 	.minor			= 0,
-	.nr				= MAX_SNGL_UARTS,
+	.nr				= 0,	/* set from devName at load time */
 	.cons			= NULL/* MEN_UART_CONSOLE */,
 };
 
@@ -657,8 +1286,6 @@ static struct uart_ops men_uart_pops = {
 	.verify_port	= men_uart_verify_port,
 };
 
-static struct ox16c954_port men_uart_ports[MAX_SNGL_UARTS];
-
 
 /*******************************************************************/
 /** Ioctl function to treat special codes not handled in serial_core.c
@@ -675,7 +1302,7 @@ static int men_uart_m77phy( struct uart_port *up,
 {
 /*     int retVal = 0; */
 	unsigned char ch = 0;
-	struct ox16c954_port *ox = &men_uart_ports[up->line];
+	struct ox16c954_port *ox = (struct ox16c954_port *)up;
 
 	M77DBG2("%s: line %d ox->type = %d\n", __FUNCTION__, up->line, ox->type );
 
@@ -710,16 +1337,16 @@ static int men_uart_m77phy( struct uart_port *up,
 		/* Read DCR, ACR and clear out Mode bits DCR[0:2] first */
 		ch = serial_in(ox, ox->dcrReg);
 		ch &= 0xF8;	/* set desired bits later.. */
-		ox->acr = serial_icr_read(ox, UART_ACR);
-		M77DBG2("1. DCR=0x%02x ACR=0x%02x ", ch, ox->acr );
+		ox->hot->acr = serial_icr_read(ox, UART_ACR);
+		M77DBG2("1. DCR=0x%02x ACR=0x%02x ", ch, ox->hot->acr );
 
 		switch (arg) {
 		case M77_RS422_HD:
 			ch |= M77_RS422_HD;
 			M77DBG2("2. set DCR(0x%02x)=%02x(RS422 HD), ", ox->dcrReg<<1, ch);
-			ox->acr |= OX954_ACR_DTR;
-			ox->acrShadow = ox->acr;
-			serial_icr_write(ox, UART_ACR, ox->acr);
+			ox->hot->acr |= OX954_ACR_DTR;
+			ox->acrShadow = ox->hot->acr;
+			serial_icr_write(ox, UART_ACR, ox->hot->acr);
 			serial_out(ox, ox->dcrReg, ch);
 			break;
 
@@ -727,35 +1354,35 @@ static int men_uart_m77phy( struct uart_port *up,
 			ch |= M77_RS422_FD;
 			M77DBG2("2. set DCR(0x%02x)=%02x(RS422 FD), ", ox->dcrReg<<1, ch);
 			serial_out(ox, ox->dcrReg, ch);
-			ox->acr &= ~OX954_ACR_DTR;
-			ox->acrShadow = ox->acr;
-			serial_icr_write(ox, UART_ACR, ox->acr);
+			ox->hot->acr &= ~OX954_ACR_DTR;
+			ox->acrShadow = ox->hot->acr;
+			serial_icr_write(ox, UART_ACR, ox->hot->acr);
 			break;
 
 		case M77_RS485_HD:
 			ch |= M77_RS485_HD;
 			M77DBG2("2. set DCR(0x%02x)=%02x(RS485 HD), ", ox->dcrReg<<1, ch);
-			ox->acr |= OX954_ACR_DTR;
-			ox->acrShadow = ox->acr;
-			serial_icr_write(ox, UART_ACR, ox->acr);
+			ox->hot->acr |= OX954_ACR_DTR;
+			ox->acrShadow = ox->hot->acr;
+			serial_icr_write(ox, UART_ACR, ox->hot->acr);
 			serial_out(ox, ox->dcrReg, ch);
 			break;
 
 		case M77_RS485_FD:
 			ch |= M77_RS485_FD;
 			M77DBG2("2. set DCR(0x%02x)=%02x(RS485 FD), ", ox->dcrReg<<1, ch);
-			ox->acr &= ~OX954_ACR_DTR;
-			ox->acrShadow = ox->acr;
-			serial_icr_write(ox, UART_ACR, ox->acr);
+			ox->hot->acr &= ~OX954_ACR_DTR;
+			ox->acrShadow = ox->hot->acr;
+			serial_icr_write(ox, UART_ACR, ox->hot->acr);
 			serial_out(ox, ox->dcrReg, ch);
 			break;
 
 		case M77_RS232:
 			ch |= M77_RS232;
 			M77DBG2("2. set DCR(0x%02x)=%02x(RS232 HD), ", ox->dcrReg<<1, ch);
-			ox->acr &= ~OX954_ACR_DTR;
-			ox->acrShadow = ox->acr;
-			serial_icr_write(ox, UART_ACR, ox->acr);
+			ox->hot->acr &= ~OX954_ACR_DTR;
+			ox->acrShadow = ox->hot->acr;
+			serial_icr_write(ox, UART_ACR, ox->hot->acr);
 			serial_out(ox, ox->dcrReg, ch);
 			break;
 		default:
@@ -763,7 +1390,7 @@ static int men_uart_m77phy( struct uart_port *up,
 		}
 
 		ox->m77Mode = arg;
-		M77DBG(" ACR = %02x\n", ox->acr);
+		M77DBG(" ACR = %02x\n", ox->hot->acr);
 		break;
 
 		/* 	
@@ -774,6 +1401,8 @@ static int men_uart_m77phy( struct uart_port *up,
 		if (ox->type != MOD_M45)
 			return -ENOTTY;
 
+		/* TCR is shared by 4 channels, keep read-modify-write atomic */
+		mutex_lock(&ox->mod->lock);
 		ch = serial_in(ox, ox->tcrReg);		
 		M77DBG2(" 1. read TCR: 0x%02x ", ch );
 		if (arg)
@@ -783,6 +1412,7 @@ static int men_uart_m77phy( struct uart_port *up,
 
 		M77DBG2("2. set TCR(0x%02x) = %02x\n", ox->tcrReg << 1, ch );
 		serial_out(ox, ox->tcrReg, ch );			
+		mutex_unlock(&ox->mod->lock);
 		break;
 	}
 
@@ -805,6 +1435,8 @@ static int men_uart_ioctl(struct uart_port *up, unsigned int cmd,
 						  unsigned long arg)
 {
 	int retval = 0;
+	unsigned int mmioOp = m77_mmio_port_op((struct ox16c954_port *)up,
+										   M77_MMIO_IOCTL);
 
 	/* M77DBG("%s: cmd = 0x%x arg = 0x%x ", __FUNCTION__, cmd, arg ); */
 
@@ -814,11 +1446,35 @@ static int men_uart_ioctl(struct uart_port *up, unsigned int cmd,
 	case M77_ECHO_SUPPRESS:
 	case M45_TIO_TRI_MODE:
 		retval = men_uart_m77phy( up, cmd, arg);
+		trace_m77_phy(up->line, cmd, arg, retval);
+		break;
+
+	case M77_BRIDGE_SET:
+	case M77_BRIDGE_GET:
+		retval = m77_bridge_ioctl((struct ox16c954_port *)up, cmd, arg);
+		break;
+
+	/* serial core holds the tty port mutex, as for men_uart_shutdown() */
+	case M77_NET_ATTACH:
+		retval = m77_net_attach((struct ox16c954_port *)up, arg);
+		break;
+
+	case M77_NET_DETACH:
+		m77_net_detach((struct ox16c954_port *)up);
+		break;
+
+	case M77_BPF_ATTACH:
+		retval = m77_bpf_attach((struct ox16c954_port *)up, (int)arg);
+		break;
+
+	case M77_BPF_STATS:
+		retval = m77_bpf_stats((struct ox16c954_port *)up, arg);
 		break;
             
 	default:
 		retval = -ENOIOCTLCMD;
 	}
+	m77_mmio_port_op((struct ox16c954_port *)up, mmioOp);
 	return retval;
 
 }
@@ -845,8 +1501,8 @@ static void autoconfig_16550a(struct ox16c954_port *up)
 		up->capabilities |= UART_CAP_FIFO|UART_CAP_EFR | UART_CAP_SLEEP;
 
 		/* Check for Oxford Semiconductor 16C95x (true for M45N/69N/77) */
-		up->acr = 0;	
-		up->acrShadow = up->acr;
+		up->hot->acr = 0;	
+		up->acrShadow = up->hot->acr;
 		
 		/* Set Enhanced Mode */
 		serial_efr_write(up, UART_EFR, UART_EFR_ECB);
@@ -893,6 +1549,8 @@ static void autoconfig(struct ox16c954_port *up, unsigned int probeflags)
 
 	up->capabilities = 0;
 	up->bugs = 0;
+	up->txenTested = 0;
+	up->cfgValid = 0;
 
 	scratch = serial_in(up, UART_IER);
 	serial_out(up, UART_IER, 0);
@@ -963,7 +1621,7 @@ static void autoconfig(struct ox16c954_port *up, unsigned int probeflags)
 
 	up->port.fifosize = uart_config[up->port.type].fifo_size;
 	up->capabilities = uart_config[up->port.type].flags;
-	up->tx_loadsz = uart_config[up->port.type].tx_loadsz;
+	up->hot->tx_loadsz = uart_config[up->port.type].tx_loadsz;
 
 	if (up->port.type == PORT_UNKNOWN)
 		goto out;
@@ -987,6 +1645,68 @@ static void autoconfig(struct ox16c954_port *up, unsigned int probeflags)
 }
 
 
+/*******************************************************************/
+/** Check the ID of one OX16C954 on an identified M-Module
+ *
+ * \param up		\IN Oxford 16C954 Port Struct, first channel of the chip
+ *
+ * \brief Replaces autoconfig() when fullProbe is not set. The module
+ *        type is known from m_getmodinfo(), so only the chip ID is read
+ *        once per OX16C954 instead of probing every channel.
+ *
+ * \return 			0 if an OX16C95x was found or -ENODEV
+ */
+static int m77_check_chip_id(struct ox16c954_port *up)
+{
+	unsigned int id1, id2, id3;
+
+	/* Set Enhanced Mode, ID registers are read through the ICR */
+	serial_efr_write(up, UART_EFR, UART_EFR_ECB);
+	id1 = serial_icr_read(up, UART_ID1);
+	id2 = serial_icr_read(up, UART_ID2);
+	id3 = serial_icr_read(up, UART_ID3);
+	M77DBG("16c950 ID: %02x:%02x:%02x ", id1, id2, id3);
+
+	if (id1==0x16 && id2 == 0xC9 && (id3==0x50 || id3==0x52 || id3==0x54)) 
+		return 0;
+
+	printk(KERN_ERR "*** "UART_NAME_PREFIX"%d: no OX16C95x, ID %02x:%02x:%02x\n",
+		   up->port.line, id1, id2, id3);
+	return -ENODEV;
+}
+
+
+/*******************************************************************/
+/** Preset a channel of an identified M-Module without autoconfig()
+ *
+ * \param up		\IN Oxford 16C954 Port Struct
+ *
+ * \brief Sets what autoconfig() would detect for an OX16C954 and does
+ *        the same UART reset. The port is registered without
+ *        UPF_BOOT_AUTOCONF afterwards, so serial core keeps the type.
+ *
+ * \return 			-
+ */
+static void m77_fast_config(struct ox16c954_port *up)
+{
+	up->port.type		= PORT_16C950;
+	up->port.fifosize	= uart_config[PORT_16C950].fifo_size;
+	up->capabilities	= uart_config[PORT_16C950].flags;
+	up->hot->tx_loadsz	= uart_config[PORT_16C950].tx_loadsz;
+	up->bugs			= 0;
+	up->txenTested		= 0;
+	up->cfgValid		= 0;
+	up->hot->acr		= 0;
+	up->acrShadow		= 0;
+
+	/* Set Enhanced Mode and reset the UART like autoconfig() */
+	serial_efr_write(up, UART_EFR, UART_EFR_ECB);
+	men_uart_clear_fifos(up);
+	(void)serial_in(up, UART_RX);
+	serial_out(up, UART_IER, 0);
+}
+
+
 /*******************************************************************/
 /** lowlevel TX Stop function, by clearing Threshold IRQ
  *
@@ -996,9 +1716,9 @@ static void autoconfig(struct ox16c954_port *up, unsigned int probeflags)
  */
 static inline void __stop_tx(struct ox16c954_port *p)
 {
-	if (p->ier & UART_IER_THRI) {
-		p->ier &= ~UART_IER_THRI;
-		serial_out(p, UART_IER, p->ier);
+	if (p->hot->ier & UART_IER_THRI) {
+		p->hot->ier &= ~UART_IER_THRI;
+		serial_out(p, UART_IER, p->hot->ier);
 	}
 }
 
@@ -1019,54 +1739,372 @@ static void men_uart_stop_tx(struct uart_port *port)
 	 * We really want to stop the transmitter from sending.
 	 */
 	if (up->port.type == PORT_16C950) {
-		up->acr |= UART_ACR_TXDIS;
-		serial_icr_write(up, UART_ACR, up->acr);
-		up->acrShadow = up->acr;
+		up->hot->acr |= UART_ACR_TXDIS;
+		serial_icr_write(up, UART_ACR, up->hot->acr);
+		up->acrShadow = up->hot->acr;
 	}
 }
 
 
 /*******************************************************************/
-/** central transmit function, called in ISR 
+/** map the LSR error bits of a received char to M77_MUX_xxx flags
  *
- * \param up		\IN Oxford 16C954 Port Struct
+ * \param lsr		\IN LSR Register value of the char
+ *
+ * \return 			M77_MUX_BREAK/PARITY/FRAME/OVERRUN
+ */
+static inline unsigned char m77_lsr_flags(unsigned char lsr)
+{
+	unsigned char flags = 0;
+
+	if (lsr & UART_LSR_BI)
+		flags |= M77_MUX_BREAK;
+	else if (lsr & UART_LSR_PE)
+		flags |= M77_MUX_PARITY;
+	else if (lsr & UART_LSR_FE)
+		flags |= M77_MUX_FRAME;
+	if (lsr & UART_LSR_OE)
+		flags |= M77_MUX_OVERRUN;
+	return flags;
+}
+
+
+/*******************************************************************/
+/** store one record in the tap ring of a port, called in ISR
+ *
+ * \param up		\IN Oxford 16C954 Port Struct, port lock held
+ * \param acc		\IN collected chars, len <= M77_TAP_DATA
+ * \param dir		\IN M77_TAP_RX or M77_TAP_TX
+ *
+ * \brief The ring is overwritten when full, readers see the gap in seq.
  *
  * \return 			-
  */
-static inline void transmit_chars(struct ox16c954_port *up)
+static void m77_tap_put(struct ox16c954_port *up, struct m77_tap_acc *acc,
+						unsigned char dir)
 {
-	struct circ_buf *xmit = &up->port.state->xmit;
+	struct m77_tap *tap = up->tap;
+	struct m77_tap_rec *rec;
+
+	spin_lock(&tap->lock);
+	rec = &tap->slots[tap->seq & (TAP_NSLOTS - 1)];
+	rec->timestamp	= ktime_get_ns();
+	rec->seq		= tap->seq;
+	rec->dir		= dir;
+	rec->flags		= acc->flags;
+	rec->len		= acc->len;
+	memcpy(rec->data, acc->buf, acc->len);
+	tap->seq++;
+	spin_unlock(&tap->lock);
+
+	wake_up_interruptible(&tap->wait);
+}
 
-	int count;
 
-	if (up->port.x_char) {
-		serial_out(up, UART_TX, up->port.x_char);
-		up->port.icount.tx++;
-		up->port.x_char = 0;
-		return;
-	}
+/*******************************************************************/
+/** pass the chars collected by this drain to the tap, if one is attached
+ *
+ * \param up		\IN Oxford 16C954 Port Struct, port lock held
+ * \param dir		\IN M77_TAP_RX or M77_TAP_TX
+ *
+ * \return 			-
+ */
+static inline void m77_tap_flush(struct ox16c954_port *up, unsigned char dir)
+{
+	struct m77_tap_acc *acc;
 
-	if (uart_tx_stopped(&up->port)) {
-		men_uart_stop_tx(&up->port);
+	if (!static_branch_unlikely(&m77_tap_key) || !up->tap)
 		return;
-	}
 
-	if (uart_circ_empty(xmit)) {
-		__stop_tx(up);
-		return;
+	acc = &up->tap->acc[dir];
+	if (acc->len || acc->flags)
+		m77_tap_put(up, acc, dir);
+	acc->len	= 0;
+	acc->flags	= 0;
+}
+
+
+/*******************************************************************/
+/** collect one char for the tap, nothing but a patched jump if no tap
+ *  is attached to any port
+ *
+ * \param up		\IN Oxford 16C954 Port Struct, port lock held
+ * \param dir		\IN M77_TAP_RX or M77_TAP_TX
+ * \param ch		\IN char received or sent
+ * \param lsr		\IN RX: LSR Register value of the char, TX: 0
+ *
+ * \brief The chars are collected in the tap of the port, so the drain
+ *        loops need no buffer of their own.
+ *
+ * \return 			-
+ */
+static inline void m77_tap_char(struct ox16c954_port *up, unsigned char dir,
+								unsigned char ch, unsigned char lsr)
+{
+	struct m77_tap_acc *acc;
+
+	if (!static_branch_unlikely(&m77_tap_key) || !up->tap)
+		return;
+
+	acc = &up->tap->acc[dir];
+	acc->flags |= m77_lsr_flags(lsr);
+	acc->buf[acc->len++] = ch;
+	if (acc->len == M77_TAP_DATA)
+		m77_tap_flush(up, dir);
+}
+
+
+/*******************************************************************/
+/** send from the TX buffer of the serdev consumer, called in ISR
+ *
+ * \param up		\IN Oxford 16C954 Port Struct, port lock held
+ *
+ * \return 			-
+ */
+static inline void m77_serdev_tx_chars(struct ox16c954_port *up)
+{
+	struct m77_serdev *sd = up->serdev;
+	struct circ_buf *xmit = &sd->xmit;
+	int count = up->hot->tx_loadsz;
+
+	if (uart_circ_empty(xmit)) {
+		__stop_tx(up);
+		return;
+	}
+
+	do {
+		serial_out(up, UART_TX, xmit->buf[xmit->tail]);
+		m77_tap_char(up, M77_TAP_TX, xmit->buf[xmit->tail], 0);
+		xmit->tail = (xmit->tail + 1) & (UART_XMIT_SIZE - 1);
+		up->port.icount.tx++;
+	} while (!uart_circ_empty(xmit) && --count > 0);
+	m77_tap_flush(up, M77_TAP_TX);
+
+	if (uart_circ_chars_pending(xmit) < WAKEUP_CHARS)
+		serdev_controller_write_wakeup(sd->ctrl);
+	if (uart_circ_empty(xmit))
+		__stop_tx(up);
+}
+
+
+/*******************************************************************/
+/** send from the pages queued by splice() on /dev/m77raw<line>,
+ *  called in ISR
+ *
+ * \param up		\IN Oxford 16C954 Port Struct, up->raw set
+ *
+ * \brief The raw device is woken up once per finished page only, the
+ *        splice writer then drops its page reference.
+ *
+ * \return 			number of chars written to the TX FIFO
+ */
+static inline int m77_raw_tx_segs(struct ox16c954_port *up)
+{
+	struct m77_raw *raw = up->raw;
+	unsigned int tail = raw->segTail, n, i;
+	int count = up->hot->tx_loadsz, sent = 0;
+	struct m77_raw_seg *seg;
+	unsigned char *p;
+
+	if (tail == raw->segHead)
+		return 0;
+
+	while (count > 0 && tail != raw->segHead) {
+		seg = &raw->seg[tail & (RAW_SPLICE_SEGS - 1)];
+		n = min_t(unsigned int, seg->len, count);
+
+		p = kmap_local_page(seg->page);
+		for (i = 0; i < n; i++) {
+			serial_out(up, UART_TX, p[seg->off + i]);
+			m77_tap_char(up, M77_TAP_TX, p[seg->off + i], 0);
+		}
+		kunmap_local(p);
+
+		seg->off	+= n;
+		seg->len	-= n;
+		count		-= n;
+		sent		+= n;
+		if (!seg->len)
+			tail++;
+	}
+	m77_tap_flush(up, M77_TAP_TX);
+	up->port.icount.tx += sent;
+
+	if (tail != raw->segTail) {
+		/* pairs with smp_load_acquire() in m77_raw_put_segs() */
+		smp_store_release(&raw->segTail, tail);
+		wake_up_interruptible(&raw->wait);
+	}
+	return sent;
+}
+
+
+/*******************************************************************/
+/** send from the TX ring of /dev/m77raw<line>, called in ISR
+ *
+ * \param up		\IN Oxford 16C954 Port Struct, up->raw set
+ *
+ * \return 			number of chars written to the TX FIFO
+ */
+static inline int m77_raw_tx_chars(struct ox16c954_port *up)
+{
+	struct m77_raw *raw = up->raw;
+	unsigned int tail = raw->txTail;
+	unsigned int pending = smp_load_acquire(&raw->hdr->txHead) - tail;
+	int count = up->hot->tx_loadsz, sent = 0;
+	unsigned char ch;
+
+	if (!pending)
+		return m77_raw_tx_segs(up);
+
+	/* the user may write anything into txHead, stay within the ring */
+	if (pending > M77_RAW_TX_SIZE)
+		pending = M77_RAW_TX_SIZE;
+
+	while (pending-- && count-- > 0) {
+		ch = raw->tx[tail++ & (M77_RAW_TX_SIZE - 1)];
+		serial_out(up, UART_TX, ch);
+		m77_tap_char(up, M77_TAP_TX, ch, 0);
+		sent++;
+	}
+	m77_tap_flush(up, M77_TAP_TX);
+	up->port.icount.tx += sent;
+
+	raw->txTail = tail;
+	smp_store_release(&raw->hdr->txTail, tail);
+	wake_up_interruptible(&raw->wait);
+	return sent;
+}
+
+
+/*******************************************************************/
+/** self-test running on a port, nothing but a patched jump if no test
+ *  runs on any port
+ *
+ * \param up		\IN Oxford 16C954 Port Struct, port lock held
+ *
+ * \return 			self-test or NULL
+ */
+static inline struct m77_selftest *m77_selftest_of(struct ox16c954_port *up)
+{
+	if (!static_branch_unlikely(&m77_selftest_key))
+		return NULL;
+	return up->selftest;
+}
+
+/*******************************************************************/
+/** next char of the PRBS15 (x^15 + x^14 + 1) sequence
+ *
+ * \param state		\INOUT generator state, the last 15 bits sent
+ *
+ * \brief The bits go out MSB first, so the state after a char is
+ *        (previous char << 8 | char) & 0x7fff. The checker uses this to
+ *        resynchronize after lost chars.
+ *
+ * \return 			char
+ */
+static inline unsigned char m77_prbs_next(u16 *state)
+{
+	unsigned int s = *state, bit, i;
+	unsigned char c = 0;
+
+	for (i = 0; i < 8; i++) {
+		bit = ((s >> 14) ^ (s >> 13)) & 1;
+		s	= ((s << 1) | bit) & 0x7fff;
+		c	= (c << 1) | bit;
+	}
+	*state = s;
+	return c;
+}
+
+/*******************************************************************/
+/** send the PRBS pattern of the self-test, called in ISR
+ *
+ * \param up		\IN Oxford 16C954 Port Struct, port lock held
+ * \param st		\IN self-test running on the port
+ *
+ * \return 			-
+ */
+static inline void m77_selftest_tx_chars(struct ox16c954_port *up,
+										 struct m77_selftest *st)
+{
+	int count = min_t(unsigned int, up->hot->tx_loadsz, st->txLeft);
+
+	st->txLeft			-= count;
+	up->port.icount.tx	+= count;
+	while (count-- > 0)
+		serial_out(up, UART_TX, m77_prbs_next(&st->txPrbs));
+
+	if (!st->txLeft)
+		__stop_tx(up);
+}
+
+
+/*******************************************************************/
+/** central transmit function, called in ISR 
+ *
+ * \param up		\IN Oxford 16C954 Port Struct
+ *
+ * \return 			-
+ */
+static inline void transmit_chars(struct ox16c954_port *up)
+{
+	struct circ_buf *xmit = &up->port.state->xmit;
+	int count;
+
+	if (up->port.x_char) {
+		serial_out(up, UART_TX, up->port.x_char);
+		m77_tap_char(up, M77_TAP_TX, up->port.x_char, 0);
+		m77_tap_flush(up, M77_TAP_TX);
+		up->port.icount.tx++;
+		up->port.x_char = 0;
+		return;
+	}
+
+	if (uart_tx_stopped(&up->port)) {
+		men_uart_stop_tx(&up->port);
+		return;
+	}
+
+	if (unlikely(m77_selftest_of(up))) {
+		m77_selftest_tx_chars(up, up->selftest);
+		return;
+	}
+
+	/* raw TX ring first, the tty xmit buffer when it is empty */
+	if (up->raw && m77_raw_tx_chars(up))
+		return;
+
+	if (up->serdev) {
+		m77_serdev_tx_chars(up);
+		return;
+	}
+
+	if (uart_circ_empty(xmit)) {
+		__stop_tx(up);
+		return;
 	}
 
-	count = up->tx_loadsz;
+	count = up->hot->tx_loadsz;
 	do {
 		serial_out(up, UART_TX, xmit->buf[xmit->tail]);
+		m77_tap_char(up, M77_TAP_TX, xmit->buf[xmit->tail], 0);
 		xmit->tail = (xmit->tail + 1) & (UART_XMIT_SIZE - 1);
 		up->port.icount.tx++;
 		if (uart_circ_empty(xmit))
 			break;
 	} while (--count > 0);
+	m77_tap_flush(up, M77_TAP_TX);
 
-	if (uart_circ_chars_pending(xmit) < WAKEUP_CHARS)
+	if (uart_circ_chars_pending(xmit) < WAKEUP_CHARS) {
 		uart_write_wakeup(&up->port);
+		if (up->bridgeSrc && READ_ONCE(up->bridgeSrc->bridgeStall))
+			schedule_work(&up->bridgeSrc->bridgeWork);
+		if (up->bondMem)
+			tty_port_tty_wakeup(&up->bondMem->bond->port);
+		if (up->net)
+			netif_wake_queue(up->net->dev);
+	}
 
 	DEBUG_INTR("THRE ");
 
@@ -1086,9 +2124,9 @@ static void men_uart_start_tx(struct uart_port *port)
 {
 	struct ox16c954_port *up = (struct ox16c954_port *)port;
 
-	if (!(up->ier & UART_IER_THRI)) {
-		up->ier |= UART_IER_THRI;
-		serial_out(up, UART_IER, up->ier);
+	if (!(up->hot->ier & UART_IER_THRI)) {
+		up->hot->ier |= UART_IER_THRI;
+		serial_out(up, UART_IER, up->hot->ier);
 
 		if (up->bugs & UART_BUG_TXEN) {
 			unsigned char lsr, iir;
@@ -1100,10 +2138,10 @@ static void men_uart_start_tx(struct uart_port *port)
 	}
 
 	/* Re-enable the transmitter if we disabled it. */
-	if ( up->acr & UART_ACR_TXDIS) {
-		up->acr &= ~UART_ACR_TXDIS;
-		serial_icr_write(up, UART_ACR, up->acr);
-		up->acrShadow = up->acr;
+	if ( up->hot->acr & UART_ACR_TXDIS) {
+		up->hot->acr &= ~UART_ACR_TXDIS;
+		serial_icr_write(up, UART_ACR, up->hot->acr);
+		up->acrShadow = up->hot->acr;
 	}
 }
 
@@ -1119,9 +2157,9 @@ static void men_uart_stop_rx(struct uart_port *port)
 {
 	struct ox16c954_port *up = (struct ox16c954_port *)port;
 
-	up->ier &= ~UART_IER_RLSI;
+	up->hot->ier &= ~UART_IER_RLSI;
 	up->port.read_status_mask &= ~UART_LSR_DR;
-	serial_out(up, UART_IER, up->ier);
+	serial_out(up, UART_IER, up->hot->ier);
 }
 
 /*******************************************************************/
@@ -1139,8 +2177,8 @@ static void men_uart_enable_ms(struct uart_port *port)
 	if (up->bugs & UART_BUG_NOMSR)
 		return;
 
-	up->ier |= UART_IER_MSI;
-	serial_out(up, UART_IER, up->ier);
+	up->hot->ier |= UART_IER_MSI;
+	serial_out(up, UART_IER, up->hot->ier);
 }
 
 /*******************************************************************/
@@ -1163,6 +2201,7 @@ receive_chars(struct ox16c954_port *up, int *status, struct pt_regs *regs)
 
 	do {
 		ch = serial_in(up, UART_RX);
+		m77_tap_char(up, M77_TAP_RX, ch, lsr);
 		flag = TTY_NORMAL;
 		up->port.icount.rx++;
 
@@ -1211,6 +2250,7 @@ receive_chars(struct ox16c954_port *up, int *status, struct pt_regs *regs)
 	ignore_char:
 		lsr = serial_in(up, UART_LSR);
 	} while ((lsr & UART_LSR_DR) && (max_count-- > 0));
+	m77_tap_flush(up, M77_TAP_RX);
 	spin_unlock(&up->port.lock);
 	tty_flip_buffer_push(tty->port);
 	spin_lock(&up->port.lock);
@@ -1218,906 +2258,5692 @@ receive_chars(struct ox16c954_port *up, int *status, struct pt_regs *regs)
 }
 
 /*******************************************************************/
-/** check_modem_status Bits
+/** count the line errors of one received char, called within ISR
  *
- * \param up			\IN Oxford 16C954 Port Struct
+ * \param up			\IN		Oxford 16C954 Port Struct
+ * \param lsr			\IN		LSR Register value of the char
  *
  * \return 			-
  */
-static inline void check_modem_status(struct ox16c954_port *up)
+static inline void m77_count_lsr_errors(struct ox16c954_port *up,
+										unsigned char lsr)
 {
-	int status;
-
-	status = serial_in(up, UART_MSR);
-
-	if ((status & UART_MSR_ANY_DELTA) == 0)
-		return;
-
-	if (status & UART_MSR_TERI)
-		up->port.icount.rng++;
-	if (status & UART_MSR_DDSR)
-		up->port.icount.dsr++;
-	if (status & UART_MSR_DDCD)
-		uart_handle_dcd_change(&up->port, status & UART_MSR_DCD);
-	if (status & UART_MSR_DCTS)
-		uart_handle_cts_change(&up->port, status & UART_MSR_CTS);
-
-	wake_up_interruptible(&up->port.state->port.delta_msr_wait);
+	if (lsr & UART_LSR_BI)
+		up->port.icount.brk++;
+	else if (lsr & UART_LSR_PE)
+		up->port.icount.parity++;
+	else if (lsr & UART_LSR_FE)
+		up->port.icount.frame++;
+	if (lsr & UART_LSR_OE)
+		up->port.icount.overrun++;
 }
 
-
 /*******************************************************************/
-/** handles the interrupt from one port, within ISR
+/** receive chars into the RX ring of /dev/m77raw<line>, called in ISR
  *
- * \param up		\IN 	Oxford 16C954 Port Struct
- * \param regs		\IN 	passed from ISR but unused
+ * \param up			\IN		Oxford 16C954 Port Struct, up->raw set
+ * \param status		\INOUT	LSR Register value
+ *
+ * \brief Bypasses the tty flip buffers. Break characters are dropped,
+ *        chars with parity/framing errors are stored and counted.
  *
  * \return 			-
  */
-static inline void men_uart_handle_port(struct ox16c954_port *up, 
-										struct pt_regs *regs)
+static inline void
+receive_chars_raw(struct ox16c954_port *up, unsigned int *status)
 {
-	unsigned int status = serial_in(up, UART_LSR);
-
-	DEBUG_INTR("status = %x...", status);
+	struct m77_raw *raw = up->raw;
+	unsigned int head = raw->rxHead;
+	unsigned int tail = smp_load_acquire(&raw->hdr->rxTail);
+	unsigned char ch, lsr = *status;
+	int max_count = 256;
 
-	if (status & UART_LSR_DR)
-		receive_chars(up, &status, regs);
+	do {
+		ch = serial_in(up, UART_RX);
+		m77_tap_char(up, M77_TAP_RX, ch, lsr);
+		up->port.icount.rx++;
 
-	check_modem_status(up);
+		if (unlikely(lsr & (UART_LSR_BI | UART_LSR_PE |
+							UART_LSR_FE | UART_LSR_OE))) {
+			m77_count_lsr_errors(up, lsr);
+			if (lsr & (UART_LSR_BI | UART_LSR_PE | UART_LSR_FE))
+				raw->hdr->rxErrors++;
+			if (lsr & UART_LSR_BI)
+				goto ignore_char;
+		}
 
-	if (status & UART_LSR_THRE)
-		transmit_chars(up);
-}
+		/* the user may write anything into rxTail, never overwrite */
+		if (head - tail < M77_RAW_RX_SIZE)
+			raw->rx[head++ & (M77_RAW_RX_SIZE - 1)] = ch;
+		else
+			raw->hdr->rxDropped++;
 
+	ignore_char:
+		lsr = serial_in(up, UART_LSR);
+	} while ((lsr & UART_LSR_DR) && (max_count-- > 0));
+	m77_tap_flush(up, M77_TAP_RX);
 
+	if (head != raw->rxHead) {
+		raw->rxHead = head;
+		smp_store_release(&raw->hdr->rxHead, head);
+		wake_up_interruptible(&raw->wait);
+	}
+	*status = lsr;
+}
 
-/*****************************************************************************/
-/** handles the interrupt from one M-Module
+/*******************************************************************/
+/** forward received chars into the xmit buffer of the bridge peer,
+ *  called within ISR
  *
- * \param data		\IN 	void Parameter from MDIS Irq handler
+ * \param up			\IN		Oxford 16C954 Port Struct, port lock held
+ * \param status		\IN		LSR Register Value
+ *
+ * \brief The peer lock is taken after dropping our own one, two ports
+ *        forwarding to each other never hold both locks. With
+ *        M77_BRIDGE_FLOW only as many chars are read as the peer can
+ *        take, when it runs full the RX interrupts are disabled and,
+ *        with CRTSCTS, RTS is dropped until the peer transmitted its
+ *        buffer (m77_bridge_resume_work()).
+ *        Without, chars the peer cannot take are dropped and counted.
+ *        The chars are collected in up->bridgeBuf; only this ISR uses
+ *        it, so it stays private while the port lock is dropped.
  *
- * \brief The original 8250.c UART interrupt handler is now Registered via
- * mdis_install_external_irq(). Its taylored to match the Requirements
- * of serving the M45N/M69N/M77 Interrupts only. No calls to request_irq() are
- * done within this driver.
  * \return 			-
  */
-static int M77_IrqHandler(void *data)
+static inline void
+receive_chars_bridge(struct ox16c954_port *up, unsigned int *status)
 {
+	struct ox16c954_port *peer = up->bridge;
+	unsigned int flow = up->bridgeFlags & M77_BRIDGE_FLOW;
+	struct circ_buf *xmit = &peer->port.state->xmit;
+	unsigned char *buf = up->bridgeBuf;
+	unsigned char ch, lsr = *status;
+	unsigned int len = 0, max = BRIDGE_BLOCK, n = 0, i, room;
+	int max_count = 256;
 
- 	UARTMOD_INFO *mmod 			= data;
-	struct pt_regs *regs = NULL;
-	unsigned int i;
-	struct ox16c954_port *up;
-	unsigned int iir;
-	unsigned char cpld_ir_reg;
-	unsigned int retcode 		= LL_IRQ_DEV_NOT;
-	struct list_head  *pos		= NULL;
+	/* snapshot only, the peer may consume but nobody else produces */
+	if (flow && READ_ONCE(peer->opened))
+		max = min_t(unsigned int, max,
+					CIRC_SPACE(READ_ONCE(xmit->head), READ_ONCE(xmit->tail),
+							   UART_XMIT_SIZE));
 
-	/* skip through the registered M-Modules List */
-    list_for_each( pos, &G_uartModListHead ) {
+	while (len < max) {
+		ch = serial_in(up, UART_RX);
+		m77_tap_char(up, M77_TAP_RX, ch, lsr);
+		up->port.icount.rx++;
 
-		mmod = list_entry(pos, UARTMOD_INFO, head);
+		if (unlikely(lsr & (UART_LSR_BI | UART_LSR_PE |
+							UART_LSR_FE | UART_LSR_OE))) {
+			m77_count_lsr_errors(up, lsr);
+			/* the peer line has no way to mark errors, drop the char */
+			if (lsr & (UART_LSR_BI | UART_LSR_PE | UART_LSR_FE))
+				goto ignore_char;
+		}
+		buf[len++] = ch;
 
-		cpld_ir_reg = MREAD_D16( mmod->memBase, M77_REG_IR ) & 0x00ff;
-		/* printk(KERN_ERR "cpld_ir_reg = 0x%02x\n", cpld_ir_reg); */
+	ignore_char:
+		lsr = serial_in(up, UART_LSR);
+		if (!(lsr & UART_LSR_DR) || max_count-- <= 0)
+			break;
+	}
+	m77_tap_flush(up, M77_TAP_RX);
+	spin_unlock(&up->port.lock);
 
-		if ( cpld_ir_reg & 0x1 ) {
-			for (i = 0; i < mmod->nrChannels; i++) {
-				up = mmod->port8250[i];				
-				iir = serial_in(up, UART_IIR);
-				if ( !(iir & UART_IIR_NO_INT) ) {
-					spin_lock(&up->port.lock);
-					DEBUG_INTR("ISR: UART%d\n", i);
-					men_uart_handle_port(up, regs);
-					spin_unlock(&up->port.lock);
-				}
-			}
-			/* clear Interrupt */
-			control_out( mmod->memBase, M77_REG_IR,	cpld_ir_reg);
-			retcode = LL_IRQ_DEVICE;
+	spin_lock(&peer->port.lock);
+	if (peer->opened && xmit->buf) {
+		room = CIRC_SPACE(xmit->head, xmit->tail, UART_XMIT_SIZE);
+		n = min(len, room);
+		for (i = 0; i < n; i++) {
+			xmit->buf[xmit->head] = buf[i];
+			xmit->head = (xmit->head + 1) & (UART_XMIT_SIZE - 1);
 		}
+		if (n)
+			men_uart_start_tx(&peer->port);
 
-		/* If its an M45N check the second IR Register at 0xC8 too */
-		if (mmod->modtype == MOD_M45) {
+		/* peer->bridgeSrc is cleared under this lock when unlinked */
+		if (flow && peer->bridgeSrc == up && room - n < BRIDGE_STALL_ROOM)
+			WRITE_ONCE(up->bridgeStall, 1);
+	}
+	spin_unlock(&peer->port.lock);
+
+	spin_lock(&up->port.lock);
+	up->bridgeFwd	+= n;
+	up->bridgeDrop	+= len - n;
+	if (up->bridgeStall && (up->hot->ier & UART_IER_RDI)) {
+		/* leave the chars in the FIFO, RTS holds off the sender */
+		up->hot->ier &= ~(UART_IER_RLSI | UART_IER_RDI);
+		serial_out(up, UART_IER, up->hot->ier);
+		if (up->ctsFlow)
+			men_uart_set_mctrl(&up->port, up->port.mctrl & ~TIOCM_RTS);
+		up->rxStallAt = ktime_get_ns();
+	}
+	*status = lsr;
+}
 
-			cpld_ir_reg = MREAD_D16(mmod->memBase, M45_REG_IR2 ) & 0x00ff;
-			/* printk(KERN_ERR "cpld_ir_reg(2) = 0x%02x\n", cpld_ir_reg); */
+/*******************************************************************/
+/** send a block redirected by the RX filter on another ttyD line
+ *
+ * \param up			\IN		port the block was received on, lock held
+ * \param line			\IN		ttyD line to send it on
+ * \param buf			\IN		chars
+ * \param len			\IN		nr. of chars
+ *
+ * \brief The port lock is dropped while the peer lock is taken, as in
+ *        receive_chars_bridge(). Chars not fitting into the xmit buffer
+ *        of the peer, or for a peer not open as ttyD or sending frames
+ *        of its own (raw device, serdev, network interface, bond), are
+ *        counted as lost.
+ *
+ * \return 			-
+ */
+static void m77_bpf_redirect(struct ox16c954_port *up, unsigned int line,
+							 const unsigned char *buf, unsigned int len)
+{
+	struct ox16c954_port *peer = m77_find_port(line);
+	struct circ_buf *xmit;
+	unsigned int n = 0, i;
 
-			if ( cpld_ir_reg & 0x1 ) {
-				for (i = 0; i < mmod->nrChannels; i++) { 
-					/* optimal:check 4-7 only */
-					up = mmod->port8250[i];
-					iir = serial_in(up, UART_IIR);
-					if ( !(iir & UART_IIR_NO_INT) ) {
-						spin_lock(&up->port.lock);
-						men_uart_handle_port(up, regs);
-						spin_unlock(&up->port.lock);
-					}
-				}
-				/* clear Interrupt */
-				control_out( mmod->memBase, M45_REG_IR2, cpld_ir_reg);
+	spin_unlock(&up->port.lock);
+	if (peer) {
+		spin_lock(&peer->port.lock);
+		xmit = &peer->port.state->xmit;
+		if (peer->opened && xmit->buf && !peer->raw && !peer->serdev &&
+			!peer->net && !peer->bondMem) {
+			n = min_t(unsigned int, len,
+					  CIRC_SPACE(xmit->head, xmit->tail, UART_XMIT_SIZE));
+			for (i = 0; i < n; i++) {
+				xmit->buf[xmit->head] = buf[i];
+				xmit->head = (xmit->head + 1) & (UART_XMIT_SIZE - 1);
 			}
+			if (n)
+				men_uart_start_tx(&peer->port);
 		}
+		spin_unlock(&peer->port.lock);
 	}
-	return(retcode);
-}
+	spin_lock(&up->port.lock);
 
+	/* the filter may have been detached meanwhile */
+	if (up->bpf) {
+		up->bpf->stats.redirBytes	+= n;
+		up->bpf->stats.redirLost	+= len - n;
+	}
+}
 
 /*******************************************************************/
-/** check if UART transmit Register is empty
+/** receive chars through the attached BPF program, called within ISR
  *
- * \param port		\IN highlevel uart_port Struct (as in serial_core)
+ * \param up			\IN		Oxford 16C954 Port Struct, up->bpf set
+ * \param status		\INOUT	LSR Register value
  *
- * \return 			TIOCSER_TEMT if empty or 0
+ * \brief Up to BPF_BLOCK chars are drained into the skb of the filter
+ *        and the program runs once on the block, before anything is
+ *        inserted into the tty flip buffer. Verdicts see serial_m77.h.
+ *        No sysrq handling while a filter is attached.
+ *
+ * \return 			-
  */
-static unsigned int men_uart_tx_empty(struct uart_port *port)
+static inline void
+receive_chars_bpf(struct ox16c954_port *up, unsigned int *status)
 {
+	struct m77_bpf *bpf = up->bpf;
+	struct sk_buff *skb = bpf->skb;
+	unsigned char *lsrs = bpf->lsrs;
+	unsigned char ch, lsr = *status, *data;
+	unsigned int len = 0, n, i, ret;
+	char flag;
 
-	unsigned long flags;
-	unsigned int ret;
-	struct ox16c954_port *up;
+	__skb_trim(skb, 0);
+	data = skb->data;
 
-	up = (struct ox16c954_port *)port;
+	do {
+		ch = serial_in(up, UART_RX);
+		m77_tap_char(up, M77_TAP_RX, ch, lsr);
+		up->port.icount.rx++;
+		if (unlikely(lsr & (UART_LSR_BI | UART_LSR_PE |
+							UART_LSR_FE | UART_LSR_OE)))
+			m77_count_lsr_errors(up, lsr);
+		lsrs[len]	= lsr;
+		data[len++]	= ch;
+		lsr = serial_in(up, UART_LSR);
+	} while ((lsr & UART_LSR_DR) && len < BPF_BLOCK);
+	m77_tap_flush(up, M77_TAP_RX);
+	*status = lsr;
 
-	spin_lock_irqsave(&up->port.lock, flags);
-	ret = serial_in(up, UART_LSR) & UART_LSR_TEMT ? TIOCSER_TEMT : 0;
-	spin_unlock_irqrestore(&up->port.lock, flags);
+	skb_put(skb, len);
+	ret = bpf_prog_run_save_cb(bpf->prog, skb);
 
-	return ret;
-}
+	if (!ret) {
+		bpf->stats.dropBytes += len;
+		return;
+	}
 
+	if ((ret & ~0xffffU) == M77_BPF_REDIRECT) {
+		/* the skb belongs to the filter, copy before the lock is dropped */
+		memcpy(bpf->redir, data, len);
+		m77_bpf_redirect(up, ret & 0xffff, bpf->redir, len);
+		return;
+	}
 
-/******************************************************************************/
-/** return Modem Control Register and return as TIO* Values, for ioctl call
+	/* like a socket filter: ret is the nr. of chars kept */
+	n = min(ret, len);
+	for (i = 0; i < n; i++) {
+		lsr = lsrs[i];
+		if (lsr & UART_LSR_BI)
+			lsr &= ~(UART_LSR_FE | UART_LSR_PE);
+		lsr &= up->port.read_status_mask;
+
+		flag = TTY_NORMAL;
+		if (lsr & UART_LSR_BI)
+			flag = TTY_BREAK;
+		else if (lsr & UART_LSR_PE)
+			flag = TTY_PARITY;
+		else if (lsr & UART_LSR_FE)
+			flag = TTY_FRAME;
+
+		uart_insert_char(&up->port, lsr, UART_LSR_OE, data[i], flag);
+	}
+	bpf->stats.passBytes	+= n;
+	bpf->stats.dropBytes	+= len - n;
+
+	spin_unlock(&up->port.lock);
+	tty_flip_buffer_push(&up->port.state->port);
+	spin_lock(&up->port.lock);
+}
+
+/*******************************************************************/
+/** feed one received char into the frame parser of a bond member
  *
- * \param port		\IN 	Oxford 16C954 Port Struct
+ * \param mem		\IN  bond member, port lock held
+ * \param ch		\IN  received char
  *
- * \return 			encoded MSR Bits
+ * \brief Frame format see serial_m77.h. Invalid headers or checksums
+ *        restart the search for M77_BOND_SYNC.
+ *
+ * \return 			1 if mem->data holds a complete frame, else 0
  */
-static unsigned int men_uart_get_mctrl(struct uart_port *port)
+static int m77_bond_rx_byte(struct m77_bond_member *mem, unsigned char ch)
 {
-	unsigned char status;
-	unsigned int ret;
-	struct ox16c954_port *up = (struct ox16c954_port *)port;
-	status = serial_in(up, UART_MSR);
+	unsigned char *h = mem->hdr;
+
+	if (mem->pos < M77_BOND_HDR) {
+		if (mem->pos == 0 && ch != M77_BOND_SYNC)
+			return 0;
+		h[mem->pos++] = ch;
+		if (mem->pos < M77_BOND_HDR)
+			return 0;
+		if (h[4] != (unsigned char)~(h[1] + h[2] + h[3]) || !h[3] ||
+			h[3] > M77_BOND_MAX_PAYLOAD) {
+			mem->bad++;
+			mem->pos = 0;
+		}
+		mem->sum = 0;
+		return 0;
+	}
 
-	ret = 0;
-	if (status & UART_MSR_DCD)
-		ret |= TIOCM_CAR;
-	if (status & UART_MSR_RI)
-		ret |= TIOCM_RNG;
-	if (status & UART_MSR_DSR)
-		ret |= TIOCM_DSR;
-	if (status & UART_MSR_CTS)
-		ret |= TIOCM_CTS;
-	return ret;
-}
+	if (mem->pos < M77_BOND_HDR + h[3]) {
+		mem->data[mem->pos++ - M77_BOND_HDR] = ch;
+		mem->sum += ch;
+		return 0;
+	}
 
+	/* trailing payload checksum */
+	mem->pos = 0;
+	if (ch != mem->sum) {
+		mem->bad++;
+		return 0;
+	}
+	return 1;
+}
 
 
-/******************************************************************************/
-/** set Modem Control Register, called from core ioctl function
+/*******************************************************************/
+/** pass the frames of the reorder window to the bond tty in order
  *
- * \param port		\IN 	Oxford 16C954 Port Struct
- * \param mctrl		\IN 	MSR Bits to set
+ * \param bond		\IN  bonded tty, rxLock held
  *
  * \return 			-
  */
-static void men_uart_set_mctrl(struct uart_port *port, unsigned int mctrl)
+static void m77_bond_rx_deliver(struct m77_bond *bond)
 {
-	struct ox16c954_port *up = (struct ox16c954_port *)port;
-	unsigned char mcr = 0;
-
-	if (mctrl & TIOCM_RTS)
-		mcr |= UART_MCR_RTS;
-
-	if (mctrl & TIOCM_DTR)
-		mcr |= UART_MCR_DTR;
-
-	if (mctrl & TIOCM_OUT1)
-		mcr |= UART_MCR_OUT1;
-
-	if (mctrl & TIOCM_OUT2)
-		mcr |= UART_MCR_OUT2;
-
-	if (mctrl & TIOCM_LOOP)
-		mcr |= UART_MCR_LOOP;
-
-	mcr = (mcr & up->mcr_mask) | up->mcr_force | up->mcr;
+	struct m77_bond_slot *slot;
 
-	serial_out(up, UART_MCR, mcr);
+	for (;;) {
+		slot = &bond->slot[bond->rxSeq & (BOND_WINDOW - 1)];
+		if (!slot->valid)
+			break;
+		if (bond->open)
+			tty_insert_flip_string(&bond->port, slot->data, slot->len);
+		slot->valid = 0;
+		bond->rxWaiting--;
+		bond->rxFrames++;
+		bond->rxSeq++;
+	}
 }
 
 
-/******************************************************************************/
-/** set Set break control 
+/*******************************************************************/
+/** give up the missing frame(s) at the delivery point
  *
- * \param port			\IN 	Oxford 16C954 Port Struct
- * \param break_state	\IN     state to set, -1: set break, != -1:clear
+ * \param bond		\IN  bonded tty, rxLock held, rxWaiting != 0
  *
  * \return 			-
  */
-static void men_uart_break_ctl(struct uart_port *port, int break_state)
+static void m77_bond_rx_skip(struct m77_bond *bond)
 {
-	struct ox16c954_port *up = (struct ox16c954_port *)port;
-	unsigned long flags;
-
-	spin_lock_irqsave(&up->port.lock, flags);
-	if (break_state == -1)
-		up->lcr |= UART_LCR_SBC;
-	else
-		up->lcr &= ~UART_LCR_SBC;
-	serial_out(up, UART_LCR, up->lcr);
-	spin_unlock_irqrestore(&up->port.lock, flags);
+	while (!bond->slot[bond->rxSeq & (BOND_WINDOW - 1)].valid) {
+		bond->rxLost++;
+		bond->rxSeq++;
+	}
+	m77_bond_rx_deliver(bond);
 }
 
 
-
-/*****************************************************************************/
-/** central UART channel startup function, called upon each open to /dev/ttyDx
- *
- * \param port			\IN 	Oxford 16C954 Port Struct
+/*******************************************************************/
+/** sort a received frame into the reorder window, called in ISR
  *
- * \return 				0 or error code
+ * \param bond		\IN  bonded tty, rxLock held
+ * \param mem		\IN  member which received the frame
  *
- * \brief	Wakes up and initialize UART. Gets called whenever a process opens
- *          /dev/ttyDx. When passed at module load time the ACR is set such
- *          that for M077
+ * \brief A frame is delivered when all frames before it arrived. If one
+ *        is missing, e.g. because its member was lost, it is skipped
+ *        after bondGapMs or when the window is full.
  *
+ * \return 			-
  */
-static int men_uart_startup(struct uart_port *port)
+static void m77_bond_rx_frame(struct m77_bond *bond,
+							  struct m77_bond_member *mem)
 {
-	struct ox16c954_port *up = (struct ox16c954_port *)port;
-	unsigned long flags;
-	unsigned char lsr, iir;
-
-	up->capabilities = uart_config[up->port.type].flags;
-	up->mcr = 0;
-
-	serial_out(up, 	UART_IER, 	0);
-	serial_out(up, 	UART_LCR, 	0);
-	serial_icr_write(up, UART_CSR, 	0); /* Reset the UART */
-
-	/* Set Enhanced Mode */
-	serial_efr_write(up, UART_EFR, UART_EFR_ECB);
+	unsigned short seq = mem->hdr[1] | (mem->hdr[2] << 8);
+	unsigned short d;
+	struct m77_bond_slot *slot;
+	unsigned int i;
 
-	up->acr = up->acrShadow;
-	M77DBG3("%s: up=%p up->type=0x%x up->m77Mode=0x%x up->acr=0x%02x\n", 
-			__FUNCTION__, up, up->type, up->m77Mode, up->acr);
-	
-	if ( up->type == MOD_M77 && \
-		 ((up->m77Mode == M77_RS485_HD) || (up->m77Mode == M77_RS422_HD ))) {
-		M77DBG3("%s: up->acr = 0x%02x\n", __FUNCTION__, up->acr);		
-		up->acr |= 0x18;
-		serial_icr_write(up, UART_ACR, up->acr);
+	if (!bond->rxSync) {
+		bond->rxSeq		= seq;
+		bond->rxSync	= 1;
 	}
 
-	/* Clear FIFO buffers & disable them. Theyre reenabled in set_termios */
-	men_uart_clear_fifos(up);
+	d = seq - bond->rxSeq;
+	if (d >= 0x8000) {
+		/* behind the delivery point: duplicate or the sender restarted */
+		if (++bond->rxOld < BOND_WINDOW)
+			return;
+		for (i = 0; i < BOND_WINDOW; i++)
+			bond->slot[i].valid = 0;
+		bond->rxWaiting	= 0;
+		bond->rxSeq		= seq;
+		d = 0;
+	}
+	bond->rxOld = 0;
 
-	/* Clear the interrupt registers. */
-	(void) serial_in(up, UART_LSR);
-	(void) serial_in(up, UART_RX);
-	(void) serial_in(up, UART_IIR);
-	(void) serial_in(up, UART_MSR);
+	/* too far ahead, make room by giving up the oldest frames */
+	while (d >= BOND_WINDOW && bond->rxWaiting) {
+		m77_bond_rx_skip(bond);
+		d = seq - bond->rxSeq;
+	}
+	if (d >= BOND_WINDOW) {
+		bond->rxLost += d;
+		bond->rxSeq = seq;
+	}
 
-	/* Now, initialize the UART */
-	serial_out(up, UART_LCR, UART_LCR_WLEN8);
+	slot = &bond->slot[seq & (BOND_WINDOW - 1)];
+	if (slot->valid)
+		return;
+	memcpy(slot->data, mem->data, mem->hdr[3]);
+	slot->len	= mem->hdr[3];
+	slot->valid	= 1;
+	bond->rxWaiting++;
+
+	m77_bond_rx_deliver(bond);
+	if (bond->rxWaiting)
+		schedule_delayed_work(&bond->gapWork,
+							  msecs_to_jiffies(READ_ONCE(bondGapMs)));
+}
 
-	spin_lock_irqsave(&up->port.lock, flags);
 
-	up->port.mctrl |= TIOCM_OUT2;
-	men_uart_set_mctrl(&up->port, up->port.mctrl);
+/*******************************************************************/
+/** receive frames on a bond member, called within ISR
+ *
+ * \param up			\IN		Oxford 16C954 Port Struct, port lock held
+ * \param status		\IN		LSR Register Value
+ *
+ * \return 			-
+ */
+static inline void
+receive_chars_bond(struct ox16c954_port *up, unsigned int *status)
+{
+	struct m77_bond_member *mem = up->bondMem;
+	struct m77_bond *bond = mem->bond;
+	unsigned char ch, lsr = *status;
+	int max_count = 256, frames = 0;
 
-	/* quick test to see if we receive an IRQ when we enable the TX irq. */
-	serial_out(up, UART_IER, UART_IER_THRI);
-	lsr = serial_in(up, UART_LSR);
-	iir = serial_in(up, UART_IIR);
-	serial_out(up, UART_IER, 0);
+	spin_lock(&bond->rxLock);
+	do {
+		ch = serial_in(up, UART_RX);
+		m77_tap_char(up, M77_TAP_RX, ch, lsr);
+		up->port.icount.rx++;
 
-	if (lsr & UART_LSR_TEMT && iir & UART_IIR_NO_INT) {
-		if (!(up->bugs & UART_BUG_TXEN)) {
-			up->bugs |= UART_BUG_TXEN;
-			pr_debug("ttyS%d - enabling bad tx status workarounds\n",
-				 port->line);
+		if (unlikely(lsr & (UART_LSR_BI | UART_LSR_PE |
+							UART_LSR_FE | UART_LSR_OE))) {
+			m77_count_lsr_errors(up, lsr);
+			/* the frame is broken, look for the next one */
+			if (mem->pos)
+				mem->bad++;
+			mem->pos = 0;
+			if (lsr & (UART_LSR_BI | UART_LSR_PE | UART_LSR_FE))
+				goto ignore_char;
 		}
-	} else {
-		up->bugs &= ~UART_BUG_TXEN;
-	}
-
-	spin_unlock_irqrestore(&up->port.lock, flags);
 
-	/*
-	 * Finally, enable interrupts.  Note: Modem status interrupts
-	 * are set via set_termios(), which will be occurring imminently
-	 * anyway, so we don't enable them here.
-	 */
-	up->ier = UART_IER_RLSI | UART_IER_RDI;
-	serial_out(up, UART_IER, up->ier);
+		if (m77_bond_rx_byte(mem, ch)) {
+			m77_bond_rx_frame(bond, mem);
+			frames++;
+		}
 
-	/*
-	 * And clear the interrupt registers again for luck.
-	 */
-	(void) serial_in(up, UART_LSR);
-	(void) serial_in(up, UART_RX);
-	(void) serial_in(up, UART_IIR);
-	(void) serial_in(up, UART_MSR);
+	ignore_char:
+		lsr = serial_in(up, UART_LSR);
+	} while ((lsr & UART_LSR_DR) && (max_count-- > 0));
+	spin_unlock(&bond->rxLock);
+	m77_tap_flush(up, M77_TAP_RX);
 
-	return 0;
+	if (frames)
+		tty_flip_buffer_push(&bond->port);
+	*status = lsr;
 }
 
+/*******************************************************************/
+/** RX of a network interface line: leave the FIFO to the NAPI poll,
+ *  called within ISR
+ *
+ * \param up			\IN		Oxford 16C954 Port Struct, port lock held
+ *
+ * \return 			-
+ */
+static inline void m77_net_rx_irq(struct ox16c954_port *up)
+{
+	if (up->hot->ier & UART_IER_RDI) {
+		up->hot->ier &= ~(UART_IER_RLSI | UART_IER_RDI);
+		serial_out(up, UART_IER, up->hot->ier);
+	}
+	napi_schedule(&up->net->napi);
+}
 
-/******************************************************************************/
-/** central UART shutdown function, called upon funal close of port /dev/ttyDx
+/*******************************************************************/
+/** receive chars for the serdev consumer, called within ISR
  *
- * \param port			\IN 	Oxford 16C954 Port Struct
+ * \param up			\IN		Oxford 16C954 Port Struct, port lock held
+ * \param status		\IN		LSR Register Value
  *
- * \return 				0 or error code
+ * \brief The chars go to a ring passed on by m77_serdev_rx_work(), no
+ *        tty flip buffers or line discipline are involved. serdev has no
+ *        error flags, chars with break/parity/framing errors are dropped.
+ *
+ * \return 			-
  */
-static void men_uart_shutdown(struct uart_port *port)
+static inline void
+receive_chars_serdev(struct ox16c954_port *up, unsigned int *status)
 {
+	struct m77_serdev *sd = up->serdev;
+	unsigned int head = sd->rxHead;
+	unsigned int tail = smp_load_acquire(&sd->rxTail);
+	unsigned char ch, lsr = *status;
+	int max_count = 256;
 
-	struct ox16c954_port *up = (struct ox16c954_port *)port;
-	unsigned long flags;
+	do {
+		ch = serial_in(up, UART_RX);
+		m77_tap_char(up, M77_TAP_RX, ch, lsr);
+		up->port.icount.rx++;
 
-	/*
-	 * Disable interrupts from this port
-	 */
-	up->ier = 0;
-	serial_out(up, UART_IER, 0);
+		if (unlikely(lsr & (UART_LSR_BI | UART_LSR_PE |
+							UART_LSR_FE | UART_LSR_OE))) {
+			m77_count_lsr_errors(up, lsr);
+			if (lsr & (UART_LSR_BI | UART_LSR_PE | UART_LSR_FE))
+				goto ignore_char;
+		}
 
-	spin_lock_irqsave(&up->port.lock, flags);
+		if (head - tail < SERDEV_RX_SIZE)
+			sd->rx[head++ & (SERDEV_RX_SIZE - 1)] = ch;
+		else
+			sd->rxDropped++;
 
-	
-	up->port.mctrl &= ~TIOCM_OUT2;
-	
-	men_uart_set_mctrl(&up->port, up->port.mctrl);
-	spin_unlock_irqrestore(&up->port.lock, flags);
+	ignore_char:
+		lsr = serial_in(up, UART_LSR);
+	} while ((lsr & UART_LSR_DR) && (max_count-- > 0));
+	m77_tap_flush(up, M77_TAP_RX);
 
-	/*
-	 * Disable break condition and FIFOs
-	 */
-	serial_out(up, UART_LCR, serial_in(up, UART_LCR) & ~UART_LCR_SBC);
-	men_uart_clear_fifos(up);
+	if (head != sd->rxHead) {
+		smp_store_release(&sd->rxHead, head);
+		schedule_work(&sd->rxWork);
+	}
+	*status = lsr;
+}
 
+/*******************************************************************/
+/** check the chars of the loopback self-test, called within ISR
+ *
+ * \param up			\IN		Oxford 16C954 Port Struct, port lock held
+ * \param st			\IN		self-test running on the port
+ * \param status		\INOUT	LSR Register value
+ *
+ * \brief A wrong char is counted and the checker continues in step with
+ *        the sender. Two wrong chars in a row mean chars were lost, the
+ *        checker then takes its state from the last two chars received.
+ *
+ * \return 			-
+ */
+static inline void
+receive_chars_selftest(struct ox16c954_port *up, struct m77_selftest *st,
+					   unsigned int *status)
+{
+	unsigned char ch, lsr = *status;
+	int max_count = 256;
 
-	/*
-	 * Read data port to reset things
-	 */
-	(void) serial_in(up, UART_RX);
+	do {
+		ch = serial_in(up, UART_RX);
+		up->port.icount.rx++;
+		if (unlikely(lsr & (UART_LSR_BI | UART_LSR_PE |
+							UART_LSR_FE | UART_LSR_OE)))
+			m77_count_lsr_errors(up, lsr);
+
+		if (ch != m77_prbs_next(&st->rxPrbs)) {
+			st->errors++;
+			if (++st->rxBad >= 2) {
+				st->rxPrbs	= ((st->rxLast << 8) | ch) & 0x7fff;
+				st->rxBad	= 0;
+			}
+		} else
+			st->rxBad = 0;
+		st->rxLast = ch;
+		st->rxBytes++;
 
+		lsr = serial_in(up, UART_LSR);
+	} while ((lsr & UART_LSR_DR) && (max_count-- > 0));
 
+	st->lastNs = ktime_get_ns();
+	if (st->rxBytes >= st->total)
+		wake_up(&st->wait);
+	*status = lsr;
 }
 
-
-/******************************************************************************/
-/** Calculate Baudrate Divisor
+/*******************************************************************/
+/** append one record to the /dev/m77mux ring, called in ISR
  *
- * \param port			\IN 	Oxford 16C954 Port Struct
- * \param baud			\IN 	Baudrate Value, 300-1152000
+ * \param line		\IN  ttyD line
+ * \param flags		\IN  M77_MUX_xxx error flags
+ * \param data		\IN  received bytes
+ * \param len		\IN  nr. of bytes, max. M77_MUX_MAX_PAYLOAD
  *
- * \return 				Divisor with respect to Clock 18,432 MHz
+ * \return 			-
  */
-static unsigned int men_uart_get_divisor(struct uart_port *port, 
-										 unsigned int baud)
+static void m77_mux_put(unsigned int line, unsigned short flags,
+						const unsigned char *data, unsigned int len)
 {
-	/* No magic handling needed for M Modules, Clock is always 18,432 MHz */
-	return uart_get_divisor(port, baud);
+	static const unsigned char pad[M77_MUX_ALIGN];
+	struct m77_mux_rec rec;
+	unsigned int need = M77_MUX_REC_SIZE(len);
+
+	spin_lock(&G_mux.lock);
+	if (!G_mux.buf)
+		goto out;
+
+	if (MUX_RING_SIZE - (G_mux.head - G_mux.tail) < need) {
+		G_mux.lost = 1;		/* flagged in the next record */
+		goto out;
+	}
+
+	rec.timestamp	= ktime_get_ns();
+	rec.line		= line;
+	rec.flags		= flags | (G_mux.lost ? M77_MUX_LOST : 0);
+	rec.len			= len;
+	G_mux.lost		= 0;
+
+	m77_mux_copy(G_mux.head, &rec, sizeof(rec), 1);
+	m77_mux_copy(G_mux.head + sizeof(rec), (void *)data, len, 1);
+	m77_mux_copy(G_mux.head + sizeof(rec) + len, (void *)pad,
+				 need - sizeof(rec) - len, 1);
+	G_mux.head += need;
+
+	spin_unlock(&G_mux.lock);
+	wake_up_interruptible(&G_mux.wait);
+	return;
+ out:
+	spin_unlock(&G_mux.lock);
+}
+
+
+/*******************************************************************/
+/** receive chars of a line subscribed to /dev/m77mux, called in ISR
+ *
+ * \param up			\IN		Oxford 16C954 Port Struct, up->muxOn set
+ * \param status		\INOUT	LSR Register value
+ *
+ * \brief One record per drain. Break characters are dropped, the
+ *        error conditions of the drained chars are ORed into the flags.
+ *        The chars are collected in up->muxBuf, the port lock keeps it
+ *        private to this drain.
+ *
+ * \return 			-
+ */
+static inline void
+receive_chars_mux(struct ox16c954_port *up, unsigned int *status)
+{
+	unsigned char *buf = up->muxBuf;
+	unsigned char ch, lsr = *status;
+	unsigned short flags = 0;
+	unsigned int len = 0;
+
+	do {
+		ch = serial_in(up, UART_RX);
+		m77_tap_char(up, M77_TAP_RX, ch, lsr);
+		up->port.icount.rx++;
+
+		if (unlikely(lsr & (UART_LSR_BI | UART_LSR_PE |
+							UART_LSR_FE | UART_LSR_OE))) {
+			m77_count_lsr_errors(up, lsr);
+			flags |= m77_lsr_flags(lsr);
+			if (lsr & UART_LSR_BI)
+				goto ignore_char;
+		}
+		buf[len++] = ch;
+
+	ignore_char:
+		lsr = serial_in(up, UART_LSR);
+	} while ((lsr & UART_LSR_DR) && len < sizeof(up->muxBuf));
+	m77_tap_flush(up, M77_TAP_RX);
+
+	if (len || flags)
+		m77_mux_put(up->port.line, flags, buf, len);
+	*status = lsr;
+}
+
+/*******************************************************************/
+/** end a flow control stall of a port, port lock held
+ *
+ * \param at		\INOUT	ktime_get_ns() the stall began, 0: none
+ * \param ns		\INOUT	sum of the ended stalls
+ *
+ * \return 			-
+ */
+static inline void m77_stall_end(u64 *at, u64 *ns)
+{
+	if (*at) {
+		*ns += ktime_get_ns() - *at;
+		*at = 0;
+	}
+}
+
+/*******************************************************************/
+/** check_modem_status Bits
+ *
+ * \param up			\IN Oxford 16C954 Port Struct
+ *
+ * \return 			-
+ */
+static inline void check_modem_status(struct ox16c954_port *up)
+{
+	int status;
+
+	status = serial_in(up, UART_MSR);
+
+	if ((status & UART_MSR_ANY_DELTA) == 0)
+		return;
+
+	if (status & UART_MSR_TERI)
+		up->port.icount.rng++;
+	if (status & UART_MSR_DDSR)
+		up->port.icount.dsr++;
+	if (status & UART_MSR_DDCD)
+		uart_handle_dcd_change(&up->port, status & UART_MSR_DCD);
+	if (status & UART_MSR_DCTS) {
+		if (!(status & UART_MSR_CTS) && up->ctsFlow) {
+			if (!up->txStallAt)
+				up->txStallAt = ktime_get_ns();
+		} else
+			m77_stall_end(&up->txStallAt, &up->txStallNs);
+		uart_handle_cts_change(&up->port, status & UART_MSR_CTS);
+	}
+
+	wake_up_interruptible(&up->port.state->port.delta_msr_wait);
+}
+
+
+/*******************************************************************/
+/** histograms of a port, nothing but a patched jump if disabled
+ *
+ * \param up		\IN Oxford 16C954 Port Struct
+ *
+ * \return 			per CPU histograms or NULL
+ */
+static inline struct m77_hist __percpu *m77_hist_of(struct ox16c954_port *up)
+{
+	if (!static_branch_unlikely(&m77_hist_key))
+		return NULL;
+	return up->hist;
+}
+
+/*******************************************************************/
+/** bin of a power of 2 histogram: 0 for 0, n for 2^(n-1) ... 2^n - 1
+ */
+static inline unsigned int m77_hist_log(u64 val)
+{
+	return min_t(unsigned int, fls64(val), HIST_LOG_BINS - 1);
+}
+
+/*******************************************************************/
+/** bin of a FIFO level histogram, 8 chars per bin
+ */
+static inline unsigned int m77_hist_fifo(unsigned int chars)
+{
+	return min_t(unsigned int, chars >> 3, HIST_FIFO_BINS - 1);
+}
+
+/*******************************************************************/
+/** add one service of a port to its histograms, within ISR
+ *
+ * \param hist		\IN per CPU histograms of the port
+ * \param rx		\IN chars received
+ * \param tx		\IN chars written to the TX FIFO
+ * \param lsr		\IN LSR value the TX refill was done on
+ * \param t0		\IN ktime_get_ns() at entry
+ * \param irqAt		\IN ktime_get_ns() the IR was asserted, 0: unknown
+ *
+ * \brief The chars per RX drain are the RX FIFO level (RFL) at the time
+ *        of the drain, plus chars arriving during it. The TX FIFO is
+ *        refilled on THRE, i.e. with TFL 0, so instead of TFL the chars
+ *        loaded are counted and, separately, the refills that found the
+ *        transmitter empty (TEMT), where the line went idle. Reading the
+ *        RFL/TFL registers would cost a bus cycle each and needs ACR[7],
+ *        which hides the LCR the EFR access relies on.
+ *
+ * \return 			-
+ */
+static inline void m77_hist_port(struct m77_hist __percpu *hist,
+								 unsigned int rx, unsigned int tx,
+								 unsigned int lsr, u64 t0, u64 irqAt)
+{
+	u64 now = ktime_get_ns();
+
+	if (rx)
+		__this_cpu_inc(hist->rxDrain[m77_hist_fifo(rx)]);
+	if (tx) {
+		__this_cpu_inc(hist->txLoad[m77_hist_fifo(tx)]);
+		if (lsr & UART_LSR_TEMT)
+			__this_cpu_inc(hist->txIdle);
+	}
+	__this_cpu_inc(hist->isrBytes[m77_hist_log(rx + tx)]);
+	__this_cpu_inc(hist->isrNs[m77_hist_log(now - t0)]);
+	if (irqAt && t0 > irqAt)
+		__this_cpu_inc(hist->irqNs[m77_hist_log(t0 - irqAt)]);
+}
+
+
+/*******************************************************************/
+/** RX FIFO trigger level of the OX16C954
+ *
+ * \param fcr		\IN FCR written, 0: FIFOs off
+ * \param efr		\IN EFR written, ECB selects the 650 levels
+ *
+ * \return 			trigger level in chars
+ */
+static unsigned int m77_rx_trigger(unsigned int fcr, unsigned int efr)
+{
+	static const unsigned char lvl550[4] = { 1, 4, 8, 14 };
+	static const unsigned char lvl650[4] = { 16, 32, 112, 120 };
+
+	if (!(fcr & UART_FCR_ENABLE_FIFO))
+		return 1;
+	if (efr & UART_EFR_ECB)
+		return lvl650[(fcr >> 6) & 3];
+	return lvl550[(fcr >> 6) & 3];
+}
+
+/*******************************************************************/
+/** receive path of a port, in the order men_uart_handle_port() checks
+ *
+ * \param up		\IN Oxford 16C954 Port Struct, port lock held
+ * \param st		\IN self-test running on the port or NULL
+ *
+ * \return 			M77_RXM_xxx
+ */
+static unsigned int m77_rx_mode(struct ox16c954_port *up,
+								struct m77_selftest *st)
+{
+	if (st)
+		return M77_RXM_SELFTEST;
+	if (up->net)
+		return M77_RXM_NET;
+	if (up->serdev)
+		return M77_RXM_SERDEV;
+	if (up->raw)
+		return M77_RXM_RAW;
+	if (up->muxOn)
+		return M77_RXM_MUX;
+	if (up->bridge)
+		return M77_RXM_BRIDGE;
+	if (up->bondMem)
+		return M77_RXM_BOND;
+	if (up->bpf)
+		return M77_RXM_BPF;
+	return M77_RXM_TTY;
+}
+
+/*******************************************************************/
+/** record the context of a service that saw an RX overrun, within ISR
+ *
+ * \param up		\IN Oxford 16C954 Port Struct, port lock held
+ * \param st		\IN self-test running on the port or NULL
+ * \param t0		\IN ktime_get_ns() at entry of the service
+ * \param prevNs	\IN up->svcNs before this service, 0: unknown
+ * \param prevSeq	\IN up->svcSeq before this service
+ * \param lsr		\IN LSR at entry
+ * \param rx		\IN chars drained
+ *
+ * \brief Keeps the last OVR_RECS records. The channels serviced in
+ *        between are those whose svcSeq is newer than the previous
+ *        service of this port; a long time since the last service with
+ *        few others points to interrupt latency, a short one to a low
+ *        trigger level or baudrate setting. svcSeq counts per M-Module:
+ *        other M-Modules and devices sharing the IRQ are not in others
+ *        and otherMask, their services only show in sinceNs. A global
+ *        counter would be another cache line shared by all CPUs taking
+ *        M-Module interrupts.
+ *
+ * \return 			-
+ */
+static noinline void m77_ovr_add(struct ox16c954_port *up,
+								 struct m77_selftest *st, u64 t0,
+								 u64 prevNs, unsigned int prevSeq,
+								 unsigned int lsr, unsigned int rx)
+{
+	struct m77_ovr_rec *rec = &up->ovr[up->ovrCnt++ & (OVR_RECS - 1)];
+	UARTMOD_INFO *mod = up->mod;
+	unsigned int i;
+
+	rec->ns			= t0;
+	rec->sinceNs	= prevNs ? t0 - prevNs : 0;
+	rec->others		= prevNs ? up->svcSeq - prevSeq - 1 : 0;
+	rec->baud		= up->quot ? up->port.uartclk / (16 * up->quot) : 0;
+	rec->rx			= min_t(unsigned int, rx, USHRT_MAX);
+	rec->mode		= m77_rx_mode(up, st);
+	rec->trig		= m77_rx_trigger(up->fcr, up->efr);
+	rec->lsr		= lsr;
+	rec->otherMask	= 0;
+	for (i = 0; prevNs && i < mod->nrChannels; i++)
+		if (&mod->ports[i] != up &&
+			(int)(READ_ONCE(mod->ports[i].svcSeq) - prevSeq) > 0)
+			rec->otherMask |= 1 << i;
+}
+
+
+/*******************************************************************/
+/** add the chars counted since the last call to rxBytes and txBytes
+ *
+ * \param up		\IN 	Oxford 16C954 Port Struct, port lock held
+ *
+ * \brief icount.rx and tx are 32 bit and wrap after 4 GiB. Each service
+ *        of the port folds them, so the 64 bit sums stay exact as long
+ *        as less than 4 GiB pass between two interrupts.
+ *
+ * \return 			-
+ */
+static inline void m77_bytes_fold(struct ox16c954_port *up)
+{
+	up->rxBytes	+= (__u32)(up->port.icount.rx - up->rxFold);
+	up->rxFold	 = up->port.icount.rx;
+	up->txBytes	+= (__u32)(up->port.icount.tx - up->txFold);
+	up->txFold	 = up->port.icount.tx;
+}
+
+
+/*******************************************************************/
+/** handles the interrupt from one port, within ISR
+ *
+ * \param up		\IN 	Oxford 16C954 Port Struct
+ * \param regs		\IN 	passed from ISR but unused
+ * \param iir		\IN 	IIR value read by the ISR
+ * \param irqAt		\IN 	time the IR was asserted, 0: unknown
+ *
+ * \return 			-
+ */
+static inline void men_uart_handle_port(struct ox16c954_port *up, 
+										struct pt_regs *regs,
+										unsigned int iir, u64 irqAt)
+{
+	struct m77_selftest *st = m77_selftest_of(up);
+	struct m77_hist __percpu *hist = m77_hist_of(up);
+	bool track = static_branch_likely(&m77_ovr_key);
+	u64 t0 = (track || hist || unlikely(st)) ? ktime_get_ns() : 0;
+	u64 prevNs = 0;
+	__u32 rx0 = up->port.icount.rx, tx0 = up->port.icount.tx;
+	__u32 ovr0 = up->port.icount.overrun;
+	unsigned int rx, tx, prevSeq = 0;
+	unsigned int status = serial_in(up, UART_LSR), lsr0 = status;
+
+	DEBUG_INTR("status = %x...", status);
+
+	if (status & UART_LSR_DR) {
+		m77_mmio_op(M77_MMIO_RX);
+		if (unlikely(st))
+			receive_chars_selftest(up, st, &status);
+		else if (up->net)
+			m77_net_rx_irq(up);
+		else if (up->serdev)
+			receive_chars_serdev(up, &status);
+		else if (up->raw)
+			receive_chars_raw(up, &status);
+		else if (up->muxOn)
+			receive_chars_mux(up, &status);
+		else if (up->bridge)
+			receive_chars_bridge(up, &status);
+		else if (up->bondMem)
+			receive_chars_bond(up, &status);
+		else if (up->bpf)
+			receive_chars_bpf(up, &status);
+		else
+			receive_chars(up, &status, regs);
+		m77_mmio_op(M77_MMIO_IIR);
+	}
+
+	check_modem_status(up);
+
+	if (status & UART_LSR_THRE) {
+		m77_mmio_op(M77_MMIO_TX);
+		transmit_chars(up);
+		m77_mmio_op(M77_MMIO_IIR);
+	}
+
+	rx = up->port.icount.rx - rx0;
+	tx = up->port.icount.tx - tx0;
+	up->irqs++;
+	m77_bytes_fold(up);
+	if (rx > up->rxHigh)
+		up->rxHigh = rx;
+	if (tx > up->txHigh)
+		up->txHigh = tx;
+
+	if (track) {
+		prevNs		= up->svcNs;
+		prevSeq		= up->svcSeq;
+		up->svcNs	= t0;
+		up->svcSeq	= ++up->mod->svcSeq;
+	}
+	/* always recorded, an overrun is rare enough to read the clock */
+	if (unlikely((lsr0 & UART_LSR_OE) || up->port.icount.overrun != ovr0))
+		m77_ovr_add(up, st, t0 ? t0 : ktime_get_ns(), prevNs, prevSeq,
+					lsr0, rx);
+
+	if (unlikely(st)) {
+		st->isrNs += ktime_get_ns() - t0;
+		st->isrCalls++;
+	}
+	if (unlikely(hist))
+		m77_hist_port(hist, rx, tx, status, t0, irqAt);
+	trace_m77_chan(up->port.line, iir, status, rx, tx);
+}
+
+
+
+/*******************************************************************/
+/** Mask or unmask the interrupt of a user mode M-Module
+ *
+ * \param mmod		\IN  M-Module in user mode
+ * \param on		\IN  0: mask, else unmask
+ *
+ * \return 			-
+ */
+static void m77_uio_irq_mask(UARTMOD_INFO *mmod, int on)
+{
+	unsigned int ir = on ? M77_IR_IMASK : 0;
+
+	/* keep the galvanic isolated drivers of the M77 switched on */
+	if (mmod->modtype == MOD_M77)
+		ir |= M77_IR_DRVEN;
+
+	control_out(mmod, M77_REG_IR, ir);
+	if (mmod->modtype == MOD_M45)
+		control_out(mmod, M45_REG_IR2, ir);
+}
+
+/*******************************************************************/
+/** handle the interrupt of a user mode M-Module, called in ISR
+ *
+ * \param mmod		\IN  M-Module in user mode
+ * \param uio		\IN  its uio_info
+ *
+ * \brief The UARTs are not touched. The M-Module interrupt is masked
+ *        and user space is woken up, it serves the UARTs and unmasks
+ *        the interrupt again by writing 1 to /dev/uio<n>.
+ *
+ * \return 			LL_IRQ_DEVICE or LL_IRQ_DEV_NOT
+ */
+static unsigned int m77_uio_irq(UARTMOD_INFO *mmod, struct uio_info *uio)
+{
+	unsigned char ir, ir2 = 0;
+
+	ir = MREAD_D16(mmod->memBase, M77_REG_IR) & 0x00ff;
+	if (mmod->modtype == MOD_M45)
+		ir2 = MREAD_D16(mmod->memBase, M45_REG_IR2) & 0x00ff;
+
+	if (!((ir | ir2) & M77_IR_IRQ))
+		return LL_IRQ_DEV_NOT;
+
+	/* clear the pending bit with IMASK cleared: stays quiet until unmask */
+	control_out(mmod, M77_REG_IR, ir & ~M77_IR_IMASK);
+	if (mmod->modtype == MOD_M45)
+		control_out(mmod, M45_REG_IR2, ir2 & ~M77_IR_IMASK);
+
+	uio_event_notify(uio);
+	return LL_IRQ_DEVICE;
+}
+
+/*****************************************************************************/
+/** handles the interrupt from one M-Module
+ *
+ * \param data		\IN 	void Parameter from MDIS Irq handler
+ *
+ * \brief The original 8250.c UART interrupt handler is now Registered via
+ * mdis_install_external_irq(). Its taylored to match the Requirements
+ * of serving the M45N/M69N/M77 Interrupts only. No calls to request_irq() are
+ * done within this driver.
+ * \return 			-
+ */
+static int M77_IrqHandler(void *data)
+{
+
+ 	UARTMOD_INFO *mmod 			= data;
+	struct pt_regs *regs = NULL;
+	unsigned int i;
+	struct ox16c954_port *up;
+	struct m77_chan_hot *hot;
+	unsigned int iir;
+	unsigned char cpld_ir_reg;
+	unsigned int retcode 		= LL_IRQ_DEV_NOT;
+	struct list_head  *pos		= NULL;
+	struct uio_info *uio;
+	unsigned int mmioOp			= m77_mmio_op(M77_MMIO_IIR);
+	u64 irqAt					= 0;
+
+	/* skip through the registered M-Modules List */
+    list_for_each( pos, &G_uartModListHead ) {
+
+		mmod = list_entry(pos, UARTMOD_INFO, head);
+		/* pairs with smp_store_release() in m77_uio_add() */
+		uio = smp_load_acquire(&mmod->uio);
+		if (uio) {
+			if (m77_uio_irq(mmod, uio) == LL_IRQ_DEVICE)
+				retcode = LL_IRQ_DEVICE;
+			continue;
+		}
+		/* pairs with smp_store_release() in m77_probe_module() */
+		if (!smp_load_acquire(&mmod->ready))
+			continue;	/* UARTs not registered yet */
+
+		if (static_branch_unlikely(&m77_hist_key))
+			irqAt = M77_IRQ_ASSERT_NS(mmod);
+
+		cpld_ir_reg = control_in( mmod, M77_REG_IR );
+		trace_m77_irq_entry(mmod->modnum, 0, cpld_ir_reg);
+
+		if ( cpld_ir_reg & 0x1 ) {
+			for (i = 0, hot = mmod->hot; i < mmod->nrChannels; i++, hot++) {
+				iir = MREAD_D16(hot->membase, UART_IIR << 1) & 0x00ff;
+				M77_MMIO_CNT(&mmod->ports[i].mmio, rd);
+				if ( !(iir & UART_IIR_NO_INT) ) {
+					up = &mmod->ports[i];
+					spin_lock(&up->port.lock);
+					DEBUG_INTR("ISR: UART%d\n", i);
+					men_uart_handle_port(up, regs, iir, irqAt);
+					spin_unlock(&up->port.lock);
+				}
+			}
+			/* clear Interrupt */
+			control_out( mmod, M77_REG_IR,	cpld_ir_reg);
+			retcode = LL_IRQ_DEVICE;
+		}
+		trace_m77_irq_exit(mmod->modnum, 0, cpld_ir_reg);
+
+		/* If its an M45N check the second IR Register at 0xC8 too */
+		if (mmod->modtype == MOD_M45) {
+
+			cpld_ir_reg = control_in(mmod, M45_REG_IR2 );
+			trace_m77_irq_entry(mmod->modnum, 1, cpld_ir_reg);
+
+			if ( cpld_ir_reg & 0x1 ) {
+				for (i = 0, hot = mmod->hot; i < mmod->nrChannels; 
+					 i++, hot++) { 
+					/* optimal:check 4-7 only */
+					iir = MREAD_D16(hot->membase, UART_IIR << 1) & 0x00ff;
+					M77_MMIO_CNT(&mmod->ports[i].mmio, rd);
+					if ( !(iir & UART_IIR_NO_INT) ) {
+						up = &mmod->ports[i];
+						spin_lock(&up->port.lock);
+						men_uart_handle_port(up, regs, iir, irqAt);
+						spin_unlock(&up->port.lock);
+					}
+				}
+				/* clear Interrupt */
+				control_out( mmod, M45_REG_IR2, cpld_ir_reg);
+			}
+			trace_m77_irq_exit(mmod->modnum, 1, cpld_ir_reg);
+		}
+	}
+	m77_mmio_op(mmioOp);
+	return(retcode);
+}
+
+
+/*******************************************************************/
+/** check if UART transmit Register is empty
+ *
+ * \param port		\IN highlevel uart_port Struct (as in serial_core)
+ *
+ * \return 			TIOCSER_TEMT if empty or 0
+ */
+static unsigned int men_uart_tx_empty(struct uart_port *port)
+{
+
+	unsigned long flags;
+	unsigned int ret;
+	struct ox16c954_port *up;
+
+	up = (struct ox16c954_port *)port;
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	ret = serial_in(up, UART_LSR) & UART_LSR_TEMT ? TIOCSER_TEMT : 0;
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	return ret;
+}
+
+
+/******************************************************************************/
+/** return Modem Control Register and return as TIO* Values, for ioctl call
+ *
+ * \param port		\IN 	Oxford 16C954 Port Struct
+ *
+ * \return 			encoded MSR Bits
+ */
+static unsigned int men_uart_get_mctrl(struct uart_port *port)
+{
+	unsigned char status;
+	unsigned int ret;
+	struct ox16c954_port *up = (struct ox16c954_port *)port;
+	status = serial_in(up, UART_MSR);
+
+	ret = 0;
+	if (status & UART_MSR_DCD)
+		ret |= TIOCM_CAR;
+	if (status & UART_MSR_RI)
+		ret |= TIOCM_RNG;
+	if (status & UART_MSR_DSR)
+		ret |= TIOCM_DSR;
+	if (status & UART_MSR_CTS)
+		ret |= TIOCM_CTS;
+	return ret;
+}
+
+
+
+/******************************************************************************/
+/** set Modem Control Register, called from core ioctl function
+ *
+ * \param port		\IN 	Oxford 16C954 Port Struct
+ * \param mctrl		\IN 	MSR Bits to set
+ *
+ * \return 			-
+ */
+static void men_uart_set_mctrl(struct uart_port *port, unsigned int mctrl)
+{
+	struct ox16c954_port *up = (struct ox16c954_port *)port;
+	unsigned char mcr = 0;
+
+	if (mctrl & TIOCM_RTS)
+		mcr |= UART_MCR_RTS;
+
+	if (mctrl & TIOCM_DTR)
+		mcr |= UART_MCR_DTR;
+
+	if (mctrl & TIOCM_OUT1)
+		mcr |= UART_MCR_OUT1;
+
+	if (mctrl & TIOCM_OUT2)
+		mcr |= UART_MCR_OUT2;
+
+	if (mctrl & TIOCM_LOOP)
+		mcr |= UART_MCR_LOOP;
+
+	mcr = (mcr & up->mcr_mask) | up->mcr_force | up->hot->mcr;
+
+	serial_out(up, UART_MCR, mcr);
+}
+
+
+/******************************************************************************/
+/** set Set break control 
+ *
+ * \param port			\IN 	Oxford 16C954 Port Struct
+ * \param break_state	\IN     state to set, -1: set break, != -1:clear
+ *
+ * \return 			-
+ */
+static void men_uart_break_ctl(struct uart_port *port, int break_state)
+{
+	struct ox16c954_port *up = (struct ox16c954_port *)port;
+	unsigned long flags;
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	if (break_state == -1)
+		up->hot->lcr |= UART_LCR_SBC;
+	else
+		up->hot->lcr &= ~UART_LCR_SBC;
+	serial_out(up, UART_LCR, up->hot->lcr);
+	spin_unlock_irqrestore(&up->port.lock, flags);
+}
+
+
+
+/*****************************************************************************/
+/** central UART channel startup function, called upon each open to /dev/ttyDx
+ *
+ * \param port			\IN 	Oxford 16C954 Port Struct
+ *
+ * \return 				0 or -EBUSY if a serdev consumer has the UART
+ */
+static int men_uart_startup(struct uart_port *port)
+{
+	struct ox16c954_port *up = (struct ox16c954_port *)port;
+
+	if (test_and_set_bit(0, &up->inUse))
+		return -EBUSY;
+
+	men_uart_hw_startup(up);
+	return 0;
+}
+
+
+/*****************************************************************************/
+/** start the UART, for the ttyD or the serdev consumer
+ *
+ * \param up			\IN 	Oxford 16C954 Port Struct
+ *
+ * \return 				-
+ *
+ * \brief	Wakes up and initialize UART. Gets called whenever a process opens
+ *          /dev/ttyDx. When passed at module load time the ACR is set such
+ *          that for M077
+ *          If the UART still holds the configuration of the last
+ *          set_termios() call, only the settings changed by
+ *          men_uart_shutdown() are restored instead of resetting it.
+ *
+ */
+static void men_uart_hw_startup(struct ox16c954_port *up)
+{
+	unsigned long flags;
+	unsigned char lsr, iir, acr;
+	unsigned int mmioOp = m77_mmio_port_op(up, M77_MMIO_STARTUP);
+
+	up->capabilities = uart_config[up->port.type].flags;
+	up->hot->mcr = 0;
+
+	acr = up->acrShadow;
+	if ( up->type == MOD_M77 && \
+		 ((up->m77Mode == M77_RS485_HD) || (up->m77Mode == M77_RS422_HD )))
+		acr |= 0x18;
+
+	if (up->cfgValid) {
+		/*
+		 * Reopen: men_uart_shutdown() only cleared IER, OUT2, break and
+		 * the FIFOs. set_termios() follows and restores the FCR.
+		 */
+		M77DBG3("%s: reopen, acr=0x%02x\n", __FUNCTION__, acr);
+		if (acr != up->hot->acr) {
+			up->hot->acr = acr;
+			serial_icr_write(up, UART_ACR, up->hot->acr);
+		}
+		goto enable;
+	}
+
+	serial_out(up, 	UART_IER, 	0);
+	serial_out(up, 	UART_LCR, 	0);
+	serial_icr_write(up, UART_CSR, 	0); /* Reset the UART */
+	up->xonSet = 0;
+
+	/* Set Enhanced Mode */
+	serial_efr_write(up, UART_EFR, UART_EFR_ECB);
+
+	up->hot->acr = up->acrShadow;
+	M77DBG3("%s: up=%p up->type=0x%x up->m77Mode=0x%x up->acr=0x%02x\n", 
+			__FUNCTION__, up, up->type, up->m77Mode, up->hot->acr);
+	
+	if (acr != up->hot->acr) {
+		M77DBG3("%s: up->acr = 0x%02x\n", __FUNCTION__, acr);		
+		up->hot->acr = acr;
+		serial_icr_write(up, UART_ACR, up->hot->acr);
+	}
+
+	/* Clear FIFO buffers & disable them. Theyre reenabled in set_termios */
+	men_uart_clear_fifos(up);
+
+	/* Clear the interrupt registers. */
+	(void) serial_in(up, UART_LSR);
+	(void) serial_in(up, UART_RX);
+	(void) serial_in(up, UART_IIR);
+	(void) serial_in(up, UART_MSR);
+
+	/* Now, initialize the UART */
+	up->hot->lcr = UART_LCR_WLEN8;
+	serial_out(up, UART_LCR, up->hot->lcr);
+
+ enable:
+	spin_lock_irqsave(&up->port.lock, flags);
+
+	up->port.mctrl |= TIOCM_OUT2;
+	men_uart_set_mctrl(&up->port, up->port.mctrl);
+	up->opened = 1;
+
+	/*
+	 * quick test to see if we receive an IRQ when we enable the TX irq.
+	 * The result only depends on the UART, so it is done once per port.
+	 */
+	if (!up->txenTested) {
+		serial_out(up, UART_IER, UART_IER_THRI);
+		lsr = serial_in(up, UART_LSR);
+		iir = serial_in(up, UART_IIR);
+		serial_out(up, UART_IER, 0);
+
+		if (lsr & UART_LSR_TEMT && iir & UART_IIR_NO_INT) {
+			if (!(up->bugs & UART_BUG_TXEN)) {
+				up->bugs |= UART_BUG_TXEN;
+				pr_debug("ttyS%d - enabling bad tx status workarounds\n",
+						 up->port.line);
+			}
+		} else {
+			up->bugs &= ~UART_BUG_TXEN;
+		}
+		up->txenTested = 1;
+	}
+
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	/*
+	 * Finally, enable interrupts.  Note: Modem status interrupts
+	 * are set via set_termios(), which will be occurring imminently
+	 * anyway, so we don't enable them here.
+	 */
+	up->hot->ier = UART_IER_RLSI | UART_IER_RDI;
+	serial_out(up, UART_IER, up->hot->ier);
+
+	/*
+	 * And clear the interrupt registers again for luck.
+	 */
+	(void) serial_in(up, UART_LSR);
+	(void) serial_in(up, UART_RX);
+	(void) serial_in(up, UART_IIR);
+	(void) serial_in(up, UART_MSR);
+	m77_mmio_port_op(up, mmioOp);
+}
+
+
+/******************************************************************************/
+/** central UART shutdown function, called upon funal close of port /dev/ttyDx
+ *
+ * \param port			\IN 	Oxford 16C954 Port Struct
+ *
+ * \return 				-
+ */
+static void men_uart_shutdown(struct uart_port *port)
+{
+	struct ox16c954_port *up = (struct ox16c954_port *)port;
+
+	m77_net_detach(up);
+	m77_bridge_shutdown(up);
+	m77_bpf_attach(up, -1);
+	men_uart_hw_shutdown(up);
+	clear_bit(0, &up->inUse);
+}
+
+
+/******************************************************************************/
+/** stop the UART, for the ttyD or the serdev consumer
+ *
+ * \param up			\IN 	Oxford 16C954 Port Struct
+ *
+ * \return 				-
+ */
+static void men_uart_hw_shutdown(struct ox16c954_port *up)
+{
+	unsigned long flags;
+	unsigned int mmioOp = m77_mmio_port_op(up, M77_MMIO_STARTUP);
+
+	/*
+	 * Disable interrupts from this port
+	 */
+	up->hot->ier = 0;
+	serial_out(up, UART_IER, 0);
+
+	spin_lock_irqsave(&up->port.lock, flags);
+
+	
+	up->port.mctrl &= ~TIOCM_OUT2;
+	
+	men_uart_set_mctrl(&up->port, up->port.mctrl);
+	up->opened = 0;
+
+	/* let a raw device user see POLLHUP */
+	if (up->raw)
+		wake_up_interruptible(&up->raw->wait);
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	/*
+	 * Disable break condition and FIFOs
+	 */
+	up->hot->lcr &= ~UART_LCR_SBC;
+	serial_out(up, UART_LCR, up->hot->lcr);
+	men_uart_clear_fifos(up);
+
+
+	/*
+	 * Read data port to reset things
+	 */
+	(void) serial_in(up, UART_RX);
+	m77_mmio_port_op(up, mmioOp);
+}
+
+
+/******************************************************************************/
+/** Calculate Baudrate Divisor
+ *
+ * \param port			\IN 	Oxford 16C954 Port Struct
+ * \param baud			\IN 	Baudrate Value, 300-1152000
+ *
+ * \return 				Divisor with respect to Clock 18,432 MHz
+ */
+static unsigned int men_uart_get_divisor(struct uart_port *port, 
+										 unsigned int baud)
+{
+	/* No magic handling needed for M Modules, Clock is always 18,432 MHz */
+	return uart_get_divisor(port, baud);
+}
+
+
+
+/******************************************************************************/
+/** function to set changed tty settings
+ *
+ * \param port			\IN 	highlevel UART Port Struct
+ * \param termios		\IN 	termios struct with new settings
+ * \param old			\IN 	termios struct to keep old settings(?)
+ *
+ * \brief this is the central link between higher tty layer and the UART 
+ *        Hardware to change all aspects of the Channel like Baudrate, data bit
+ *        settings etc. Its called everytime a property of the channel is 
+ *		  changed e.g. with stty.
+ *
+ * \return 				-
+ */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,1,0)
+static void men_uart_set_termios(struct uart_port *port,struct ktermios *termios, const struct ktermios *old)
+#else
+static void men_uart_set_termios(struct uart_port *port,struct ktermios *termios, struct ktermios *old)
+#endif
+{
+	unsigned char efr = 0;
+	struct ox16c954_port *up = (struct ox16c954_port *)port;
+	unsigned char cval, fcr = 0;
+	unsigned long flags;
+	unsigned int baud, quot;
+	unsigned int mmioOp = m77_mmio_port_op(up, M77_MMIO_TERMIOS);
+
+	M77DBG3("%s: c_iflag = 0x%04x c_cflag = 0x%04x  Settings:\n",
+			   __FUNCTION__, termios->c_iflag, termios->c_cflag );
+
+	/* 
+	 * Set Word Length: 5..8 bit 
+	 */
+	switch (termios->c_cflag & CSIZE) {
+	case CS5:
+		cval = UART_LCR_WLEN5;
+		M77DBG3(" - 5 Data Bits\n");
+		break;
+	case CS6:
+		cval = UART_LCR_WLEN6;
+		M77DBG3(" - 6 Data Bits\n");
+		break;
+	case CS7:
+		cval = UART_LCR_WLEN7;
+		M77DBG3(" - 7 Data Bits\n");
+		break;
+	default:
+	case CS8:
+		cval = UART_LCR_WLEN8;
+		M77DBG3(" - 8 Data Bits\n");
+		break;
+	}
+
+	/* 
+	 * Set 1 or 2 Stop Bits
+	 * Oxford Data Sheet states that its actually 1.5 Stopbits at 5 Databits,
+	 * 2 Bits at 6,7,8 Data bits
+	 */
+	if (termios->c_cflag & CSTOPB){
+		cval |= UART_LCR_STOP;
+		M77DBG3(" - 2 Stop Bits\n");
+	} else {
+		M77DBG3(" - 1 Stop Bit\n");
+	}
+
+
+	/* 
+	 * Set Parity (none/odd/even)
+	 */
+	if (termios->c_cflag & PARENB)
+		cval |= UART_LCR_PARITY;
+	if (!(termios->c_cflag & PARODD))
+		cval |= UART_LCR_EPAR;
+
+	/* Report the Parity setting according to LCR[5:3] Data Sheet */
+
+	if(!(cval & UART_LCR_PARITY)){
+		M77DBG3(" - No Parity\n");
+	} else {
+		if( ((cval & 0x38) >> 3) == 1 ) /* Mask Bits 5,4,3:  0x38=0011 1000 */
+			M77DBG3(" - Odd Parity\n");
+
+		if( ((cval & 0x38) >> 3) == 3 )
+			M77DBG3(" - Even Parity\n");
+
+		if( ((cval & 0x38) >> 3) == 5 )
+			M77DBG3(" - Parity forced 1\n");
+
+		if( ((cval & 0x38) >> 3) == 7 )
+			M77DBG3(" - Parity forced 0\n");
+	}
+
+	/*
+	 * Ask the core to calculate the divisor for us.
+	 */
+	baud = uart_get_baud_rate(port, termios, old, 0, port->uartclk/16); 
+	quot = men_uart_get_divisor(port, baud);
+	M77DBG3(" - Baudrate: %d (quot=%d)\n", baud, quot);
+
+	/*
+	 * Oxford Semi 952 rev B workaround
+	 */
+	if (up->bugs & UART_BUG_QUOT && (quot & 0xff) == 0)
+		quot ++;
+
+	if (up->capabilities & UART_CAP_FIFO && up->port.fifosize > 1) {
+		if (baud < 2400)
+			fcr = UART_FCR_ENABLE_FIFO | UART_FCR_TRIGGER_1;
+		else
+			fcr = uart_config[up->port.type].fcr;
+	}
+
+	/*
+	 * MCR-based auto flow control.  When AFE is enabled, RTS will be
+	 * deasserted when the receive FIFO contains more characters than
+	 * the trigger, or the MCR RTS bit is cleared.  In the case where
+	 * the remote UART is not using CTS auto flow control, we must
+	 * have sufficient FIFO entries for the latency of the remote
+	 * UART to respond.  IOW, at least 32 bytes of FIFO.
+	 */
+	if (up->capabilities & UART_CAP_AFE && up->port.fifosize >= 32) {
+		up->hot->mcr &= ~UART_MCR_AFE;
+		if (termios->c_cflag & CRTSCTS)
+			up->hot->mcr |= UART_MCR_AFE;
+	}
+
+	/* Ok, we're now changing the port state. Do it with interrupts disabled. */
+	spin_lock_irqsave(&up->port.lock, flags);
+
+	/* Update the per-port timeout. */
+	uart_update_timeout(port, termios->c_cflag, baud);
+
+	up->ctsFlow = !!(termios->c_cflag & CRTSCTS);
+	if (!up->ctsFlow)
+		m77_stall_end(&up->txStallAt, &up->txStallNs);
+
+	up->port.read_status_mask = UART_LSR_OE | UART_LSR_THRE | UART_LSR_DR;
+	if (termios->c_iflag & INPCK)
+		up->port.read_status_mask |= UART_LSR_FE | UART_LSR_PE;
+	if (termios->c_iflag & (BRKINT | PARMRK))
+		up->port.read_status_mask |= UART_LSR_BI;
+
+	/* Characteres to ignore */
+	up->port.ignore_status_mask = 0;
+	if (termios->c_iflag & IGNPAR)
+		up->port.ignore_status_mask |= UART_LSR_PE | UART_LSR_FE;
+	if (termios->c_iflag & IGNBRK) {
+		up->port.ignore_status_mask |= UART_LSR_BI;
+		/*
+		 * If we're ignoring parity and break indicators,
+		 * ignore overruns too (for real raw support).
+		 */
+		if (termios->c_iflag & IGNPAR)
+			up->port.ignore_status_mask |= UART_LSR_OE;
+	}
+
+	/* ignore all characters if CREAD is not set */
+	if ((termios->c_cflag & CREAD) == 0)
+		up->port.ignore_status_mask |= UART_LSR_DR;
+
+	/* CTS flow control flag and modem status interrupts */
+	up->hot->ier &= ~UART_IER_MSI;
+	if (!(up->bugs & UART_BUG_NOMSR) &&
+			UART_ENABLE_MS(&up->port, termios->c_cflag))
+		up->hot->ier |= UART_IER_MSI;
+	if (up->capabilities & UART_CAP_UUE)
+		up->hot->ier |= UART_IER_UUE | UART_IER_RTOIE;
+	serial_out(up, UART_IER, up->hot->ier);
+
+	if ( termios->c_cflag & CRTSCTS ) {
+		if ( up->type != MOD_M77 ) {
+
+			efr |= UART_EFR_CTS;
+			M77DBG3(" - HW Flow Control (RTS/CTS)\n");
+		} else {
+			/* Dont use RTS/CTS Handshake setting on M77! */
+			printk(KERN_INFO "*** Module is a M77 - ignoring Flag CRTSCTS\n");
+		}
+	}
+
+	/* Inband XON/XOFF Flow Control desired? */
+	if (termios->c_iflag & (IXON|IXOFF)) {
+		if (!up->cfgValid || !up->xonSet) {
+			serial_efr_write(up, M77_XON1_OFFSET, 	M77_XON_CHAR );
+			serial_efr_write(up, M77_XON2_OFFSET, 	M77_XON_CHAR );        
+			serial_efr_write(up, M77_XOFF1_OFFSET, 	M77_XOFF_CHAR );       
+			serial_efr_write(up, M77_XOFF2_OFFSET, 	M77_XOFF_CHAR );       
+			up->xonSet = 1;
+		}
+		M77DBG3(" - SW Flow Control IXON/IXOFF\n");
+		efr |= 0xa;  /* bits xxxx 1010 enable it*/
+	}
+
+	/* Apply to Register, only the UART state changed since last call */
+	if (!up->cfgValid || efr != up->efr) {
+		serial_efr_write(up, UART_EFR, efr );
+		up->efr = efr;
+	}
+
+	/*  Set Baudrate Divider. M45N/69N/77 uartclk is always 18,432 MHz */
+	if (!up->cfgValid || quot != up->quot || cval != up->hot->lcr ||
+		up->port.type == PORT_16750) {
+		serial_out(up, UART_LCR, cval | UART_LCR_DLAB);
+		serial_out(up, UART_DLL, quot & 0xff);			
+		serial_out(up, UART_DLM, quot >> 8);			
+
+		/*
+		 * LCR DLAB must be set to enable 64-byte FIFO mode. If the FCR
+		 * is written without DLAB set, this mode will be disabled.
+		 */
+		if (up->port.type == PORT_16750)
+			serial_out(up, UART_FCR, fcr);
+
+		serial_out(up, UART_LCR, cval);		/* reset DLAB */
+		up->quot = quot;
+	}
+
+	up->hot->lcr = cval;					    /* Save LCR */
+	if (up->port.type != PORT_16750 && fcr != up->fcr) {
+
+		if (fcr & UART_FCR_ENABLE_FIFO) {
+			/* emulated UARTs (Lucent Venus 167x) need two steps */
+			serial_out(up, UART_FCR, UART_FCR_ENABLE_FIFO);
+		}
+		serial_out(up, UART_FCR, fcr);		/* set fcr */
+	}
+	up->fcr = fcr;
+	up->cfgValid = 1;
+
+	men_uart_set_mctrl(&up->port, up->port.mctrl);
+	spin_unlock_irqrestore(&up->port.lock, flags);
+	m77_mmio_port_op(up, mmioOp);
+	trace_m77_set_termios(up->port.line, termios->c_cflag, termios->c_iflag,
+						  baud, quot, cval, fcr, efr);
+}
+
+
+static void
+men_uart_pm(struct uart_port *port, unsigned int state, unsigned int oldstate)
+{
+	/* No special Powermanagement for our M Modules */
+	do { } while (0);
+
+}
+
+
+static void men_uart_release_port(struct uart_port *port)
+{
+	/* Not necessary for M-Modules */
+}
+
+static int men_uart_request_port(struct uart_port *port)
+{
+	/* Not necessary for M-Modules */
+	return 0;
+}
+
+
+/******************************************************************************/
+/** highlevel UART Port config function
+ *
+ * \param port			\IN 	highlevel UART Port Struct
+ * \param flags			\IN 	optional flags to control probing
+ *
+ * \return 				-
+ */
+static void men_uart_config_port(struct uart_port *port, int flags)
+{
+	struct ox16c954_port *up = (struct ox16c954_port *)port;
+	int probeflags = ~0;
+
+	if (flags & UART_CONFIG_TYPE)
+		autoconfig(up, probeflags);
+
+}
+
+
+static int men_uart_verify_port(struct uart_port *port, 
+								struct serial_struct *ser)
+{
+	/* shouldnt hurt to report us to serial core as always existing */
+	return 0;
+}
+
+
+
+/*****************************************************************************/
+/** Function to register each 4 or 8 UART Channels of a M-Module at serial core
+ *
+ * \param port		\IN    highlevel UART Port Struct
+ * \param modtype	\IN    Module ID as in 13m07790.xml
+ * \param nrLine	\IN    Channel number on the M-Module
+ * \param uart		\IN    OX16C954 UART from the UARTMOD_INFO ports array,
+ *					       its line is already set by men_uart_init_ports()
+ *
+ * \return 				line number or negative error number
+ */
+int men_uart_register_port(struct uart_port *port, 
+						   unsigned int modtype,
+						   unsigned int nrLine, 
+						   struct ox16c954_port *uart )
+{
+	int ret;
+	
+	/* For M45N: helper for TCRbit-to-Channelnumber mapping */
+	unsigned int tcr[8] = {M45_TCR_TRISTATE0, M45_TCR_TRISTATE1, 
+						   M45_TCR_TRISTATE2, M45_TCR_TRISTATE2,
+						   M45_TCR_TRISTATE3, M45_TCR_TRISTATE3,
+						   M45_TCR_TRISTATE4, M45_TCR_TRISTATE4 };
+
+	if (port->uartclk == 0)
+		return -EINVAL;
+
+	mutex_lock(&uart->mod->lock);
+
+	{
+		uart->port.iobase   	= port->iobase;
+		uart->port.membase  	= port->membase;
+		uart->port.irq      	= port->irq;
+		uart->port.uartclk  	= port->uartclk;
+		uart->port.fifosize 	= port->fifosize;
+		uart->port.regshift 	= port->regshift;
+		uart->port.iotype   	= port->iotype;
+		uart->port.flags    	= port->flags;
+		uart->port.mapbase  	= port->mapbase;
+
+		/* for runtime-ioctl calls remember if we are a M45N, M69N or M77 */
+		uart->type				= modtype;
+
+		switch (uart->type) {
+		case MOD_M77:
+			uart->dcrReg = M77_DCR_REG_BASE + nrLine;
+			break;
+
+		case MOD_M45:
+			uart->tcrReg = (nrLine < 4) ? M45_TCR1_REG : M45_TCR2_REG;
+			uart->tcrBit = tcr[nrLine];	
+			break;
+		}
+
+#if 0
+		printk( KERN_INFO "men_uart_register_port:\n");
+		printk( KERN_INFO "uart->port.iobase   = 0x%08x\n",uart->port.iobase);
+		printk( KERN_INFO "uart->port.membase  = 0x%08x\n",uart->port.membase);
+		printk( KERN_INFO "uart->port.irq      = 0x%02x\n",uart->port.irq);
+		printk( KERN_INFO "uart->port.uartclk  = %ld\n",uart->port.uartclk);
+		printk( KERN_INFO "uart->port.fifosize = %d\n", uart->port.fifosize );
+		printk( KERN_INFO "uart->port.regshift = %d\n", uart->port.regshift );
+		printk( KERN_INFO "uart->port.iotype   = 0x%08x\n", uart->port.iotype);
+		printk( KERN_INFO "uart->port.flags    = 0x%08x\n",uart->port.flags );
+		printk( KERN_INFO "uart->port.mapbase  = 0x%08x\n",uart->port.mapbase);
+#endif
+
+		if (port->dev)
+			uart->port.dev = port->dev;
+
+		ret = uart_add_one_port(&men_uart_reg, &uart->port);
+
+		if (ret == 0)
+			ret = uart->port.line;
+		else
+			uart->port.membase = NULL;	/* not registered, skip in deinit */
+	} 
+
+	mutex_unlock(&uart->mod->lock);
+	return ret;
+}
+
+/*******************************************************************/
+/** Remove one serial port
+ *
+ * \param uart		\IN Oxford 16C954 Port Struct
+ *
+ * \return 			-
+ */
+void men_uart_unregister_port(struct ox16c954_port *uart)
+{
+	mutex_lock(&uart->mod->lock);
+	uart_remove_one_port( &men_uart_reg, &uart->port);
+	uart->port.dev = NULL;
+	mutex_unlock(&uart->mod->lock);
+}
+
+
+
+/*******************************************************************/
+/** return Port type name
+ *
+ * \param port		\IN 	highlevel UART Port Struct
+ *
+ * \return 			char pointer to string, typically "16C954" here
+ */
+static const char *men_uart_type(struct uart_port *port)
+{
+	int type = port->type;
+
+	if (type >= ARRAY_SIZE(uart_config))
+		type = 0;
+	return uart_config[type].name;
+}
+
+
+
+/*-----------------------------+
+|   RAW RING DEVICE            |
++-----------------------------*/
+
+/*******************************************************************/
+/** Find the registered port of a ttyD line
+ *
+ * \param line		\IN  ttyD line number
+ *
+ * \brief The module list is complete before any M-Module is probed and
+ *        is not changed until deinit_devices(), so it is walked unlocked.
+ *
+ * \return 			port or NULL if the line is not registered
+ */
+static struct ox16c954_port *m77_find_port(unsigned int line)
+{
+	UARTMOD_INFO *mmod;
+	struct list_head *pos;
+
+	list_for_each( pos, &G_uartModListHead ) {
+		mmod = list_entry(pos, UARTMOD_INFO, head);
+		if (line - mmod->lineBase >= mmod->nrChannels)
+			continue;
+		if (!smp_load_acquire(&mmod->ready))
+			return NULL;
+		return &mmod->ports[line - mmod->lineBase];
+	}
+	return NULL;
+}
+
+
+/*******************************************************************/
+/** Check if the received data of a port goes somewhere else than to
+ *  its ttyD
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct
+ *
+ * \return 			nonzero if raw, mux, bridge, bond, netdev or serdev
+ *					own it
+ */
+static inline int m77_port_claimed(struct ox16c954_port *up)
+{
+	return up->raw || up->muxOn || up->bridge || up->bondMem || up->net ||
+		up->serdev;
+}
+
+
+/*******************************************************************/
+/** open /dev/m77raw<line>
+ *
+ * \brief Allocates the ring area and attaches it to the port. Only one
+ *        opener per line, and none while mux, bridge, bond, netdev
+ *        or serdev take the received data. The ttyD line must be open,
+ *        it provides the line settings and the UART interrupts.
+ *
+ * \return 			0 or negative error code
+ */
+static int m77_raw_open(struct inode *inode, struct file *file)
+{
+	struct ox16c954_port *up;
+	struct m77_raw *raw;
+	unsigned long flags;
+	int ret = 0;
+
+	up = m77_find_port(iminor(inode) - MINOR(G_rawDevt));
+	if (!up)
+		return -ENODEV;
+
+	raw = kzalloc(sizeof(*raw), GFP_KERNEL);
+	if (!raw)
+		return -ENOMEM;
+
+	raw->hdr = vmalloc_user(M77_RAW_MAP_SIZE);
+	if (!raw->hdr) {
+		kfree(raw);
+		return -ENOMEM;
+	}
+	raw->rx = (unsigned char *)raw->hdr + M77_RAW_RX_OFFSET;
+	raw->tx = (unsigned char *)raw->hdr + M77_RAW_TX_OFFSET;
+	raw->up = up;
+	init_waitqueue_head(&raw->wait);
+	mutex_init(&raw->spliceLock);
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	if (m77_port_claimed(up))
+		ret = -EBUSY;
+	else if (!up->opened)
+		ret = -EIO;		/* ttyD line not open */
+	else
+		up->raw = raw;
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	if (ret) {
+		vfree(raw->hdr);
+		kfree(raw);
+		return ret;
+	}
+
+	file->private_data = raw;
+	return nonseekable_open(inode, file);
+}
+
+
+/*******************************************************************/
+/** drop the page references of sent splice() segments
+ *
+ * \param raw		\IN  raw device
+ * \param upto		\IN  put pages of the segments before this one
+ *
+ * \return 			-
+ */
+static void m77_raw_put_segs(struct m77_raw *raw, unsigned int upto)
+{
+	while (raw->segFree != upto) {
+		put_page(raw->seg[raw->segFree & (RAW_SPLICE_SEGS - 1)].page);
+		raw->segFree++;
+	}
+}
+
+
+/*******************************************************************/
+/** splice actor: queue one pipe buffer for sending
+ *
+ * \brief The page itself is queued, the ISR sends from it, so file
+ *        pages go from the page cache to the UART without a copy.
+ *
+ * \return 			bytes queued or negative error code
+ */
+static int m77_raw_splice_actor(struct pipe_inode_info *pipe,
+								struct pipe_buffer *buf,
+								struct splice_desc *sd)
+{
+	struct m77_raw *raw = sd->u.file->private_data;
+	struct ox16c954_port *up = raw->up;
+	struct m77_raw_seg *seg;
+	unsigned long flags;
+	int ret;
+
+	m77_raw_put_segs(raw, smp_load_acquire(&raw->segTail));
+
+	if (raw->segHead - raw->segFree >= RAW_SPLICE_SEGS) {
+		if (sd->flags & SPLICE_F_NONBLOCK)
+			return -EAGAIN;
+		ret = wait_event_interruptible(raw->wait,
+					raw->segHead - READ_ONCE(raw->segTail) < RAW_SPLICE_SEGS ||
+					!READ_ONCE(up->opened));
+		if (ret)
+			return ret;
+		m77_raw_put_segs(raw, smp_load_acquire(&raw->segTail));
+	}
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	if (!up->opened) {
+		spin_unlock_irqrestore(&up->port.lock, flags);
+		return -EIO;		/* ttyD line closed */
+	}
+	seg = &raw->seg[raw->segHead & (RAW_SPLICE_SEGS - 1)];
+	get_page(buf->page);
+	seg->page	= buf->page;
+	seg->off	= buf->offset;
+	seg->len	= sd->len;
+	raw->segHead++;
+	men_uart_start_tx(&up->port);
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	return sd->len;
+}
+
+
+/*******************************************************************/
+/** splice()/sendfile() to /dev/m77raw<line>
+ *
+ * \brief Returns when the data is queued, sending goes on from the
+ *        pages. They are sent after the mmap()ed TX ring ran empty.
+ *
+ * \return 			bytes queued or negative error code
+ */
+static ssize_t m77_raw_splice_write(struct pipe_inode_info *pipe,
+									struct file *out, loff_t *ppos,
+									size_t len, unsigned int flags)
+{
+	struct m77_raw *raw = out->private_data;
+	struct splice_desc sd = {
+		.total_len	= len,
+		.flags		= flags,
+		.pos		= ppos ? *ppos : 0,
+		.u.file		= out,
+	};
+	ssize_t ret;
+
+	if (out->f_flags & O_NONBLOCK)
+		sd.flags |= SPLICE_F_NONBLOCK;
+
+	mutex_lock(&raw->spliceLock);
+	pipe_lock(pipe);
+	ret = __splice_from_pipe(pipe, &sd, m77_raw_splice_actor);
+	pipe_unlock(pipe);
+	mutex_unlock(&raw->spliceLock);
+
+	return ret;
+}
+
+
+/*******************************************************************/
+/** release /dev/m77raw<line>, called after the last munmap() too
+ */
+static int m77_raw_release(struct inode *inode, struct file *file)
+{
+	struct m77_raw *raw = file->private_data;
+	struct ox16c954_port *up = raw->up;
+	unsigned long flags;
+
+	/* the ISR uses up->raw under the port lock only */
+	spin_lock_irqsave(&up->port.lock, flags);
+	up->raw = NULL;
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	/* pages not sent yet are dropped too */
+	m77_raw_put_segs(raw, raw->segHead);
+	mutex_destroy(&raw->spliceLock);
+	vfree(raw->hdr);
+	kfree(raw);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** map header and both rings into the caller
+ */
+static int m77_raw_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct m77_raw *raw = file->private_data;
+
+	return remap_vmalloc_range(vma, raw->hdr, vma->vm_pgoff);
+}
+
+
+/*******************************************************************/
+/** poll for RX data, TX ring space or a closed ttyD line
+ */
+static unsigned int m77_raw_poll(struct file *file, poll_table *wait)
+{
+	struct m77_raw *raw = file->private_data;
+	unsigned int mask = 0;
+
+	poll_wait(file, &raw->wait, wait);
+
+	if (READ_ONCE(raw->hdr->rxTail) != READ_ONCE(raw->rxHead))
+		mask |= POLLIN | POLLRDNORM;
+	if (READ_ONCE(raw->hdr->txHead) - READ_ONCE(raw->txTail)
+		< M77_RAW_TX_SIZE)
+		mask |= POLLOUT | POLLWRNORM;
+	if (!READ_ONCE(raw->up->opened))
+		mask |= POLLHUP;
+
+	return mask;
+}
+
+
+/*******************************************************************/
+/** raw device ioctl, M77_RAW_KICK starts sending the TX ring
+ */
+static long m77_raw_ioctl(struct file *file, unsigned int cmd,
+						  unsigned long arg)
+{
+	struct m77_raw *raw = file->private_data;
+	struct ox16c954_port *up = raw->up;
+	unsigned long flags;
+	long ret = 0;
+
+	switch (cmd) {
+	case M77_RAW_KICK:
+		spin_lock_irqsave(&up->port.lock, flags);
+		if (up->opened)
+			men_uart_start_tx(&up->port);
+		else
+			ret = -EIO;
+		spin_unlock_irqrestore(&up->port.lock, flags);
+		break;
+	default:
+		ret = -ENOTTY;
+	}
+	return ret;
+}
+
+
+static const struct file_operations m77_raw_fops = {
+	.owner			= THIS_MODULE,
+	.open			= m77_raw_open,
+	.release		= m77_raw_release,
+	.mmap			= m77_raw_mmap,
+	.poll			= m77_raw_poll,
+	.splice_write	= m77_raw_splice_write,
+	.unlocked_ioctl	= m77_raw_ioctl,
+	.compat_ioctl	= m77_raw_ioctl,
+};
+
+
+/*******************************************************************/
+/** Create /dev/m77raw<line> for a registered port
+ *
+ * \param up		\IN  registered port
+ *
+ * \return 			0 or negative error code
+ */
+static int m77_raw_add(struct ox16c954_port *up)
+{
+	struct device *dev;
+
+	dev = device_create(G_rawClass, up->port.dev,
+						MKDEV(MAJOR(G_rawDevt), MINOR(G_rawDevt) + up->port.line),
+						up, RAW_NAME_PREFIX "%d", up->port.line);
+	if (IS_ERR(dev))
+		return PTR_ERR(dev);
+
+	up->rawDev = dev;
+	return 0;
+}
+
+
+/*******************************************************************/
+/** Remove /dev/m77raw<line> of a port
+ */
+static void m77_raw_remove(struct ox16c954_port *up)
+{
+	if (!up->rawDev)
+		return;
+
+	device_destroy(G_rawClass,
+				   MKDEV(MAJOR(G_rawDevt), MINOR(G_rawDevt) + up->port.line));
+	up->rawDev = NULL;
+}
+
+
+/*******************************************************************/
+/** Reserve the raw device numbers for all ttyD lines
+ *
+ * \param nr		\IN  number of ttyD lines
+ *
+ * \return 			0 or negative error code
+ */
+static int m77_raw_init(unsigned int nr)
+{
+	int ret;
+
+	ret = alloc_chrdev_region(&G_rawDevt, 0, nr, RAW_NAME_PREFIX);
+	if (ret)
+		return ret;
+
+	cdev_init(&G_rawCdev, &m77_raw_fops);
+	G_rawCdev.owner = THIS_MODULE;
+	ret = cdev_add(&G_rawCdev, G_rawDevt, nr);
+	if (ret)
+		goto unreg;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,4,0)
+	G_rawClass = class_create(RAW_NAME_PREFIX);
+#else
+	G_rawClass = class_create(THIS_MODULE, RAW_NAME_PREFIX);
+#endif
+	if (IS_ERR(G_rawClass)) {
+		ret = PTR_ERR(G_rawClass);
+		goto del;
+	}
+	return 0;
+
+ del:
+	cdev_del(&G_rawCdev);
+ unreg:
+	unregister_chrdev_region(G_rawDevt, nr);
+	return ret;
+}
+
+
+/*******************************************************************/
+/** Release what m77_raw_init() reserved
+ */
+static void m77_raw_exit(unsigned int nr)
+{
+	class_destroy(G_rawClass);
+	cdev_del(&G_rawCdev);
+	unregister_chrdev_region(G_rawDevt, nr);
+}
+
+
+
+/*-----------------------------+
+|   CAPTURE MULTIPLEXER        |
++-----------------------------*/
+
+/*******************************************************************/
+/** copy from/to the /dev/m77mux ring at a free running index
+ *
+ * \param idx		\IN  ring index
+ * \param data		\IN  data to write or buffer to read into
+ * \param len		\IN  nr. of bytes
+ * \param in		\IN  1: copy into the ring, 0: out of it
+ *
+ * \return 			-
+ */
+static void m77_mux_copy(unsigned int idx, void *data, unsigned int len,
+						 int in)
+{
+	unsigned int pos = idx & (MUX_RING_SIZE - 1);
+	unsigned int first = min_t(unsigned int, len, MUX_RING_SIZE - pos);
+
+	if (in) {
+		memcpy(G_mux.buf + pos, data, first);
+		memcpy(G_mux.buf, (unsigned char *)data + first, len - first);
+	} else {
+		memcpy(data, G_mux.buf + pos, first);
+		memcpy((unsigned char *)data + first, G_mux.buf, len - first);
+	}
+}
+
+
+/*******************************************************************/
+/** Subscribe/unsubscribe ttyD lines to /dev/m77mux
+ *
+ * \param base		\IN  first line
+ * \param mask		\IN  bit n: capture line base + n, 0: tty as usual
+ *
+ * \brief Nothing is changed if a line to capture does not exist or its
+ *        received data already goes to raw, bridge, bond, netdev or
+ *        serdev. A line claimed by those between the check and the
+ *        change is left alone, the ISR would not look at muxOn anyway.
+ *
+ * \return 			0, -ENODEV if a line to capture does not exist or
+ *					-EBUSY if it is claimed
+ */
+static int m77_mux_subscribe(unsigned int base, unsigned int mask)
+{
+	struct ox16c954_port *up;
+	unsigned long flags;
+	unsigned int n;
+	int ret = 0;
+
+	for (n = 0; n < 32 && !ret; n++) {
+		if (!(mask & (1u << n)))
+			continue;
+		up = m77_find_port(base + n);
+		if (!up)
+			return -ENODEV;
+		spin_lock_irqsave(&up->port.lock, flags);
+		if (!up->muxOn && m77_port_claimed(up))
+			ret = -EBUSY;
+		spin_unlock_irqrestore(&up->port.lock, flags);
+	}
+	if (ret)
+		return ret;
+
+	for (n = 0; n < 32; n++) {
+		up = m77_find_port(base + n);
+		if (!up)
+			continue;
+		spin_lock_irqsave(&up->port.lock, flags);
+		if (!(mask & (1u << n)))
+			up->muxOn = 0;
+		else if (!m77_port_claimed(up))
+			up->muxOn = 1;
+		spin_unlock_irqrestore(&up->port.lock, flags);
+	}
+	return 0;
+}
+
+
+/*******************************************************************/
+/** open /dev/m77mux, one reader at a time
+ */
+static int m77_mux_open(struct inode *inode, struct file *file)
+{
+	unsigned char *buf;
+	unsigned long flags;
+
+	if (test_and_set_bit(0, &G_mux.open))
+		return -EBUSY;
+
+	buf = vmalloc(MUX_RING_SIZE);
+	if (!buf) {
+		clear_bit(0, &G_mux.open);
+		return -ENOMEM;
+	}
+
+	spin_lock_irqsave(&G_mux.lock, flags);
+	G_mux.buf	= buf;
+	G_mux.head	= 0;
+	G_mux.tail	= 0;
+	G_mux.lost	= 0;
+	spin_unlock_irqrestore(&G_mux.lock, flags);
+
+	return nonseekable_open(inode, file);
+}
+
+
+/*******************************************************************/
+/** release /dev/m77mux, all lines go back to their ttyD
+ */
+static int m77_mux_release(struct inode *inode, struct file *file)
+{
+	UARTMOD_INFO *mmod;
+	struct list_head *pos;
+	unsigned char *buf;
+	unsigned long flags;
+	unsigned int i;
+
+	list_for_each( pos, &G_uartModListHead ) {
+		mmod = list_entry(pos, UARTMOD_INFO, head);
+		if (!smp_load_acquire(&mmod->ready))
+			continue;
+		for (i = 0; i < mmod->nrChannels; i++) {
+			spin_lock_irqsave(&mmod->ports[i].port.lock, flags);
+			mmod->ports[i].muxOn = 0;
+			spin_unlock_irqrestore(&mmod->ports[i].port.lock, flags);
+		}
+	}
+
+	spin_lock_irqsave(&G_mux.lock, flags);
+	buf = G_mux.buf;
+	G_mux.buf = NULL;
+	spin_unlock_irqrestore(&G_mux.lock, flags);
+
+	vfree(buf);
+	clear_bit(0, &G_mux.open);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** read whole records from /dev/m77mux
+ *
+ * \brief count must hold at least one record of maximum size. Each
+ *        record is a struct m77_mux_rec followed by len data bytes.
+ *
+ * \return 			nr. of bytes read or negative error code
+ */
+static ssize_t m77_mux_read(struct file *file, char __user *ubuf,
+							size_t count, loff_t *ppos)
+{
+	struct m77_mux_rec rec;
+	unsigned int head, tail, pos, first, n = 0;
+	unsigned long flags;
+	ssize_t ret;
+
+	if (count < M77_MUX_REC_SIZE(M77_MUX_MAX_PAYLOAD))
+		return -EINVAL;
+
+	if (mutex_lock_interruptible(&G_mux.readLock))
+		return -ERESTARTSYS;
+
+	tail = G_mux.tail;		/* only changed here */
+	if (file->f_flags & O_NONBLOCK) {
+		if (READ_ONCE(G_mux.head) == tail) {
+			ret = -EAGAIN;
+			goto out;
+		}
+	} else if (wait_event_interruptible(G_mux.wait,
+										READ_ONCE(G_mux.head) != tail)) {
+		ret = -ERESTARTSYS;
+		goto out;
+	}
+
+	spin_lock_irqsave(&G_mux.lock, flags);
+	head = G_mux.head;
+	spin_unlock_irqrestore(&G_mux.lock, flags);
+
+	/* whole records only, the ISR does not touch [tail, head) */
+	while (n + sizeof(rec) <= head - tail) {
+		m77_mux_copy(tail + n, &rec, sizeof(rec), 0);
+		if (n + M77_MUX_REC_SIZE(rec.len) > count)
+			break;
+		n += M77_MUX_REC_SIZE(rec.len);
+	}
+
+	pos		= tail & (MUX_RING_SIZE - 1);
+	first	= min_t(unsigned int, n, MUX_RING_SIZE - pos);
+	if (copy_to_user(ubuf, G_mux.buf + pos, first) ||
+		copy_to_user(ubuf + first, G_mux.buf, n - first)) {
+		ret = -EFAULT;
+		goto out;
+	}
+
+	spin_lock_irqsave(&G_mux.lock, flags);
+	G_mux.tail = tail + n;
+	spin_unlock_irqrestore(&G_mux.lock, flags);
+	ret = n;
+ out:
+	mutex_unlock(&G_mux.readLock);
+	return ret;
+}
+
+
+/*******************************************************************/
+/** poll for records
+ */
+static unsigned int m77_mux_poll(struct file *file, poll_table *wait)
+{
+	poll_wait(file, &G_mux.wait, wait);
+
+	if (READ_ONCE(G_mux.head) != READ_ONCE(G_mux.tail))
+		return POLLIN | POLLRDNORM;
+	return 0;
+}
+
+
+/*******************************************************************/
+/** /dev/m77mux ioctl, M77_MUX_SET_MASK selects the captured lines
+ */
+static long m77_mux_ioctl(struct file *file, unsigned int cmd,
+						  unsigned long arg)
+{
+	struct m77_mux_mask mm;
+
+	switch (cmd) {
+	case M77_MUX_SET_MASK:
+		if (copy_from_user(&mm, (void __user *)arg, sizeof(mm)))
+			return -EFAULT;
+		return m77_mux_subscribe(mm.base, mm.mask);
+	}
+	return -ENOTTY;
+}
+
+#ifdef CONFIG_COMPAT
+/*******************************************************************/
+/** /dev/m77mux ioctl of a 32 bit process, struct m77_mux_mask has
+ *  the same layout
+ */
+static long m77_mux_compat_ioctl(struct file *file, unsigned int cmd,
+								 unsigned long arg)
+{
+	return m77_mux_ioctl(file, cmd, (unsigned long)compat_ptr(arg));
+}
+#endif
+
+
+static const struct file_operations m77_mux_fops = {
+	.owner			= THIS_MODULE,
+	.open			= m77_mux_open,
+	.release		= m77_mux_release,
+	.read			= m77_mux_read,
+	.poll			= m77_mux_poll,
+	.unlocked_ioctl	= m77_mux_ioctl,
+#ifdef CONFIG_COMPAT
+	.compat_ioctl	= m77_mux_compat_ioctl,
+#endif
+};
+
+static struct miscdevice G_muxDev = {
+	.minor	= MISC_DYNAMIC_MINOR,
+	.name	= MUX_NAME,
+	.fops	= &m77_mux_fops,
+};
+
+
+/*-----------------------------+
+|   SERIAL BRIDGE              |
++-----------------------------*/
+
+/*******************************************************************/
+/** Enable the RX interrupts of a port stopped by the bridge flow control
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct, port lock held
+ *
+ * \return 			-
+ */
+static void m77_bridge_resume(struct ox16c954_port *up)
+{
+	if (!up->bridgeStall)
+		return;
+
+	up->bridgeStall = 0;
+	m77_stall_end(&up->rxStallAt, &up->rxStallNs);
+	up->hot->ier |= UART_IER_RLSI | UART_IER_RDI;
+	serial_out(up, UART_IER, up->hot->ier);
+	men_uart_set_mctrl(&up->port, up->port.mctrl);	/* RTS as before */
+}
+
+
+/*******************************************************************/
+/** Resume a stalled bridge source, scheduled by the peer's transmit_chars()
+ */
+static void m77_bridge_resume_work(struct work_struct *work)
+{
+	struct ox16c954_port *up =
+		container_of(work, struct ox16c954_port, bridgeWork);
+	unsigned long flags;
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	m77_bridge_resume(up);
+	spin_unlock_irqrestore(&up->port.lock, flags);
+}
+
+
+/*******************************************************************/
+/** Forward the RX data of src to dst, G_bridgeLock held
+ *
+ * \param src		\IN  port whose received data is forwarded
+ * \param dst		\IN  port sending it
+ * \param flags		\IN  M77_BRIDGE_xxx
+ *
+ * \return 			0 or -EBUSY if dst is fed by another port
+ */
+static int m77_bridge_link(struct ox16c954_port *src,
+						   struct ox16c954_port *dst, unsigned int flags)
+{
+	unsigned long fl;
+
+	if (dst->bridgeSrc && dst->bridgeSrc != src)
+		return -EBUSY;
+
+	spin_lock_irqsave(&dst->port.lock, fl);
+	dst->bridgeSrc = src;
+	spin_unlock_irqrestore(&dst->port.lock, fl);
+
+	spin_lock_irqsave(&src->port.lock, fl);
+	src->bridge			= dst;
+	src->bridgeFlags	= flags;
+	src->bridgeFwd		= 0;
+	src->bridgeDrop		= 0;
+	spin_unlock_irqrestore(&src->port.lock, fl);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** Stop forwarding the RX data of src, G_bridgeLock held
+ *
+ * \param src		\IN  port whose received data was forwarded
+ *
+ * \brief dst->bridgeSrc is cleared first, so the ISR of src cannot stall
+ *        it again after it was resumed here.
+ *
+ * \return 			-
+ */
+static void m77_bridge_unlink(struct ox16c954_port *src)
+{
+	struct ox16c954_port *dst = src->bridge;
+	unsigned long fl;
+
+	if (!dst)
+		return;
+
+	spin_lock_irqsave(&dst->port.lock, fl);
+	if (dst->bridgeSrc == src)
+		dst->bridgeSrc = NULL;
+	spin_unlock_irqrestore(&dst->port.lock, fl);
+
+	spin_lock_irqsave(&src->port.lock, fl);
+	src->bridge = NULL;
+	m77_bridge_resume(src);
+	spin_unlock_irqrestore(&src->port.lock, fl);
+}
+
+
+/*******************************************************************/
+/** Remove the bridge rules of a port, bidirectional ones both ways
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct
+ *
+ * \return 			-
+ */
+static void m77_bridge_clear(struct ox16c954_port *up)
+{
+	struct ox16c954_port *peer = up->bridge;
+
+	if (!peer)
+		return;
+
+	if ((up->bridgeFlags & M77_BRIDGE_BIDIR) && peer->bridge == up)
+		m77_bridge_unlink(peer);
+	m77_bridge_unlink(up);
+}
+
+
+/*******************************************************************/
+/** Check if m77_bridge_clear(ox) removes the rule of src
+ *
+ * \return 			nonzero if so
+ */
+static inline int m77_bridge_goes(struct ox16c954_port *src,
+								  struct ox16c954_port *ox)
+{
+	return src == ox || (ox->bridge == src && src->bridge == ox &&
+						 (ox->bridgeFlags & M77_BRIDGE_BIDIR));
+}
+
+/*******************************************************************/
+/** Check if the rule src -> dst can replace the rules of ox, as
+ *  m77_bridge_link() would after m77_bridge_clear(ox)
+ *
+ * \param src		\IN  port to forward from, G_bridgeLock held
+ * \param dst		\IN  port to forward to
+ * \param ox		\IN  port the bridge is set on
+ *
+ * \return 			0 or -EBUSY if the RX data of src goes elsewhere or
+ *					dst already takes the data of another port
+ */
+static int m77_bridge_check(struct ox16c954_port *src,
+							struct ox16c954_port *dst,
+							struct ox16c954_port *ox)
+{
+	if (src->raw || src->muxOn || src->bondMem || src->net || src->serdev)
+		return -EBUSY;
+	if (src->bridge && !m77_bridge_goes(src, ox))
+		return -EBUSY;
+	if (dst->bridgeSrc && dst->bridgeSrc != src &&
+		!m77_bridge_goes(dst->bridgeSrc, ox))
+		return -EBUSY;
+	return 0;
+}
+
+
+/*******************************************************************/
+/** Bridge ioctls on a ttyD line
+ *
+ * \param ox		\IN  Oxford 16C954 Port Struct
+ * \param cmd		\IN  M77_BRIDGE_SET / M77_BRIDGE_GET
+ * \param arg		\IN  user pointer to struct m77_bridge
+ *
+ * \brief A new rule is checked before the current one is removed, a
+ *        refused M77_BRIDGE_SET leaves the bridge as it was.
+ *
+ * \return 			0 or negative error number, -EOPNOTSUPP for
+ *					M77_BRIDGE_FLOW on a M77 line without RTS/CTS
+ */
+static int m77_bridge_ioctl(struct ox16c954_port *ox, unsigned int cmd,
+							unsigned long arg)
+{
+	struct m77_bridge __user *ub = (struct m77_bridge __user *)arg;
+	struct ox16c954_port *peer;
+	struct m77_bridge br;
+	int ret = 0;
+
+	mutex_lock(&G_bridgeLock);
+
+	if (cmd == M77_BRIDGE_GET) {
+		memset(&br, 0, sizeof(br));
+		br.peer		= ox->bridge ? (int)ox->bridge->port.line : -1;
+		br.flags	= ox->bridgeFlags;
+		br.fwdBytes	= ox->bridgeFwd;
+		br.dropBytes = ox->bridgeDrop;
+		if (copy_to_user(ub, &br, sizeof(br)))
+			ret = -EFAULT;
+		goto out;
+	}
+
+	if (copy_from_user(&br, ub, sizeof(br))) {
+		ret = -EFAULT;
+		goto out;
+	}
+
+	if (br.peer < 0) {
+		m77_bridge_clear(ox);
+		goto out;
+	}
+
+	peer = m77_find_port(br.peer);
+	if (!peer || peer == ox) {
+		ret = -EINVAL;
+		goto out;
+	}
+	ret = m77_bridge_check(ox, peer, ox);
+	if (!ret && (br.flags & M77_BRIDGE_BIDIR))
+		ret = m77_bridge_check(peer, ox, ox);
+	if (ret)
+		goto out;
+	/* FLOW stops the sender with the RTS of the line that stops reading */
+	if ((br.flags & M77_BRIDGE_FLOW) &&
+		(ox->type == MOD_M77 ||
+		 ((br.flags & M77_BRIDGE_BIDIR) && peer->type == MOD_M77))) {
+		ret = -EOPNOTSUPP;
+		goto out;
+	}
+
+	m77_bridge_clear(ox);
+	ret = m77_bridge_link(ox, peer, br.flags);
+	if (!ret && (br.flags & M77_BRIDGE_BIDIR)) {
+		ret = m77_bridge_link(peer, ox, br.flags);
+		if (ret)
+			m77_bridge_unlink(ox);
+	}
+ out:
+	mutex_unlock(&G_bridgeLock);
+	return ret;
+}
+
+
+/*******************************************************************/
+/** Bridge part of men_uart_shutdown(): drop our rules, let a source
+ *  stalled on our xmit buffer run again
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct
+ *
+ * \return 			-
+ */
+static void m77_bridge_shutdown(struct ox16c954_port *up)
+{
+	unsigned long flags;
+
+	mutex_lock(&G_bridgeLock);
+	m77_bridge_clear(up);
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	up->opened = 0;
+	if (up->bridgeSrc)
+		schedule_work(&up->bridgeSrc->bridgeWork);
+	spin_unlock_irqrestore(&up->port.lock, flags);
+	mutex_unlock(&G_bridgeLock);
+
+	cancel_work_sync(&up->bridgeWork);
+}
+
+
+
+/*-----------------------------+
+|   CHANNEL BONDING            |
++-----------------------------*/
+
+/*******************************************************************/
+/** Set module parameter "bondGapMs", 1..BOND_GAP_MAX_MS
+ *
+ * \return 			0 or -EINVAL
+ */
+static int m77_bond_gap_set(const char *val, const struct kernel_param *kp)
+{
+	unsigned int ms;
+
+	if (kstrtouint(val, 0, &ms) || !ms || ms > BOND_GAP_MAX_MS)
+		return -EINVAL;
+	WRITE_ONCE(*(unsigned int *)kp->arg, ms);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** give up missing frames after bondGapMs, so frames received after
+ *  them are not held back forever
+ */
+static void m77_bond_gap_work(struct work_struct *work)
+{
+	struct m77_bond *bond =
+		container_of(to_delayed_work(work), struct m77_bond, gapWork);
+	unsigned long flags;
+
+	spin_lock_irqsave(&bond->rxLock, flags);
+	if (bond->rxWaiting)
+		m77_bond_rx_skip(bond);
+	spin_unlock_irqrestore(&bond->rxLock, flags);
+
+	tty_flip_buffer_push(&bond->port);
+}
+
+
+/*******************************************************************/
+/** Select the member to send the next frame on
+ *
+ * \param bond		\IN  bonded tty, txLock held
+ * \param need		\IN  frame size incl. header and checksum
+ *
+ * \brief The member with the most free space in its xmit buffer is
+ *        taken. So the members are loaded according to their speed and
+ *        a member which stopped sending (e.g. held off by CTS, closed)
+ *        simply gets no more frames.
+ *
+ * \return 			member or NULL if no member can take the frame
+ */
+static struct m77_bond_member *m77_bond_pick(struct m77_bond *bond,
+											 unsigned int need)
+{
+	struct m77_bond_member *best = NULL;
+	struct ox16c954_port *up;
+	struct circ_buf *xmit;
+	unsigned int i, room, bestRoom = need - 1;
+
+	for (i = 0; i < bond->nMembers; i++) {
+		up = bond->member[i]->up;
+		xmit = &up->port.state->xmit;
+		if (!READ_ONCE(up->opened) || !READ_ONCE(xmit->buf))
+			continue;
+		room = CIRC_SPACE(READ_ONCE(xmit->head), READ_ONCE(xmit->tail),
+						  UART_XMIT_SIZE);
+		if (room > bestRoom) {
+			bestRoom	= room;
+			best		= bond->member[i];
+		}
+	}
+	return best;
+}
+
+
+/*******************************************************************/
+/** copy bytes into a circular xmit buffer, room checked by the caller
+ */
+static void m77_bond_put(struct circ_buf *xmit, const unsigned char *p,
+						 unsigned int n)
+{
+	while (n--) {
+		xmit->buf[xmit->head] = *p++;
+		xmit->head = (xmit->head + 1) & (UART_XMIT_SIZE - 1);
+	}
+}
+
+
+/*******************************************************************/
+/** Stripe data as frames over the bond members
+ *
+ * \param bond		\IN  bonded tty
+ * \param buf		\IN  data
+ * \param count		\IN  nr. of bytes
+ *
+ * \return 			nr. of bytes accepted
+ */
+static int m77_bond_send(struct m77_bond *bond, const unsigned char *buf,
+						 int count)
+{
+	struct m77_bond_member *mem;
+	struct ox16c954_port *up;
+	struct circ_buf *xmit;
+	unsigned char hdr[M77_BOND_HDR], sum;
+	unsigned long flags;
+	int len, i, done = 0;
+
+	spin_lock_irqsave(&bond->txLock, flags);
+	while (done < count) {
+		len = min(count - done, M77_BOND_MAX_PAYLOAD);
+		mem = m77_bond_pick(bond, len + M77_BOND_OVERHEAD);
+		if (!mem)
+			break;
+
+		up = mem->up;
+		xmit = &up->port.state->xmit;
+		spin_lock(&up->port.lock);
+		if (!up->opened || !xmit->buf ||
+			CIRC_SPACE(xmit->head, xmit->tail, UART_XMIT_SIZE) <
+			len + M77_BOND_OVERHEAD) {
+			spin_unlock(&up->port.lock);
+			break;
+		}
+
+		hdr[0] = M77_BOND_SYNC;
+		hdr[1] = bond->txSeq & 0xff;
+		hdr[2] = bond->txSeq >> 8;
+		hdr[3] = len;
+		hdr[4] = ~(hdr[1] + hdr[2] + hdr[3]);
+		for (sum = 0, i = 0; i < len; i++)
+			sum += buf[done + i];
+
+		m77_bond_put(xmit, hdr, sizeof(hdr));
+		m77_bond_put(xmit, buf + done, len);
+		m77_bond_put(xmit, &sum, 1);
+		men_uart_start_tx(&up->port);
+		spin_unlock(&up->port.lock);
+
+		bond->txSeq++;
+		bond->txFrames++;
+		done += len;
+	}
+	spin_unlock_irqrestore(&bond->txLock, flags);
+	return done;
+}
+
+
+/*******************************************************************/
+/** Add a ttyD line to a bond, G_bondLock held
+ *
+ * \param bond		\IN  bonded tty
+ * \param line		\IN  ttyD line
+ *
+ * \return 			0 or negative error code
+ */
+static int m77_bond_add(struct m77_bond *bond, unsigned int line)
+{
+	struct ox16c954_port *up = m77_find_port(line);
+	struct m77_bond_member *mem;
+	unsigned long flags;
+
+	if (!up)
+		return -ENODEV;
+	if (m77_port_claimed(up))
+		return -EBUSY;
+	if (bond->nMembers == M77_BOND_MAX_MEMBERS)
+		return -ENOSPC;
+
+	mem = kzalloc(sizeof(*mem), GFP_KERNEL);
+	if (!mem)
+		return -ENOMEM;
+	mem->bond	= bond;
+	mem->up		= up;
+
+	spin_lock_irqsave(&bond->txLock, flags);
+	bond->member[bond->nMembers++] = mem;
+	spin_unlock_irqrestore(&bond->txLock, flags);
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	up->bondMem = mem;
+	spin_unlock_irqrestore(&up->port.lock, flags);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** Remove a member from its bond, G_bondLock held
+ *
+ * \param bond		\IN  bonded tty
+ * \param idx		\IN  index in bond->member[]
+ *
+ * \return 			-
+ */
+static void m77_bond_del(struct m77_bond *bond, unsigned int idx)
+{
+	struct m77_bond_member *mem = bond->member[idx];
+	struct ox16c954_port *up = mem->up;
+	unsigned long flags;
+
+	spin_lock_irqsave(&bond->txLock, flags);
+	bond->member[idx] = bond->member[--bond->nMembers];
+	bond->member[bond->nMembers] = NULL;
+	spin_unlock_irqrestore(&bond->txLock, flags);
+
+	/* the ISR uses up->bondMem under the port lock only */
+	spin_lock_irqsave(&up->port.lock, flags);
+	up->bondMem = NULL;
+	spin_unlock_irqrestore(&up->port.lock, flags);
+	kfree(mem);
+}
+
+
+/*******************************************************************/
+/** tty_port activate: start with an empty reorder window, the first
+ *  frame received sets the sequence
+ */
+static int m77_bond_activate(struct tty_port *port, struct tty_struct *tty)
+{
+	struct m77_bond *bond = container_of(port, struct m77_bond, port);
+	unsigned long flags;
+	unsigned int i;
+
+	spin_lock_irqsave(&bond->rxLock, flags);
+	for (i = 0; i < BOND_WINDOW; i++)
+		bond->slot[i].valid = 0;
+	bond->rxWaiting	= 0;
+	bond->rxSync	= 0;
+	bond->rxOld		= 0;
+	bond->open		= 1;
+	spin_unlock_irqrestore(&bond->rxLock, flags);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** tty_port shutdown: received frames are dropped until reopened
+ */
+static void m77_bond_port_shutdown(struct tty_port *port)
+{
+	struct m77_bond *bond = container_of(port, struct m77_bond, port);
+	unsigned long flags;
+
+	spin_lock_irqsave(&bond->rxLock, flags);
+	bond->open = 0;
+	spin_unlock_irqrestore(&bond->rxLock, flags);
+	cancel_delayed_work_sync(&bond->gapWork);
+}
+
+
+static const struct tty_port_operations m77_bond_port_ops = {
+	.activate	= m77_bond_activate,
+	.shutdown	= m77_bond_port_shutdown,
+};
+
+
+static int m77_bond_install(struct tty_driver *driver, struct tty_struct *tty)
+{
+	struct m77_bond *bond = G_bond[tty->index];
+
+	tty->driver_data = bond;
+	return tty_port_install(&bond->port, driver, tty);
+}
+
+static int m77_bond_open(struct tty_struct *tty, struct file *filp)
+{
+	struct m77_bond *bond = tty->driver_data;
+
+	return tty_port_open(&bond->port, tty, filp);
+}
+
+static void m77_bond_close(struct tty_struct *tty, struct file *filp)
+{
+	struct m77_bond *bond = tty->driver_data;
+
+	tty_port_close(&bond->port, tty, filp);
+}
+
+static void m77_bond_hangup(struct tty_struct *tty)
+{
+	struct m77_bond *bond = tty->driver_data;
+
+	tty_port_hangup(&bond->port);
+}
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,6,0)
+static ssize_t m77_bond_write(struct tty_struct *tty, const u8 *buf,
+							  size_t count)
+{
+	return m77_bond_send(tty->driver_data, buf,
+						 min_t(size_t, count, INT_MAX));
+}
+#else
+static int m77_bond_write(struct tty_struct *tty, const unsigned char *buf,
+						  int count)
+{
+	return m77_bond_send(tty->driver_data, buf, count);
+}
+#endif
+
+
+/*******************************************************************/
+/** free space for the tty layer, sum of what the members can take
+ */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5,14,0)
+static unsigned int m77_bond_write_room(struct tty_struct *tty)
+#else
+static int m77_bond_write_room(struct tty_struct *tty)
+#endif
+{
+	struct m77_bond *bond = tty->driver_data;
+	struct ox16c954_port *up;
+	struct circ_buf *xmit;
+	unsigned int i, room, frames, ret = 0;
+	unsigned long flags;
+
+	spin_lock_irqsave(&bond->txLock, flags);
+	for (i = 0; i < bond->nMembers; i++) {
+		up = bond->member[i]->up;
+		xmit = &up->port.state->xmit;
+		if (!READ_ONCE(up->opened) || !READ_ONCE(xmit->buf))
+			continue;
+		room = CIRC_SPACE(READ_ONCE(xmit->head), READ_ONCE(xmit->tail),
+						  UART_XMIT_SIZE);
+		frames = room / (M77_BOND_MAX_PAYLOAD + M77_BOND_OVERHEAD);
+		room -= frames * (M77_BOND_MAX_PAYLOAD + M77_BOND_OVERHEAD);
+		ret += frames * M77_BOND_MAX_PAYLOAD;
+		if (room > M77_BOND_OVERHEAD)
+			ret += room - M77_BOND_OVERHEAD;
+	}
+	spin_unlock_irqrestore(&bond->txLock, flags);
+	return ret;
+}
+
+
+/*******************************************************************/
+/** Bond ioctls: add/remove members, statistics
+ */
+static int m77_bond_ioctl(struct tty_struct *tty, unsigned int cmd,
+						  unsigned long arg)
+{
+	struct m77_bond *bond = tty->driver_data;
+	struct m77_bond_info info;
+	unsigned int i;
+	int ret = 0;
+
+	switch (cmd) {
+	case M77_BOND_ADD:
+		mutex_lock(&G_bondLock);
+		ret = m77_bond_add(bond, arg);
+		mutex_unlock(&G_bondLock);
+		break;
+
+	case M77_BOND_DEL:
+		mutex_lock(&G_bondLock);
+		ret = -ENOENT;
+		for (i = 0; i < bond->nMembers; i++) {
+			if (bond->member[i]->up->port.line == arg) {
+				m77_bond_del(bond, i);
+				ret = 0;
+				break;
+			}
+		}
+		mutex_unlock(&G_bondLock);
+		break;
+
+	case M77_BOND_INFO:
+		memset(&info, 0, sizeof(info));
+		mutex_lock(&G_bondLock);
+		info.nMembers = bond->nMembers;
+		for (i = 0; i < bond->nMembers; i++) {
+			info.line[i]	= bond->member[i]->up->port.line;
+			info.rxBad		+= bond->member[i]->bad;
+		}
+		mutex_unlock(&G_bondLock);
+		info.txFrames	= bond->txFrames;
+		info.rxFrames	= bond->rxFrames;
+		info.rxLost		= bond->rxLost;
+		if (copy_to_user((void __user *)arg, &info, sizeof(info)))
+			ret = -EFAULT;
+		break;
+
+	default:
+		ret = -ENOIOCTLCMD;
+	}
+	return ret;
+}
+
+
+static const struct tty_operations m77_bond_ops = {
+	.install	= m77_bond_install,
+	.open		= m77_bond_open,
+	.close		= m77_bond_close,
+	.hangup		= m77_bond_hangup,
+	.write		= m77_bond_write,
+	.write_room	= m77_bond_write_room,
+	.ioctl		= m77_bond_ioctl,
+};
+
+
+/*******************************************************************/
+/** Remove the bonded ttys and release their members
+ *
+ * \brief Called before deinit_devices(), the members point to its ports.
+ *
+ * \return 			-
+ */
+static void m77_bond_exit(void)
+{
+	struct m77_bond *bond;
+	unsigned int i;
+
+	if (!G_bondDrv)
+		return;
+
+	for (i = 0; i < BOND_NUM; i++) {
+		bond = G_bond[i];
+		if (!bond)
+			continue;
+		tty_unregister_device(G_bondDrv, i);
+		mutex_lock(&G_bondLock);
+		while (bond->nMembers)
+			m77_bond_del(bond, 0);
+		mutex_unlock(&G_bondLock);
+		cancel_delayed_work_sync(&bond->gapWork);
+		tty_port_destroy(&bond->port);
+		kfree(bond);
+		G_bond[i] = NULL;
+	}
+	tty_unregister_driver(G_bondDrv);
+	tty_driver_kref_put(G_bondDrv);
+	G_bondDrv = NULL;
+}
+
+
+/*******************************************************************/
+/** Register the bonded ttys /dev/ttyDB0..BOND_NUM-1
+ *
+ * \return 			0 or negative error code
+ */
+static int m77_bond_init(void)
+{
+	struct tty_driver *drv;
+	struct m77_bond *bond;
+	struct device *dev;
+	unsigned int i;
+	int ret;
+
+	drv = tty_alloc_driver(BOND_NUM, TTY_DRIVER_REAL_RAW |
+						   TTY_DRIVER_DYNAMIC_DEV);
+	if (IS_ERR(drv))
+		return PTR_ERR(drv);
+
+	drv->driver_name	= "men_bond";
+	drv->name			= BOND_NAME;
+	drv->major			= 0;
+	drv->minor_start	= 0;
+	drv->type			= TTY_DRIVER_TYPE_SERIAL;
+	drv->subtype		= SERIAL_TYPE_NORMAL;
+	drv->init_termios	= tty_std_termios;
+	drv->init_termios.c_cflag = B9600 | CS8 | CREAD | HUPCL | CLOCAL;
+	tty_set_operations(drv, &m77_bond_ops);
+
+	ret = tty_register_driver(drv);
+	if (ret) {
+		tty_driver_kref_put(drv);
+		return ret;
+	}
+	G_bondDrv = drv;
+
+	for (i = 0; i < BOND_NUM; i++) {
+		bond = kzalloc(sizeof(*bond), GFP_KERNEL);
+		if (!bond) {
+			ret = -ENOMEM;
+			goto err;
+		}
+		tty_port_init(&bond->port);
+		bond->port.ops = &m77_bond_port_ops;
+		spin_lock_init(&bond->txLock);
+		spin_lock_init(&bond->rxLock);
+		INIT_DELAYED_WORK(&bond->gapWork, m77_bond_gap_work);
+		G_bond[i] = bond;
+
+		dev = tty_port_register_device(&bond->port, drv, i, NULL);
+		if (IS_ERR(dev)) {
+			ret = PTR_ERR(dev);
+			tty_port_destroy(&bond->port);
+			kfree(bond);
+			G_bond[i] = NULL;
+			goto err;
+		}
+	}
+	return 0;
+
+ err:
+	m77_bond_exit();
+	return ret;
+}
+
+
+
+/*-----------------------------+
+|   NETWORK INTERFACE          |
++-----------------------------*/
+
+/*******************************************************************/
+/** feed one received char into the deframer
+ *
+ * \param net		\IN  network interface, NAPI poll
+ * \param ch		\IN  received char
+ *
+ * \brief Frames are NET_FLAG delimited, NET_ESC escapes the next char
+ *        (xor 0x20) and the last two bytes are the PPP FCS-16.
+ *
+ * \return 			length of a complete, good frame in rxBuf (w/o FCS)
+ *					or 0
+ */
+static unsigned int m77_net_rx_byte(struct m77_net *net, unsigned char ch)
+{
+	struct net_device *dev = net->dev;
+	unsigned int len;
+
+	if (ch == NET_FLAG) {
+		len = net->rxLen;
+		net->rxLen	= 0;
+		net->rxEsc	= 0;
+		if (net->rxDiscard) {
+			net->rxDiscard = 0;
+			return 0;
+		}
+		if (len < 3)			/* back to back flags, idle */
+			return 0;
+		if (crc_ccitt(PPP_INITFCS, net->rxBuf, len) != PPP_GOODFCS) {
+			dev->stats.rx_crc_errors++;
+			dev->stats.rx_errors++;
+			return 0;
+		}
+		return len - 2;
+	}
+
+	if (net->rxDiscard)
+		return 0;
+	if (ch == NET_ESC) {
+		net->rxEsc = 1;
+		return 0;
+	}
+	if (net->rxEsc) {
+		ch ^= 0x20;
+		net->rxEsc = 0;
+	}
+	if (net->rxLen == NET_MAX_FRAME) {
+		dev->stats.rx_length_errors++;
+		dev->stats.rx_errors++;
+		net->rxDiscard = 1;
+		return 0;
+	}
+	net->rxBuf[net->rxLen++] = ch;
+	return 0;
+}
+
+
+/*******************************************************************/
+/** NAPI poll, drains the UART FIFO and passes the frames up
+ *
+ * \param napi		\IN  NAPI context of the interface
+ * \param budget	\IN  max. nr. of frames
+ *
+ * \brief The RX interrupts stay disabled until the FIFO is empty, so a
+ *        busy line is drained in batches without an interrupt per FIFO
+ *        trigger level.
+ *
+ * \return 			nr. of frames received
+ */
+static int m77_net_poll(struct napi_struct *napi, int budget)
+{
+	struct m77_net *net = container_of(napi, struct m77_net, napi);
+	struct ox16c954_port *up = net->up;
+	struct net_device *dev = net->dev;
+	struct sk_buff_head q;
+	struct sk_buff *skb;
+	unsigned char ch, lsr;
+	unsigned int len, max_count = NET_POLL_CHARS;
+	unsigned long flags;
+	int work = 0;
+
+	__skb_queue_head_init(&q);
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	if (up->net != net) {		/* detached, the UART is not ours */
+		spin_unlock_irqrestore(&up->port.lock, flags);
+		napi_complete_done(napi, 0);
+		return 0;
+	}
+	lsr = serial_in(up, UART_LSR);
+	while ((lsr & UART_LSR_DR) && work < budget && max_count--) {
+		ch = serial_in(up, UART_RX);
+		m77_tap_char(up, M77_TAP_RX, ch, lsr);
+		up->port.icount.rx++;
+
+		if (unlikely(lsr & (UART_LSR_BI | UART_LSR_PE |
+							UART_LSR_FE | UART_LSR_OE))) {
+			m77_count_lsr_errors(up, lsr);
+			/* the frame is broken, drop it up to the next flag */
+			if (!net->rxDiscard) {
+				dev->stats.rx_frame_errors++;
+				dev->stats.rx_errors++;
+			}
+			net->rxDiscard = 1;
+			if (lsr & (UART_LSR_BI | UART_LSR_PE | UART_LSR_FE))
+				goto ignore_char;
+		}
+
+		len = m77_net_rx_byte(net, ch);
+		if (len) {
+			skb = napi_alloc_skb(napi, len);
+			if (skb) {
+				skb_put_data(skb, net->rxBuf, len);
+				__skb_queue_tail(&q, skb);
+				work++;
+			} else {
+				dev->stats.rx_dropped++;
+			}
+		}
+
+	ignore_char:
+		lsr = serial_in(up, UART_LSR);
+	}
+	m77_tap_flush(up, M77_TAP_RX);
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	while ((skb = __skb_dequeue(&q))) {
+		switch (skb->data[0] & 0xf0) {
+		case 0x40:
+			skb->protocol = htons(ETH_P_IP);
+			break;
+		case 0x60:
+			skb->protocol = htons(ETH_P_IPV6);
+			break;
+		default:
+			dev->stats.rx_errors++;
+			kfree_skb(skb);
+			continue;
+		}
+		skb_reset_mac_header(skb);
+		dev->stats.rx_packets++;
+		dev->stats.rx_bytes += skb->len;
+		netif_receive_skb(skb);
+	}
+
+	if (work < budget && napi_complete_done(napi, work)) {
+		spin_lock_irqsave(&up->port.lock, flags);
+		if (up->net == net && up->opened) {
+			up->hot->ier |= UART_IER_RLSI | UART_IER_RDI;
+			serial_out(up, UART_IER, up->hot->ier);
+		}
+		spin_unlock_irqrestore(&up->port.lock, flags);
+	}
+	return work;
+}
+
+
+/*******************************************************************/
+/** put one char into the xmit buffer, escaped if needed
+ */
+static inline void m77_net_put(struct circ_buf *xmit, unsigned char ch,
+							   int esc)
+{
+	if (esc && (ch == NET_FLAG || ch == NET_ESC ||
+				ch == M77_XON_CHAR || ch == M77_XOFF_CHAR)) {
+		xmit->buf[xmit->head] = NET_ESC;
+		xmit->head = (xmit->head + 1) & (UART_XMIT_SIZE - 1);
+		ch ^= 0x20;
+	}
+	xmit->buf[xmit->head] = ch;
+	xmit->head = (xmit->head + 1) & (UART_XMIT_SIZE - 1);
+}
+
+
+/*******************************************************************/
+/** ndo_start_xmit: frame the packet into the xmit buffer of the line
+ *
+ * \brief The queue is stopped while the buffer cannot take a frame of
+ *        maximum size, transmit_chars() wakes it. If data written to the
+ *        ttyD filled the buffer meanwhile, the packet is dropped.
+ */
+static netdev_tx_t m77_net_xmit(struct sk_buff *skb, struct net_device *dev)
+{
+	struct m77_net *net = netdev_priv(dev);
+	struct ox16c954_port *up = net->up;
+	struct circ_buf *xmit = &up->port.state->xmit;
+	unsigned long flags;
+	unsigned int i;
+	u16 fcs;
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	if (up->net != net || !up->opened || !xmit->buf ||
+		CIRC_SPACE(xmit->head, xmit->tail, UART_XMIT_SIZE) < NET_TX_ROOM) {
+		if (up->net == net && up->opened)
+			netif_stop_queue(dev);
+		spin_unlock_irqrestore(&up->port.lock, flags);
+		dev->stats.tx_dropped++;
+		dev_kfree_skb_any(skb);
+		return NETDEV_TX_OK;
+	}
+
+	fcs = ~crc_ccitt(PPP_INITFCS, skb->data, skb->len);
+	m77_net_put(xmit, NET_FLAG, 0);
+	for (i = 0; i < skb->len; i++)
+		m77_net_put(xmit, skb->data[i], 1);
+	m77_net_put(xmit, fcs & 0xff, 1);
+	m77_net_put(xmit, fcs >> 8, 1);
+	m77_net_put(xmit, NET_FLAG, 0);
+	men_uart_start_tx(&up->port);
+
+	if (CIRC_SPACE(xmit->head, xmit->tail, UART_XMIT_SIZE) < NET_TX_ROOM)
+		netif_stop_queue(dev);
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	dev->stats.tx_packets++;
+	dev->stats.tx_bytes += skb->len;
+	dev_consume_skb_any(skb);
+	return NETDEV_TX_OK;
+}
+
+
+/*******************************************************************/
+/** ndo_open: start with an empty deframer, let the UART interrupt again
+ */
+static int m77_net_open(struct net_device *dev)
+{
+	struct m77_net *net = netdev_priv(dev);
+	struct ox16c954_port *up = net->up;
+	unsigned long flags;
+
+	net->rxLen		= 0;
+	net->rxEsc		= 0;
+	net->rxDiscard	= 1;		/* sync to the first flag */
+	napi_enable(&net->napi);
+	netif_start_queue(dev);
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	if (up->net == net && up->opened) {
+		up->hot->ier |= UART_IER_RLSI | UART_IER_RDI;
+		serial_out(up, UART_IER, up->hot->ier);
+	}
+	spin_unlock_irqrestore(&up->port.lock, flags);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** ndo_stop
+ */
+static int m77_net_stop(struct net_device *dev)
+{
+	struct m77_net *net = netdev_priv(dev);
+
+	netif_stop_queue(dev);
+	napi_disable(&net->napi);
+	return 0;
+}
+
+
+static const struct net_device_ops m77_net_ops = {
+	.ndo_open		= m77_net_open,
+	.ndo_stop		= m77_net_stop,
+	.ndo_start_xmit	= m77_net_xmit,
+};
+
+
+/*******************************************************************/
+/** alloc_netdev() setup: point to point link carrying IP packets
+ */
+static void m77_net_setup(struct net_device *dev)
+{
+	dev->netdev_ops			= &m77_net_ops;
+	dev->type				= ARPHRD_NONE;
+	dev->hard_header_len	= 0;
+	dev->addr_len			= 0;
+	dev->mtu				= NET_MTU;
+	dev->min_mtu			= 68;
+	dev->max_mtu			= NET_MTU;
+	dev->tx_queue_len		= 10;
+	dev->flags				= IFF_POINTOPOINT | IFF_NOARP;
+}
+
+
+/*******************************************************************/
+/** Register a network interface for a ttyD line
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct, tty port mutex held
+ * \param arg		\IN  M77_NET_xxx flags
+ *
+ * \brief The received data of the line goes to the interface from now
+ *        on, so RX stays off until the interface is brought up.
+ *
+ * \return 			0 or negative error code
+ */
+static int m77_net_attach(struct ox16c954_port *up, unsigned long arg)
+{
+	struct net_device *dev;
+	struct m77_net *net;
+	unsigned long flags;
+	int ret;
+
+	/* also while the last interface of the line is being removed */
+	if (m77_port_claimed(up) || READ_ONCE(up->netGone))
+		return -EBUSY;
+
+	dev = alloc_netdev(sizeof(*net), NET_NAME, NET_NAME_UNKNOWN,
+					   m77_net_setup);
+	if (!dev)
+		return -ENOMEM;
+
+	net = netdev_priv(dev);
+	net->dev	= dev;
+	net->up		= up;
+	net->loop	= !!(arg & M77_NET_LOOPBACK);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,1,0)
+	netif_napi_add(dev, &net->napi, m77_net_poll);
+#else
+	netif_napi_add(dev, &net->napi, m77_net_poll, NAPI_POLL_WEIGHT);
+#endif
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	up->net = net;
+	if (net->loop) {
+		up->port.mctrl |= TIOCM_LOOP;
+		men_uart_set_mctrl(&up->port, up->port.mctrl);
+	}
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	ret = register_netdev(dev);
+	if (ret) {
+		m77_net_release(up);
+		netif_napi_del(&net->napi);
+		free_netdev(dev);
+		return ret;
+	}
+
+	printk(KERN_INFO "ttyD%d: network interface %s%s\n", up->port.line,
+		   dev->name, net->loop ? " (MCR loopback)" : "");
+	return 0;
+}
+
+
+/*******************************************************************/
+/** Give the line back to the ttyD
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct
+ *
+ * \brief The interface is not touched, a xmit or NAPI poll running on it
+ *        sees up->net changed and leaves the UART alone.
+ *
+ * \return 			-
+ */
+static void m77_net_release(struct ox16c954_port *up)
+{
+	struct m77_net *net = up->net;
+	unsigned long flags;
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	up->net = NULL;
+	if (net->loop) {
+		up->port.mctrl &= ~TIOCM_LOOP;
+		men_uart_set_mctrl(&up->port, up->port.mctrl);
+	}
+	if (up->opened) {
+		up->hot->ier |= UART_IER_RLSI | UART_IER_RDI;
+		serial_out(up, UART_IER, up->hot->ier);
+	}
+	spin_unlock_irqrestore(&up->port.lock, flags);
+}
+
+
+/*******************************************************************/
+/** Unregister and free the interface detached from a line
+ *
+ * \brief Runs without the tty port mutex, unregister_netdev() takes the
+ *        RTNL lock and waits for the interface to go down.
+ */
+static void m77_net_gone_work(struct work_struct *work)
+{
+	struct ox16c954_port *up =
+		container_of(work, struct ox16c954_port, netWork);
+	struct m77_net *net = up->netGone;
+
+	unregister_netdev(net->dev);
+	netif_napi_del(&net->napi);
+	free_netdev(net->dev);
+	WRITE_ONCE(up->netGone, NULL);
+}
+
+
+/*******************************************************************/
+/** Remove the network interface of a ttyD line, if any
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct, tty port mutex held
+ *
+ * \brief The line is given back at once, the interface is unregistered
+ *        by m77_net_gone_work() outside of the tty port mutex.
+ *
+ * \return 			-
+ */
+static void m77_net_detach(struct ox16c954_port *up)
+{
+	struct m77_net *net = up->net;
+
+	if (!net)
+		return;
+
+	m77_net_release(up);
+	up->netGone = net;
+	schedule_work(&up->netWork);
+}
+
+
+
+/*-----------------------------+
+|   SERDEV CONTROLLER          |
++-----------------------------*/
+
+/*******************************************************************/
+/** pass the received data to the serdev consumer
+ *
+ * \brief Runs in process context, consumers may sleep in receive_buf.
+ *        What the consumer does not take stays in the ring until the
+ *        next chars are received.
+ */
+static void m77_serdev_rx_work(struct work_struct *work)
+{
+	struct m77_serdev *sd = container_of(work, struct m77_serdev, rxWork);
+	unsigned int head = smp_load_acquire(&sd->rxHead);
+	unsigned int tail = sd->rxTail, n;
+
+	while (head != tail) {
+		n = min(head - tail, SERDEV_RX_SIZE - (tail & (SERDEV_RX_SIZE - 1)));
+		n = serdev_controller_receive_buf(sd->ctrl,
+										  sd->rx + (tail & (SERDEV_RX_SIZE - 1)),
+										  n);
+		if (!n)
+			break;
+		tail += n;
+		smp_store_release(&sd->rxTail, tail);
+		head = smp_load_acquire(&sd->rxHead);
+	}
+}
+
+
+/*******************************************************************/
+/** serdev open: take the UART from the ttyD and start it
+ *
+ * \return 			0 or -EBUSY if the ttyD is open or another mode
+ *					(raw, mux, bridge, bond, net) has the line
+ */
+static int m77_serdev_open(struct serdev_controller *ctrl)
+{
+	struct m77_serdev *sd = serdev_controller_get_drvdata(ctrl);
+	struct ox16c954_port *up = sd->up;
+	unsigned long flags;
+	char *buf;
+
+	buf = kmalloc(UART_XMIT_SIZE, GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	if (test_and_set_bit(0, &up->inUse)) {
+		kfree(buf);
+		return -EBUSY;
+	}
+
+	sd->xmit.buf	= buf;
+	sd->xmit.head	= 0;
+	sd->xmit.tail	= 0;
+	sd->rxHead		= 0;
+	sd->rxTail		= 0;
+
+	/* e.g. /dev/m77raw<line> has the received data */
+	spin_lock_irqsave(&up->port.lock, flags);
+	if (m77_port_claimed(up)) {
+		sd->xmit.buf = NULL;
+		spin_unlock_irqrestore(&up->port.lock, flags);
+		clear_bit(0, &up->inUse);
+		kfree(buf);
+		return -EBUSY;
+	}
+	up->serdev = sd;
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	men_uart_hw_startup(up);
+	men_uart_set_termios(&up->port, &sd->termios, NULL);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** serdev close: stop the UART, the ttyD may be opened again
+ */
+static void m77_serdev_close(struct serdev_controller *ctrl)
+{
+	struct m77_serdev *sd = serdev_controller_get_drvdata(ctrl);
+	struct ox16c954_port *up = sd->up;
+	unsigned long flags;
+	char *buf;
+
+	men_uart_hw_shutdown(up);
+	cancel_work_sync(&sd->rxWork);
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	up->serdev	= NULL;
+	buf			= sd->xmit.buf;
+	sd->xmit.buf = NULL;
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	kfree(buf);
+	clear_bit(0, &up->inUse);
+}
+
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,8,0)
+static ssize_t m77_serdev_write_buf(struct serdev_controller *ctrl,
+									const u8 *data, size_t count)
+#else
+static int m77_serdev_write_buf(struct serdev_controller *ctrl,
+								const unsigned char *data, size_t count)
+#endif
+{
+	struct m77_serdev *sd = serdev_controller_get_drvdata(ctrl);
+	struct ox16c954_port *up = sd->up;
+	struct circ_buf *xmit = &sd->xmit;
+	unsigned long flags;
+	int c, ret = 0;
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	while (count) {
+		c = CIRC_SPACE_TO_END(xmit->head, xmit->tail, UART_XMIT_SIZE);
+		if (count < c)
+			c = count;
+		if (c <= 0)
+			break;
+		memcpy(xmit->buf + xmit->head, data, c);
+		xmit->head = (xmit->head + c) & (UART_XMIT_SIZE - 1);
+		data	+= c;
+		count	-= c;
+		ret		+= c;
+	}
+	if (ret)
+		men_uart_start_tx(&up->port);
+	spin_unlock_irqrestore(&up->port.lock, flags);
+	return ret;
+}
+
+
+static int m77_serdev_write_room(struct serdev_controller *ctrl)
+{
+	struct m77_serdev *sd = serdev_controller_get_drvdata(ctrl);
+	unsigned long flags;
+	int ret;
+
+	spin_lock_irqsave(&sd->up->port.lock, flags);
+	ret = uart_circ_chars_free(&sd->xmit);
+	spin_unlock_irqrestore(&sd->up->port.lock, flags);
+	return ret;
+}
+
+
+static void m77_serdev_write_flush(struct serdev_controller *ctrl)
+{
+	struct m77_serdev *sd = serdev_controller_get_drvdata(ctrl);
+	unsigned long flags;
+
+	spin_lock_irqsave(&sd->up->port.lock, flags);
+	sd->xmit.head = sd->xmit.tail = 0;
+	spin_unlock_irqrestore(&sd->up->port.lock, flags);
+}
+
+
+static void m77_serdev_wait_until_sent(struct serdev_controller *ctrl,
+									   long timeout)
+{
+	struct m77_serdev *sd = serdev_controller_get_drvdata(ctrl);
+	unsigned long end = jiffies + timeout;
+
+	while (READ_ONCE(sd->xmit.head) != READ_ONCE(sd->xmit.tail) ||
+		   !men_uart_tx_empty(&sd->up->port)) {
+		if (timeout && time_after(jiffies, end))
+			break;
+		msleep(1);
+	}
+}
+
+
+/*******************************************************************/
+/** apply the line settings of the consumer
+ */
+static void m77_serdev_apply(struct m77_serdev *sd)
+{
+	if (test_bit(0, &sd->up->inUse) && sd->up->serdev == sd)
+		men_uart_set_termios(&sd->up->port, &sd->termios, NULL);
+}
+
+
+static unsigned int m77_serdev_set_baudrate(struct serdev_controller *ctrl,
+											unsigned int speed)
+{
+	struct m77_serdev *sd = serdev_controller_get_drvdata(ctrl);
+
+	tty_termios_encode_baud_rate(&sd->termios, speed, speed);
+	m77_serdev_apply(sd);
+	return tty_termios_baud_rate(&sd->termios);
+}
+
+
+static void m77_serdev_set_flow_control(struct serdev_controller *ctrl,
+										bool enable)
+{
+	struct m77_serdev *sd = serdev_controller_get_drvdata(ctrl);
+
+	if (enable)
+		sd->termios.c_cflag |= CRTSCTS;
+	else
+		sd->termios.c_cflag &= ~CRTSCTS;
+	m77_serdev_apply(sd);
+}
+
+
+static int m77_serdev_set_parity(struct serdev_controller *ctrl,
+								 enum serdev_parity parity)
+{
+	struct m77_serdev *sd = serdev_controller_get_drvdata(ctrl);
+
+	sd->termios.c_cflag &= ~(PARENB | PARODD);
+	if (parity != SERDEV_PARITY_NONE)
+		sd->termios.c_cflag |= PARENB;
+	if (parity == SERDEV_PARITY_ODD)
+		sd->termios.c_cflag |= PARODD;
+	m77_serdev_apply(sd);
+	return 0;
+}
+
+
+static int m77_serdev_get_tiocm(struct serdev_controller *ctrl)
+{
+	struct m77_serdev *sd = serdev_controller_get_drvdata(ctrl);
+	struct uart_port *port = &sd->up->port;
+	unsigned long flags;
+	int ret;
+
+	spin_lock_irqsave(&port->lock, flags);
+	ret = port->mctrl | men_uart_get_mctrl(port);
+	spin_unlock_irqrestore(&port->lock, flags);
+	return ret;
+}
+
+
+static int m77_serdev_set_tiocm(struct serdev_controller *ctrl,
+								unsigned int set, unsigned int clear)
+{
+	struct m77_serdev *sd = serdev_controller_get_drvdata(ctrl);
+	struct uart_port *port = &sd->up->port;
+	unsigned long flags;
+
+	spin_lock_irqsave(&port->lock, flags);
+	port->mctrl = (port->mctrl & ~clear) | set;
+	men_uart_set_mctrl(port, port->mctrl);
+	spin_unlock_irqrestore(&port->lock, flags);
+	return 0;
+}
+
+
+static const struct serdev_controller_ops m77_serdev_ops = {
+	.write_buf			= m77_serdev_write_buf,
+	.write_flush		= m77_serdev_write_flush,
+	.write_room			= m77_serdev_write_room,
+	.open				= m77_serdev_open,
+	.close				= m77_serdev_close,
+	.set_flow_control	= m77_serdev_set_flow_control,
+	.set_parity			= m77_serdev_set_parity,
+	.set_baudrate		= m77_serdev_set_baudrate,
+	.wait_until_sent	= m77_serdev_wait_until_sent,
+	.get_tiocm			= m77_serdev_get_tiocm,
+	.set_tiocm			= m77_serdev_set_tiocm,
+};
+
+
+/*******************************************************************/
+/** Register a serdev controller for a ttyD line, if serdevNode names
+ *  a device tree node for it
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct, registered
+ *
+ * \brief The children of the node are the serdev devices, their drivers
+ *        bind as usual. A missing node or controller is reported, the
+ *        line stays a plain ttyD then.
+ *
+ * \return 			0 or negative error code
+ */
+static int m77_serdev_add(struct ox16c954_port *up)
+{
+	struct serdev_controller *ctrl;
+	struct device_node *np;
+	struct m77_serdev *sd;
+	const char *path;
+	int ret;
+
+	if (up->port.line >= serdevNode.num)
+		return 0;
+	path = serdevNode.str[up->port.line];
+	if (!path || !*path || !strcmp(path, "-"))
+		return 0;
+
+	np = of_find_node_by_path(path);
+	if (!np) {
+		printk(KERN_ERR "*** ttyD%d: serdev node %s not found\n",
+			   up->port.line, path);
+		return 0;
+	}
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,8,0)
+	ctrl = serdev_controller_alloc(up->rawDev, up->rawDev, sizeof(*sd));
+#else
+	ctrl = serdev_controller_alloc(up->rawDev, sizeof(*sd));
+#endif
+	if (!ctrl) {
+		of_node_put(np);
+		return -ENOMEM;
+	}
+	ctrl->dev.of_node	= np;
+	ctrl->ops			= &m77_serdev_ops;
+
+	sd = serdev_controller_get_drvdata(ctrl);
+	sd->ctrl	= ctrl;
+	sd->up		= up;
+	sd->termios	= tty_std_termios;
+	sd->termios.c_cflag = B9600 | CS8 | CREAD | HUPCL | CLOCAL;
+	sd->termios.c_ispeed = sd->termios.c_ospeed = 9600;
+	INIT_WORK(&sd->rxWork, m77_serdev_rx_work);
+
+	ret = serdev_controller_add(ctrl);
+	if (ret) {
+		printk(KERN_ERR "*** ttyD%d: serdev_controller_add returned %d\n",
+			   up->port.line, ret);
+		serdev_controller_put(ctrl);
+		of_node_put(np);
+		return 0;
+	}
+
+	up->sdCtrl = ctrl;
+	printk(KERN_INFO "ttyD%d: serdev controller %s for %s\n",
+		   up->port.line, dev_name(&ctrl->dev), path);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** Remove the serdev controller of a ttyD line, its devices are unbound
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct
+ *
+ * \return 			-
+ */
+static void m77_serdev_remove(struct ox16c954_port *up)
+{
+	struct serdev_controller *ctrl = up->sdCtrl;
+	struct device_node *np;
+
+	if (!ctrl)
+		return;
+
+	np = ctrl->dev.of_node;
+	serdev_controller_remove(ctrl);
+	serdev_controller_put(ctrl);
+	of_node_put(np);
+	up->sdCtrl = NULL;
+}
+
+
+
+/*-----------------------------+
+|   RX FILTER (BPF)            |
++-----------------------------*/
+
+/*******************************************************************/
+/** Release a filter detached from its port
+ */
+static void m77_bpf_free(struct m77_bpf *bpf)
+{
+	if (!bpf)
+		return;
+
+	bpf_prog_put(bpf->prog);
+	kfree_skb(bpf->skb);
+	kfree(bpf);
+}
+
+
+/*******************************************************************/
+/** Attach a BPF program to the RX path of a ttyD line
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct
+ * \param fd		\IN  fd of a BPF_PROG_TYPE_SOCKET_FILTER program,
+ *						 -1: detach
+ *
+ * \brief Called with the tty port mutex held, like men_uart_shutdown().
+ *        The ISR drops the port lock while it redirects a block from
+ *        bpf->redir, so the old filter is released after
+ *        synchronize_rcu(), i.e. after the running ISRs. Attaching needs
+ *        CAP_NET_ADMIN or CAP_SYS_ADMIN, the filter sees and redirects
+ *        all data of the line.
+ *
+ * \return 			0 or negative error number
+ */
+static int m77_bpf_attach(struct ox16c954_port *up, int fd)
+{
+	struct m77_bpf *bpf = NULL, *old;
+	unsigned long flags;
+	int ret;
+
+	if (fd >= 0) {
+		if (!capable(CAP_NET_ADMIN) && !capable(CAP_SYS_ADMIN))
+			return -EPERM;
+
+		bpf = kzalloc(sizeof(*bpf), GFP_KERNEL);
+		if (!bpf)
+			return -ENOMEM;
+
+		bpf->skb = alloc_skb(BPF_BLOCK, GFP_KERNEL);
+		if (!bpf->skb) {
+			kfree(bpf);
+			return -ENOMEM;
+		}
+
+		bpf->prog = bpf_prog_get_type(fd, BPF_PROG_TYPE_SOCKET_FILTER);
+		if (IS_ERR(bpf->prog)) {
+			ret = PTR_ERR(bpf->prog);
+			kfree_skb(bpf->skb);
+			kfree(bpf);
+			return ret;
+		}
+	}
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	old = up->bpf;
+	up->bpf = bpf;
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	/* hard IRQ handlers are RCU readers */
+	if (old)
+		synchronize_rcu();
+	m77_bpf_free(old);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** Return the counters of the attached filter
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct
+ * \param arg		\IN  user pointer to struct m77_bpf_stats
+ *
+ * \return 			0 or negative error number
+ */
+static int m77_bpf_stats(struct ox16c954_port *up, unsigned long arg)
+{
+	struct m77_bpf_stats st;
+	unsigned long flags;
+	int ret = -ENOENT;
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	if (up->bpf) {
+		st	= up->bpf->stats;
+		ret	= 0;
+	}
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	if (ret)
+		return ret;
+
+	return copy_to_user((void __user *)arg, &st, sizeof(st)) ? -EFAULT : 0;
+}
+
+
+
+/*-----------------------------+
+|   USER MODE (UIO)            |
++-----------------------------*/
+
+/*******************************************************************/
+/** UIO irqcontrol, called on write() of an int to /dev/uio<n>
+ *
+ * \param info		\IN  uio_info of the M-Module
+ * \param on		\IN  0: mask, 1: unmask the M-Module interrupt
+ *
+ * \return 			0
+ */
+static int m77_uio_irqcontrol(struct uio_info *info, s32 on)
+{
+	m77_uio_irq_mask(info->priv, on);
+	return 0;
+}
+
+/*******************************************************************/
+/** UIO mmap of map 0, the page holding the M-Module register window
+ *
+ * \param info		\IN  uio_info of the M-Module
+ * \param vma		\IN  mapping of map 0, one page
+ *
+ * \brief Map 0 is smaller than a page, which the generic UIO mmap
+ *        refuses. The MMU can't map less than the page anyway.
+ *
+ * \return 			0 or negative error code
+ */
+static int m77_uio_mmap(struct uio_info *info, struct vm_area_struct *vma)
+{
+	if (vma->vm_pgoff || vma->vm_end - vma->vm_start != PAGE_SIZE)
+		return -EINVAL;
+
+	vma->vm_page_prot = pgprot_noncached(vma->vm_page_prot);
+	return io_remap_pfn_range(vma, vma->vm_start,
+							  info->mem[0].addr >> PAGE_SHIFT, PAGE_SIZE,
+							  vma->vm_page_prot);
+}
+
+/*******************************************************************/
+/** Export an M-Module to user space as /dev/uio<n>
+ *
+ * \param mmod		\IN  opened M-Module, IRQ installed
+ *
+ * \brief Map 0 is the M-Module register window, UIO_WINDOW_SIZE bytes
+ *        at maps/map0/offset in the page mapped by mmap(). The UIO name
+ *        is the MDIS device name, e.g. "m77_1". The M77 PHY modes are
+ *        set from the mode/echo parameters, the UARTs are left with all
+ *        interrupt sources off, the M-Module interrupt masked.
+ *
+ * \return 			0 or negative error code
+ */
+static int m77_uio_add(UARTMOD_INFO *mmod)
+{
+	struct uio_info *info;
+	struct device *dev;
+	unsigned int i;
+	char *base;
+	int ret;
+
+	/* the ioremapped window is resolved to its physical page */
+	if (!is_vmalloc_addr(mmod->memBase) ||
+		offset_in_page(mmod->memBase) + UIO_WINDOW_SIZE > PAGE_SIZE) {
+		printk(KERN_ERR "*** %s: register window can't be mapped\n",
+			   mmod->deviceName);
+		return -ENXIO;
+	}
+
+	info = kzalloc(sizeof(*info), GFP_KERNEL);
+	if (!info)
+		return -ENOMEM;
+
+	dev = device_create(G_rawClass, NULL, MKDEV(0, 0), mmod,
+						UIO_NAME_PREFIX "%u", mmod->modnum);
+	if (IS_ERR(dev)) {
+		kfree(info);
+		return PTR_ERR(dev);
+	}
+
+	info->name				= mmod->deviceName;
+	info->version			= IdentString;
+	info->irq				= UIO_IRQ_CUSTOM;
+	info->irqcontrol		= m77_uio_irqcontrol;
+	info->mmap				= m77_uio_mmap;
+	info->priv				= mmod;
+	info->mem[0].name		= "regs";
+	info->mem[0].memtype	= UIO_MEM_PHYS;
+	info->mem[0].addr		= PFN_PHYS(vmalloc_to_pfn(mmod->memBase));
+	info->mem[0].offs		= offset_in_page(mmod->memBase);
+	info->mem[0].size		= UIO_WINDOW_SIZE;
+
+	for (i = 0; i < mmod->nrChannels; i++) {
+		base = (char *)mmod->memBase + (0x10 * i);
+		if ((mmod->modtype == MOD_M45) && (i > 3))
+			base += 0x40;
+		MWRITE_D16(base, UART_IER << 1, 0);
+		m77_phy_setup(mmod, i);
+	}
+	m77_uio_irq_mask(mmod, 0);
+
+	ret = uio_register_device(dev, info);
+	if (ret) {
+		printk(KERN_ERR "*** %s: uio_register_device failed: %d\n",
+			   mmod->deviceName, ret);
+		device_unregister(dev);
+		kfree(info);
+		return ret;
+	}
+
+	mmod->uioDev = dev;
+	/* pairs with smp_load_acquire() in M77_IrqHandler() */
+	smp_store_release(&mmod->uio, info);
+	return 0;
+}
+
+/*******************************************************************/
+/** Remove /dev/uio<n> of a user mode M-Module
+ *
+ * \param mmod		\IN  M-Module
+ *
+ * \return 			-
+ */
+static void m77_uio_remove(UARTMOD_INFO *mmod)
+{
+	struct uio_info *info = mmod->uio;
+
+	if (!info)
+		return;
+
+	WRITE_ONCE(mmod->uio, NULL);	/* ISR ignores the M-Module now */
+	m77_uio_irq_mask(mmod, 0);
+	synchronize_rcu();				/* no ISR still notifies info */
+	uio_unregister_device(info);
+	device_unregister(mmod->uioDev);
+	mmod->uioDev = NULL;
+	kfree(info);
+}
+
+
+/*-----------------------------+
+|   TRAFFIC TAP                |
++-----------------------------*/
+
+/*******************************************************************/
+/** Attach a tap reader to a ttyD line
+ *
+ * \param rd		\IN  reader of /dev/m77tap, not attached
+ * \param line		\IN  ttyD line
+ *
+ * \brief The tap ring of the port is allocated by the first reader.
+ *        The reader starts with the next record written.
+ *
+ * \return 			0 or negative error code
+ */
+static int m77_tap_attach(struct m77_tap_reader *rd, unsigned int line)
+{
+	struct ox16c954_port *up = m77_find_port(line);
+	struct m77_tap *tap;
+	unsigned long flags;
+
+	if (!up)
+		return -ENODEV;
+
+	mutex_lock(&up->mod->lock);
+	tap = up->tap;
+	if (!tap) {
+		tap = kzalloc(sizeof(*tap), GFP_KERNEL);
+		if (tap)
+			tap->slots = vmalloc(TAP_NSLOTS * sizeof(struct m77_tap_rec));
+		if (!tap || !tap->slots) {
+			kfree(tap);
+			mutex_unlock(&up->mod->lock);
+			return -ENOMEM;
+		}
+		spin_lock_init(&tap->lock);
+		init_waitqueue_head(&tap->wait);
+
+		spin_lock_irqsave(&up->port.lock, flags);
+		up->tap = tap;
+		spin_unlock_irqrestore(&up->port.lock, flags);
+	}
+	tap->readers++;
+
+	spin_lock_irqsave(&tap->lock, flags);
+	rd->seq = tap->seq;
+	spin_unlock_irqrestore(&tap->lock, flags);
+	rd->up	= up;
+	rd->tap	= tap;
+	mutex_unlock(&up->mod->lock);
+
+	static_branch_inc(&m77_tap_key);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** Detach a tap reader, the last one frees the tap ring
+ *
+ * \param rd		\IN  reader of /dev/m77tap
+ *
+ * \return 			-
+ */
+static void m77_tap_detach(struct m77_tap_reader *rd)
+{
+	struct ox16c954_port *up = rd->up;
+	struct m77_tap *tap = rd->tap;
+	unsigned long flags;
+
+	if (!up)
+		return;
+
+	mutex_lock(&up->mod->lock);
+	if (--tap->readers == 0) {
+		/* the ISR uses up->tap under the port lock only */
+		spin_lock_irqsave(&up->port.lock, flags);
+		up->tap = NULL;
+		spin_unlock_irqrestore(&up->port.lock, flags);
+		vfree(tap->slots);
+		kfree(tap);
+	}
+	mutex_unlock(&up->mod->lock);
+
+	static_branch_dec(&m77_tap_key);
+	rd->up	= NULL;
+	rd->tap	= NULL;
+}
+
+
+/*******************************************************************/
+/** open /dev/m77tap, any number of readers
+ */
+static int m77_tap_open(struct inode *inode, struct file *file)
+{
+	struct m77_tap_reader *rd;
+
+	rd = kzalloc(sizeof(*rd), GFP_KERNEL);
+	if (!rd)
+		return -ENOMEM;
+
+	mutex_init(&rd->lock);
+	file->private_data = rd;
+	return nonseekable_open(inode, file);
+}
+
+
+/*******************************************************************/
+/** release /dev/m77tap
+ */
+static int m77_tap_release(struct inode *inode, struct file *file)
+{
+	struct m77_tap_reader *rd = file->private_data;
+
+	m77_tap_detach(rd);
+	mutex_destroy(&rd->lock);
+	kfree(rd);
+	return 0;
+}
+
+
+/*******************************************************************/
+/** read tap records of the attached line
+ *
+ * \brief Returns an array of struct m77_tap_rec. If the reader was too
+ *        slow, the oldest records were overwritten, seen as a gap in seq.
+ *
+ * \return 			nr. of bytes read or negative error code
+ */
+static ssize_t m77_tap_read(struct file *file, char __user *ubuf,
+							size_t count, loff_t *ppos)
+{
+	struct m77_tap_reader *rd = file->private_data;
+	struct m77_tap *tap;
+	unsigned int n, i, seq;
+	unsigned long flags;
+	ssize_t ret;
+
+	n = min_t(size_t, count / sizeof(struct m77_tap_rec), TAP_READ_BATCH);
+	if (!n)
+		return -EINVAL;
+
+	if (mutex_lock_interruptible(&rd->lock))
+		return -ERESTARTSYS;
+
+	tap = rd->tap;
+	if (!tap) {
+		ret = -ENODEV;		/* M77_TAP_ATTACH first */
+		goto out;
+	}
+
+	if (file->f_flags & O_NONBLOCK) {
+		if (READ_ONCE(tap->seq) == rd->seq) {
+			ret = -EAGAIN;
+			goto out;
+		}
+	} else if (wait_event_interruptible(tap->wait,
+										READ_ONCE(tap->seq) != rd->seq)) {
+		ret = -ERESTARTSYS;
+		goto out;
+	}
+
+	spin_lock_irqsave(&tap->lock, flags);
+	seq = rd->seq;
+	if (tap->seq - seq > TAP_NSLOTS)
+		seq = tap->seq - TAP_NSLOTS;	/* overwritten, skip ahead */
+	n = min_t(unsigned int, n, tap->seq - seq);
+	for (i = 0; i < n; i++)
+		rd->bounce[i] = tap->slots[(seq + i) & (TAP_NSLOTS - 1)];
+	rd->seq = seq + n;
+	spin_unlock_irqrestore(&tap->lock, flags);
+
+	ret = n * sizeof(struct m77_tap_rec);
+	if (copy_to_user(ubuf, rd->bounce, ret))
+		ret = -EFAULT;
+ out:
+	mutex_unlock(&rd->lock);
+	return ret;
+}
+
+
+/*******************************************************************/
+/** poll for tap records
+ */
+static unsigned int m77_tap_poll(struct file *file, poll_table *wait)
+{
+	struct m77_tap_reader *rd = file->private_data;
+	struct m77_tap *tap = rd->tap;
+
+	if (!tap)
+		return POLLERR;
+
+	poll_wait(file, &tap->wait, wait);
+	if (READ_ONCE(tap->seq) != READ_ONCE(rd->seq))
+		return POLLIN | POLLRDNORM;
+	return 0;
+}
+
+
+/*******************************************************************/
+/** /dev/m77tap ioctl, M77_TAP_ATTACH selects the line to monitor
+ */
+static long m77_tap_ioctl(struct file *file, unsigned int cmd,
+						  unsigned long arg)
+{
+	struct m77_tap_reader *rd = file->private_data;
+	long ret;
+
+	switch (cmd) {
+	case M77_TAP_ATTACH:
+		mutex_lock(&rd->lock);
+		m77_tap_detach(rd);
+		ret = m77_tap_attach(rd, arg);
+		mutex_unlock(&rd->lock);
+		return ret;
+	}
+	return -ENOTTY;
 }
 
 
+static const struct file_operations m77_tap_fops = {
+	.owner			= THIS_MODULE,
+	.open			= m77_tap_open,
+	.release		= m77_tap_release,
+	.read			= m77_tap_read,
+	.poll			= m77_tap_poll,
+	.unlocked_ioctl	= m77_tap_ioctl,
+	.compat_ioctl	= m77_tap_ioctl,
+};
 
-/******************************************************************************/
-/** function to set changed tty settings
+static struct miscdevice G_tapDev = {
+	.minor	= MISC_DYNAMIC_MINOR,
+	.name	= TAP_NAME,
+	.fops	= &m77_tap_fops,
+};
+
+
+
+/*******************************************************************/
+/** Register /dev/m77mux, /dev/m77tap and /dev/m77ctl
  *
- * \param port			\IN 	highlevel UART Port Struct
- * \param termios		\IN 	termios struct with new settings
- * \param old			\IN 	termios struct to keep old settings(?)
+ * \return 			0 or negative error code
+ */
+static int m77_mux_init(void)
+{
+	int ret;
+
+	spin_lock_init(&G_mux.lock);
+	mutex_init(&G_mux.readLock);
+	init_waitqueue_head(&G_mux.wait);
+	ret = misc_register(&G_muxDev);
+	if (ret)
+		return ret;
+
+	ret = misc_register(&G_tapDev);
+	if (ret)
+		goto err_tap;
+
+	ret = m77_ctl_init();
+	if (ret)
+		goto err_ctl;
+	return 0;
+
+ err_ctl:
+	misc_deregister(&G_tapDev);
+ err_tap:
+	misc_deregister(&G_muxDev);
+	return ret;
+}
+
+
+/*******************************************************************/
+/** Deregister what m77_mux_init() registered
+ */
+static void m77_mux_exit(void)
+{
+	m77_ctl_exit();
+	misc_deregister(&G_tapDev);
+	misc_deregister(&G_muxDev);
+}
+
+
+/*-----------------------------+
+|   LOOPBACK SELF-TEST         |
++-----------------------------*/
+
+/*******************************************************************/
+/** Run the loopback self-test on a ttyD line
  *
- * \brief this is the central link between higher tty layer and the UART 
- *        Hardware to change all aspects of the Channel like Baudrate, data bit
- *        settings etc. Its called everytime a property of the channel is 
- *		  changed e.g. with stty.
+ * \param up		\IN  Oxford 16C954 Port Struct
+ * \param ms		\IN  test time, the nr. of chars sent is that long at
+ *						the line rate
+ * \param baud		\IN  baudrate, 0: the one last set on the line
  *
- * \return 				-
+ * \brief Takes the UART like a serdev consumer, so the ttyD must be
+ *        closed. With UART_MCR_LOOP set the PRBS15 pattern is sent in
+ *        8N1 and received through the normal interrupt path, nothing
+ *        leaves the M-Module. The UART is shut down again afterwards,
+ *        the next open of the ttyD sets it up as usual. The result is
+ *        kept in up->stRes, also of a test that timed out. A test
+ *        interrupted by a signal leaves the last result.
+ *
+ * \return 			0 or negative error code, -EINTR on a signal
  */
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,1,0)
-static void men_uart_set_termios(struct uart_port *port,struct ktermios *termios, const struct ktermios *old)
-#else
-static void men_uart_set_termios(struct uart_port *port,struct ktermios *termios, struct ktermios *old)
-#endif
+static int m77_selftest_run(struct ox16c954_port *up, unsigned int ms,
+							unsigned int baud)
 {
-	unsigned char efr = 0;
-	struct ox16c954_port *up = (struct ox16c954_port *)port;
-	unsigned char cval, fcr = 0;
+	struct m77_selftest *st;
+	struct ktermios termios;
 	unsigned long flags;
-	unsigned int baud, quot;
-
-	M77DBG3("%s: c_iflag = 0x%04x c_cflag = 0x%04x  Settings:\n",
-			   __FUNCTION__, termios->c_iflag, termios->c_cflag );
+	unsigned int overruns;
+	long left;
+	u64 t0;
+
+	/* pairs with smp_store_release() in m77_probe_module() */
+	if (!smp_load_acquire(&up->mod->ready))
+		return -EAGAIN;
+
+	if (!baud) {
+		spin_lock_irqsave(&up->port.lock, flags);
+		baud = up->quot ? up->port.uartclk / (16 * up->quot) : 9600;
+		spin_unlock_irqrestore(&up->port.lock, flags);
+	}
 
-	/* 
-	 * Set Word Length: 5..8 bit 
-	 */
-	switch (termios->c_cflag & CSIZE) {
-	case CS5:
-		cval = UART_LCR_WLEN5;
-		M77DBG3(" - 5 Data Bits\n");
-		break;
-	case CS6:
-		cval = UART_LCR_WLEN6;
-		M77DBG3(" - 6 Data Bits\n");
-		break;
-	case CS7:
-		cval = UART_LCR_WLEN7;
-		M77DBG3(" - 7 Data Bits\n");
-		break;
-	default:
-	case CS8:
-		cval = UART_LCR_WLEN8;
-		M77DBG3(" - 8 Data Bits\n");
-		break;
+	st = kzalloc(sizeof(*st), GFP_KERNEL);
+	if (!st)
+		return -ENOMEM;
+	st->total	= max_t(u64, div_u64((u64)baud * ms, 10 * 1000), 1);
+	st->txLeft	= st->total;
+	st->txPrbs	= SELFTEST_SEED;
+	st->rxPrbs	= SELFTEST_SEED;
+	init_waitqueue_head(&st->wait);
+
+	if (test_and_set_bit(0, &up->inUse)) {
+		kfree(st);
+		return -EBUSY;
 	}
 
-	/* 
-	 * Set 1 or 2 Stop Bits
-	 * Oxford Data Sheet states that its actually 1.5 Stopbits at 5 Databits,
-	 * 2 Bits at 6,7,8 Data bits
-	 */
-	if (termios->c_cflag & CSTOPB){
-		cval |= UART_LCR_STOP;
-		M77DBG3(" - 2 Stop Bits\n");
-	} else {
-		M77DBG3(" - 1 Stop Bit\n");
+	termios = tty_std_termios;
+	termios.c_cflag = CS8 | CREAD | CLOCAL;
+	tty_termios_encode_baud_rate(&termios, baud, baud);
+
+	men_uart_hw_startup(up);
+	men_uart_set_termios(&up->port, &termios, NULL);
+	static_branch_inc(&m77_selftest_key);
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	up->port.mctrl |= TIOCM_LOOP;
+	men_uart_set_mctrl(&up->port, up->port.mctrl);
+	overruns	= up->port.icount.overrun + up->port.icount.buf_overrun;
+	up->selftest = st;
+	t0			= ktime_get_ns();
+	men_uart_start_tx(&up->port);
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	/* lost chars end the test by the timeout, a signal aborts it */
+	left = wait_event_interruptible_timeout(st->wait,
+									READ_ONCE(st->rxBytes) >= st->total,
+									msecs_to_jiffies(2 * ms + 500));
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	up->selftest = NULL;
+	__stop_tx(up);
+	up->port.mctrl &= ~TIOCM_LOOP;
+	men_uart_set_mctrl(&up->port, up->port.mctrl);
+	if (left < 0)
+		goto unlock;
+
+	up->stRes.baud		= baud;
+	up->stRes.total		= st->total;
+	up->stRes.txBytes	= st->total - st->txLeft;
+	up->stRes.rxBytes	= st->rxBytes;
+	up->stRes.errors	= st->errors;
+	up->stRes.overruns	= up->port.icount.overrun +
+		up->port.icount.buf_overrun - overruns;
+	up->stRes.isrCalls	= st->isrCalls;
+	up->stRes.isrNs		= st->isrNs;
+	up->stRes.ns		= st->lastNs > t0 ? st->lastNs - t0 : 0;
+ unlock:
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	static_branch_dec(&m77_selftest_key);
+	men_uart_hw_shutdown(up);
+	clear_bit(0, &up->inUse);
+	kfree(st);
+	return left < 0 ? -EINTR : 0;
+}
+
+
+/*******************************************************************/
+/** port of a ttyD class device, as in serial_core
+ */
+static struct ox16c954_port *m77_dev_port(struct device *dev)
+{
+	struct tty_port *tport = dev_get_drvdata(dev);
+	struct uart_state *state = container_of(tport, struct uart_state, port);
+
+	return (struct ox16c954_port *)state->uart_port;
+}
+
+
+/*******************************************************************/
+/** sysfs read of /sys/class/tty/ttyD<n>/selftest: last result
+ *
+ * \brief One line of key=value pairs. rate_pct is the throughput
+ *        relative to the line rate (10 bits per char), isr_pct the time
+ *        spent in the interrupt handler for this line relative to the
+ *        test time.
+ */
+static ssize_t m77_selftest_show(struct device *dev,
+								 struct device_attribute *attr, char *buf)
+{
+	struct ox16c954_port *up = m77_dev_port(dev);
+	struct m77_selftest_res res;
+	unsigned long flags;
+	u64 bps = 0, ratePct = 0, isrPm = 0;
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	res = up->stRes;
+	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	if (!res.baud)
+		return scnprintf(buf, PAGE_SIZE, "result=none\n");
+
+	if (res.ns) {
+		bps		= div64_u64((u64)res.rxBytes * NSEC_PER_SEC, res.ns);
+		ratePct	= div_u64(bps * 1000, res.baud);
+		isrPm	= div64_u64(res.isrNs * 10000, res.ns);
 	}
 
+	return scnprintf(buf, PAGE_SIZE,
+					 "baud=%u tx=%u rx=%u errors=%u overruns=%u "
+					 "bytes_per_s=%llu rate_pct=%llu duration_us=%llu "
+					 "isr_calls=%u isr_us=%llu isr_pct=%llu.%02llu "
+					 "result=%s\n",
+					 res.baud, res.txBytes, res.rxBytes, res.errors,
+					 res.overruns, bps, ratePct, div_u64(res.ns, 1000),
+					 res.isrCalls, div_u64(res.isrNs, 1000),
+					 div_u64(isrPm, 100), isrPm % 100,
+					 res.rxBytes == res.total && res.txBytes == res.total &&
+					 !res.errors && !res.overruns ? "pass" : "fail");
+}
 
-	/* 
-	 * Set Parity (none/odd/even)
-	 */
-	if (termios->c_cflag & PARENB)
-		cval |= UART_LCR_PARITY;
-	if (!(termios->c_cflag & PARODD))
-		cval |= UART_LCR_EPAR;
 
-	/* Report the Parity setting according to LCR[5:3] Data Sheet */
+/*******************************************************************/
+/** sysfs write of /sys/class/tty/ttyD<n>/selftest: "<ms> [<baud>]"
+ *
+ * \brief Runs the test, returns when it is done, at most about
+ *        2 * SELFTEST_MAX_MS later.
+ */
+static ssize_t m77_selftest_store(struct device *dev,
+								  struct device_attribute *attr,
+								  const char *buf, size_t count)
+{
+	unsigned int ms, baud = 0;
+	int ret;
 
-	if(!(cval & UART_LCR_PARITY)){
-		M77DBG3(" - No Parity\n");
-	} else {
-		if( ((cval & 0x38) >> 3) == 1 ) /* Mask Bits 5,4,3:  0x38=0011 1000 */
-			M77DBG3(" - Odd Parity\n");
+	if (sscanf(buf, "%u %u", &ms, &baud) < 1 || !ms ||
+		ms > SELFTEST_MAX_MS)
+		return -EINVAL;
 
-		if( ((cval & 0x38) >> 3) == 3 )
-			M77DBG3(" - Even Parity\n");
+	ret = m77_selftest_run(m77_dev_port(dev), ms, baud);
+	return ret < 0 ? ret : count;
+}
 
-		if( ((cval & 0x38) >> 3) == 5 )
-			M77DBG3(" - Parity forced 1\n");
+static DEVICE_ATTR(selftest, 0644, m77_selftest_show, m77_selftest_store);
 
-		if( ((cval & 0x38) >> 3) == 7 )
-			M77DBG3(" - Parity forced 0\n");
+
+#ifdef M77_MMIO_STATS
+/*-----------------------------+
+|   MMIO STATISTICS            |
++-----------------------------*/
+
+/*******************************************************************/
+/** add up register access counters
+ *
+ * \param rd		\INOUT reads per operation
+ * \param wr		\INOUT writes per operation
+ * \param st		\IN    counters to add
+ *
+ * \return 			-
+ */
+static void m77_mmio_sum(unsigned long *rd, unsigned long *wr,
+						 struct m77_mmio_stats *st)
+{
+	int op;
+
+	for (op = 0; op < M77_MMIO_OPS; op++) {
+		rd[op] += atomic_long_read(&st->rd[op]);
+		wr[op] += atomic_long_read(&st->wr[op]);
 	}
+}
 
-	/*
-	 * Ask the core to calculate the divisor for us.
-	 */
-	baud = uart_get_baud_rate(port, termios, old, 0, port->uartclk/16); 
-	quot = men_uart_get_divisor(port, baud);
-	M77DBG3(" - Baudrate: %d (quot=%d)\n", baud, quot);
+/*******************************************************************/
+/** clear register access counters
+ */
+static void m77_mmio_clear(struct m77_mmio_stats *st)
+{
+	int op;
 
-	/*
-	 * Oxford Semi 952 rev B workaround
-	 */
-	if (up->bugs & UART_BUG_QUOT && (quot & 0xff) == 0)
-		quot ++;
+	for (op = 0; op < M77_MMIO_OPS; op++) {
+		atomic_long_set(&st->rd[op], 0);
+		atomic_long_set(&st->wr[op], 0);
+	}
+}
 
-	if (up->capabilities & UART_CAP_FIFO && up->port.fifosize > 1) {
-		if (baud < 2400)
-			fcr = UART_FCR_ENABLE_FIFO | UART_FCR_TRIGGER_1;
-		else
-			fcr = uart_config[up->port.type].fcr;
+/*******************************************************************/
+/** print register access counters, one line per operation used
+ *
+ * \return 			nr. of chars written to buf
+ */
+static int m77_mmio_print(char *buf, int len, const char *name,
+						  unsigned long *rd, unsigned long *wr)
+{
+	int op, n = 0;
+
+	for (op = 0; op < M77_MMIO_OPS; op++)
+		if (rd[op] || wr[op])
+			n += scnprintf(buf + n, len - n, "%s%s%-8s %10lu %10lu\n",
+						   name, *name ? " " : "", G_mmioOpName[op],
+						   rd[op], wr[op]);
+	return n;
+}
+
+/*******************************************************************/
+/** sysfs read of /sys/class/tty/ttyD<n>/mmio
+ *
+ * \brief Reads and writes of the UART registers per operation.
+ */
+static ssize_t m77_mmio_show(struct device *dev,
+							 struct device_attribute *attr, char *buf)
+{
+	unsigned long rd[M77_MMIO_OPS] = { 0 }, wr[M77_MMIO_OPS] = { 0 };
+
+	m77_mmio_sum(rd, wr, &m77_dev_port(dev)->mmio);
+	return m77_mmio_print(buf, PAGE_SIZE, "", rd, wr);
+}
+
+static DEVICE_ATTR(mmio, 0444, m77_mmio_show, NULL);
+
+/*******************************************************************/
+/** Read the statistics, module parameter "mmioStats"
+ *
+ * \brief Per M-Module and operation the reads and writes of its CPLD
+ *        and all its UARTs.
+ */
+static int m77_mmio_stats_get(char *buf, const struct kernel_param *kp)
+{
+	unsigned long rd[M77_MMIO_OPS], wr[M77_MMIO_OPS];
+	UARTMOD_INFO *mmod;
+	struct list_head *pos;
+	unsigned int i;
+	int n = 0;
+
+	list_for_each( pos, &G_uartModListHead ) {
+		mmod = list_entry(pos, UARTMOD_INFO, head);
+		memset(rd, 0, sizeof(rd));
+		memset(wr, 0, sizeof(wr));
+		m77_mmio_sum(rd, wr, &mmod->mmio);
+		/* pairs with smp_store_release() in m77_probe_module() */
+		if (smp_load_acquire(&mmod->ready))
+			for (i = 0; i < mmod->nrChannels; i++)
+				m77_mmio_sum(rd, wr, &mmod->ports[i].mmio);
+		n += m77_mmio_print(buf + n, PAGE_SIZE - n, mmod->deviceName,
+							rd, wr);
 	}
+	return n;
+}
 
-	/*
-	 * MCR-based auto flow control.  When AFE is enabled, RTS will be
-	 * deasserted when the receive FIFO contains more characters than
-	 * the trigger, or the MCR RTS bit is cleared.  In the case where
-	 * the remote UART is not using CTS auto flow control, we must
-	 * have sufficient FIFO entries for the latency of the remote
-	 * UART to respond.  IOW, at least 32 bytes of FIFO.
-	 */
-	if (up->capabilities & UART_CAP_AFE && up->port.fifosize >= 32) {
-		up->mcr &= ~UART_MCR_AFE;
-		if (termios->c_cflag & CRTSCTS)
-			up->mcr |= UART_MCR_AFE;
+/*******************************************************************/
+/** Clear the statistics of all M-Modules and ports, module parameter
+ *  "mmioStats"
+ */
+static int m77_mmio_stats_set(const char *val, const struct kernel_param *kp)
+{
+	UARTMOD_INFO *mmod;
+	struct list_head *pos;
+	unsigned int i;
+
+	list_for_each( pos, &G_uartModListHead ) {
+		mmod = list_entry(pos, UARTMOD_INFO, head);
+		m77_mmio_clear(&mmod->mmio);
+		if (smp_load_acquire(&mmod->ready))
+			for (i = 0; i < mmod->nrChannels; i++)
+				m77_mmio_clear(&mmod->ports[i].mmio);
 	}
+	return 0;
+}
+#endif /* M77_MMIO_STATS */
 
-	/* Ok, we're now changing the port state. Do it with interrupts disabled. */
-	spin_lock_irqsave(&up->port.lock, flags);
 
-	/* Update the per-port timeout. */
-	uart_update_timeout(port, termios->c_cflag, baud);
+static struct attribute *m77_port_attrs[] = {
+	&dev_attr_selftest.attr,
+#ifdef M77_MMIO_STATS
+	&dev_attr_mmio.attr,
+#endif
+	NULL
+};
 
-	up->port.read_status_mask = UART_LSR_OE | UART_LSR_THRE | UART_LSR_DR;
-	if (termios->c_iflag & INPCK)
-		up->port.read_status_mask |= UART_LSR_FE | UART_LSR_PE;
-	if (termios->c_iflag & (BRKINT | PARMRK))
-		up->port.read_status_mask |= UART_LSR_BI;
+/* attributes of each ttyD class device, set in men_uart_init_ports() */
+static const struct attribute_group m77_port_attr_group = {
+	.attrs	= m77_port_attrs,
+};
 
-	/* Characteres to ignore */
-	up->port.ignore_status_mask = 0;
-	if (termios->c_iflag & IGNPAR)
-		up->port.ignore_status_mask |= UART_LSR_PE | UART_LSR_FE;
-	if (termios->c_iflag & IGNBRK) {
-		up->port.ignore_status_mask |= UART_LSR_BI;
-		/*
-		 * If we're ignoring parity and break indicators,
-		 * ignore overruns too (for real raw support).
-		 */
-		if (termios->c_iflag & IGNPAR)
-			up->port.ignore_status_mask |= UART_LSR_OE;
+
+/*-----------------------------+
+|   STATISTICS SNAPSHOT        |
++-----------------------------*/
+
+/*******************************************************************/
+/** Statistics record of one port
+ *
+ * \param up		\IN  Oxford 16C954 Port Struct, port lock held
+ * \param rec		\OUT record, zeroed by the caller
+ * \param now		\IN  ktime_get_ns() of the snapshot
+ *
+ * \brief A stall still running is counted up to now, one that started
+ *        after now is flagged but adds no time yet.
+ *
+ * \return 			-
+ */
+static void m77_ctl_rec(struct ox16c954_port *up, struct m77_stats_rec *rec,
+						u64 now)
+{
+	rec->line = up->port.line;
+
+	if (test_bit(0, &up->inUse))
+		rec->flags |= M77_STATS_OPEN;
+	if (up->ctsFlow)
+		rec->flags |= M77_STATS_CTS_FLOW;
+	if (up->txStallAt)
+		rec->flags |= M77_STATS_TX_STALL;
+	if (up->rxStallAt)
+		rec->flags |= M77_STATS_RX_STALL;
+
+	m77_bytes_fold(up);
+	rec->rxBytes	= up->rxBytes;
+	rec->txBytes	= up->txBytes;
+	rec->overrun	= up->port.icount.overrun;
+	rec->bufOverrun	= up->port.icount.buf_overrun;
+	rec->frame		= up->port.icount.frame;
+	rec->parity		= up->port.icount.parity;
+	rec->brk		= up->port.icount.brk;
+	rec->irqs		= up->irqs;
+	rec->rxHigh		= up->rxHigh;
+	rec->txHigh		= up->txHigh;
+	rec->txStallNs	= up->txStallNs;
+	if (up->txStallAt && now > up->txStallAt)
+		rec->txStallNs += now - up->txStallAt;
+	rec->rxStallNs	= up->rxStallNs;
+	if (up->rxStallAt && now > up->rxStallAt)
+		rec->rxStallNs += now - up->rxStallAt;
+}
+
+
+/*******************************************************************/
+/** read a statistics snapshot of all ttyD lines from /dev/m77ctl
+ *
+ * \brief Each read() collects a new snapshot: struct m77_stats_hdr and
+ *        as many struct m77_stats_rec as fit into count. With nRecs
+ *        below nPorts the reader should retry with a larger buffer.
+ *        The M-Modules are taken one after the other: the port locks
+ *        of one M-Module, at most 8, are held together with interrupts
+ *        off, so its records are consistent with each other. Stall
+ *        times of all records are counted up to the common timestamp.
+ *        The file position is not used.
+ *
+ * \return 			nr. of bytes read or negative error code
+ */
+static ssize_t m77_ctl_read(struct file *file, char __user *ubuf,
+							size_t count, loff_t *ppos)
+{
+	struct m77_stats_hdr *hdr;
+	struct m77_stats_rec *rec;
+	UARTMOD_INFO *mmod;
+	struct list_head *pos;
+	unsigned int i, n, max;
+	unsigned long flags;
+	ssize_t ret;
+
+	if (count < sizeof(*hdr))
+		return -EINVAL;
+
+	max = min_t(size_t, (count - sizeof(*hdr)) / sizeof(*rec),
+				men_uart_reg.nr);
+	hdr = vzalloc(sizeof(*hdr) + max * sizeof(*rec));
+	if (!hdr)
+		return -ENOMEM;
+	rec = (struct m77_stats_rec *)(hdr + 1);
+
+	hdr->version	= M77_STATS_VERSION;
+	hdr->hdrSize	= sizeof(*hdr);
+	hdr->recSize	= sizeof(*rec);
+
+	/* one reader at a time, lockdep nest lock for the port locks */
+	mutex_lock(&G_ctlLock);
+	hdr->timestamp = ktime_get_ns();
+	list_for_each( pos, &G_uartModListHead ) {
+		mmod = list_entry(pos, UARTMOD_INFO, head);
+		/* pairs with smp_store_release() in m77_probe_module() */
+		if (!smp_load_acquire(&mmod->ready))
+			continue;
+		n = min(mmod->nrChannels, max - hdr->nRecs);
+		hdr->nPorts += mmod->nrChannels;
+
+		local_irq_save(flags);
+		for (i = 0; i < n; i++)
+			spin_lock_nest_lock(&mmod->ports[i].port.lock, &G_ctlLock);
+		for (i = 0; i < n; i++)
+			m77_ctl_rec(&mmod->ports[i], &rec[hdr->nRecs + i],
+						hdr->timestamp);
+		for (i = n; i-- > 0; )
+			spin_unlock(&mmod->ports[i].port.lock);
+		local_irq_restore(flags);
+		hdr->nRecs += n;
 	}
+	hdr->duration = ktime_get_ns() - hdr->timestamp;
+	mutex_unlock(&G_ctlLock);
 
-	/* ignore all characters if CREAD is not set */
-	if ((termios->c_cflag & CREAD) == 0)
-		up->port.ignore_status_mask |= UART_LSR_DR;
+	ret = sizeof(*hdr) + hdr->nRecs * sizeof(*rec);
+	if (copy_to_user(ubuf, hdr, ret))
+		ret = -EFAULT;
+	vfree(hdr);
+	return ret;
+}
 
-	/* CTS flow control flag and modem status interrupts */
-	up->ier &= ~UART_IER_MSI;
-	if (!(up->bugs & UART_BUG_NOMSR) &&
-			UART_ENABLE_MS(&up->port, termios->c_cflag))
-		up->ier |= UART_IER_MSI;
-	if (up->capabilities & UART_CAP_UUE)
-		up->ier |= UART_IER_UUE | UART_IER_RTOIE;
-	serial_out(up, UART_IER, up->ier);
 
-	if ( termios->c_cflag & CRTSCTS ) {
-		if ( up->type != MOD_M77 ) {
+static const struct file_operations m77_ctl_fops = {
+	.owner			= THIS_MODULE,
+	.read			= m77_ctl_read,
+};
 
-			efr |= UART_EFR_CTS;
-			M77DBG3(" - HW Flow Control (RTS/CTS)\n");
-		} else {
-			/* Dont use RTS/CTS Handshake setting on M77! */
-			printk(KERN_INFO "*** Module is a M77 - ignoring Flag CRTSCTS\n");
-		}
-	}
+static struct miscdevice G_ctlDev = {
+	.minor	= MISC_DYNAMIC_MINOR,
+	.name	= CTL_NAME,
+	.fops	= &m77_ctl_fops,
+};
 
-	/* Apply to Register */
-	serial_efr_write(up, UART_EFR, efr );
 
-	/* Inband XON/XOFF Flow Control desired? */
-	if (termios->c_iflag & (IXON|IXOFF)) {
-		serial_efr_write(up, M77_XON1_OFFSET, 	M77_XON_CHAR );
-		serial_efr_write(up, M77_XON2_OFFSET, 	M77_XON_CHAR );        
-		serial_efr_write(up, M77_XOFF1_OFFSET, 	M77_XOFF_CHAR );       
- 		serial_efr_write(up, M77_XOFF2_OFFSET, 	M77_XOFF_CHAR );       
-		M77DBG3(" - SW Flow Control IXON/IXOFF\n");
-		set_inband_flowctrl(up, 1 );
- 	} else {
-		set_inband_flowctrl(up, 0 );
-	}
-	
-	/*  Set Baudrate Divider. M45N/69N/77 uartclk is always 18,432 MHz */
-	serial_out(up, UART_LCR, cval | UART_LCR_DLAB);
-	serial_out(up, UART_DLL, quot & 0xff);			
-	serial_out(up, UART_DLM, quot >> 8);			
+/*******************************************************************/
+/** Register /dev/m77ctl, part of m77_mux_init()
+ *
+ * \return 			0 or negative error code
+ */
+static int m77_ctl_init(void)
+{
+	return misc_register(&G_ctlDev);
+}
 
-	/*
-	 * LCR DLAB must be set to enable 64-byte FIFO mode. If the FCR
-	 * is written without DLAB set, this mode will be disabled.
-	 */
-	if (up->port.type == PORT_16750)
-		serial_out(up, UART_FCR, fcr);
 
-	serial_out(up, UART_LCR, cval);		/* reset DLAB */
+/*******************************************************************/
+/** Deregister /dev/m77ctl
+ */
+static void m77_ctl_exit(void)
+{
+	misc_deregister(&G_ctlDev);
+}
 
-	up->lcr = cval;					    /* Save LCR */
-	if (up->port.type != PORT_16750) {
 
-		if (fcr & UART_FCR_ENABLE_FIFO) {
-			/* emulated UARTs (Lucent Venus 167x) need two steps */
-			serial_out(up, UART_FCR, UART_FCR_ENABLE_FIFO);
-		}
-		serial_out(up, UART_FCR, fcr);		/* set fcr */
-	}
+/*-----------------------------+
+|   OVERRUN RECORDS (DEBUGFS)  |
++-----------------------------*/
 
-	men_uart_set_mctrl(&up->port, up->port.mctrl);
+static const char * const G_rxModeName[M77_RXM_NUM] = {
+	"tty", "selftest", "net", "serdev", "raw", "mux", "bridge", "bond", "bpf"
+};
+
+/*******************************************************************/
+/** read of /sys/kernel/debug/m77/overrun/ttyD<n>, oldest record first
+ */
+static int m77_ovr_show(struct seq_file *m, void *v)
+{
+	struct ox16c954_port *up = m->private;
+	struct m77_ovr_rec *rec;
+	unsigned long flags;
+	unsigned int cnt, n, i;
+
+	rec = kmalloc_array(OVR_RECS, sizeof(*rec), GFP_KERNEL);
+	if (!rec)
+		return -ENOMEM;
+
+	spin_lock_irqsave(&up->port.lock, flags);
+	cnt = up->ovrCnt;
+	n	= min_t(unsigned int, cnt, OVR_RECS);
+	for (i = 0; i < n; i++)
+		rec[i] = up->ovr[(cnt - n + i) & (OVR_RECS - 1)];
 	spin_unlock_irqrestore(&up->port.lock, flags);
+
+	seq_printf(m, "records %u\n", cnt);
+	seq_puts(m, "# time_ns since_ns others mask mode trig baud lsr rx\n");
+	for (i = 0; i < n; i++)
+		seq_printf(m, "%llu %llu %u 0x%02x %s %u %u 0x%02x %u\n",
+				   rec[i].ns, rec[i].sinceNs, rec[i].others,
+				   rec[i].otherMask, G_rxModeName[rec[i].mode],
+				   rec[i].trig, rec[i].baud, rec[i].lsr, rec[i].rx);
+	kfree(rec);
+	return 0;
 }
 
+static int m77_ovr_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, m77_ovr_show, inode->i_private);
+}
 
-static void
-men_uart_pm(struct uart_port *port, unsigned int state, unsigned int oldstate)
+/*******************************************************************/
+/** write of /sys/kernel/debug/m77/overrun/ttyD<n>: drop the records
+ */
+static ssize_t m77_ovr_write(struct file *file, const char __user *buf,
+							 size_t count, loff_t *ppos)
 {
-	/* No special Powermanagement for our M Modules */
-	do { } while (0);
+	struct ox16c954_port *up = file_inode(file)->i_private;
+	unsigned long flags;
 
+	spin_lock_irqsave(&up->port.lock, flags);
+	up->ovrCnt = 0;
+	spin_unlock_irqrestore(&up->port.lock, flags);
+	return count;
 }
 
+static const struct file_operations m77_ovr_fops = {
+	.owner		= THIS_MODULE,
+	.open		= m77_ovr_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.write		= m77_ovr_write,
+	.release	= single_release,
+};
 
-static void men_uart_release_port(struct uart_port *port)
+
+/*-----------------------------+
+|   HISTOGRAMS (DEBUGFS)       |
++-----------------------------*/
+
+/*******************************************************************/
+/** print one histogram, bins without counts are left out
+ *
+ * \param m			\IN  seq_file of /sys/kernel/debug/m77/ttyD<n>
+ * \param up		\IN  port
+ * \param off		\IN  offset of the histogram in struct m77_hist
+ * \param bins		\IN  HIST_FIFO_BINS or HIST_LOG_BINS
+ * \param title		\IN  header line
+ *
+ * \return 			-
+ */
+static void m77_hist_print(struct seq_file *m, struct ox16c954_port *up,
+						   size_t off, unsigned int bins, const char *title)
 {
-	/* Not necessary for M-Modules */
+	unsigned long cnt;
+	unsigned int bin;
+	int cpu;
+
+	seq_printf(m, "# %s\n", title);
+	for (bin = 0; bin < bins; bin++) {
+		cnt = 0;
+		for_each_possible_cpu(cpu)
+			cnt += ((unsigned long *)
+					((char *)per_cpu_ptr(up->hist, cpu) + off))[bin];
+		if (!cnt)
+			continue;
+		if (bins == HIST_FIFO_BINS && bin == bins - 1)
+			seq_printf(m, "%10u- %12lu\n", bin * 8, cnt);
+		else if (bins == HIST_FIFO_BINS)
+			seq_printf(m, "%10u-%-3u %8lu\n", bin * 8, bin * 8 + 7, cnt);
+		else if (bin == 0)
+			seq_printf(m, "%10u %12lu\n", 0, cnt);
+		else
+			seq_printf(m, "%10llu- %12lu\n", 1ULL << (bin - 1), cnt);
+	}
 }
 
-static int men_uart_request_port(struct uart_port *port)
+/*******************************************************************/
+/** read of /sys/kernel/debug/m77/ttyD<n>
+ */
+static int m77_hist_show(struct seq_file *m, void *v)
 {
-	/* Not necessary for M-Modules */
+	struct ox16c954_port *up = m->private;
+	unsigned long idle = 0;
+	int cpu;
+
+	seq_printf(m, "enabled %d\n", static_key_enabled(&m77_hist_key));
+	mutex_lock(&G_histLock);
+	if (!up->hist) {
+		mutex_unlock(&G_histLock);
+		return 0;
+	}
+
+	for_each_possible_cpu(cpu)
+		idle += per_cpu_ptr(up->hist, cpu)->txIdle;
+
+	m77_hist_print(m, up, offsetof(struct m77_hist, rxDrain), HIST_FIFO_BINS,
+				   "rx_fifo: chars per RX drain (RFL at drain)");
+	m77_hist_print(m, up, offsetof(struct m77_hist, txLoad), HIST_FIFO_BINS,
+				   "tx_load: chars per TX refill (at TFL 0)");
+	seq_printf(m, "# tx_idle: refills with transmitter empty\n%23lu\n", idle);
+	m77_hist_print(m, up, offsetof(struct m77_hist, isrBytes), HIST_LOG_BINS,
+				   "isr_bytes: chars moved per service of the port");
+	m77_hist_print(m, up, offsetof(struct m77_hist, isrNs), HIST_LOG_BINS,
+				   "isr_ns: duration of the service");
+	m77_hist_print(m, up, offsetof(struct m77_hist, irqNs), HIST_LOG_BINS,
+				   "irq_ns: IR asserted to service (mock carrier only)");
+	mutex_unlock(&G_histLock);
 	return 0;
 }
 
+static int m77_hist_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, m77_hist_show, inode->i_private);
+}
 
-/******************************************************************************/
-/** highlevel UART Port config function
- *
- * \param port			\IN 	highlevel UART Port Struct
- * \param flags			\IN 	optional flags to control probing
+/*******************************************************************/
+/** write of /sys/kernel/debug/m77/ttyD<n>: clear the histograms
  *
- * \return 				-
+ * \brief Services running on other CPUs meanwhile may survive.
  */
-static void men_uart_config_port(struct uart_port *port, int flags)
+static ssize_t m77_hist_write(struct file *file, const char __user *buf,
+							  size_t count, loff_t *ppos)
 {
-	struct ox16c954_port *up = (struct ox16c954_port *)port;
-	int probeflags = ~0;
+	struct ox16c954_port *up = file_inode(file)->i_private;
+	int cpu;
+
+	mutex_lock(&G_histLock);
+	if (up->hist)
+		for_each_possible_cpu(cpu)
+			memset(per_cpu_ptr(up->hist, cpu), 0, sizeof(struct m77_hist));
+	mutex_unlock(&G_histLock);
+	return count;
+}
 
-	if (flags & UART_CONFIG_TYPE)
-		autoconfig(up, probeflags);
+static const struct file_operations m77_hist_fops = {
+	.owner		= THIS_MODULE,
+	.open		= m77_hist_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.write		= m77_hist_write,
+	.release	= single_release,
+};
 
-}
 
+/*******************************************************************/
+/** read of /sys/kernel/debug/m77/enable
+ */
+static ssize_t m77_hist_enable_read(struct file *file, char __user *buf,
+									size_t count, loff_t *ppos)
+{
+	char val[3] = { static_key_enabled(&m77_hist_key) ? '1' : '0', '\n' };
 
-/*****************************************************************************/
-/** return next free UART from internal UART Array
- *
- * \param port			\IN 	highlevel UART Port Struct
+	return simple_read_from_buffer(buf, count, ppos, val, 2);
+}
+
+/*******************************************************************/
+/** write of /sys/kernel/debug/m77/enable: 1 starts, 0 stops collecting
  *
- * \brief  We are free to use the ttyDxx entries by ourselves 
- * 		   So just return the next free men_uart_ports[i].port.
- * 		   This is simplified from serial8250_find_match_or_unused().
+ * \brief The histograms of the ports registered by now are allocated on
+ *        the first start and kept until the driver is unloaded.
  *
- * \return 				pointer to port struct
+ * \return 			count or negative error code
  */
-static struct 
-ox16c954_port *men_uart_find_match_or_unused(struct uart_port *port)
+static ssize_t m77_hist_enable_write(struct file *file,
+									 const char __user *buf,
+									 size_t count, loff_t *ppos)
 {
-	int i;
-	/* simply return the first entry which hasnt already a membase entry */
-	for (i = 0; i < MAX_SNGL_UARTS; i++) {
-		if ( !men_uart_ports[i].port.membase ) {
-			M77DBG3("%s: return UART nr. %d\n", __FUNCTION__, i);
-			return &men_uart_ports[i];
-		}	
-	}
-	return NULL;
+	struct ox16c954_port *up;
+	UARTMOD_INFO *mmod;
+	struct list_head *pos;
+	unsigned int i;
+	bool on;
+	int ret;
+
+	ret = kstrtobool_from_user(buf, count, &on);
+	if (ret)
+		return ret;
+
+	mutex_lock(&G_histLock);
+	if (on) {
+		list_for_each( pos, &G_uartModListHead ) {
+			mmod = list_entry(pos, UARTMOD_INFO, head);
+			/* pairs with smp_store_release() in m77_probe_module() */
+			if (!smp_load_acquire(&mmod->ready))
+				continue;
+			for (i = 0; i < mmod->nrChannels; i++) {
+				up = &mmod->ports[i];
+				/* the ISR only sees it after static_branch_enable() */
+				if (!up->hist)
+					up->hist = alloc_percpu(struct m77_hist);
+				if (!up->hist)
+					ret = -ENOMEM;
+			}
+		}
+		static_branch_enable(&m77_hist_key);
+	} else
+		static_branch_disable(&m77_hist_key);
+	mutex_unlock(&G_histLock);
+
+	return ret ? ret : count;
 }
 
+static const struct file_operations m77_hist_enable_fops = {
+	.owner		= THIS_MODULE,
+	.read		= m77_hist_enable_read,
+	.write		= m77_hist_enable_write,
+	.llseek		= default_llseek,
+};
 
 
-static int men_uart_verify_port(struct uart_port *port, 
-								struct serial_struct *ser)
+/*******************************************************************/
+/** Create /sys/kernel/debug/m77/ttyD<n> and overrun/ttyD<n> for a
+ *  registered port
+ *
+ * \brief Like all debugfs users, errors are ignored.
+ */
+static void m77_hist_add(struct ox16c954_port *up)
 {
-	/* shouldnt hurt to report us to serial core as always existing */
-	return 0;
+	char name[16];
+
+	snprintf(name, sizeof(name), UART_NAME_PREFIX "%d", up->port.line);
+	debugfs_create_file(name, 0644, G_dbgDir, up, &m77_hist_fops);
+	debugfs_create_file(name, 0644, G_ovrDir, up, &m77_ovr_fops);
+}
+
+/*******************************************************************/
+/** Create /sys/kernel/debug/m77, its enable file and overrun directory
+ */
+static void m77_hist_init(void)
+{
+	G_dbgDir = debugfs_create_dir(HIST_DIR_NAME, NULL);
+	debugfs_create_file("enable", 0644, G_dbgDir, NULL,
+						&m77_hist_enable_fops);
+	G_ovrDir = debugfs_create_dir(OVR_DIR_NAME, G_dbgDir);
+}
+
+/*******************************************************************/
+/** Remove /sys/kernel/debug/m77, before the ports are freed
+ *
+ * \brief The histograms are freed with the ports, see deinit_devices().
+ *        A second call does nothing, m77_init_devices() calls it on its
+ *        error path and m77_serial_init() once more.
+ */
+static void m77_hist_exit(void)
+{
+	debugfs_remove_recursive(G_dbgDir);
+	G_dbgDir = NULL;
+	G_ovrDir = NULL;
+	static_branch_disable(&m77_hist_key);
 }
 
 
 
-/*****************************************************************************/
-/** Function to register each 4 or 8 UART Channels of a M-Module at serial core
+/*******************************************************************/
+/** Initialize the Array of Oxford UARTs of one M-Module
  *
- * \param port		\IN    highlevel UART Port Struct
- * \param modtype	\IN    Module ID as in 13m07790.xml
- * \param nrLine	\IN    UART Line number as in /dev/ttyDn
- * \param glob		\OUT   returned OX16C954 UART, stored in UARTMOD_INFO array
+ * \param mod		\IN  per-module struct of M-Module data
  *
- * \return 				0 or negative error number
+ * \brief The lines are contiguous from mod->lineBase on, so a ttyD line
+ *        is found without scanning: line - lineBase is the channel.
  */
-int men_uart_register_port(struct uart_port *port, 
-						   unsigned int modtype,
-						   unsigned int nrLine, 
-						   struct ox16c954_port **glob )
+static void men_uart_init_ports(UARTMOD_INFO *mod)
 {
-	struct ox16c954_port *uart;
-	int ret = -ENOSPC;
-	
-	/* For M45N: helper for TCRbit-to-Channelnumber mapping */
-	unsigned int tcr[8] = {M45_TCR_TRISTATE0, M45_TCR_TRISTATE1, 
-						   M45_TCR_TRISTATE2, M45_TCR_TRISTATE2,
-						   M45_TCR_TRISTATE3, M45_TCR_TRISTATE3,
-						   M45_TCR_TRISTATE4, M45_TCR_TRISTATE4 };
 
-	if (port->uartclk == 0)
-		return -EINVAL;
+	unsigned int i;
 
-	down( &serial_sem );
+	for (i = 0; i < mod->nrChannels; i++) {
+		struct ox16c954_port *up = &mod->ports[i];
 
-	/* take one UART from the global ox16c954_port array */
-	uart = men_uart_find_match_or_unused(port);
+		up->port.line 		= 	mod->lineBase + i;
+		up->hot				=	&mod->hot[i];
+		up->mod				=	mod;
+		spin_lock_init(&up->port.lock);
+		INIT_WORK(&up->bridgeWork, m77_bridge_resume_work);
+		INIT_WORK(&up->netWork, m77_net_gone_work);
 
-	if (uart) {
-		uart->port.iobase   	= port->iobase;
-		uart->port.membase  	= port->membase;
-		uart->port.irq      	= port->irq;
-		uart->port.uartclk  	= port->uartclk;
-		uart->port.fifosize 	= port->fifosize;
-		uart->port.regshift 	= port->regshift;
-		uart->port.iotype   	= port->iotype;
-		uart->port.flags    	= port->flags;
-		uart->port.mapbase  	= port->mapbase;
+		up->mcr_mask 		= ~0;
+		up->mcr_force 		= 0;
+		up->port.ops 		= &men_uart_pops;
+		up->port.attr_group	= &m77_port_attr_group;
+	}
+}
 
-		/* for runtime-ioctl calls remember if we are a M45N, M69N or M77 */
-		uart->type				= modtype;
 
-		switch (uart->type) {
-		case MOD_M77:
-			uart->dcrReg = M77_DCR_REG_BASE + nrLine;
-			break;
+/*******************************************************************/
+/** Shut down one M-Module: unregister its UARTs, close the MDIS device
+ *
+ * \param mmod		\IN  M-Module
+ *
+ * \brief Also used on a M-Module that failed to probe while the others
+ *        stay registered. The ports and the UARTMOD_INFO are kept until
+ *        deinit_devices(): the ISR of every M-Module walks the whole
+ *        list, and debugfs files refer to the ports. Calling it again
+ *        does nothing.
+ *
+ * \return 			-
+ */
+static void m77_remove_module(UARTMOD_INFO *mmod)
+{
+	struct ox16c954_port *up;
+	unsigned int i;
 
-		case MOD_M45:
-			uart->tcrReg = (nrLine < 4) ? M45_TCR1_REG : M45_TCR2_REG;
-			uart->tcrBit = tcr[nrLine];	
-			break;
+	/*
+	 * 1. shutdown the UARTs physically 
+	 */
+	WRITE_ONCE(mmod->ready, 0);		/* ISR skips this M-Module now */
+	synchronize_rcu();				/* and no ISR is still inside it */
+	m77_uio_remove(mmod);
+	if (mmod->ports) {
+		for (i=0; i < mmod->nrChannels ; i++) {
+			up = &mmod->ports[i];
+			if ( up->port.membase ) 
+			{
+				M77DBG3(KERN_INFO "deinit port %d\n", up->port.line);
+				serial_out(up, 	UART_IER, 0);
+				serial_out(up, 	UART_LCR, 0);
+				serial_icr_write(up, UART_CSR, 0); /* Reset the UART */
+				m77_serdev_remove( up );
+				m77_raw_remove( up );
+				/* unregister the UARTs from the driver subsystem */
+				men_uart_unregister_port( up );
+				flush_work(&up->netWork);	/* interface detached on close */
+				up->port.membase = NULL;
+			}	
 		}
+	}
 
-#if 0
-		printk( KERN_INFO "men_uart_register_port:\n");
-		printk( KERN_INFO "uart->port.iobase   = 0x%08x\n",uart->port.iobase);
-		printk( KERN_INFO "uart->port.membase  = 0x%08x\n",uart->port.membase);
-		printk( KERN_INFO "uart->port.irq      = 0x%02x\n",uart->port.irq);
-		printk( KERN_INFO "uart->port.uartclk  = %ld\n",uart->port.uartclk);
-		printk( KERN_INFO "uart->port.fifosize = %d\n", uart->port.fifosize );
-		printk( KERN_INFO "uart->port.regshift = %d\n", uart->port.regshift );
-		printk( KERN_INFO "uart->port.iotype   = 0x%08x\n", uart->port.iotype);
-		printk( KERN_INFO "uart->port.flags    = 0x%08x\n",uart->port.flags );
-		printk( KERN_INFO "uart->port.mapbase  = 0x%08x\n",uart->port.mapbase);
-#endif
+	/*
+	 * 2. Unregister it in the MDIS context (external MDIS device) 
+	 */
+	if (mmod->mdisDev) {			
+		M77DBG2(KERN_INFO "Closing Device %s \n",mmod->deviceName);
 
-		if (port->dev)
-			uart->port.dev = port->dev;
+		/* clear any left Interrupt & disable them */
+		control_out(mmod, M77_REG_IR, 0x01 );
+		control_out(mmod, M77_REG_IR, 0x00 );
 
-		ret = uart_add_one_port(&men_uart_reg, &uart->port);
-		
-		/* give back this OX16C954 UART for storing in UARTMOD_INFO array */
-		*glob = uart;
+		/* Clear TCR/DCR Registers back to powerup values*/
+		if (mmod->modtype == MOD_M77) {
+			for (i = M77_DCR_REG_BASE; i < M77_DCR_REG_BASE + 4; i++ )
+				control_out(mmod, i << 1, M77_RS422_HD );
+		}
 
-		if (ret == 0)
-			ret = uart->port.line;
-	} 
+		if (mmod->modtype == MOD_M45) {
+			control_out(mmod, M45_REG_IR2, 		0x01 );
+			control_out(mmod, M45_REG_IR2, 		0x00 );
+			control_out(mmod, M45_TCR1_REG << 1, 	0x00 );
+			control_out(mmod, M45_TCR2_REG << 1, 	0x00 );
+		}
+		M77DBG2(KERN_INFO "Closing external device %s \n",mmod->deviceName);
+		mdis_close_external_dev( mmod->mdisDev );
+		mmod->mdisDev = NULL;
+	}
+}
+
+
+/*******************************************************************/
+/** Deinitialize all registered M-Modules
+ *
+ * \return 			-
+ */
+static void deinit_devices(void)
+{
+
+ 	UARTMOD_INFO *mmod;
+	struct list_head *tmp, *element;
+	unsigned int i;
+
+	/*
+	 * 1./2. shutdown the UARTs, close the MDIS devices
+	 */
+    list_for_each( tmp, &G_uartModListHead ) {
+		mmod = list_entry(tmp, UARTMOD_INFO, head);
+		m77_remove_module(mmod);
+	}
+
+	/*
+	 * 3. kfree kmalloc'ed memory and resources
+	 */
+	list_for_each_safe(element, tmp, &G_uartModListHead) { // Liste freigeben
+		mmod = list_entry(element, UARTMOD_INFO, head);
+		M77DBG2(KERN_INFO "Now freeing space for '%s'\n", mmod->deviceName );
+		list_del( element );
+		if (mmod->ports)
+			for (i = 0; i < mmod->nrChannels; i++)
+				free_percpu(mmod->ports[i].hist);
+		kfree( mmod->ports );
+		kfree( mmod->hot );
+		mutex_destroy( &mmod->lock );
+		kfree( mmod );
+    }
 
-	up(&serial_sem);
-	return ret;
 }
 
+
 /*******************************************************************/
-/** Remove one serial port
+/** Release the storage of a parsed module parameter list
  *
- * \param line		\IN serial line number
+ * \param arg		\IN  struct m77_param_list to free
  *
  * \return 			-
  */
-void men_uart_unregister_port(int line)
+static void m77_param_free_list(void *arg)
 {
-	struct ox16c954_port *uart = &men_uart_ports[line];
-	
-	down(&serial_sem);
-	uart_remove_one_port( &men_uart_reg, &uart->port);
-	uart->port.dev = NULL;
-	up(&serial_sem);
-}
+	struct m77_param_list *pl = arg;
+	unsigned int i;
 
+	if (pl->str) {
+		for (i = 0; i < pl->num; i++)
+			kfree(pl->str[i]);
+		kfree(pl->str);
+	}
+	kfree(pl->val);
+	pl->str = NULL;
+	pl->val = NULL;
+	pl->num = 0;
+}
 
 
 /*******************************************************************/
-/** return Port type name
+/** Parse a comma separated module parameter into a m77_param_list
  *
- * \param port		\IN 	highlevel UART Port Struct
+ * \param val		\IN  parameter string as passed to modprobe
+ * \param kp		\IN  kernel parameter, kp->arg is the m77_param_list
+ * \param isInt		\IN  0: keep strings, else convert each value to int
  *
- * \return 			char pointer to string, typically "16C954" here
+ * \return 			0 or negative error number
  */
-static const char *men_uart_type(struct uart_port *port)
+static int m77_param_set_list(const char *val, const struct kernel_param *kp,
+							  int isInt)
 {
-	int type = port->type;
+	struct m77_param_list *pl = kp->arg;
+	char *buf, *cur, *tok;
+	unsigned int n = 1;
+	const char *c;
+	int ret = 0;
 
-	if (type >= ARRAY_SIZE(uart_config))
-		type = 0;
-	return uart_config[type].name;
-}
+	m77_param_free_list(pl);
 
+	for (c = val; *c; c++)
+		if (*c == ',')
+			n++;
 
+	if ((buf = kstrdup(val, GFP_KERNEL)) == NULL)
+		return -ENOMEM;
 
-/*******************************************************************/
-/** Initialize the global Array of Oxford UARTs
- *
- */
-static void men_uart_init_ports(void)
-{
+	if (isInt)
+		pl->val = kcalloc(n, sizeof(int), GFP_KERNEL);
+	else
+		pl->str = kcalloc(n, sizeof(char *), GFP_KERNEL);
 
-	unsigned int i;
+	if (!pl->val && !pl->str) {
+		ret = -ENOMEM;
+		goto out;
+	}
 
-	for (i = 0; i < MAX_SNGL_UARTS; i++) {
-		struct ox16c954_port *up = &men_uart_ports[i];
+	cur = strim(buf);
+	while ((tok = strsep(&cur, ",")) != NULL) {
+		if (isInt) {
+			ret = kstrtoint(tok, 0, &pl->val[pl->num]);
+			if (ret) {
+				printk(KERN_ERR "*** %s: invalid value '%s'\n", kp->name, tok);
+				break;
+			}
+		} else if ((pl->str[pl->num] = kstrdup(tok, GFP_KERNEL)) == NULL) {
+			ret = -ENOMEM;
+			break;
+		}
+		pl->num++;
+	}
 
-		up->port.line 		= 	i;
-		spin_lock_init(&up->port.lock);
+ out:
+	if (ret)
+		m77_param_free_list(pl);
+	kfree(buf);
+	return ret;
+}
 
-		up->timer.function 	= NULL /* serial8250_timeout */;
-		up->mcr_mask 		= ~0;
-		up->mcr_force 		= 0;
-		up->port.ops 		= &men_uart_pops;
-	}
+static int m77_param_set_charp_list(const char *val,
+									const struct kernel_param *kp)
+{
+	return m77_param_set_list(val, kp, 0);
 }
 
+static int m77_param_set_int_list(const char *val,
+								  const struct kernel_param *kp)
+{
+	return m77_param_set_list(val, kp, 1);
+}
 
-/*******************************************************************/
-/** Deinitialize all registered M-Modules
- *
- * \return 			-
- */
-static void deinit_devices(void)
+static int m77_param_get_list(char *buffer, const struct kernel_param *kp)
 {
+	struct m77_param_list *pl = kp->arg;
 
- 	UARTMOD_INFO *mmod;
-	struct list_head *tmp, *element;
-	struct ox16c954_port *up;
-	unsigned int i;
+	return sprintf(buffer, "%u values\n", pl->num);
+}
 
-	/*
-	 * 1. shutdown all UARTs physically 
-	 */
-	for (i=0; i < MAX_SNGL_UARTS ; i++) {
-		if ( men_uart_ports[i].port.membase ) 
-		{
-			M77DBG3(KERN_INFO "deinit port %d\n", i);
-			up = (struct ox16c954_port *)&men_uart_ports[i].port;
-			serial_out(up, 	UART_IER, 0);
-			serial_out(up, 	UART_LCR, 0);
-			serial_icr_write(up, UART_CSR, 0); /* Reset the UART */
-			/* unregister the UARTs from the driver subsystem */
-			men_uart_unregister_port( i );
-		}	
-	}
 
-	/*
-	 * 2. Unregister everything in the MDIS context (external MDIS devices) 
-	 */
-	M77DBG2(KERN_INFO "Unregister external MDIS devices\n");
-    list_for_each( tmp, &G_uartModListHead ) {
-		mmod = list_entry(tmp, UARTMOD_INFO, head);
-		if (mmod->mdisDev) {			
-			M77DBG2(KERN_INFO "Closing Device %s \n",mmod->deviceName);
+/*******************************************************************/
+/** return one string of a module parameter list
+ *
+ * \param pl		\IN  parsed module parameter list
+ * \param idx		\IN  index of the value
+ *
+ * \return 			value or NULL if less values were passed
+ */
+static inline char *m77_param_str(struct m77_param_list *pl, unsigned int idx)
+{
+	return (pl->str && idx < pl->num) ? pl->str[idx] : NULL;
+}
 
-			/* clear any left Interrupt & disable them */
-			control_out(mmod->memBase, M77_REG_IR, 0x01 );
-			control_out(mmod->memBase, M77_REG_IR, 0x00 );
 
-			/* Clear TCR/DCR Registers back to powerup values*/
-			if (mmod->modtype == MOD_M77) {
-				for (i = M77_DCR_REG_BASE; i < M77_DCR_REG_BASE + 4; i++ )
-					control_out(mmod->memBase, i << 1, M77_RS422_HD );
-			}
+/*******************************************************************/
+/** return one int of a module parameter list
+ *
+ * \param pl		\IN  parsed module parameter list
+ * \param idx		\IN  index of the value
+ *
+ * \return 			value or 0 if less values were passed
+ */
+static inline int m77_param_int(struct m77_param_list *pl, unsigned int idx)
+{
+	return (pl->val && idx < pl->num) ? pl->val[idx] : 0;
+}
 
-			if (mmod->modtype == MOD_M45) {
-				control_out(mmod->memBase, M45_REG_IR2, 		0x01 );
-				control_out(mmod->memBase, M45_REG_IR2, 		0x00 );
-				control_out(mmod->memBase, M45_TCR1_REG << 1, 	0x00 );
-				control_out(mmod->memBase, M45_TCR2_REG << 1, 	0x00 );
-			}
-			M77DBG2(KERN_INFO "Closing external device %s \n",mmod->deviceName);
-			mdis_close_external_dev( mmod->mdisDev );
-		}
-	}
-	/*
-	 * 3. kfree kmalloc'ed memory and resources
-	 */
-	list_for_each_safe(element, tmp, &G_uartModListHead) { // Liste freigeben
-		mmod = list_entry(element, UARTMOD_INFO, head);
-		M77DBG2(KERN_INFO "Now freeing space for '%s'\n", mmod->deviceName );
-		list_del( element );
-		kfree( list_entry( element, UARTMOD_INFO, head));
-    }
 
+/*******************************************************************/
+/** Number of UART channels expected from the MDIS device name
+ *
+ * \param name		\IN  devName value, e.g. 'm45_1'
+ *
+ * \brief The name is checked against the Module ID in m77_init_devices(),
+ *        so it can be used to size the tty driver before any M-Module is
+ *        opened.
+ *
+ * \return 			8 (M45N), 4 (M69N/M77) or 0 if unknown
+ */
+static unsigned int m77_name_channels(const char *name)
+{
+	if (!strncmp("m45", name, 3))
+		return MOD_M45_CHAN_NUM;
+	if (!strncmp("m69", name, 3))
+		return MOD_M69_CHAN_NUM;
+	if (!strncmp("m77", name, 3))
+		return MOD_M77_CHAN_NUM;
+	return 0;
 }
 
 
@@ -2136,7 +7962,7 @@ static void	parse_m77_phyinfo( UARTMOD_INFO *mmod_data, unsigned int idx )
 
 		mmod_data->mode[j] = 0;
 		mmod_data->echo[j] = 0;
-		m77mode = mode[(idx*4) + j];
+		m77mode = m77_param_int(&mode, (idx*4) + j);
 
 		if (m77mode) {
 			/* sanity check of passed mode */
@@ -2144,7 +7970,7 @@ static void	parse_m77_phyinfo( UARTMOD_INFO *mmod_data, unsigned int idx )
 				 (m77mode == M77_RS485_HD) || (m77mode == M77_RS485_FD) ||
 				 (m77mode == M77_RS232)) {
 				mmod_data->mode[j] = m77mode;
-				mmod_data->echo[j] = !!echo[(idx*4) + j];
+				mmod_data->echo[j] = !!m77_param_int(&echo, (idx*4) + j);
 				M77DBG("mmod_data->mode[%d] = %d  ", j, mmod_data->mode[j] );
 				M77DBG("mmod_data->echo[%d] = %d\n", j, mmod_data->echo[j] );
 			} else {
@@ -2158,6 +7984,35 @@ static void	parse_m77_phyinfo( UARTMOD_INFO *mmod_data, unsigned int idx )
 }
 
 
+/*******************************************************************/
+/** Set the PHY mode and echo of a M77 channel from mode[]/echo[]
+ *
+ * \param mod		\IN  per-module struct of M-Module data
+ * \param nrChan	\IN  channel
+ *
+ * \return 			mode set or 0: not a M77 or no mode passed
+ */
+static unsigned int m77_phy_setup(UARTMOD_INFO *mod, unsigned int nrChan)
+{
+	unsigned int tmpmode;
+	unsigned char dcr_val;
+
+	/* mode[] has 4 entries, don't index it with the M45N channels 4-7 */
+	tmpmode = (mod->modtype == MOD_M77) ? mod->mode[nrChan] : 0;
+	if ( !tmpmode )
+		return 0;
+
+	dcr_val = tmpmode;
+	/* echoing only for HD modes! unknown effects at other modes.. */
+	if ( (( tmpmode==M77_RS422_HD) || (tmpmode==M77_RS485_HD )) && (mod->echo[nrChan])) 
+	{
+		dcr_val |= M77_RX_EN;
+	}
+	control_out(mod, (M77_DCR_REG_BASE+nrChan) << 1, dcr_val);
+	return tmpmode;
+}
+
+
 /*******************************************************************/
 /** Register the 4 or 8 UART Channels of this M-Module 
  *
@@ -2168,10 +8023,10 @@ static void	parse_m77_phyinfo( UARTMOD_INFO *mmod_data, unsigned int idx )
 static int register_uarts(UARTMOD_INFO *mod )
 {
 	int retval = 0, nrChan = 0 ;
-	unsigned char dcr_val = 0;
 	unsigned int tmpmode = 0;
 	struct ox16c954_port *ox; 
 	void *baseAdr;
+	unsigned int nrExpected = mod->nrChannels;
 
 	switch ( mod->modtype ) {
 	case MOD_M45:
@@ -2188,6 +8043,26 @@ static int register_uarts(UARTMOD_INFO *mod )
 		return -ENODEV;
 	}
 
+	/* the lines were reserved from devName, they must match the Module */
+	if (mod->nrChannels != nrExpected) {
+		printk(KERN_ERR "*** %s has %d channels, %d lines reserved!\n",
+			   mod->deviceName, mod->nrChannels, nrExpected );
+		return -ENODEV;
+	}
+
+	/* one contiguous array of ports and of ISR data per M-Module */
+	mod->hot = kcalloc(mod->nrChannels, sizeof(struct m77_chan_hot),
+					   GFP_KERNEL);
+	if (!mod->hot)
+		return -ENOMEM;
+
+	mod->ports = kcalloc(mod->nrChannels, sizeof(struct ox16c954_port),
+						 GFP_KERNEL);
+	if (!mod->ports)
+		return -ENOMEM;
+
+	men_uart_init_ports(mod);
+
 	/*
 	 *	Enable Interrupts in the additional IR Registers on locations:
 	 *	M77:	0x48
@@ -2197,27 +8072,28 @@ static int register_uarts(UARTMOD_INFO *mod )
 	switch ( mod->modtype ) {
 	case MOD_M45:
 		M77DBG2("Init M45N Registers\n");
-		control_out( mod->memBase, M45_REG_IR1, M77_IR_IMASK );
-		control_out( mod->memBase, M45_REG_IR2, M77_IR_IMASK );
+		control_out( mod, M45_REG_IR1, M77_IR_IMASK );
+		control_out( mod, M45_REG_IR2, M77_IR_IMASK );
 		break;
 
 	case MOD_M69:
 		M77DBG2("Init M69N Register\n");
-		control_out( mod->memBase, M69_REG_IR, M77_IR_IMASK );
+		control_out( mod, M69_REG_IR, M77_IR_IMASK );
 		break;
 
 	case MOD_M77:
 		/* On M77 also enable the galvanic isolated Drivers */
 		M77DBG2("Init M77 Register \n");		
-		control_out( mod->memBase, M77_REG_IR, M77_IR_IMASK | M77_IR_DRVEN );
+		control_out( mod, M77_REG_IR, M77_IR_IMASK | M77_IR_DRVEN );
 		break;
 	}
 
 
 	/*  Register all channels of this M-Module  */
 	for ( nrChan = 0; nrChan < mod->nrChannels; nrChan++ ) {
-		dcr_val = 0;
-		mod->uart.flags 	= UPF_SHARE_IRQ | UPF_BOOT_AUTOCONF;
+		mod->uart.flags 	= UPF_SHARE_IRQ;
+		if (fullProbe)
+			mod->uart.flags |= UPF_BOOT_AUTOCONF;
 		mod->uart.uartclk 	= MM_UARTCLK;
 		mod->uart.iotype 	= UPIO_MEM;
 		mod->uart.irq 		= 0xff; /* dummy Info, unused by this driver */
@@ -2235,32 +8111,293 @@ static int register_uarts(UARTMOD_INFO *mod )
 		mod->uart.membase 	= baseAdr;
 		mod->uart.mapbase 	= (unsigned long)(unsigned long*)baseAdr;
 		
+		ox = &mod->ports[nrChan];
+		ox->hot->membase	= baseAdr;
+
+		/* Module type is known, check each OX16C954 once and skip autoconfig */
+		if (!fullProbe) {
+			ox->port.membase = baseAdr;
+			if (!(nrChan % OX954_CHAN_NUM) &&
+				(retval = m77_check_chip_id(ox)) < 0) {
+				ox->port.membase = NULL;	/* not registered, skip in deinit */
+				return retval;
+			}
+			m77_fast_config(ox);
+		}
+
 		if ((retval=men_uart_register_port(&mod->uart, mod->modtype, nrChan, 
-										   &mod->port8250[nrChan]))<0) {
+										   ox))<0) {
 
 			printk(KERN_ERR "*** Error during registering UART %d!\n", nrChan);
 			return retval;
-		} else
-			mod->line = retval;
+		}
+
+		if ((retval = m77_raw_add(ox)) < 0) {
+			printk(KERN_ERR "*** Error creating "RAW_NAME_PREFIX"%d!\n",
+				   ox->port.line);
+			return retval;
+		}
 
-		ox = mod->port8250[nrChan]; /* is valid now */
+		if ((retval = m77_serdev_add(ox)) < 0)
+			return retval;
+
+		m77_hist_add(ox);
 
 		/* on M77, also set phy mode and echo and switch it on */
-		tmpmode = mod->mode[nrChan];
-		if ( mod->modtype == MOD_M77 && tmpmode ) {
-			dcr_val |= tmpmode;
-			/* echoing only for HD modes! unknown effects at other modes.. */
-			if ( (( tmpmode==M77_RS422_HD) || (tmpmode==M77_RS485_HD )) && (mod->echo[nrChan])) 
-			{
-				dcr_val |= M77_RX_EN;
+		tmpmode = m77_phy_setup(mod, nrChan);
+		if ( tmpmode )
+			ox->m77Mode = tmpmode;	/* save M77 mode */
+	}
+	return 0;
+}
+
+
+/*******************************************************************/
+/** Measure the register access times of an M-Module and estimate the
+ *  line load it can take
+ *
+ * \param mmod		\IN  identified M-Module, its IRQ not installed yet
+ *
+ * \brief Times reads and writes of the scratch register of UART 0 in
+ *        CALIB_ROUNDS rounds of CALIB_BATCH accesses each, with the
+ *        local interrupts off. Writes may be posted by the carrier, each
+ *        write batch is closed with a read whose time is subtracted.
+ *
+ *        From these times the bus time per char is derived with the
+ *        accesses the driver makes: a char received costs the RBR and
+ *        the LSR read, a char sent the THR write. Each port service adds
+ *        the IR read(s), the IIR scan of all channels, LSR, MSR and the
+ *        IR clear; it moves one RX trigger level (8 chars, FCR of the
+ *        16C950 entry in uart_config) or one TX load (tx_loadsz). maxBaud
+ *        is the sum of the baudrates of all channels, each receiving and
+ *        sending 8N1 at full rate, that keeps the M-Module access busy
+ *        all the time. Above it the RX FIFOs will overrun, CPU time and
+ *        other M-Modules on the carrier come on top.
+ *
+ * \return 			-
+ */
+static void m77_calibrate(UARTMOD_INFO *mmod)
+{
+	void *scr = mmod->memBase + (UART_SCR << 1);
+	unsigned int trig, load, svcRd, i, r;
+	unsigned long flags;
+	u64 t, rd = 0, wr = 0, svc, num, den;
+	u16 old;
+
+	old = MREAD_D16(mmod->memBase, UART_SCR << 1);
+	for (r = 0; r < CALIB_ROUNDS; r++) {
+		local_irq_save(flags);
+		t = ktime_get_ns();
+		for (i = 0; i < CALIB_BATCH; i++)
+			MREAD_D16(scr, 0);
+		rd += ktime_get_ns() - t;
+
+		t = ktime_get_ns();
+		for (i = 0; i < CALIB_BATCH; i++)
+			MWRITE_D16(scr, 0, i);
+		MREAD_D16(scr, 0);
+		wr += ktime_get_ns() - t;
+		local_irq_restore(flags);
+	}
+	MWRITE_D16(mmod->memBase, UART_SCR << 1, old);
+
+	mmod->rdNs = div_u64(rd, CALIB_ROUNDS * CALIB_BATCH);
+	wr = div_u64(wr, CALIB_ROUNDS);
+	mmod->wrNs = div_u64(wr > mmod->rdNs ? wr - mmod->rdNs : 0, CALIB_BATCH);
+
+	/* set_termios leaves the EFR ECB off, 550 mode trigger levels */
+	trig	= m77_rx_trigger(uart_config[PORT_16C950].fcr, 0);
+	load	= uart_config[PORT_16C950].tx_loadsz;
+	svcRd	= (mmod->modtype == MOD_M45 ? 2 : 1) + mmod->nrChannels + 2;
+	svc		= (u64)svcRd * mmod->rdNs + mmod->wrNs;
+
+	/* ns per char both ways: 2 rd + svc / trig + wr + svc / load */
+	num = 10ULL * NSEC_PER_SEC * trig * load;
+	den = (2ULL * mmod->rdNs * trig + svc) * load +
+		((u64)mmod->wrNs * load + svc) * trig;
+	mmod->maxBaud = den ? div64_u64(num, den) : ULONG_MAX;
+
+	printk(KERN_INFO "%s: register read %u ns, write %u ns, max. %lu baud "
+		   "on all %u channels\n", mmod->deviceName, mmod->rdNs,
+		   mmod->wrNs, mmod->maxBaud, mmod->nrChannels);
+}
+
+
+/*******************************************************************/
+/** Read the capacity estimate, module parameter "capacity"
+ *
+ * \brief Per M-Module the measured read and write ns, maxBaud of
+ *        m77_calibrate() and the sum of the baudrates set on its lines
+ *        in use. A sum above maxBaud will overrun at full line load.
+ */
+static int m77_capacity_get(char *buf, const struct kernel_param *kp)
+{
+	struct ox16c954_port *up;
+	UARTMOD_INFO *mmod;
+	struct list_head *pos;
+	unsigned long sum;
+	unsigned int i, quot;
+	int n = 0;
+
+	list_for_each( pos, &G_uartModListHead ) {
+		mmod = list_entry(pos, UARTMOD_INFO, head);
+		if (!mmod->maxBaud)
+			continue;		/* not probed */
+		sum = 0;
+		/* pairs with smp_store_release() in m77_probe_module() */
+		if (smp_load_acquire(&mmod->ready))
+			for (i = 0; i < mmod->nrChannels; i++) {
+				up = &mmod->ports[i];
+				quot = READ_ONCE(up->quot);
+				if (test_bit(0, &up->inUse) && quot)
+					sum += up->port.uartclk / (16 * quot);
 			}
-			control_out(mod->memBase, (M77_DCR_REG_BASE+nrChan) << 1, dcr_val);
-			
-			/* save M77 mode */
-			ox->m77Mode = tmpmode;
-		}
+		n += scnprintf(buf + n, PAGE_SIZE - n, "%s %u %u %lu %lu\n",
+					   mmod->deviceName, mmod->rdNs, mmod->wrNs,
+					   mmod->maxBaud, sum);
 	}
-	return retval;
+	return n;
+}
+
+
+/*******************************************************************/
+/** Open, identify and register one M-Module
+ *
+ * \param mmod		\IN  per-module struct, filled by m77_init_devices()
+ *
+ * \brief Runs concurrently for all M-Modules. The MDIS calls which
+ * change carrier board state are serialized by G_mdisLock, the module
+ * identification (ID EEPROM read) and the registration of the UART
+ * channels run in parallel. The channels of this M-Module are usable as
+ * soon as it returns, independent of the other M-Modules.
+ *
+ * \return 			0 on success or negative error code
+ */
+static int m77_probe_module(UARTMOD_INFO *mmod)
+{
+
+	u_int32 modtype = 0, devid = 0, devrev = 0, modnr = 0;
+	char moddevname[64];
+	char *dev = mmod->deviceName, *brd = mmod->brdName;
+	int slot = m77_param_int(&slotNo, mmod->modnum);
+	int retval;
+
+	mutex_lock(&G_mdisLock);
+	retval=mdis_open_external_dev( dev, 
+				       brd,
+				       slot, 
+				       MDIS_MA08, 
+				       MDIS_MD08, 
+				       256, 
+				       &mmod->memBase,
+				       NULL, 
+				       &mmod->mdisDev );
+	mutex_unlock(&G_mdisLock);
+		
+	M77DBG3("called mdis_open_external_dev for '%s' board '%s' slot %d.\n",
+			dev, brd, slot );
+	M77DBG3("returnvalue %d. membase=0x%08x\n",retval, mmod->memBase);
+
+	if (retval < 0) {
+		printk(KERN_ERR "*** open '%s' failed: board %s slot %d!\n",
+			   dev, brd, slot );
+		printk(KERN_ERR "hint: forgot mdis_createdev -b %s ?\n",
+			   brd);
+		mmod->mdisDev = NULL;
+		return -EIO;
+	}
+
+	if ( m_getmodinfo( (unsigned long)((unsigned long*)mmod->memBase), 
+					   &modtype, &devid, 
+					   &devrev, moddevname) != 0) {
+		printk(KERN_ERR "*** Error identifying M-Module %s!\n", dev);
+		return -ENODEV;
+	}
+	M77DBG3("getmodinfo found: '%s' devID: 0x%08x\n",moddevname,devid);
+
+	modnr = devid & 0xffff;
+	mmod->modtype = modnr;
+
+	/*  sanity checks against wrong driver insertion */
+	if ((strncmp("m45" ,dev, 3 ) && (modnr == MOD_M45)) ||
+		(strncmp("m69" ,dev, 3 ) && (modnr == MOD_M69)) ||
+		(strncmp("m77" ,dev, 3 ) && (modnr == MOD_M77))) {
+		printk(KERN_ERR "*** Error: passed '%s' but found '%s'\n",
+			   dev, moddevname );
+		return -ENODEV;
+	}
+
+	if ((modnr != MOD_M45) && (modnr != MOD_M69) &&(modnr != MOD_M77)){
+		printk(KERN_ERR "*** Error: unknown Module (0x%04x)!\n", devid);
+		return -ENODEV;
+	} 
+
+	/* before the IRQ and the ttyDs, nothing else touches the UARTs yet */
+	m77_calibrate(mmod);
+
+	M77DBG("Carrier %s: Registering ISR for %s\n", brd, dev );
+	mutex_lock(&G_mdisLock);
+	retval = mdis_install_external_irq(	mmod->mdisDev,	M77_IrqHandler,
+										(void*)mmod);
+	mutex_unlock(&G_mdisLock);
+	if ( retval < 0 ) {	
+		printk(KERN_ERR "*** install irq error: %d\n", retval);
+		return -EBUSY;
+	}
+
+	if ( mmod->modtype == MOD_M77 ) 		
+		parse_m77_phyinfo(mmod, mmod->modnum);
+
+	if (m77_param_int(&userMode, mmod->modnum)) {
+		/* user space drives the UARTs, the ttyD lines stay unused */
+		retval = m77_uio_add(mmod);
+		if ( retval < 0 )
+			return retval;
+	} else {
+		/* Register all UART channels of this M-Module */
+		retval = register_uarts(mmod);
+		if ( retval < 0 )
+			return retval;
+
+		/* let the ISR scan this M-Module, pairs with smp_load_acquire() */
+		smp_store_release(&mmod->ready, 1);
+	}
+
+	mutex_lock(&G_mdisLock);
+	retval = mdis_enable_external_irq( mmod->mdisDev );
+	mutex_unlock(&G_mdisLock);
+	if ( retval < 0 ) {	
+		printk(KERN_ERR "*** enable irq error: %d\n", retval);
+		return -EBUSY;
+	}
+
+	return 0;
+}
+
+/*******************************************************************/
+/** async_schedule_domain() wrapper around m77_probe_module()
+ *
+ * \param data		\IN  per-module struct
+ * \param cookie	\IN  async cookie, unused
+ */
+static void m77_probe_module_async(void *data, async_cookie_t cookie)
+{
+	UARTMOD_INFO *mmod = data;
+	ktime_t start = ktime_get();
+
+	mmod->probeErr	= m77_probe_module(mmod);
+	mmod->probeUs	= ktime_us_delta(ktime_get(), start);
+
+	if (!mmod->probeErr && mmod->uio)
+		printk(KERN_INFO "%s: user mode, %s%d..%d unused, probed in %lld us\n",
+			   mmod->deviceName, UART_NAME_PREFIX, mmod->lineBase,
+			   mmod->lineBase + mmod->nrChannels - 1,
+			   (long long)mmod->probeUs);
+	else if (!mmod->probeErr)
+		printk(KERN_INFO "%s: %s%d..%d ready, probed in %lld us\n",
+			   mmod->deviceName, UART_NAME_PREFIX, mmod->lineBase,
+			   mmod->lineBase + mmod->nrChannels - 1,
+			   (long long)mmod->probeUs);
 }
 
 
@@ -2268,31 +8405,28 @@ static int register_uarts(UARTMOD_INFO *mod )
 /** main enumeration and initialization Function of all Modules
  *
  * \brief
- * The passed module Parameters are parsed and for each given Module
- * and a call to mdis_open_external_dev() is done. For each new 
- * carrier board a call to mdis_install_external_irq() is done because
- * from CPU View the IRQ s of all M-Modules on the same Carrier are
- * equal.
+ * The passed module Parameters are parsed and one UARTMOD_INFO per
+ * M-Module is set up, including its reserved ttyD lines. Then all
+ * M-Modules are probed in parallel by m77_probe_module(), which does the
+ * calls to mdis_open_external_dev() and mdis_install_external_irq() and
+ * registers the UART channels. From CPU View the IRQ s of all M-Modules
+ * on the same Carrier are equal, so the ISR walks the whole list.
  *
  * \return 			0 on success or negative error code
  */
 static int m77_init_devices(void)
 {
 
-	u_int32 modtype = 0, devid = 0, devrev = 0, modnr = 0;
-	char moddevname[64];
-    unsigned int m_idx = 0;
+    unsigned int m_idx = 0, nrUp = 0;
 	int retval = 0;
-    char device[ARRLEN];
-	char prevBrdName[ARRLEN];
 	UARTMOD_INFO *mmod_data = NULL;
-
-	memset( device, 0x0, sizeof(device));
-	memset( prevBrdName, 0x0, sizeof(prevBrdName));
+	struct list_head *pos;
+	char *dev, *brd;
+	int slot;
 
     INIT_LIST_HEAD( &G_uartModListHead );	
 
-	if ( brdName[m_idx] == NULL ) {
+	if ( m77_param_str(&brdName, m_idx) == NULL ) {
 		printk(KERN_ERR 
 			   " *** Error: No BBIS device specified, e.g.'brdName=d201_1'\n");
 		retval = -EINVAL;
@@ -2302,125 +8436,45 @@ static int m77_init_devices(void)
 	/*-----------------------------+
 	 |  For each M-Module do..     |
      +-----------------------------*/
-    while( devName[m_idx] )  {
-		
-		strncpy( device, devName[m_idx], ARRLEN-1 );
+    while( (dev = m77_param_str(&devName, m_idx)) != NULL )  {
 
-		/* kmalloc one UARTMOD_INFO struct per M-Module   */	
-		if ((mmod_data = kmalloc(sizeof(UARTMOD_INFO), GFP_KERNEL)) == NULL ){
-			retval = -ENOMEM;
+		brd  = m77_param_str(&brdName, m_idx);
+		slot = m77_param_int(&slotNo, m_idx);
+		if ( brd == NULL ) {
+			printk(KERN_ERR " *** Error: No BBIS device specified for '%s'\n",
+				   dev);
+			retval = -EINVAL;
 			goto errout;
 		}
-		memset( mmod_data, 0x0, sizeof(UARTMOD_INFO) );
-
-		/* store index, devicename, list element etc */
-		mmod_data->modnum = m_idx;	
-		strncpy( mmod_data->brdName, brdName[m_idx], ARRLEN-1 );
-		list_add(&mmod_data->head, &G_uartModListHead );
 
-		if ( slotNo[m_idx] > 3 ) {
+		if ( slot > 3 ) {
 			printk(KERN_ERR " *** Error: Slotnumber %d invalid (use 0..3)\n", 
-				   slotNo[m_idx]);
+				   slot);
 			retval = -EINVAL;
 			goto errout;
 		}
 
-		retval=mdis_open_external_dev( device, 
-					       brdName[m_idx],
-					       slotNo[m_idx], 
-					       MDIS_MA08, 
-					       MDIS_MD08, 
-					       256, 
-					       &mmod_data->memBase,
-					       NULL, 
-					       &mmod_data->mdisDev );
-		
-		M77DBG3("called mdis_open_external_dev for '%s' board '%s' slot %d.\n",
-				devName[m_idx], brdName[m_idx], slotNo[m_idx] );
-		M77DBG3("returnvalue %d. membase=0x%08x\n",retval, mmod_data->memBase);
-
-		if (retval < 0) {
-			printk(KERN_ERR "*** open '%s' failed: board %s slot %d!\n",
-				   devName[m_idx], brdName[m_idx], slotNo[m_idx] );
-			printk(KERN_ERR "hint: forgot mdis_createdev -b %s ?\n",
-				   brdName[m_idx]);
-
-			retval 	= -EIO;
-			goto errout;
-		}
-
-		if ( m_getmodinfo( (unsigned long)((unsigned long*)mmod_data->memBase), 
-				   &modtype, &devid, 
-				   &devrev, moddevname) == 0) {
-			M77DBG3("getmodinfo found: '%s' devID: 0x%08x\n",moddevname,devid);
-
-			modnr = devid & 0xffff;
-			mmod_data->modtype = modnr;
-			strncpy( mmod_data->deviceName, device, ARRLEN-1 );
-			mmod_data->deviceName[ARRLEN-1] = '\0';
-
-			/*  sanity checks against wrong driver insertion */
-			if (strncmp("m45" ,devName[m_idx], 3 ) && (modnr == MOD_M45)){
-				printk(KERN_ERR "*** Error: passed '%s' but found '%s'\n",
-					   devName[m_idx], moddevname );
-				retval = -ENODEV;
-				goto errout;	
-			}
-			
-			if (strncmp("m69" ,devName[m_idx], 3) && (modnr == MOD_M69)) {
-				printk(KERN_ERR "*** Error: passed '%s' but found '%s'\n",
-					   devName[m_idx], moddevname );
-				retval = -ENODEV;
-				goto errout;
-			} 
-			
-			if (strncmp("m77" ,devName[m_idx], 3) && (modnr == MOD_M77)) {
-				printk(KERN_ERR "*** Error: passed '%s' but found '%s'\n",
-					   devName[m_idx], moddevname );
-				retval = -ENODEV;
-				goto errout;				
-			} 
-
-			if ((modnr != MOD_M45) && (modnr != MOD_M69) &&(modnr != MOD_M77)){
-				printk(KERN_ERR "*** Error: unknown Module (0x%04x)!\n", devid);
-				retval = -ENODEV;
-				goto errout;				
-			} 
-
-		} else {
-			printk("*** Error identifying M-Module!\n");
-			retval = -ENODEV;
-			goto errout;
-		}
-		
-		M77DBG("Carrier now %s: Registering new ISR\n", brdName[m_idx] );
-		retval = mdis_install_external_irq(	mmod_data->mdisDev,	M77_IrqHandler,
-											(void*)mmod_data);
-		if ( retval < 0 ) {	
-			printk(KERN_ERR "*** install irq error: %d\n", retval);
-			retval = -EBUSY;
+		/* kzalloc one UARTMOD_INFO struct per M-Module   */	
+		if ((mmod_data = kzalloc(sizeof(UARTMOD_INFO), GFP_KERNEL)) == NULL ){
+			retval = -ENOMEM;
 			goto errout;
 		}
 
-		if ( mmod_data->modtype == MOD_M77 ) 		
-			parse_m77_phyinfo(mmod_data, m_idx);
-
-		/* Register all UART channels of this M-Module */
-		register_uarts(mmod_data);
+		/* store index, names, list element etc */
+		mmod_data->modnum = m_idx;	
+		strncpy( mmod_data->brdName, brd, ARRLEN-1 );
+		strncpy( mmod_data->deviceName, dev, ARRLEN-1 );
+		mutex_init( &mmod_data->lock );
+		list_add_tail(&mmod_data->head, &G_uartModListHead );
 
-		retval = mdis_enable_external_irq( mmod_data->mdisDev );
-		if ( retval < 0 ) {	
-			printk(KERN_ERR "*** enable irq error: %d\n", retval);
-			retval = -EBUSY;
-			goto errout;
-		}
-		/* current carrier becomes old one  */
-		strncpy(prevBrdName, brdName[m_idx], ARRLEN-1);
-		prevBrdName[ARRLEN-1] = '\0';
+		/* reserve contiguous ttyD lines, checked in register_uarts() */
+		mmod_data->nrChannels	= m77_name_channels(dev);
+		mmod_data->lineBase		= G_nextLine;
+		G_nextLine			   += mmod_data->nrChannels;
 
 		m_idx++; 
 
-	} /* end while(brdname... */
+	} /* end while(devName... */
 
 	/* was any M-Module processed at all ?  */
 	if (!m_idx) {
@@ -2430,8 +8484,33 @@ static int m77_init_devices(void)
 		goto errout;
 	}
 
+	/* the list is complete now, it is not changed until deinit_devices() */
+    list_for_each( pos, &G_uartModListHead ) {
+		mmod_data = list_entry(pos, UARTMOD_INFO, head);
+		async_schedule_domain(m77_probe_module_async, mmod_data,
+							  &m77_async_domain);
+	}
+	async_synchronize_full_domain(&m77_async_domain);
+
+	/* a failed M-Module is shut down alone, the others stay usable */
+    list_for_each( pos, &G_uartModListHead ) {
+		mmod_data = list_entry(pos, UARTMOD_INFO, head);
+		if (mmod_data->probeErr) {
+			printk(KERN_ERR "*** probing %s failed: %d\n",
+				   mmod_data->deviceName, mmod_data->probeErr);
+			m77_remove_module(mmod_data);
+			if (!retval)
+				retval = mmod_data->probeErr;
+		} else
+			nrUp++;
+	}
+	if (!nrUp)
+		goto errout;
+
 	return 0; 
  errout:
+	/* the debugfs files point to the ports, remove them first */
+	m77_hist_exit();
 	deinit_devices();	
 	return retval;
 }
@@ -2443,11 +8522,23 @@ static int __init m77_serial_init(void)
 {
 
 	int ret = 0;
+	unsigned int i;
 	printk(KERN_INFO "MEN M45/69/77 driver version %s\n", IdentString);
-	printk(KERN_INFO "Up to %d modules supported\n", MAX_MODS_SUPPORTED );
 
-	/* 2. Init the global Array of 16550(950) like ports */
-	men_uart_init_ports();
+	if (!ovrTrack)
+		static_branch_disable(&m77_ovr_key);
+
+	/* 2. Size the tty driver from the passed M-Modules */
+	for (i = 0; i < devName.num; i++)
+		men_uart_reg.nr += m77_name_channels(devName.str[i]);
+
+	if (!men_uart_reg.nr) {
+		printk(KERN_ERR 
+			   " *** Error: No MDIS Device specified, e.g. 'devName=m45_1'\n");
+		return -ENODEV;
+	}
+	printk(KERN_INFO "%d modules with %d UARTs configured\n",
+		   devName.num, men_uart_reg.nr );
 
 	/* 3. Register platform Driver */
 	ret = uart_register_driver( &men_uart_reg );
@@ -2456,7 +8547,35 @@ static int __init m77_serial_init(void)
 		goto out;
 	}
 
-	/* 4. Register the passed UART M-Modules */
+	/* 4. Reserve the raw ring devices, one per ttyD line */
+	ret = m77_raw_init( men_uart_reg.nr );
+	if (ret) {
+		printk(KERN_ERR "*** m77_raw_init returned %d\n", ret );
+		uart_unregister_driver(&men_uart_reg);
+		return ret;
+	}
+
+	/* 5. Register /dev/m77mux, /dev/m77tap and /dev/m77ctl */
+	ret = m77_mux_init();
+	if (ret) {
+		printk(KERN_ERR "*** m77_mux_init returned %d\n", ret );
+		m77_raw_exit( men_uart_reg.nr );
+		uart_unregister_driver(&men_uart_reg);
+		return ret;
+	}
+
+	/* 6. Register the bonded ttys */
+	ret = m77_bond_init();
+	if (ret) {
+		printk(KERN_ERR "*** m77_bond_init returned %d\n", ret );
+		m77_mux_exit();
+		m77_raw_exit( men_uart_reg.nr );
+		uart_unregister_driver(&men_uart_reg);
+		return ret;
+	}
+
+	/* 7. Register the passed UART M-Modules, their debugfs files too */
+	m77_hist_init();
 	ret = m77_init_devices();
 
 	if (ret) {
@@ -2464,6 +8583,10 @@ static int __init m77_serial_init(void)
 	}
 
 	if ( ret < 0 ) {		
+		m77_hist_exit();
+		m77_bond_exit();
+		m77_mux_exit();
+		m77_raw_exit( men_uart_reg.nr );
 		uart_unregister_driver(&men_uart_reg);
 		return ret;
 	} else if ( ret )
@@ -2473,7 +8596,11 @@ static int __init m77_serial_init(void)
 	return ret;
 
  unreg:
+	m77_hist_exit();
+	m77_bond_exit();
 	deinit_devices();
+	m77_mux_exit();
+	m77_raw_exit( men_uart_reg.nr );
 	uart_unregister_driver(&men_uart_reg);
 	return ret;
 }
@@ -2483,7 +8610,11 @@ static int __init m77_serial_init(void)
  */
 static void __exit m77_serial_cleanup(void)
 {
+	m77_hist_exit();
+	m77_bond_exit();
 	deinit_devices();
+	m77_mux_exit();
+	m77_raw_exit( men_uart_reg.nr );
 	uart_unregister_driver(&men_uart_reg);
 	return;
 }
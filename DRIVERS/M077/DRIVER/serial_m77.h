@@ -106,6 +106,213 @@
 #define M77_IR_IMASK     0x02  /* IR Register IRQ Mask (IRQ dis/enable bit) */
 #define M77_IR_IRQ     	 0x01  /* IR Register IRQ pending bit				*/
 
+/*
+ *  Raw ring device /dev/m77raw<line>, see serial_m77_doc.c
+ *
+ *  The whole area is mapped with one mmap() at offset 0:
+ *  struct m77_raw_hdr, RX ring at M77_RAW_RX_OFFSET, TX ring at
+ *  M77_RAW_TX_OFFSET. Ring indices are free running, the ring position
+ *  is (index & (size - 1)).
+ */
+#define M77_RAW_RX_SIZE		0x10000		/* RX ring size, power of 2		*/
+#define M77_RAW_TX_SIZE		0x4000		/* TX ring size, power of 2		*/
+#define M77_RAW_RX_OFFSET	0x1000		/* RX ring offset in mapping	*/
+#define M77_RAW_TX_OFFSET	(M77_RAW_RX_OFFSET + M77_RAW_RX_SIZE)
+#define M77_RAW_MAP_SIZE	(M77_RAW_TX_OFFSET + M77_RAW_TX_SIZE)
+
+struct m77_raw_hdr {
+	unsigned int rxHead;	/* driver: next RX byte written			*/
+	unsigned int rxTail;	/* user:   next RX byte to consume		*/
+	unsigned int txHead;	/* user:   next TX byte written			*/
+	unsigned int txTail;	/* driver: next TX byte sent			*/
+	unsigned int rxDropped;	/* driver: RX bytes lost, ring full		*/
+	unsigned int rxErrors;	/* driver: bytes with parity/frame/break */
+};
+
+/*  raw ring device ioctl: start sending the TX ring after txHead moved */
+#define M77_RAW_KICK       _IO(M77_IOCTL_MAGIC, M77_IOCTLBASE + 3)
+
+/*
+ *  Capture multiplexer /dev/m77mux, see serial_m77_doc.c
+ *
+ *  read() returns whole records, each a struct m77_mux_rec followed by
+ *  len data bytes, in the order the UARTs were drained. The data is
+ *  padded to a multiple of 8 bytes, so every record is naturally aligned.
+ */
+#define M77_MUX_MAX_PAYLOAD	256		/* max. data bytes per record		*/
+#define M77_MUX_ALIGN		8		/* record alignment in read()		*/
+
+/*  bytes of a record with len data bytes, the next record follows */
+#define M77_MUX_REC_SIZE(len) \
+	(sizeof(struct m77_mux_rec) + \
+	 (((len) + M77_MUX_ALIGN - 1) & ~(M77_MUX_ALIGN - 1)))
+
+#define M77_MUX_BREAK		0x01	/* record flags: break received		*/
+#define M77_MUX_PARITY		0x02	/* parity error						*/
+#define M77_MUX_FRAME		0x04	/* framing error					*/
+#define M77_MUX_OVERRUN		0x08	/* UART FIFO overrun				*/
+#define M77_MUX_LOST		0x80	/* records lost before this one		*/
+
+struct m77_mux_rec {
+	unsigned long long	timestamp;	/* ns, CLOCK_MONOTONIC at drain	*/
+	unsigned int		line;		/* ttyD line					*/
+	unsigned short		flags;		/* M77_MUX_xxx					*/
+	unsigned short		len;		/* data bytes following			*/
+};
+
+struct m77_mux_mask {
+	unsigned int base;		/* first ttyD line of mask				*/
+	unsigned int mask;		/* bit n set: capture line base + n		*/
+};
+
+/*  /dev/m77mux ioctl: select the captured lines base..base+31 */
+#define M77_MUX_SET_MASK   _IOW(M77_IOCTL_MAGIC, M77_IOCTLBASE + 4, struct m77_mux_mask)
+
+/*
+ *  Traffic tap /dev/m77tap, see serial_m77_doc.c
+ *
+ *  read() returns an array of struct m77_tap_rec. seq counts the records
+ *  of the line, a gap means the reader was too slow.
+ */
+#define M77_TAP_DATA		48		/* max. data bytes per record		*/
+#define M77_TAP_RX			0		/* dir: received by the UART		*/
+#define M77_TAP_TX			1		/* dir: sent by the UART			*/
+
+struct m77_tap_rec {
+	unsigned long long	timestamp;	/* ns, CLOCK_MONOTONIC			*/
+	unsigned int		seq;		/* record nr. of this line		*/
+	unsigned char		dir;		/* M77_TAP_RX / M77_TAP_TX		*/
+	unsigned char		flags;		/* RX: M77_MUX_xxx error flags	*/
+	unsigned short		len;		/* valid bytes in data			*/
+	unsigned char		data[M77_TAP_DATA];
+};
+
+/*  /dev/m77tap ioctl: monitor the ttyD line passed as argument */
+#define M77_TAP_ATTACH     _IO(M77_IOCTL_MAGIC, M77_IOCTLBASE + 5)
+
+/*
+ *  Serial bridge, ttyD ioctls, see serial_m77_doc.c
+ *
+ *  The data received on the line is sent on line peer. peer = -1 removes
+ *  the bridge. fwdBytes/dropBytes are returned by M77_BRIDGE_GET only.
+ */
+#define M77_BRIDGE_BIDIR	0x01	/* also forward peer -> this line	*/
+#define M77_BRIDGE_FLOW		0x02	/* stop RX while the peer is full	*/
+
+struct m77_bridge {
+	int				peer;		/* ttyD line to forward to, -1: none	*/
+	unsigned int	flags;		/* M77_BRIDGE_xxx						*/
+	unsigned int	fwdBytes;	/* bytes forwarded to peer				*/
+	unsigned int	dropBytes;	/* bytes dropped, peer closed or full	*/
+};
+
+#define M77_BRIDGE_SET     _IOW(M77_IOCTL_MAGIC, M77_IOCTLBASE + 6, struct m77_bridge)
+#define M77_BRIDGE_GET     _IOR(M77_IOCTL_MAGIC, M77_IOCTLBASE + 7, struct m77_bridge)
+
+/*
+ *  Bonded ttys /dev/ttyDB<n>, see serial_m77_doc.c
+ *
+ *  Frame sent on a member line:
+ *    M77_BOND_SYNC, seq low, seq high, len, ~(seq low + seq high + len),
+ *    len data bytes, 8 bit sum of the data bytes
+ *  seq counts the frames of the bond, 16 bit, wrapping.
+ */
+#define M77_BOND_SYNC			0xa5
+#define M77_BOND_HDR			5		/* header bytes						*/
+#define M77_BOND_OVERHEAD		(M77_BOND_HDR + 1)
+#define M77_BOND_MAX_PAYLOAD	128		/* max. data bytes per frame		*/
+#define M77_BOND_MAX_MEMBERS	8		/* max. ttyD lines per bond			*/
+
+struct m77_bond_info {
+	unsigned int	nMembers;
+	int				line[M77_BOND_MAX_MEMBERS];	/* member ttyD lines	*/
+	unsigned int	txFrames;	/* frames sent							*/
+	unsigned int	rxFrames;	/* frames delivered in order			*/
+	unsigned int	rxLost;		/* frames skipped, not received in time	*/
+	unsigned int	rxBad;		/* frames with bad header or checksum	*/
+};
+
+/*  ttyDB ioctls, M77_BOND_ADD/DEL: argument is the member ttyD line */
+#define M77_BOND_ADD       _IO(M77_IOCTL_MAGIC, M77_IOCTLBASE + 8)
+#define M77_BOND_DEL       _IO(M77_IOCTL_MAGIC, M77_IOCTLBASE + 9)
+#define M77_BOND_INFO      _IOR(M77_IOCTL_MAGIC, M77_IOCTLBASE + 10, struct m77_bond_info)
+
+/*
+ *  Network interface m77n<n> on a ttyD line, see serial_m77_doc.c
+ *  M77_NET_ATTACH argument: M77_NET_xxx flags
+ */
+#define M77_NET_LOOPBACK	0x01	/* UART internal loopback (MCR LOOP)	*/
+
+#define M77_NET_ATTACH     _IO(M77_IOCTL_MAGIC, M77_IOCTLBASE + 11)
+#define M77_NET_DETACH     _IO(M77_IOCTL_MAGIC, M77_IOCTLBASE + 12)
+
+/*
+ *  RX filter on a ttyD line, see serial_m77_doc.c
+ *
+ *  The BPF_PROG_TYPE_SOCKET_FILTER program sees a block of received chars
+ *  as packet data and returns:
+ *    0							drop the block
+ *    M77_BPF_REDIRECT | line	send the block on ttyD line instead
+ *    n, other values			pass the first n chars to the tty
+ */
+#define M77_BPF_REDIRECT	0x00010000
+
+struct m77_bpf_stats {
+	unsigned int	passBytes;	/* chars passed to the tty				*/
+	unsigned int	dropBytes;	/* chars dropped						*/
+	unsigned int	redirBytes;	/* chars sent on the redirect line		*/
+	unsigned int	redirLost;	/* redirected, line closed or full		*/
+};
+
+/*  M77_BPF_ATTACH argument: program fd, -1 detaches */
+#define M77_BPF_ATTACH     _IO(M77_IOCTL_MAGIC, M77_IOCTLBASE + 13)
+#define M77_BPF_STATS      _IOR(M77_IOCTL_MAGIC, M77_IOCTLBASE + 14, struct m77_bpf_stats)
+
+/*
+ *  Statistics snapshot /dev/m77ctl, see serial_m77_doc.c
+ *
+ *  read() returns struct m77_stats_hdr followed by nRecs times
+ *  struct m77_stats_rec, one per registered ttyD line in line order.
+ *  Fields are only appended at the end of the structs, a reader uses
+ *  hdrSize and recSize to step over the ones it does not know. version
+ *  is incremented if the meaning of an existing field changes.
+ */
+#define M77_STATS_VERSION	1
+
+#define M77_STATS_OPEN		0x01	/* rec flags: UART in use (ttyD etc.)	*/
+#define M77_STATS_CTS_FLOW	0x02	/* CRTSCTS set on the line				*/
+#define M77_STATS_TX_STALL	0x04	/* CTS low right now					*/
+#define M77_STATS_RX_STALL	0x08	/* RX held off right now				*/
+
+struct m77_stats_hdr {
+	unsigned int		version;	/* M77_STATS_VERSION				*/
+	unsigned int		hdrSize;	/* sizeof(struct m77_stats_hdr)		*/
+	unsigned int		recSize;	/* sizeof(struct m77_stats_rec)		*/
+	unsigned int		nPorts;		/* registered ttyD lines			*/
+	unsigned int		nRecs;		/* records following, < nPorts if	*/
+	unsigned int		res;		/*   the read() buffer was too small */
+	unsigned long long	timestamp;	/* ns, CLOCK_MONOTONIC at start		*/
+	unsigned long long	duration;	/* ns to collect all records		*/
+};
+
+struct m77_stats_rec {
+	unsigned int		line;		/* ttyD line						*/
+	unsigned int		flags;		/* M77_STATS_xxx					*/
+	unsigned long long	rxBytes;	/* chars received					*/
+	unsigned long long	txBytes;	/* chars sent						*/
+	unsigned int		overrun;	/* UART RX FIFO overruns			*/
+	unsigned int		bufOverrun;	/* chars lost, tty buffer full		*/
+	unsigned int		frame;		/* framing errors					*/
+	unsigned int		parity;		/* parity errors					*/
+	unsigned int		brk;		/* breaks received					*/
+	unsigned int		res;		/* reserved, 0						*/
+	unsigned long long	irqs;		/* interrupt services of the port	*/
+	unsigned int		rxHigh;		/* most chars of one RX FIFO drain	*/
+	unsigned int		txHigh;		/* most chars of one TX FIFO refill	*/
+	unsigned long long	txStallNs;	/* TX held by CTS, CRTSCTS set		*/
+	unsigned long long	rxStallNs;	/* RX held off, bridge flow control	*/
+};
+
 
 #endif /* _LINUX_SERIAL_M77_H */
 
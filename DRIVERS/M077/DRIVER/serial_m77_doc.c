@@ -129,6 +129,497 @@ Code: M77_PHYS_INT_SET   Arguments:  M77_RS422_HD
 
     See LINUX/DRIVERS/M077/DRIVER/serial_m77.h for their definitions.
 
+	\n \section rawdev Raw ring devices
+
+	For each ttyD<nr> line a character device /dev/m77raw<nr> is created.
+	While it is open, received bytes are written by the interrupt handler
+	directly into a RX ring and bytes to send are taken from a TX ring,
+	both mapped into the application. The tty layer is bypassed, no
+	read() or write() calls are needed.
+
+	The ttyD line must be opened first and stays open, it holds the line
+	settings (baudrate, parity, ...) and keeps the UART running. Only one
+	process can open the raw device of a line. open() returns EBUSY
+	while the line is bridged, bonded, subscribed by /dev/m77mux or used
+	as network interface or serdev.
+
+	Map M77_RAW_MAP_SIZE bytes at offset 0. The mapping starts with
+	struct m77_raw_hdr, followed by the RX ring at M77_RAW_RX_OFFSET and
+	the TX ring at M77_RAW_TX_OFFSET. The indices are free running.
+	- RX: the driver advances rxHead, the application consumes up to
+	  rxHead and then sets rxTail. Bytes arriving while the ring is full
+	  are counted in rxDropped, break characters are not stored.
+	- TX: the application writes data, advances txHead and calls the
+	  ioctl M77_RAW_KICK. The driver advances txTail while sending.
+
+	poll() reports POLLIN for RX data, POLLOUT for free TX ring space and
+	POLLHUP when the ttyD line was closed.
+
+	Bulk data, e.g. a firmware image, can be sent with sendfile() or
+	splice() to the raw device without mapping it. The pages of the file
+	(or pipe) are queued, up to 64 of them, and the interrupt handler
+	fills the TX FIFO directly from them: no copy through the 4 KiB tty
+	xmit buffer and one wakeup per sent page instead of one per
+	WAKEUP_CHARS. The call returns when the data is queued, sending goes
+	on in the background; closing the raw device drops what is not sent
+	yet. Queued pages are sent after the TX ring ran empty.
+
+	\n \section muxdev Capture multiplexer
+
+	/dev/m77mux delivers the received data of many lines through one file
+	descriptor. With the ioctl M77_MUX_SET_MASK (struct m77_mux_mask) the
+	lines base..base+31 are selected, a set bit captures that line. The
+	received data of a captured line goes to /dev/m77mux instead of its
+	ttyD, which must still be open for the line settings.
+
+	read() returns whole records in the order the UARTs were drained. Each
+	record is a struct m77_mux_rec (line, timestamp, error flags, length)
+	followed by up to M77_MUX_MAX_PAYLOAD data bytes, padded so that the
+	next record is 8 byte aligned: it starts M77_MUX_REC_SIZE(len) bytes
+	after the current one. The read buffer must hold at least one record
+	of maximum size. If records had to be dropped
+	because the reader was too slow, the next record has M77_MUX_LOST set.
+
+	Only one process can open /dev/m77mux, on close all lines return to
+	their ttyD. M77_MUX_SET_MASK fails with EBUSY and changes nothing if
+	a line to capture has an open /dev/m77raw device, is bridged, bonded
+	or used as network interface or serdev.
+
+	\n \section tapdev Traffic tap
+
+	/dev/m77tap monitors a line without disturbing its reader: the data
+	received and sent by the UART is copied, the line keeps working as
+	before on its ttyD, /dev/m77raw or /dev/m77mux. Any number of
+	processes can open /dev/m77tap, each selects its line with the ioctl
+	M77_TAP_ATTACH (argument: ttyD line number). Several taps on the same
+	line all get the complete traffic.
+
+	read() returns an array of struct m77_tap_rec. Each record holds up to
+	M77_TAP_DATA bytes of one direction (M77_TAP_RX/M77_TAP_TX), a
+	timestamp and for RX the M77_MUX_xxx error flags. The records of a
+	line are numbered in seq, the last 1024 are kept. A tap which reads
+	too slow finds the older ones overwritten and sees a gap in seq.
+
+	While no tap is attached to any line, the copy is disabled by a static
+	key and costs nothing in the interrupt path.
+
+	\n \section bridge Serial bridge
+
+	Two ttyD lines can be bridged in the driver, e.g. a RS232 device onto
+	a RS485 bus, without a process copying the data. The ioctl
+	M77_BRIDGE_SET on an open ttyD (struct m77_bridge) forwards the data
+	received on this line to the line peer, peer = -1 removes the bridge.
+	With M77_BRIDGE_BIDIR the data received on peer is forwarded back too.
+	Both lines must be open and configured through their ttyD, the data
+	written to the peer ttyD is sent as well. A line can be fed by one
+	bridge only. A new M77_BRIDGE_SET replaces the current bridge of the
+	line; if it fails (EINVAL, EBUSY, EOPNOTSUPP) the current bridge stays.
+
+	Without M77_BRIDGE_FLOW data the peer cannot buffer is dropped. With
+	it the driver stops reading the line while the peer's transmit buffer
+	is full, e.g. because the peer itself is held off by CTS. Then the
+	UART FIFO fills up and, with CRTSCTS set on the line, the driver
+	drops RTS to stop the sender until the peer caught up. The M77 has no RTS/CTS lines, so
+	M77_BRIDGE_SET fails with EOPNOTSUPP for M77_BRIDGE_FLOW on a M77
+	line that is read from (the line, and peer with M77_BRIDGE_BIDIR).
+
+	M77_BRIDGE_GET returns the current setting and the forwarded and
+	dropped byte counters. The bridge is removed when the line is closed.
+
+	\n \section bond Channel bonding
+
+	The ttys /dev/ttyDB0..3 stripe one data stream over several ttyD
+	lines, on the same or on different M-Modules, for more throughput than
+	one channel gives. The lines are added with the ioctl M77_BOND_ADD
+	(argument: ttyD line) on the open ttyDB and removed with M77_BOND_DEL.
+	The member ttyDs must be open and configured (baudrate, CRTSCTS) by
+	the application, their received data goes to the ttyDB.
+
+	Written data is sent in frames of up to M77_BOND_MAX_PAYLOAD bytes
+	with a small header holding a sequence number, see serial_m77.h. Each
+	frame goes to the member with the most free space in its transmit
+	buffer, so faster or idle lines get more of the data. The receiving
+	side, the ttyDB on the other end, puts the frames back into order.
+
+	If a member is lost, e.g. its cable is pulled or its ttyD closed, no
+	more frames are sent on it. Frames lost with it are skipped by the
+	receiver after bondGapMs or when 64 later frames are waiting, the
+	stream goes on with the remaining members. M77_BOND_INFO returns the
+	members and frame counters, rxLost counts the skipped frames.
+
+	\n \section netdev Network interface
+
+	The ioctl M77_NET_ATTACH on an open ttyD registers a network interface
+	m77n<n> for the line, so IP packets can be sent over it with the
+	standard socket tools (ip, ping, tc, ...) instead of framing them in
+	user space. The kernel log shows the interface name. M77_NET_DETACH or
+	closing the ttyD removes it again; the line is given back at once,
+	the interface is unregistered in the background and M77_NET_ATTACH
+	fails with EBUSY until then. The line settings are still made on the
+	ttyD, which must stay open.
+
+	Packets are sent as async HDLC like frames: 0x7e flags, 0x7d escapes
+	0x7e, 0x7d and the XON/XOFF chars (xor 0x20), PPP FCS-16. Received
+	frames with a bad FCS, UART errors or more than 1500 bytes are dropped
+	and counted in the interface statistics. The RX data is read by a NAPI
+	poll function: the RX interrupts stay off while frames arrive faster
+	than the poll consumes them, and packets are passed up in batches.
+
+	With the argument M77_NET_LOOPBACK the UART is set to its internal
+	loopback (MCR LOOP), everything sent is received on the same interface.
+	This tests the framing and the driver without cabling.
+
+	\n \section serdev serdev devices
+
+	In-kernel drivers using the serdev bus (GNSS receivers, sensor heads,
+	...) can be bound to a ttyD line. The M-Modules have no device tree
+	node the serial core could create a serdev controller from, so the
+	node holding the serdev devices of a line is passed with the module
+	parameter serdevNode, e.g. loaded with a device tree overlay. The
+	driver then registers its own serdev controller for the line, the
+	serdev devices below the node are created and their drivers bind.
+
+	While a serdev driver has the line open, the ttyD cannot be opened
+	(EBUSY) and vice versa. The received data goes from the interrupt
+	routine through a ring directly to the serdev driver, without tty
+	flip buffers or line discipline. Chars with errors are dropped.
+
+	\n \section bpffilter RX filter
+
+	A BPF program can be attached to the receive path of a ttyD with the
+	ioctl M77_BPF_ATTACH, argument is the fd of a loaded program of type
+	BPF_PROG_TYPE_SOCKET_FILTER (e.g. from bpf(BPF_PROG_LOAD) or libbpf),
+	-1 detaches it. Attaching needs CAP_NET_ADMIN or CAP_SYS_ADMIN.
+	Closing the ttyD detaches the program too. Unwanted traffic,
+	e.g. frames for other nodes on a shared RS485 bus, is then dropped in
+	the interrupt routine instead of going through the tty buffers to the
+	application.
+
+	The interrupt routine drains up to 128 chars from the UART and runs
+	the program once on them, as packet data of an skb (skb->len, direct
+	loads, bpf_skb_load_bytes()). Its return value decides, before the
+	chars reach the tty flip buffer:
+
+	- 0: the block is dropped
+	- M77_BPF_REDIRECT | line: the block is sent on ttyD line instead, if
+	  that line is open as ttyD, does not send for a raw device, serdev
+	  consumer, network interface or bond, and its transmit buffer has
+	  room
+	- n: the first n chars are passed to the tty, as for a socket filter
+
+	Since the program does not run per char, its cost stays small at high
+	baudrates. M77_BPF_STATS returns the passed, dropped and redirected
+	byte counters. While a program is attached no sysrq chars are handled
+	on the line, and the line must not be taken by the other special
+	modes (raw device, bridge, ...), which bypass the filter.
+
+	\n \section uiomode User mode M-Modules
+
+	An M-Module loaded with userMode=1 is not driven by the tty layer: no
+	ttyDs are registered for it (its ttyD line numbers stay reserved, the
+	following M-Modules keep their lines). Its register window and
+	interrupt are exported as a UIO device, /dev/uio<n> with the MDIS
+	device name in /sys/class/uio/uio<n>/name. An application dedicated
+	to the M-Module serves its UARTs directly, without system calls per
+	char and without the tty layer.
+
+	Map 0 is the 256 byte M-Module register window, at maps/map0/offset
+	within the page mmap() maps. The MMU can't map less than that page,
+	which may also hold the windows of other slots of the carrier, so
+	access to /dev/uio<n> must be restricted to the application. The M77
+	PHY modes are set from the mode and echo parameters as for ttyDs. On an interrupt the driver only
+	masks it (IMASK in the IR register) and wakes up read()/poll() on
+	/dev/uio<n>. After serving the UARTs the application unmasks it by
+	writing the int 1 to /dev/uio<n>.
+
+	The library in LIBSRC/M77_UIO does this. M77_UioOpen("m77_1") maps
+	the window, M77_UioChanInit() sets up a UART, M77_UioIrqWait() and
+	M77_UioIrqEnable() handle the interrupt, M77_UioPending() returns the
+	UARTs to serve, M77_UioRxBurst() and M77_UioTxBurst() move whole FIFO
+	contents like receive_chars() and transmit_chars() of the driver.
+
+	\n \section bench Line benchmark
+
+	TEST/m77bench.c measures the ttyD lines on the target. All given
+	lines run at the same time, for each baudrate and M77 PHY mode: first
+	single chars for the latency from write() to read(), then a checked
+	counting pattern at full speed for the throughput. The data goes
+	through the UART internal loopback (-k loop, no cable needed), a
+	loopback plug per line (-k plug) or a cable between the lines of each
+	pair (-k pair):
+
+\verbatim
+gcc -Wall -O2 -pthread -o m77bench m77bench.c
+m77bench -l 0-7 -b 9600,115200,921600 -t 10 > m77bench.txt
+m77bench -l 0-3 -k pair -m 2,4 -b 1152000
+\endverbatim
+
+	Per port and run it prints bytes/s, utilization of the line rate,
+	errors, overruns, latency percentiles, inter-read gaps and the CPU
+	time of its threads, plus a line with the load of all CPUs. The
+	format is described in m77bench.c, lines starting with '#' are
+	comments, so the results of two driver releases can be compared
+	with standard tools.
+
+	\n \section selftest Loopback self-test
+
+	Each ttyD has the sysfs attribute selftest. Writing "<ms> [<baud>]"
+	to it sends a PRBS15 pattern for about ms milliseconds (1..5000) at
+	the line rate through the UART internal loopback (UART_MCR_LOOP) and
+	checks it in the interrupt handler; without a baudrate the one last
+	set on the line is used. The write returns when the test is done,
+	nothing is sent on the line. A test that does not get all chars back
+	ends after 2 * ms + 500 ms and is stored as fail; a signal aborts it,
+	the write returns EINTR and no result is stored. The ttyD must be
+	closed, it is set up as usual on the next open:
+
+\verbatim
+echo "1000 921600" > /sys/class/tty/ttyD0/selftest
+cat /sys/class/tty/ttyD0/selftest
+baud=921600 tx=92160 rx=92160 errors=0 overruns=0 bytes_per_s=92154 ...
+\endverbatim
+
+	Reading it returns the result of the last test: chars sent and
+	received, wrong chars, overruns, the throughput in bytes/s and in
+	percent of the line rate, the test time, the calls of and the time
+	spent in the interrupt handler for this line and result=pass or
+	fail. pass means all chars were sent and received without error. This checks a port and its interrupt path in the field,
+	without cable or m77bench (see \ref bench).
+
+	\n \section histograms Port histograms
+
+	With debugfs mounted, /sys/kernel/debug/m77 holds one file per ttyD
+	line with histograms of its interrupt service. Collecting is off by
+	default and costs nothing then; it is switched for all lines with
+	the file enable. The counters are kept per CPU and updated without
+	locks, writing to a line's file clears them:
+
+\verbatim
+echo 1 > /sys/kernel/debug/m77/enable
+cat /sys/kernel/debug/m77/ttyD0
+echo 0 > /sys/kernel/debug/m77/ttyD0
+\endverbatim
+
+	- rx_fifo: chars read per RX drain in bins of 8, i.e. the RX FIFO
+	  level when the ISR came. Near 128 the FIFO was about to overrun.
+	- tx_load: chars written per TX refill. The refill is done on THRE,
+	  when the TX FIFO is empty (TFL 0); tx_idle counts the refills
+	  where also the transmitter was empty, the line went idle before.
+	- isr_bytes: chars received and sent per service of the line, in
+	  powers of 2.
+	- isr_ns: duration of the service in ns, in powers of 2.
+	- irq_ns: time from the M-Module interrupt assertion to the service.
+	  The carriers don't show when the IR was asserted, so it is only
+	  filled on the mock carrier (see \ref mock).
+
+	The FIFO levels are derived from the chars moved, reading the RFL and
+	TFL registers of the UART would cost a bus cycle each. Lines of
+	M-Modules probed after enable was written get their histograms with
+	the next write of 1.
+
+	\n \section overrun Overrun records
+
+	For each RX overrun the driver keeps a record of the interrupt
+	service that found it, the last 16 per ttyD line. They are always
+	collected, also without debugfs enable, so an overrun in the field
+	leaves its record. since_ns and others need the time and order of
+	every service, the ISR reads the clock once per port service for
+	them; with the module parameter ovrTrack=0 it does not, and these
+	fields are 0. The records are shown, oldest first, in
+	/sys/kernel/debug/m77/overrun/ttyD<n>; writing to the file drops them:
+
+\verbatim
+cat /sys/kernel/debug/m77/overrun/ttyD2
+records 1
+# time_ns since_ns others mask mode trig baud lsr rx
+4546454635831 131856 4 0x0b tty 8 57600 0x63 128
+\endverbatim
+
+	- time_ns: CLOCK_MONOTONIC of the service
+	- since_ns: time since the previous service of the line
+	- others, mask: services of other channels of the same M-Module in
+	  between, and a bit per channel that had one. Other M-Modules and
+	  devices on the same IRQ are not counted here, the time their
+	  services took is only part of since_ns
+	- mode: receive path, tty, raw, mux, bridge, bond, bpf, net, serdev
+	  or selftest
+	- trig: RX FIFO trigger level, baud: baudrate set
+	- lsr: LSR at the start of the service, rx: chars drained by it
+
+	since_ns above the time the FIFO takes to fill (128 chars at baud)
+	with few other services points to interrupt latency, e.g. other
+	devices on the carrier IRQ. A short since_ns points to the settings:
+	baudrate, trigger level or a busy receive path.
+
+	\n \section ctlstats Statistics snapshot
+
+	/dev/m77ctl returns the counters of all ttyD lines with one read(),
+	for monitoring many lines without a syscall per line and counter.
+	Each read() collects a new snapshot: struct m77_stats_hdr and one
+	struct m77_stats_rec per line, in line order (serial_m77.h). The
+	M-Modules are copied one after the other; the lines of one M-Module
+	are locked together, so their records belong to the same moment.
+	Running stalls are counted up to the header timestamp, the header
+	also tells within how many ns all records were taken.
+
+	- rxBytes, txBytes: chars received and sent, 64 bit sums that do
+	  not wrap with the 32 bit TIOCGICOUNT counters
+	- overrun, bufOverrun: RX FIFO overruns, chars lost with the tty
+	  buffer full
+	- frame, parity, brk: receive errors and breaks
+	- the error counters are 32 bit like in TIOCGICOUNT and wrap
+	- irqs: interrupt services of the line
+	- rxHigh, txHigh: most chars moved by one RX FIFO drain and one TX
+	  FIFO refill, i.e. the FIFO high-water marks
+	- txStallNs: time CTS was low with CRTSCTS set
+	- rxStallNs: time RX was held off by the bridge flow control, see
+	  \ref bridge
+
+\verbatim
+char buf[sizeof(struct m77_stats_hdr) + 64 * sizeof(struct m77_stats_rec)];
+struct m77_stats_hdr *hdr = (struct m77_stats_hdr *)buf;
+int fd = open("/dev/m77ctl", O_RDONLY);
+
+read(fd, buf, sizeof(buf));
+rec = (struct m77_stats_rec *)(buf + hdr->hdrSize);
+... rec = (struct m77_stats_rec *)((char *)rec + hdr->recSize) ...
+\endverbatim
+
+	If the buffer is too small, nRecs is less than nPorts. New fields are
+	only added at the end of the structs, so a reader steps with hdrSize
+	and recSize and works with newer drivers; version changes only if an
+	existing field changes its meaning. The counters are not cleared,
+	they start at 0 when the driver is loaded.
+
+	\n \section mmiostats Register access statistics
+
+	Built with the switch M77_MMIO_STATS (add $(SW_PREFIX)M77_MMIO_STATS
+	to MAK_SWITCH in driver.mak), the driver counts each register read
+	and write of the M-Modules. The counts are split by the operation
+	that made the access: the ISR receive path (rx), transmit_chars()
+	(tx), the ISR scan of IR/IIR including LSR, MSR and IR clear (iir),
+	set_termios (termios), UART startup and shutdown (startup), the
+	ioctls (ioctl) and everything else (other). Without the switch
+	nothing of this is compiled in.
+
+	/sys/class/tty/ttyD<n>/mmio shows the counts of one UART, the
+	module parameter mmioStats the sum of the CPLD and all UARTs of each
+	M-Module. Writing to mmioStats clears all counters:
+
+\verbatim
+echo 0 > /sys/module/men_lx_m77/parameters/mmioStats
+cat /sys/module/men_lx_m77/parameters/mmioStats
+m77_1 rx             2048          0
+m77_1 tx                0      32784
+m77_1 iir            1152        136
+\endverbatim
+
+	The columns are reads and writes, operations without accesses are
+	left out. The ISR keeps its operation per CPU, set_termios, startup,
+	shutdown and ioctl keep theirs in the port, as they may sleep.
+
+	\n \section capacity Capacity estimate
+
+	The access time of the M-Module registers depends on the carrier
+	(D201, F205, VME ...) and limits the line load a M-Module can take.
+	When a M-Module is probed, the driver times reads and writes of a
+	UART scratch register and logs them with an estimate of the sum of
+	the baudrates all its channels can run at:
+
+\verbatim
+m77_1: register read 520 ns, write 260 ns, max. 5500644 baud on all 4 channels
+\endverbatim
+
+	The estimate assumes each channel receives and sends 8N1 at full
+	rate and counts the register accesses the driver makes for it: two
+	reads per char received, one write per char sent and the interrupt
+	service, which moves one RX trigger level (8 chars) or one TX FIFO
+	load (128 chars). At that sum the M-Module access is busy all the
+	time, so a configuration should stay well below it; CPU time and the
+	other M-Modules on the same carrier are not included.
+
+	The module parameter capacity shows per M-Module the read and write
+	ns, the estimate and the sum of the baudrates set on its lines in
+	use:
+
+\verbatim
+cat /sys/module/men_lx_m77/parameters/capacity
+m77_1 520 260 5500644 460800
+\endverbatim
+
+	\n \section tracing Tracepoints
+
+	The driver has tracepoints in the trace system m77, for ftrace and
+	perf. Disabled tracepoints cost a not taken jump, so they are always
+	built in:
+
+	- m77_irq_entry, m77_irq_exit
+	  M-Module number and interrupt register (IR1, and IR2 on M45N) when
+	  M77_IrqHandler() read it and after the channels were serviced.
+	- m77_chan
+	  One channel serviced by the ISR: IIR, LSR afterwards, chars received
+	  and chars loaded into the TX FIFO.
+	- m77_set_termios
+	  cflag, iflag, baudrate, divisor and the LCR, FCR and EFR written.
+	- m77_phy
+	  The PHY ioctls M77_PHYS_INT_SET, M77_ECHO_SUPPRESS and
+	  M45_TIO_TRI_MODE with argument and result.
+
+\verbatim
+echo 1 > /sys/kernel/tracing/events/m77/enable
+cat /sys/kernel/tracing/trace_pipe
+perf record -e 'm77:*' -a -- sleep 10
+\endverbatim
+
+	The events are defined in serial_m77_trace.h, which is included with
+	TRACE_INCLUDE_PATH "." - the driver directory must be in the include
+	path of the build.
+
+	\n \section regbench Register model benchmark
+
+	TEST/REGMODEL builds serial_m77.c unchanged as a program on the
+	development host. MREAD_D16/MWRITE_D16 go to a register model of the
+	M-Modules (OX16C954 FIFOs, 650 and ICR register banks, CPLD IR, DCR
+	and TCR) which counts every access. m77_regbench runs the receive,
+	transmit and set_termios paths for 1 to 64 ports on M77, M69N or
+	M45N and prints bytes per register access and ns per byte, one
+	whitespace separated line per scenario:
+
+\verbatim
+cd TEST/REGMODEL && make && ./m77_regbench -t m45 -p 8,64
+\endverbatim
+
+	The bus time per byte is calculated from the read and write times
+	given with -r/-w, measure them on the target carrier. The host time
+	includes the model, compare it only between builds on the same host.
+	Kernel functions the benchmark does not use are generated stubs,
+	when driver changes call new ones in these paths, implement them in
+	kshim.c. The register model is shared with the mock carrier, see
+	\ref mock.
+
+	\n \section mock Mock carrier
+
+	MOCK builds the kernel module men_m77mock, a carrier without hardware
+	for the M-Modules, and men_lx_m77 built with M77_MOCK, whose register
+	accesses go to the register model in the mock. It replaces the MDIS
+	kernel modules, no carrier descriptor is needed. The prefix of devName
+	selects the M-Module type, brdName and slotNo are ignored:
+
+\verbatim
+cd MOCK && make KDIR=/lib/modules/`uname -r`/build
+insmod men_m77mock.ko link=2
+insmod men_lx_m77.ko devName=m77_1,m45_1 brdName=mock,mock
+cat /sys/module/men_m77mock/parameters/stats
+\endverbatim
+
+	A timer tick (tickUs, default 500 us) sends the TX FIFO contents at
+	the programmed baudrate or at lineRate chars/s and calls the ISR while
+	a M-Module interrupt is pending. link selects where sent chars go: 0
+	nowhere, 1 back to the same channel, 2 to the other channel of the
+	pairs 0-1, 2-3 etc. rxRate adds generated receive traffic, rdNs and
+	wrNs delay each register access like a slow carrier. Line signals,
+	RX errors and the user mode (userMode) are not emulated.
+
 	\n \section parameter Module Parameter
 
     The driver supports the same Parameters as the previous kernel-2.4-only
@@ -150,6 +641,38 @@ Code: M77_PHYS_INT_SET   Arguments:  M77_RS422_HD
 	- echo
 	  disable/enable receive line of a M77 channelin HD modes
 
+	- ovrTrack
+	  1 (default): keep the time of every port service for the
+	  since_ns and others fields of the overrun records, see
+	  \ref overrun. 0: overruns are still recorded, without them.
+
+	- fullProbe
+	  0 (default): the UART type is taken from the identified M-Module,
+	  only the ID of each OX16C954 is checked once. 1: run the generic
+	  UART autoconfig on every channel, for diagnostics.
+
+	- serdevNode
+	  Per ttyD line: device tree path of the node whose children are the
+	  serdev devices on this line, '-' for none. E.g.
+	  serdevNode=-,/m77-serdev/line1 for a device on ttyD1.
+
+	- userMode
+	  Per M-Module: 1 = export it to user space as /dev/uio<n> instead of
+	  registering ttyDs, see \ref uiomode. Default 0.
+
+	- bondGapMs
+	  ttyDB: ms a received frame waits for a missing earlier frame before
+	  that one is skipped, 1..10000 (default 50). Should exceed the
+	  transmit delay difference of the member lines.
+
+	- capacity
+	  Read only: register access times, estimated max. and set sum of
+	  baudrates per M-Module, see \ref capacity.
+
+	- mmioStats
+	  Only built with M77_MMIO_STATS: register accesses per M-Module and
+	  operation, write to clear. See \ref mmiostats.
+
 	\subsection Examples For Module loading
 
 	The following examples explain passing the Parameters when loading the
@@ -157,7 +680,14 @@ Code: M77_PHYS_INT_SET   Arguments:  M77_RS422_HD
 	config file of the used Linux Distribution, e.g. /etc/modules on Ubuntu.
 
 	All driver Parameters are internally arrays, so they are passed comma
-	separated. Up to 4 Modules are supported.
+	separated. The number of Modules is not limited by the driver, the
+	parameter lists are sized by the number of values passed. The ttyD
+	lines are handed out Module by Module in the order of devName, 8 lines
+	for a M45N and 4 lines for a M69N or M77.
+	The Modules are probed in parallel, the lines of a Module are usable
+	as soon as that Module is registered. For each Module the probe time
+	is reported in the kernel log. If one Module fails, the driver is not
+	loaded.
 
 	The first example shows driver usage for a M45N which is mounted on a D201
 	Carrier board, Module Slot 1.
@@ -0,0 +1,188 @@
+/***********************  I n c l u d e  -  F i l e  ************************/
+/*!
+ *        \file  serial_m77_trace.h
+ *
+ *      \author  thomas schnuerer
+ *
+ *       \brief  Tracepoints of serial_m77.c, trace system m77. Created
+ *               in serial_m77.c with CREATE_TRACE_POINTS, then used with
+ *               ftrace or perf, e.g. perf record -e 'm77:*'.
+ *
+ *               <trace/define_trace.h> includes this file a second time
+ *               as "./serial_m77_trace.h", which is looked up relative to
+ *               the include path, not to serial_m77.c. The build must
+ *               therefore pass the driver directory with -I: driver.mak
+ *               and driver_sw.mak add -I$(MEN_MOD_DIR) to MAK_SWITCH,
+ *               MOCK/Makefile adds -I$(src)/../DRIVER to ccflags-y.
+ *
+ *     Switches: -
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM m77
+
+#if !defined(_SERIAL_M77_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _SERIAL_M77_TRACE_H
+
+#include <linux/tracepoint.h>
+
+/*
+ * M77_IrqHandler() per M-Module and IR register (M45N: 0 = IR1, 1 = IR2):
+ * entry when the IR was read, exit when it was cleared or found idle
+ */
+DECLARE_EVENT_CLASS(m77_irq_class,
+
+	TP_PROTO(unsigned int mod, unsigned int irNr, unsigned int ir),
+
+	TP_ARGS(mod, irNr, ir),
+
+	TP_STRUCT__entry(
+		__field(unsigned int,	mod)
+		__field(unsigned int,	irNr)
+		__field(unsigned int,	ir)
+	),
+
+	TP_fast_assign(
+		__entry->mod	= mod;
+		__entry->irNr	= irNr;
+		__entry->ir		= ir;
+	),
+
+	TP_printk("mod=%u ir%u=0x%02x", __entry->mod, __entry->irNr + 1,
+			  __entry->ir)
+);
+
+DEFINE_EVENT(m77_irq_class, m77_irq_entry,
+	TP_PROTO(unsigned int mod, unsigned int irNr, unsigned int ir),
+	TP_ARGS(mod, irNr, ir)
+);
+
+DEFINE_EVENT(m77_irq_class, m77_irq_exit,
+	TP_PROTO(unsigned int mod, unsigned int irNr, unsigned int ir),
+	TP_ARGS(mod, irNr, ir)
+);
+
+/*
+ * service of one channel by the ISR: IIR that made it, LSR after the
+ * service, chars drained from the RX FIFO and filled into the TX FIFO
+ */
+TRACE_EVENT(m77_chan,
+
+	TP_PROTO(unsigned int line, unsigned int iir, unsigned int lsr,
+			 unsigned int rx, unsigned int tx),
+
+	TP_ARGS(line, iir, lsr, rx, tx),
+
+	TP_STRUCT__entry(
+		__field(unsigned int,	line)
+		__field(unsigned char,	iir)
+		__field(unsigned char,	lsr)
+		__field(unsigned int,	rx)
+		__field(unsigned int,	tx)
+	),
+
+	TP_fast_assign(
+		__entry->line	= line;
+		__entry->iir	= iir;
+		__entry->lsr	= lsr;
+		__entry->rx		= rx;
+		__entry->tx		= tx;
+	),
+
+	TP_printk("line=%u iir=0x%02x lsr=0x%02x rx=%u tx=%u",
+			  __entry->line, __entry->iir, __entry->lsr,
+			  __entry->rx, __entry->tx)
+);
+
+/*
+ * men_uart_set_termios(): the settings written to the UART
+ */
+TRACE_EVENT(m77_set_termios,
+
+	TP_PROTO(unsigned int line, unsigned int cflag, unsigned int iflag,
+			 unsigned int baud, unsigned int quot, unsigned int lcr,
+			 unsigned int fcr, unsigned int efr),
+
+	TP_ARGS(line, cflag, iflag, baud, quot, lcr, fcr, efr),
+
+	TP_STRUCT__entry(
+		__field(unsigned int,	line)
+		__field(unsigned int,	cflag)
+		__field(unsigned int,	iflag)
+		__field(unsigned int,	baud)
+		__field(unsigned int,	quot)
+		__field(unsigned char,	lcr)
+		__field(unsigned char,	fcr)
+		__field(unsigned char,	efr)
+	),
+
+	TP_fast_assign(
+		__entry->line	= line;
+		__entry->cflag	= cflag;
+		__entry->iflag	= iflag;
+		__entry->baud	= baud;
+		__entry->quot	= quot;
+		__entry->lcr	= lcr;
+		__entry->fcr	= fcr;
+		__entry->efr	= efr;
+	),
+
+	TP_printk("line=%u cflag=0x%x iflag=0x%x baud=%u quot=%u lcr=0x%02x "
+			  "fcr=0x%02x efr=0x%02x", __entry->line, __entry->cflag,
+			  __entry->iflag, __entry->baud, __entry->quot, __entry->lcr,
+			  __entry->fcr, __entry->efr)
+);
+
+/*
+ * PHY ioctls M77_PHYS_INT_SET, M77_ECHO_SUPPRESS and M45_TIO_TRI_MODE
+ */
+TRACE_EVENT(m77_phy,
+
+	TP_PROTO(unsigned int line, unsigned int cmd, unsigned long arg,
+			 int ret),
+
+	TP_ARGS(line, cmd, arg, ret),
+
+	TP_STRUCT__entry(
+		__field(unsigned int,	line)
+		__field(unsigned int,	cmd)
+		__field(unsigned long,	arg)
+		__field(int,			ret)
+	),
+
+	TP_fast_assign(
+		__entry->line	= line;
+		__entry->cmd	= cmd;
+		__entry->arg	= arg;
+		__entry->ret	= ret;
+	),
+
+	TP_printk("line=%u cmd=0x%x arg=%lu ret=%d", __entry->line,
+			  __entry->cmd, __entry->arg, __entry->ret)
+);
+
+#endif /* _SERIAL_M77_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE serial_m77_trace
+#include <trace/define_trace.h>
@@ -0,0 +1,30 @@
+#**************************  M a k e f i l e ********************************
+#  
+#         Author: thomas schnuerer
+#  
+#    Description: makefile descriptor for the M77 user mode (UIO) library
+#                      
+#-----------------------------------------------------------------------------
+#   Copyright 2026, MEN Mikro Elektronik GmbH
+#*****************************************************************************
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+MAK_NAME=m77_uio
+
+MAK_INCL=$(MEN_MOD_DIR)/m77_uio.h \
+		 $(MEN_MOD_DIR)/../../DRIVER/serial_m77.h
+
+MAK_INP1=m77_uio$(INP_SUFFIX)
+
+MAK_INP=$(MAK_INP1)
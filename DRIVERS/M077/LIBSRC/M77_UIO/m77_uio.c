@@ -0,0 +1,401 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  m77_uio.c
+ *
+ *      \author  thomas schnuerer
+ *
+ *       \brief  User space access library for M45N/M69N/M77 M-Modules
+ *               loaded with userMode=1
+ *
+ *               The driver exports the M-Module register window and its
+ *               interrupt as /dev/uio<n>, named after the MDIS device.
+ *               This library maps the window and does the UART burst
+ *               transfers of receive_chars()/transmit_chars() in the
+ *               kernel driver, without system call per character.
+ *
+ *     Switches: MAC_BYTESWAP	byte swapped register window
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <linux/serial_reg.h>
+#include "../../DRIVER/serial_m77.h"
+#include "m77_uio.h"
+
+/*-----------------------------+
+|   DEFINES                    |
++-----------------------------*/
+#define UIO_SYSFS		"/sys/class/uio"
+#define UIO_MAX_DEV		64		/* /dev/uio0..63 are searched	*/
+
+/* the MM Interface has no A0 bit: registers are 16 bit, data in D0..7 */
+#ifdef MAC_BYTESWAP
+# define REG_RD(a)		((unsigned char)(*(volatile unsigned short *)(a) >> 8))
+# define REG_WR(a,v)	(*(volatile unsigned short *)(a) = (unsigned short)((v) << 8))
+#else
+# define REG_RD(a)		((unsigned char)(*(volatile unsigned short *)(a) & 0xff))
+# define REG_WR(a,v)	(*(volatile unsigned short *)(a) = (unsigned short)(v))
+#endif
+
+/*-----------------------------+
+|   TYPEDEFS                   |
++-----------------------------*/
+struct M77_UIO_HANDLE {
+	int				fd;				/* /dev/uio<n>					*/
+	void			*map;			/* mmap()ed page				*/
+	size_t			mapSize;
+	char			*base;			/* M-Module register window		*/
+	int				isM45;			/* second IR Register at 0xc8	*/
+	int				nrChan;
+	char			*chan[M77_UIO_MAX_CHAN];	/* UART register base	*/
+	unsigned char	ier[M77_UIO_MAX_CHAN];		/* IER shadow			*/
+};
+
+
+/*******************************************************************/
+/** read one line from a sysfs file
+ *
+ * \param path		\IN  file name
+ * \param buf		\OUT line without newline
+ * \param size		\IN  size of buf
+ *
+ * \return 			0 or -1
+ */
+static int sysfs_read(const char *path, char *buf, size_t size)
+{
+	FILE *fp = fopen(path, "r");
+
+	if (!fp)
+		return -1;
+	if (!fgets(buf, (int)size, fp)) {
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+	buf[strcspn(buf, "\n")] = '\0';
+	return 0;
+}
+
+/*******************************************************************/
+/** Open a user mode M-Module
+ *
+ * \param devName	\IN  MDIS device name passed as devName, e.g. "m77_1"
+ *
+ * \brief Searches the uio device with this name, maps its register
+ *        window. The M-Module interrupt stays masked until
+ *        M77_UioIrqEnable().
+ *
+ * \return 			handle or NULL, errno set
+ */
+M77_UIO_HANDLE *M77_UioOpen(const char *devName)
+{
+	M77_UIO_HANDLE *h;
+	char path[128], val[64];
+	unsigned long offs, size;
+	int n, i;
+
+	for (n = 0; n < UIO_MAX_DEV; n++) {
+		snprintf(path, sizeof(path), UIO_SYSFS "/uio%d/name", n);
+		if (sysfs_read(path, val, sizeof(val)) == 0 && !strcmp(val, devName))
+			break;
+	}
+	if (n == UIO_MAX_DEV) {
+		errno = ENODEV;
+		return NULL;
+	}
+
+	snprintf(path, sizeof(path), UIO_SYSFS "/uio%d/maps/map0/offset", n);
+	if (sysfs_read(path, val, sizeof(val)) < 0)
+		return NULL;
+	offs = strtoul(val, NULL, 0);
+	snprintf(path, sizeof(path), UIO_SYSFS "/uio%d/maps/map0/size", n);
+	if (sysfs_read(path, val, sizeof(val)) < 0)
+		return NULL;
+	size = strtoul(val, NULL, 0);
+
+	if ((h = calloc(1, sizeof(*h))) == NULL)
+		return NULL;
+
+	snprintf(path, sizeof(path), "/dev/uio%d", n);
+	if ((h->fd = open(path, O_RDWR)) < 0)
+		goto errout;
+
+	/* map 0 is mapped at offset 0 * page size, the page holding it */
+	h->mapSize = offs + size;
+	h->map = mmap(NULL, h->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+				  h->fd, 0);
+	if (h->map == MAP_FAILED)
+		goto errout_close;
+
+	h->base		= (char *)h->map + offs;
+	h->isM45	= !strncmp(devName, "m45", 3);
+	h->nrChan	= h->isM45 ? MOD_M45_CHAN_NUM : MOD_M77_CHAN_NUM;
+
+	for (i = 0; i < h->nrChan; i++) {
+		h->chan[i] = h->base + (0x10 * i);
+		/* correct M45N Adress Gap between chan. 0-3 and 4-7 */
+		if (h->isM45 && i > 3)
+			h->chan[i] += 0x40;
+	}
+	return h;
+
+ errout_close:
+	close(h->fd);
+ errout:
+	free(h);
+	return NULL;
+}
+
+/*******************************************************************/
+/** Close a user mode M-Module, all UART interrupts are switched off
+ *
+ * \param h			\IN  handle from M77_UioOpen()
+ */
+void M77_UioClose(M77_UIO_HANDLE *h)
+{
+	int i;
+
+	for (i = 0; i < h->nrChan; i++)
+		REG_WR(h->chan[i] + (UART_IER << 1), 0);
+
+	munmap(h->map, h->mapSize);
+	close(h->fd);
+	free(h);
+}
+
+/*******************************************************************/
+/** Number of UARTs of the M-Module
+ */
+int M77_UioNumChan(M77_UIO_HANDLE *h)
+{
+	return h->nrChan;
+}
+
+/*******************************************************************/
+/** Read an OX16C954 register
+ *
+ * \param h			\IN  handle
+ * \param chan		\IN  UART 0..M77_UioNumChan()-1
+ * \param reg		\IN  UART register, e.g. UART_LSR
+ *
+ * \return 			register value
+ */
+unsigned char M77_UioRegRead(M77_UIO_HANDLE *h, int chan, int reg)
+{
+	return REG_RD(h->chan[chan] + (reg << 1));
+}
+
+/*******************************************************************/
+/** Write an OX16C954 register
+ *
+ * \param h			\IN  handle
+ * \param chan		\IN  UART 0..M77_UioNumChan()-1
+ * \param reg		\IN  UART register, e.g. UART_LCR
+ * \param val		\IN  value to write
+ */
+void M77_UioRegWrite(M77_UIO_HANDLE *h, int chan, int reg, unsigned char val)
+{
+	REG_WR(h->chan[chan] + (reg << 1), val);
+}
+
+/*******************************************************************/
+/** Set up a UART: 8N1, 128 byte FIFOs, RX interrupts on
+ *
+ * \param h			\IN  handle
+ * \param chan		\IN  UART 0..M77_UioNumChan()-1
+ * \param baud		\IN  baudrate
+ *
+ * \return 			0 or -1, errno set
+ */
+int M77_UioChanInit(M77_UIO_HANDLE *h, int chan, unsigned int baud)
+{
+	unsigned int quot;
+
+	if (chan < 0 || chan >= h->nrChan || !baud) {
+		errno = EINVAL;
+		return -1;
+	}
+	quot = (M77_UIO_UARTCLK / 16 + baud / 2) / baud;
+
+	M77_UioRegWrite(h, chan, UART_IER, 0);
+
+	/* enhanced mode, as serial_efr_write(up, UART_EFR, UART_EFR_ECB) */
+	M77_UioRegWrite(h, chan, UART_LCR, 0xbf);
+	M77_UioRegWrite(h, chan, UART_EFR, UART_EFR_ECB);
+
+	M77_UioRegWrite(h, chan, UART_LCR, UART_LCR_DLAB);
+	M77_UioRegWrite(h, chan, UART_DLL, quot & 0xff);
+	M77_UioRegWrite(h, chan, UART_DLM, (quot >> 8) & 0xff);
+	M77_UioRegWrite(h, chan, UART_LCR, UART_LCR_WLEN8);
+
+	M77_UioRegWrite(h, chan, UART_FCR, UART_FCR_ENABLE_FIFO |
+					UART_FCR_CLEAR_RCVR | UART_FCR_CLEAR_XMIT |
+					UART_FCR_R_TRIG_10);
+	M77_UioRegWrite(h, chan, UART_MCR, UART_MCR_DTR | UART_MCR_RTS |
+					UART_MCR_OUT2);
+	(void)M77_UioRegRead(h, chan, UART_LSR);
+	(void)M77_UioRegRead(h, chan, UART_RX);
+
+	h->ier[chan] = UART_IER_RDI | UART_IER_RLSI;
+	M77_UioRegWrite(h, chan, UART_IER, h->ier[chan]);
+	return 0;
+}
+
+/*******************************************************************/
+/** Switch the TX empty interrupt of a UART
+ *
+ * \param h			\IN  handle
+ * \param chan		\IN  UART 0..M77_UioNumChan()-1
+ * \param on		\IN  1: interrupt when the TX FIFO is empty
+ *
+ * \return 			0
+ */
+int M77_UioTxIrq(M77_UIO_HANDLE *h, int chan, int on)
+{
+	unsigned char ier = h->ier[chan];
+
+	ier = on ? (ier | UART_IER_THRI) : (ier & ~UART_IER_THRI);
+	if (ier != h->ier[chan]) {
+		h->ier[chan] = ier;
+		M77_UioRegWrite(h, chan, UART_IER, ier);
+	}
+	return 0;
+}
+
+/*******************************************************************/
+/** Unmask the M-Module interrupt
+ *
+ * \brief The driver masks it on each interrupt, call it after the
+ *        pending UARTs were served.
+ *
+ * \return 			0 or -1, errno set
+ */
+int M77_UioIrqEnable(M77_UIO_HANDLE *h)
+{
+	int on = 1;
+
+	return write(h->fd, &on, sizeof(on)) == sizeof(on) ? 0 : -1;
+}
+
+/*******************************************************************/
+/** Wait for the M-Module interrupt
+ *
+ * \param h			\IN  handle
+ * \param timeoutMs	\IN  timeout in ms, -1: forever
+ *
+ * \return 			1: interrupt, 0: timeout, -1: error, errno set
+ */
+int M77_UioIrqWait(M77_UIO_HANDLE *h, int timeoutMs)
+{
+	struct pollfd pfd;
+	int count, ret;
+
+	pfd.fd		= h->fd;
+	pfd.events	= POLLIN;
+	if ((ret = poll(&pfd, 1, timeoutMs)) <= 0)
+		return ret;
+
+	return read(h->fd, &count, sizeof(count)) == sizeof(count) ? 1 : -1;
+}
+
+/*******************************************************************/
+/** UARTs with a pending interrupt
+ *
+ * \return 			bit n set: UART n has an interrupt pending
+ */
+unsigned int M77_UioPending(M77_UIO_HANDLE *h)
+{
+	unsigned int mask = 0;
+	int i;
+
+	for (i = 0; i < h->nrChan; i++)
+		if (!(REG_RD(h->chan[i] + (UART_IIR << 1)) & UART_IIR_NO_INT))
+			mask |= 1 << i;
+	return mask;
+}
+
+/*******************************************************************/
+/** Read the received chars of a UART, as receive_chars() does
+ *
+ * \param h			\IN  handle
+ * \param chan		\IN  UART 0..M77_UioNumChan()-1
+ * \param buf		\OUT received chars
+ * \param max		\IN  size of buf
+ * \param errors	\OUT M77_UIO_ERR_xxx of the chars read, may be NULL
+ *
+ * \return 			nr. of chars read
+ */
+int M77_UioRxBurst(M77_UIO_HANDLE *h, int chan, unsigned char *buf,
+				   int max, unsigned int *errors)
+{
+	char *lsrAdr = h->chan[chan] + (UART_LSR << 1);
+	char *rxAdr  = h->chan[chan] + (UART_RX << 1);
+	unsigned int err = 0;
+	unsigned char lsr;
+	int n = 0;
+
+	lsr = REG_RD(lsrAdr);
+	while ((lsr & UART_LSR_DR) && n < max) {
+		buf[n++] = REG_RD(rxAdr);
+		err |= lsr & (UART_LSR_BI | UART_LSR_PE | UART_LSR_FE | UART_LSR_OE);
+		lsr = REG_RD(lsrAdr);
+	}
+
+	if (errors)
+		*errors = err;
+	return n;
+}
+
+/*******************************************************************/
+/** Fill the TX FIFO of a UART, as transmit_chars() does
+ *
+ * \param h			\IN  handle
+ * \param chan		\IN  UART 0..M77_UioNumChan()-1
+ * \param buf		\IN  chars to send
+ * \param len		\IN  nr. of chars
+ *
+ * \brief Writes nothing while the FIFO is not empty, else up to
+ *        M77_UIO_FIFO_SIZE chars. Use M77_UioTxIrq() to be woken up
+ *        when the rest can be sent.
+ *
+ * \return 			nr. of chars written
+ */
+int M77_UioTxBurst(M77_UIO_HANDLE *h, int chan, const unsigned char *buf,
+				   int len)
+{
+	char *txAdr = h->chan[chan] + (UART_TX << 1);
+	int n;
+
+	if (!(REG_RD(h->chan[chan] + (UART_LSR << 1)) & UART_LSR_THRE))
+		return 0;
+
+	if (len > M77_UIO_FIFO_SIZE)
+		len = M77_UIO_FIFO_SIZE;
+	for (n = 0; n < len; n++)
+		REG_WR(txAdr, buf[n]);
+	return n;
+}
@@ -0,0 +1,73 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  m77_uio.h
+ *
+ *      \author  thomas schnuerer
+ *
+ *       \brief  User space access library for M45N/M69N/M77 M-Modules
+ *               loaded with userMode=1, see serial_m77_doc.c
+ *
+ *     Switches: MAC_BYTESWAP	byte swapped register window
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef _M77_UIO_H
+#define _M77_UIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define M77_UIO_MAX_CHAN	8		/* M45N: 8, M69N/M77: 4 UARTs		*/
+#define M77_UIO_UARTCLK		18432000	/* 18,432 MHz					*/
+#define M77_UIO_FIFO_SIZE	128		/* OX16C954 FIFO depth, 950 mode	*/
+
+/* M77_UioRxBurst() error bits, the UART LSR bits of the received chars */
+#define M77_UIO_ERR_OVERRUN	0x02
+#define M77_UIO_ERR_PARITY	0x04
+#define M77_UIO_ERR_FRAME	0x08
+#define M77_UIO_ERR_BREAK	0x10
+
+typedef struct M77_UIO_HANDLE M77_UIO_HANDLE;
+
+M77_UIO_HANDLE *M77_UioOpen(const char *devName);
+void M77_UioClose(M77_UIO_HANDLE *h);
+int M77_UioNumChan(M77_UIO_HANDLE *h);
+
+int M77_UioChanInit(M77_UIO_HANDLE *h, int chan, unsigned int baud);
+int M77_UioTxIrq(M77_UIO_HANDLE *h, int chan, int on);
+
+int M77_UioIrqEnable(M77_UIO_HANDLE *h);
+int M77_UioIrqWait(M77_UIO_HANDLE *h, int timeoutMs);
+unsigned int M77_UioPending(M77_UIO_HANDLE *h);
+
+int M77_UioRxBurst(M77_UIO_HANDLE *h, int chan, unsigned char *buf,
+				   int max, unsigned int *errors);
+int M77_UioTxBurst(M77_UIO_HANDLE *h, int chan, const unsigned char *buf,
+				   int len);
+
+unsigned char M77_UioRegRead(M77_UIO_HANDLE *h, int chan, int reg);
+void M77_UioRegWrite(M77_UIO_HANDLE *h, int chan, int reg,
+					 unsigned char val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _M77_UIO_H */
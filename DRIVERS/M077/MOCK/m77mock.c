@@ -0,0 +1,636 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  m77mock.c
+ *
+ *      \author  thomas schnuerer
+ *
+ *       \brief  Mock MDIS carrier for serial_m77.c, kernel module
+ *               men_m77mock. Provides the external device functions of
+ *               the MDIS kernel (mdis_open_external_dev() etc.) and
+ *               m_getmodinfo() for M45N, M69N and M77 M-Modules that
+ *               exist only in the register model regmodel.c.
+ *
+ *               A hrtimer tick moves the chars: the TX FIFOs drain at the
+ *               programmed baudrate and are delivered as selected by the
+ *               link parameter, optional RX traffic is generated. Then
+ *               the ISR of each M-Module with a pending, unmasked
+ *               interrupt is called from the timer, like from the
+ *               carrier interrupt.
+ *
+ *               The driver must be built with M77_MOCK, see Makefile.
+ *               Plain memory can't behave like the UART registers (FIFOs,
+ *               read side effects), so its D16 accesses are routed to
+ *               m77mock_read16()/m77mock_write16().
+ *
+ *     Switches: -
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <linux/moduleparam.h>
+#include <linux/version.h>
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/spinlock.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/delay.h>
+#include <linux/string.h>
+#include <linux/slab.h>
+
+#include <MEN/men_typs.h>
+#include <MEN/mdis_com.h>
+#include <MEN/mk_nonmdisif.h>
+#include <MEN/modcom.h>
+
+#include "regmodel.h"
+#include "m77mock.h"
+
+/*-----------------------------+
+|   DEFINES                    |
++-----------------------------*/
+#define M77MOCK_NAMELEN		16			/* same as ARRLEN of the driver	*/
+#define M77MOCK_MAGIC		0x5346		/* 'SF', ID EEPROM magic		*/
+
+/* link parameter */
+#define M77MOCK_LINK_NONE	0			/* TX chars are dropped			*/
+#define M77MOCK_LINK_LOOP	1			/* loopback plug per channel	*/
+#define M77MOCK_LINK_CROSS	2			/* channel pairs 0-1, 2-3 cabled */
+
+/*-----------------------------+
+|   TYPEDEFS                   |
++-----------------------------*/
+/** one M-Module of the mock carrier, the handle of the MDIS functions */
+typedef struct {
+	char			name[M77MOCK_NAMELEN];	/* device name, "" = unused	*/
+	int				(*handler)(void *);		/* installed ISR			*/
+	void			*data;					/* passed to handler		*/
+	int				irqEn;					/* enabled by MDIS call		*/
+	u64				irqNs;					/* IRQ pending since, 0: not */
+	u64				txCredit[RM_MAX_CHAN];	/* line time, chars * 10^6	*/
+	u64				rxCredit[RM_MAX_CHAN];
+	u8				rxSeq[RM_MAX_CHAN];		/* generated RX pattern		*/
+} M77MOCK_DEV;
+
+/*-----------------------------+
+|   GLOBALS                    |
++-----------------------------*/
+static int maxMods = 16;
+static int tickUs = 500;
+static int lineRate;
+static int rxRate;
+static int link;
+static int rdNs;
+static int wrNs;
+
+static M77MOCK_DEV *G_dev;				/* maxMods entries				*/
+static DEFINE_SPINLOCK(G_lock);			/* model and G_dev				*/
+static struct hrtimer G_timer;
+static ktime_t G_tick;
+
+/*-----------------------------+
+|   PROTOTYPES                 |
++-----------------------------*/
+static int m77mock_stats_get(char *buf, const struct kernel_param *kp);
+static int m77mock_stats_set(const char *val, const struct kernel_param *kp);
+
+static const struct kernel_param_ops m77mock_stats_ops = {
+	.set	= m77mock_stats_set,
+	.get	= m77mock_stats_get,
+};
+
+module_param( maxMods, int, 0 );
+MODULE_PARM_DESC( maxMods, "nr. of mock M-Modules (default 16)");
+module_param( tickUs, int, 0 );
+MODULE_PARM_DESC( tickUs, "line and interrupt tick in us (default 500)");
+module_param( lineRate, int, 0644 );
+MODULE_PARM_DESC( lineRate, "chars/s per channel, 0 = programmed baudrate / 10");
+module_param( rxRate, int, 0644 );
+MODULE_PARM_DESC( rxRate, "generated RX chars/s per channel, 0 = off");
+module_param( link, int, 0644 );
+MODULE_PARM_DESC( link, "TX chars go to 0: nowhere 1: own RX 2: RX of channel ^ 1");
+module_param( rdNs, int, 0644 );
+MODULE_PARM_DESC( rdNs, "delay of a D16 read in ns");
+module_param( wrNs, int, 0644 );
+MODULE_PARM_DESC( wrNs, "delay of a D16 write in ns");
+module_param_cb( stats, &m77mock_stats_ops, NULL, 0644 );
+MODULE_PARM_DESC( stats, "register access and line statistics, write to clear");
+
+/*******************************************************************/
+/** D16 read of the driver, see m77mock.h
+ *
+ * \param addr		\IN register address
+ *
+ * \return 			register value
+ */
+u16 m77mock_read16(volatile void *addr)
+{
+	unsigned long flags;
+	u16 val;
+
+	spin_lock_irqsave(&G_lock, flags);
+	val = rm_read16(addr);
+	spin_unlock_irqrestore(&G_lock, flags);
+
+	if (rdNs)
+		ndelay(rdNs);
+	return val;
+}
+EXPORT_SYMBOL(m77mock_read16);
+
+/*******************************************************************/
+/** D16 write of the driver, see m77mock.h
+ *
+ * \param addr		\IN register address
+ * \param val		\IN register value
+ *
+ * \return 			-
+ */
+void m77mock_write16(volatile void *addr, u16 val)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&G_lock, flags);
+	rm_write16(addr, val);
+	spin_unlock_irqrestore(&G_lock, flags);
+
+	if (wrNs)
+		ndelay(wrNs);
+}
+EXPORT_SYMBOL(m77mock_write16);
+
+/*******************************************************************/
+/** Time the interrupt of a M-Module became pending, see m77mock.h
+ *
+ * \param addr		\IN register window of the M-Module
+ *
+ * \brief The interrupt is taken as asserted at the end of the line
+ *        model update of the tick that found it pending. It stays
+ *        asserted over the following ticks until the ISR cleared it.
+ *
+ * \return 			ktime_get_ns() value or 0 if not pending
+ */
+u64 m77mock_irq_ns(volatile void *addr)
+{
+	int idx = rm_mod_index(addr);
+	unsigned long flags;
+	u64 ns;
+
+	if (idx < 0)
+		return 0;
+
+	spin_lock_irqsave(&G_lock, flags);
+	ns = G_dev[idx].irqNs;
+	spin_unlock_irqrestore(&G_lock, flags);
+	return ns;
+}
+EXPORT_SYMBOL(m77mock_irq_ns);
+
+/*******************************************************************/
+/** Chars of one tick at a rate, keeps the remainder
+ *
+ * \param credit	\INOUT line time not used yet
+ * \param cps		\IN chars per second
+ *
+ * \return 			nr. of chars, at most one FIFO
+ */
+static unsigned int m77mock_chars(u64 *credit, unsigned int cps)
+{
+	u64 n;
+
+	*credit += (u64)cps * tickUs;
+	n = div_u64(*credit, 1000000);
+	*credit -= n * 1000000;
+	return min_t(u64, n, RM_FIFO_SIZE);
+}
+
+/*******************************************************************/
+/** Move the chars of one channel for one tick, G_lock held
+ *
+ * \param mod		\IN M-Module index
+ * \param ch		\IN channel
+ *
+ * \return 			-
+ */
+static void m77mock_chan_tick(unsigned int mod, unsigned int ch)
+{
+	M77MOCK_DEV *d = &G_dev[mod];
+	unsigned char buf[RM_FIFO_SIZE];
+	unsigned int baud = rm_chan_baud(mod, ch);
+	unsigned int cps, n, i, peer;
+
+	if (!baud)					/* not opened since reset */
+		return;
+	cps = lineRate ? lineRate : baud / 10;
+
+	n = m77mock_chars(&d->txCredit[ch], cps);
+	n = rm_tx_drain(mod, ch, buf, n);
+	if (n && link == M77MOCK_LINK_LOOP)
+		rm_rx_inject(mod, ch, buf, n, 0);
+	else if (n && link == M77MOCK_LINK_CROSS) {
+		peer = ch ^ 1;
+		if (peer < rm_mod_chans(mod))
+			rm_rx_inject(mod, peer, buf, n, 0);
+	}
+
+	if (rxRate) {
+		n = m77mock_chars(&d->rxCredit[ch], rxRate);
+		for (i = 0; i < n; i++)
+			buf[i] = d->rxSeq[ch]++;
+		rm_rx_inject(mod, ch, buf, n, 0);
+	}
+}
+
+/*******************************************************************/
+/** Timer tick: line activity, then the interrupts
+ *
+ * \param t			\IN G_timer
+ *
+ * \return 			HRTIMER_RESTART
+ */
+static enum hrtimer_restart m77mock_tick(struct hrtimer *t)
+{
+	int (*handler)(void *);
+	void *data;
+	unsigned int i, ch;
+	int pending;
+	u64 now;
+
+	spin_lock(&G_lock);
+	for (i = 0; i < maxMods; i++) {
+		if (!G_dev[i].name[0])
+			continue;
+		for (ch = 0; ch < rm_mod_chans(i); ch++)
+			m77mock_chan_tick(i, ch);
+	}
+	spin_unlock(&G_lock);
+	now = ktime_get_ns();
+
+	/* the handler does register accesses, call it without G_lock */
+	for (i = 0; i < maxMods; i++) {
+		spin_lock(&G_lock);
+		handler = G_dev[i].irqEn ? G_dev[i].handler : NULL;
+		data	= G_dev[i].data;
+		pending = handler && rm_mod_irq_pending(i);
+		if (pending && !G_dev[i].irqNs)
+			G_dev[i].irqNs = now;
+		spin_unlock(&G_lock);
+
+		if (!pending)
+			continue;
+		handler(data);
+
+		spin_lock(&G_lock);
+		if (!rm_mod_irq_pending(i))
+			G_dev[i].irqNs = 0;
+		spin_unlock(&G_lock);
+	}
+
+	hrtimer_forward_now(t, G_tick);
+	return HRTIMER_RESTART;
+}
+
+/*******************************************************************/
+/** Wait until a running tick is done, it may use an old handler
+ *
+ * \return 			-
+ */
+static void m77mock_sync_tick(void)
+{
+	hrtimer_cancel(&G_timer);
+	hrtimer_start(&G_timer, G_tick, HRTIMER_MODE_REL);
+}
+
+/*******************************************************************/
+/** Open a M-Module on the mock carrier
+ *
+ * \param devName	\IN device name, prefix m45/m69 selects the type,
+ *						M77 otherwise
+ * \param brdName	\IN carrier name, ignored
+ * \param slotNo	\IN slot, ignored
+ * \param addrMode	\IN must be MDIS_MA08
+ * \param dataMode	\IN must be MDIS_MD08
+ * \param addrSpaceSize	\IN at most 256
+ * \param mappedAddrP	\OUT register window
+ * \param reserved	\IN unused
+ * \param devHdlP	\OUT device handle
+ *
+ * \return 			0 or negative error code
+ */
+int mdis_open_external_dev(char *devName, char *brdName, int slotNo,
+						   int addrMode, int dataMode, int addrSpaceSize,
+						   void **mappedAddrP, void *reserved, void **devHdlP)
+{
+	unsigned long flags;
+	unsigned int modtype = RM_M77;
+	int i, idx = -1;
+
+	if (addrMode != MDIS_MA08 || dataMode != MDIS_MD08 ||
+		addrSpaceSize > RM_WINDOW)
+		return -EINVAL;
+
+	if (!strncmp(devName, "m45", 3))
+		modtype = RM_M45;
+	else if (!strncmp(devName, "m69", 3))
+		modtype = RM_M69;
+
+	spin_lock_irqsave(&G_lock, flags);
+	for (i = 0; i < maxMods; i++) {
+		if (!strncmp(G_dev[i].name, devName, M77MOCK_NAMELEN)) {
+			idx = -EBUSY;
+			break;
+		}
+		if (idx < 0 && !G_dev[i].name[0])
+			idx = i;
+	}
+	if (idx >= 0) {
+		memset(&G_dev[idx], 0, sizeof(G_dev[idx]));
+		strscpy(G_dev[idx].name, devName, M77MOCK_NAMELEN);
+		rm_set_mod_type(idx, modtype);
+	}
+	spin_unlock_irqrestore(&G_lock, flags);
+
+	if (idx < 0) {
+		printk(KERN_ERR "*** m77mock: can't open %s (%d)\n", devName, idx);
+		return idx == -1 ? -ENOSPC : idx;
+	}
+
+	*mappedAddrP	= rm_mod_base(idx);
+	*devHdlP		= &G_dev[idx];
+	printk(KERN_INFO "m77mock: %s at %p\n", devName, *mappedAddrP);
+	return 0;
+}
+EXPORT_SYMBOL(mdis_open_external_dev);
+
+/*******************************************************************/
+/** Close a M-Module
+ *
+ * \param devHdl	\IN device handle
+ *
+ * \return 			0
+ */
+int mdis_close_external_dev(void *devHdl)
+{
+	M77MOCK_DEV *d = devHdl;
+	unsigned long flags;
+
+	spin_lock_irqsave(&G_lock, flags);
+	d->handler	= NULL;
+	d->irqEn	= 0;
+	d->name[0]	= '\0';
+	spin_unlock_irqrestore(&G_lock, flags);
+
+	m77mock_sync_tick();
+	return 0;
+}
+EXPORT_SYMBOL(mdis_close_external_dev);
+
+/*******************************************************************/
+/** Install the interrupt handler of a M-Module
+ *
+ * \param devHdl	\IN device handle
+ * \param handler	\IN called from the tick while the interrupt is active
+ * \param data		\IN passed to handler
+ *
+ * \return 			0
+ */
+int mdis_install_external_irq(void *devHdl, int (*handler)(void *),
+							  void *data)
+{
+	M77MOCK_DEV *d = devHdl;
+	unsigned long flags;
+
+	spin_lock_irqsave(&G_lock, flags);
+	d->handler	= handler;
+	d->data		= data;
+	spin_unlock_irqrestore(&G_lock, flags);
+	return 0;
+}
+EXPORT_SYMBOL(mdis_install_external_irq);
+
+/*******************************************************************/
+/** Remove the interrupt handler, it is not running anymore on return
+ *
+ * \param devHdl	\IN device handle
+ *
+ * \return 			0
+ */
+int mdis_remove_external_irq(void *devHdl)
+{
+	M77MOCK_DEV *d = devHdl;
+	unsigned long flags;
+
+	spin_lock_irqsave(&G_lock, flags);
+	d->handler	= NULL;
+	d->irqEn	= 0;
+	spin_unlock_irqrestore(&G_lock, flags);
+
+	m77mock_sync_tick();
+	return 0;
+}
+EXPORT_SYMBOL(mdis_remove_external_irq);
+
+/*******************************************************************/
+/** Enable the interrupt of a M-Module
+ *
+ * \param devHdl	\IN device handle
+ *
+ * \return 			0
+ */
+int mdis_enable_external_irq(void *devHdl)
+{
+	M77MOCK_DEV *d = devHdl;
+	unsigned long flags;
+
+	spin_lock_irqsave(&G_lock, flags);
+	d->irqEn = 1;
+	spin_unlock_irqrestore(&G_lock, flags);
+	return 0;
+}
+EXPORT_SYMBOL(mdis_enable_external_irq);
+
+/*******************************************************************/
+/** Disable the interrupt of a M-Module
+ *
+ * \param devHdl	\IN device handle
+ *
+ * \return 			0
+ */
+int mdis_disable_external_irq(void *devHdl)
+{
+	M77MOCK_DEV *d = devHdl;
+	unsigned long flags;
+
+	spin_lock_irqsave(&G_lock, flags);
+	d->irqEn = 0;
+	spin_unlock_irqrestore(&G_lock, flags);
+
+	m77mock_sync_tick();
+	return 0;
+}
+EXPORT_SYMBOL(mdis_disable_external_irq);
+
+/*******************************************************************/
+/** Read the ID EEPROM of a mock M-Module
+ *
+ * \param addr		\IN register window from mdis_open_external_dev()
+ * \param modtype	\OUT MODCOM_MOD_MEN
+ * \param devid		\OUT magic << 16 | M-Module number
+ * \param devrev	\OUT revision
+ * \param devname	\OUT e.g. "M77"
+ *
+ * \return 			0 or -1 if addr is no mock M-Module
+ */
+int m_getmodinfo(U_INT32_OR_64 addr, u_int32 *modtype, u_int32 *devid,
+				 u_int32 *devrev, char *devname)
+{
+	int idx = rm_mod_index((void *)addr);
+	unsigned int type;
+
+	if (idx < 0)
+		return -1;
+
+	type = rm_mod_type(idx);
+	*modtype	= MODCOM_MOD_MEN;
+	*devid		= (M77MOCK_MAGIC << 16) | type;
+	*devrev		= 1;
+	sprintf(devname, "M%02d", type == RM_M45 ? 45 : type == RM_M69 ? 69 : 77);
+	return 0;
+}
+EXPORT_SYMBOL(m_getmodinfo);
+
+/*******************************************************************/
+/** Read the statistics, module parameter "stats"
+ *
+ * \param buf		\OUT PAGE_SIZE buffer
+ * \param kp		\IN unused
+ *
+ * \return 			length of buf
+ */
+static int m77mock_stats_get(char *buf, const struct kernel_param *kp)
+{
+	struct rm_stats st;
+	unsigned long flags;
+	int i, len = 0;
+
+	len += scnprintf(buf + len, PAGE_SIZE - len,
+					 "# dev rd wr rx_bytes tx_bytes rx_overrun tx_overrun\n");
+	for (i = 0; i < maxMods; i++) {
+		spin_lock_irqsave(&G_lock, flags);
+		if (!G_dev[i].name[0]) {
+			spin_unlock_irqrestore(&G_lock, flags);
+			continue;
+		}
+		rm_get_mod_stats(i, &st);
+		spin_unlock_irqrestore(&G_lock, flags);
+
+		len += scnprintf(buf + len, PAGE_SIZE - len,
+						 "%s %llu %llu %llu %llu %llu %llu\n", G_dev[i].name,
+						 st.rd, st.wr, st.rxBytes, st.txBytes,
+						 st.rxOverrun, st.txOverrun);
+	}
+	return len;
+}
+
+/*******************************************************************/
+/** Clear the statistics, module parameter "stats"
+ *
+ * \param val		\IN ignored
+ * \param kp		\IN unused
+ *
+ * \return 			0
+ */
+static int m77mock_stats_set(const char *val, const struct kernel_param *kp)
+{
+	unsigned long flags;
+
+	/* parameter given at insmod, nothing to clear yet */
+	if (!G_dev)
+		return 0;
+
+	spin_lock_irqsave(&G_lock, flags);
+	rm_clear_stats();
+	spin_unlock_irqrestore(&G_lock, flags);
+	return 0;
+}
+
+/*******************************************************************/
+/** Module init: set up the model and start the tick
+ *
+ * \return 			0 or negative error code
+ */
+static int __init m77mock_init(void)
+{
+	if (maxMods < 1 || maxMods > RM_MAX_MODS || tickUs < 10) {
+		printk(KERN_ERR "*** m77mock: invalid maxMods %d or tickUs %d\n",
+			   maxMods, tickUs);
+		return -EINVAL;
+	}
+
+	G_dev = kcalloc(maxMods, sizeof(*G_dev), GFP_KERNEL);
+	if (!G_dev)
+		return -ENOMEM;
+
+	if (rm_init(maxMods, RM_M77)) {
+		kfree(G_dev);
+		G_dev = NULL;
+		return -ENOMEM;
+	}
+	rm_set_bus_ns(rdNs, wrNs);
+
+	G_tick = ns_to_ktime((u64)tickUs * NSEC_PER_USEC);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,13,0)
+	hrtimer_setup(&G_timer, m77mock_tick, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+#else
+	hrtimer_init(&G_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	G_timer.function = m77mock_tick;
+#endif
+	hrtimer_start(&G_timer, G_tick, HRTIMER_MODE_REL);
+
+	printk(KERN_INFO "m77mock: %d M-Modules, tick %d us, link %d\n",
+		   maxMods, tickUs, link);
+	return 0;
+}
+
+/*******************************************************************/
+/** Module exit, the driver using the mock is unloaded already
+ *
+ * \return 			-
+ */
+static void __exit m77mock_exit(void)
+{
+	struct rm_stats st;
+
+	hrtimer_cancel(&G_timer);
+
+	rm_get_stats(&st);
+	printk(KERN_INFO "m77mock: rd %llu wr %llu rx %llu tx %llu "
+		   "overruns rx %llu tx %llu\n", st.rd, st.wr, st.rxBytes,
+		   st.txBytes, st.rxOverrun, st.txOverrun);
+
+	rm_exit();
+	kfree(G_dev);
+	G_dev = NULL;
+}
+
+module_init(m77mock_init);
+module_exit(m77mock_exit);
+
+MODULE_LICENSE( "GPL" );
+MODULE_DESCRIPTION("MEN M77/M69N/M45N mock MDIS carrier");
@@ -0,0 +1,47 @@
+/***********************  I n c l u d e  -  F i l e  ************************/
+/*!
+ *        \file  m77mock.h
+ *
+ *      \author  thomas schnuerer
+ *
+ *       \brief  Register access of serial_m77.c on the mock carrier
+ *               men_m77mock, included by serial_m77.c when built with
+ *               M77_MOCK. The D16 accesses go to the register model of
+ *               the mock instead of memory.
+ *
+ *     Switches: M77_MOCK
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _M77MOCK_H
+#define _M77MOCK_H
+
+u16 m77mock_read16(volatile void *addr);
+void m77mock_write16(volatile void *addr, u16 val);
+u64 m77mock_irq_ns(volatile void *addr);
+
+#ifdef M77_MOCK
+# undef MREAD_D16
+# undef MWRITE_D16
+# define MREAD_D16(ma,offs)			m77mock_read16((char *)(ma)+(offs))
+# define MWRITE_D16(ma,offs,val)	m77mock_write16((char *)(ma)+(offs),(val))
+#endif
+
+#endif /* _M77MOCK_H */
@@ -0,0 +1,852 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  regmodel.c
+ *
+ *      \author  thomas schnuerer
+ *
+ *       \brief  Register model of M45N/M69N/M77 M-Modules: OX16C954
+ *               UARTs with FIFOs, 650 (EFR) and ICR register banks and
+ *               the CPLD IR/DCR/TCR registers. Every D16 access is
+ *               counted and charged with a simulated bus time.
+ *
+ *               Used by the mock carrier m77mock.c in the kernel and by
+ *               the user space benchmark DRIVER/TEST/REGMODEL. The model
+ *               does no locking, the caller serializes all calls.
+ *
+ *               The M-Modules are one contiguous area of RM_WINDOW byte
+ *               windows, the address passed to MREAD_D16/MWRITE_D16
+ *               selects M-Module and register. The area itself is never
+ *               accessed.
+ *
+ *     Switches: __KERNEL__	kernel module build
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef __KERNEL__
+# include <linux/kernel.h>
+# include <linux/slab.h>
+# include <linux/string.h>
+# include <linux/serial_reg.h>
+# define RM_ZALLOC(n, s)	kcalloc((n), (s), GFP_KERNEL)
+# define RM_FREE(p)			kfree(p)
+# define RM_ERR(fmt, x...)	printk(KERN_ERR "*** regmodel: " fmt, ## x)
+#else
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <linux/serial_reg.h>
+# define RM_ZALLOC(n, s)	calloc((n), (s))
+# define RM_FREE(p)			free(p)
+# define RM_ERR(fmt, x...)	fprintf(stderr, "*** regmodel: " fmt, ## x)
+#endif
+
+#include "regmodel.h"
+
+/*-----------------------------+
+|   DEFINES                    |
++-----------------------------*/
+#define RM_ID1			0x16		/* OX16C954 ID registers			*/
+#define RM_ID2			0xc9
+#define RM_ID3			0x54
+#define RM_REV			0x01
+
+#define RM_REG_TCR1		0x40		/* M45N: tristate, channels 0-3		*/
+#define RM_REG_IR1		0x48		/* IR, M45N: channels 0-3			*/
+#define RM_REG_TCR2		0xc0		/* M45N: tristate, channels 4-7		*/
+#define RM_REG_IR2		0xc8		/* M45N: IR of channels 4-7			*/
+#define RM_REG_DCR		0x40		/* M77: DCR of channel 0..3, 2 apart */
+
+#define RM_IR_IRQ		0x01
+#define RM_IR_IMASK		0x02
+#define RM_IR_MASKBITS	0x06		/* IMASK, DRVEN: read back			*/
+
+/*-----------------------------+
+|   TYPEDEFS                   |
++-----------------------------*/
+/** one OX16C954 channel */
+struct rm_uart {
+	unsigned char	rx[RM_FIFO_SIZE];
+	unsigned char	rxErr[RM_FIFO_SIZE];	/* LSR error bits per char	*/
+	unsigned int	rxHead;
+	unsigned int	rxCnt;
+	unsigned char	tx[RM_FIFO_SIZE];
+	unsigned int	txHead;
+	unsigned int	txCnt;
+	unsigned char	rbr;				/* last char read				*/
+	unsigned char	ier, lcr, mcr, fcr, spr, dll, dlm;
+	unsigned char	efr, xon1, xon2, xoff1, xoff2;
+	unsigned char	oe;					/* overrun, cleared by LSR read	*/
+	unsigned char	thri;				/* THRE interrupt pending		*/
+	unsigned char	icr[16];			/* ACR ... NMR					*/
+};
+
+/** one M-Module */
+struct rm_mod {
+	unsigned int	modtype;
+	unsigned int	nChan;
+	unsigned char	ir[2];				/* IMASK/DRVEN of IR1, IR2		*/
+	unsigned char	dcr[4];				/* M77								*/
+	unsigned char	tcr[2];				/* M45N								*/
+	struct rm_uart	uart[RM_MAX_CHAN];
+	struct rm_stats	st;
+};
+
+/*-----------------------------+
+|   GLOBALS                    |
++-----------------------------*/
+static unsigned char *G_base;			/* RM_WINDOW per M-Module		*/
+static struct rm_mod *G_mod;
+static unsigned int G_nMods;
+static unsigned int G_rdNs = 0;
+static unsigned int G_wrNs = 0;
+
+
+/*******************************************************************/
+/** Reset a UART like a write of 0 to the CSR
+ *
+ * \param u			\IN UART
+ *
+ * \return 			-
+ */
+static void rm_uart_reset(struct rm_uart *u)
+{
+	memset(u, 0, sizeof(*u));
+}
+
+/*******************************************************************/
+/** RX FIFO trigger level of a UART
+ *
+ * \param u			\IN UART
+ *
+ * \return 			trigger level in chars
+ */
+static unsigned int rm_rx_trigger(struct rm_uart *u)
+{
+	static const unsigned char lvl550[4] = { 1, 4, 8, 14 };
+	static const unsigned char lvl650[4] = { 16, 32, 112, 120 };
+
+	if (!(u->fcr & UART_FCR_ENABLE_FIFO))
+		return 1;
+	if (u->icr[UART_ACR] & UART_ACR_TLENB)
+		return u->icr[UART_RTL] ? u->icr[UART_RTL] : 1;
+	if (u->efr & UART_EFR_ECB)
+		return lvl650[u->fcr >> 6];
+	return lvl550[u->fcr >> 6];
+}
+
+/*******************************************************************/
+/** Compute the IIR of a UART
+ *
+ * \param u			\IN UART
+ *
+ * \return 			IIR value, UART_IIR_NO_INT set if no interrupt
+ */
+static unsigned char rm_iir(struct rm_uart *u)
+{
+	unsigned char iir = UART_IIR_NO_INT;
+
+	if ((u->ier & UART_IER_RLSI) &&
+		(u->oe || (u->rxCnt && u->rxErr[u->rxHead])))
+		iir = UART_IIR_RLSI;
+	else if ((u->ier & UART_IER_RDI) && u->rxCnt)
+		iir = u->rxCnt >= rm_rx_trigger(u) ? UART_IIR_RDI : 0x0c;
+	else if ((u->ier & UART_IER_THRI) && u->thri)
+		iir = UART_IIR_THRI;
+
+	if (u->fcr & UART_FCR_ENABLE_FIFO)
+		iir |= 0xc0;
+	return iir;
+}
+
+/*******************************************************************/
+/** Compute the LSR of a UART
+ *
+ * \param u			\IN UART
+ *
+ * \return 			LSR value
+ */
+static unsigned char rm_lsr(struct rm_uart *u)
+{
+	unsigned char lsr = 0;
+
+	if (u->rxCnt) {
+		lsr |= UART_LSR_DR | u->rxErr[u->rxHead];
+		if (u->rxErr[u->rxHead])
+			lsr |= UART_LSR_FIFOE;
+	}
+	if (u->oe)
+		lsr |= UART_LSR_OE;
+	if (!u->txCnt)
+		lsr |= UART_LSR_THRE | UART_LSR_TEMT;
+	return lsr;
+}
+
+/*******************************************************************/
+/** Put a char into the RX FIFO of a UART
+ *
+ * \param m			\IN M-Module
+ * \param u			\IN UART
+ * \param ch		\IN char
+ * \param err		\IN LSR error bits of the char
+ *
+ * \return 			0 or -1 if the FIFO was full
+ */
+static int rm_rx_put(struct rm_mod *m, struct rm_uart *u, unsigned char ch,
+					 unsigned char err)
+{
+	unsigned int idx;
+
+	if (u->rxCnt == RM_FIFO_SIZE) {
+		u->oe = 1;
+		m->st.rxOverrun++;
+		return -1;
+	}
+	idx = (u->rxHead + u->rxCnt++) % RM_FIFO_SIZE;
+	u->rx[idx] = ch;
+	u->rxErr[idx] = err & (UART_LSR_BI | UART_LSR_FE | UART_LSR_PE);
+	return 0;
+}
+
+/*******************************************************************/
+/** Read a UART register
+ *
+ * \param m			\IN M-Module
+ * \param u			\IN UART
+ * \param reg		\IN register offset 0..7
+ *
+ * \return 			register value
+ */
+static unsigned char rm_uart_read(struct rm_mod *m, struct rm_uart *u,
+								  unsigned int reg)
+{
+	unsigned char val;
+	int bank650 = (u->lcr == 0xbf);
+	int dlab = (u->lcr & UART_LCR_DLAB) && !bank650;
+
+	switch (reg) {
+	case UART_RX:
+		if (dlab)
+			return u->dll;
+		if (u->rxCnt) {
+			u->rbr = u->rx[u->rxHead];
+			u->rxHead = (u->rxHead + 1) % RM_FIFO_SIZE;
+			u->rxCnt--;
+			m->st.rxBytes++;
+		}
+		return u->rbr;
+	case UART_IER:
+		return dlab ? u->dlm : u->ier;
+	case UART_IIR:
+		if (bank650)
+			return u->efr;
+		val = rm_iir(u);
+		if ((val & 0x0f) == UART_IIR_THRI)
+			u->thri = 0;
+		return val;
+	case UART_LCR:
+		return u->lcr;
+	case UART_MCR:
+		return bank650 ? u->xon1 : u->mcr;
+	case UART_LSR:
+		if (bank650)
+			return u->xon2;
+		if (u->icr[UART_ACR] & UART_ACR_ICRRD) {
+			switch (u->spr) {
+			case UART_ID1:	return RM_ID1;
+			case UART_ID2:	return RM_ID2;
+			case UART_ID3:	return RM_ID3;
+			case UART_REV:	return RM_REV;
+			default:		return u->icr[u->spr & 0x0f];
+			}
+		}
+		val = rm_lsr(u);
+		u->oe = 0;
+		return val;
+	case UART_MSR:
+		if (bank650)
+			return u->xoff1;
+		/* CTS, DSR and DCD asserted, loopback mirrors the MCR */
+		if (u->mcr & UART_MCR_LOOP)
+			return ((u->mcr & UART_MCR_RTS) ? UART_MSR_CTS : 0) |
+				((u->mcr & UART_MCR_DTR) ? UART_MSR_DSR : 0) |
+				((u->mcr & UART_MCR_OUT1) ? UART_MSR_RI : 0) |
+				((u->mcr & UART_MCR_OUT2) ? UART_MSR_DCD : 0);
+		return UART_MSR_CTS | UART_MSR_DSR | UART_MSR_DCD;
+	default:
+		return bank650 ? u->xoff2 : u->spr;
+	}
+}
+
+/*******************************************************************/
+/** Write a UART register
+ *
+ * \param m			\IN M-Module
+ * \param u			\IN UART
+ * \param reg		\IN register offset 0..7
+ * \param val		\IN value
+ *
+ * \return 			-
+ */
+static void rm_uart_write(struct rm_mod *m, struct rm_uart *u,
+						  unsigned int reg, unsigned char val)
+{
+	int bank650 = (u->lcr == 0xbf);
+	int dlab = (u->lcr & UART_LCR_DLAB) && !bank650;
+
+	switch (reg) {
+	case UART_TX:
+		if (dlab) {
+			u->dll = val;
+			break;
+		}
+		u->thri = 0;
+		m->st.txBytes++;
+		if (u->mcr & UART_MCR_LOOP) {
+			rm_rx_put(m, u, val, 0);
+			u->thri = 1;
+		} else if (u->txCnt == RM_FIFO_SIZE) {
+			m->st.txOverrun++;
+		} else {
+			u->tx[(u->txHead + u->txCnt++) % RM_FIFO_SIZE] = val;
+		}
+		break;
+	case UART_IER:
+		if (dlab) {
+			u->dlm = val;
+			break;
+		}
+		/* enabling THRI with an empty FIFO raises the interrupt */
+		if ((val & UART_IER_THRI) && !(u->ier & UART_IER_THRI) && !u->txCnt)
+			u->thri = 1;
+		u->ier = val;
+		break;
+	case UART_FCR:
+		if (bank650) {
+			u->efr = val;
+			break;
+		}
+		if (val & UART_FCR_CLEAR_RCVR)
+			u->rxCnt = 0;
+		if (val & UART_FCR_CLEAR_XMIT) {
+			u->txCnt = 0;
+			u->thri = 1;
+		}
+		u->fcr = val & ~(UART_FCR_CLEAR_RCVR | UART_FCR_CLEAR_XMIT);
+		break;
+	case UART_LCR:
+		u->lcr = val;
+		break;
+	case UART_MCR:
+		if (bank650)
+			u->xon1 = val;
+		else
+			u->mcr = val;
+		break;
+	case UART_LSR:
+		if (bank650) {
+			u->xon2 = val;
+		} else if (u->spr == UART_CSR) {
+			if (val == 0)
+				rm_uart_reset(u);
+		} else {
+			u->icr[u->spr & 0x0f] = val;
+		}
+		break;
+	case UART_MSR:
+		if (bank650)
+			u->xoff1 = val;
+		break;
+	default:
+		if (bank650)
+			u->xoff2 = val;
+		else
+			u->spr = val;
+		break;
+	}
+}
+
+/*******************************************************************/
+/** Check if a UART requests an interrupt
+ *
+ * \param u			\IN UART
+ *
+ * \return 			1 if the interrupt line is active
+ */
+static int rm_uart_irq(struct rm_uart *u)
+{
+	return !(rm_iir(u) & UART_IIR_NO_INT);
+}
+
+/*******************************************************************/
+/** Read an IR register: pending bit of the channels it serves
+ *
+ * \param m			\IN M-Module
+ * \param grp		\IN 0: IR1, 1: IR2 (M45N channels 4-7)
+ *
+ * \return 			IR value
+ */
+static unsigned char rm_ir(struct rm_mod *m, unsigned int grp)
+{
+	unsigned int ch, first = 0, last = m->nChan;
+	unsigned char ir = m->ir[grp];
+
+	if (m->modtype == RM_M45) {
+		first = grp * 4;
+		last = first + 4;
+	}
+	for (ch = first; ch < last; ch++) {
+		if (rm_uart_irq(&m->uart[ch])) {
+			ir |= RM_IR_IRQ;
+			break;
+		}
+	}
+	return ir;
+}
+
+/*******************************************************************/
+/** Decode an address to M-Module and register
+ *
+ * \param addr		\IN address passed to MREAD_D16/MWRITE_D16
+ * \param offP		\OUT offset in the M-Module window
+ *
+ * \return 			M-Module or NULL if addr is outside the model
+ */
+static struct rm_mod *rm_decode(volatile void *addr, unsigned int *offP)
+{
+	unsigned long off = (unsigned char *)addr - G_base;
+
+	if ((unsigned char *)addr < G_base || off >= G_nMods * RM_WINDOW) {
+		RM_ERR("access outside of the M-Modules %p\n", addr);
+		return NULL;
+	}
+	*offP = off % RM_WINDOW;
+	return &G_mod[off / RM_WINDOW];
+}
+
+/*******************************************************************/
+/** Map a window offset to a UART channel
+ *
+ * \param m			\IN M-Module
+ * \param off		\IN offset in the M-Module window
+ *
+ * \return 			channel or -1 if off is a CPLD register
+ */
+static int rm_chan(struct rm_mod *m, unsigned int off)
+{
+	if (off < 0x40)
+		return off >> 4;
+	if (m->modtype == RM_M45 && off >= 0x80 && off < 0xc0)
+		return 4 + ((off - 0x80) >> 4);
+	return -1;
+}
+
+/*******************************************************************/
+/** D16 read, MREAD_D16 of the user space build
+ *
+ * \param addr		\IN address
+ *
+ * \return 			register value in the low byte
+ */
+unsigned short rm_read16(volatile void *addr)
+{
+	unsigned int off;
+	struct rm_mod *m = rm_decode(addr, &off);
+	int ch;
+
+	if (!m)
+		return 0xffff;
+	ch = rm_chan(m, off);
+	m->st.rd++;
+	m->st.busNs += G_rdNs;
+
+	if (ch >= 0) {
+		m->st.uartRd++;
+		return rm_uart_read(m, &m->uart[ch], (off & 0x0f) >> 1);
+	}
+
+	m->st.cpldRd++;
+	switch (off) {
+	case RM_REG_IR1:
+		return rm_ir(m, 0);
+	case RM_REG_IR2:
+		return m->modtype == RM_M45 ? rm_ir(m, 1) : 0xff;
+	case RM_REG_TCR2:
+		return m->modtype == RM_M45 ? m->tcr[1] : 0xff;
+	}
+	if (m->modtype == RM_M45 && off == RM_REG_TCR1)
+		return m->tcr[0];
+	if (m->modtype == RM_M77 && off >= RM_REG_DCR && off < RM_REG_IR1)
+		return m->dcr[(off - RM_REG_DCR) >> 1];
+	return 0xff;
+}
+
+/*******************************************************************/
+/** D16 write, MWRITE_D16 of the user space build
+ *
+ * \param addr		\IN address
+ * \param val		\IN value, the low byte is used
+ *
+ * \return 			-
+ */
+void rm_write16(volatile void *addr, unsigned short val)
+{
+	unsigned int off;
+	struct rm_mod *m = rm_decode(addr, &off);
+	int ch;
+
+	if (!m)
+		return;
+	ch = rm_chan(m, off);
+	m->st.wr++;
+	m->st.busNs += G_wrNs;
+
+	if (ch >= 0) {
+		m->st.uartWr++;
+		rm_uart_write(m, &m->uart[ch], (off & 0x0f) >> 1, val & 0xff);
+		return;
+	}
+
+	m->st.cpldWr++;
+	switch (off) {
+	case RM_REG_IR1:
+		m->ir[0] = val & RM_IR_MASKBITS;
+		return;
+	case RM_REG_IR2:
+		m->ir[1] = val & RM_IR_MASKBITS;
+		return;
+	case RM_REG_TCR2:
+		m->tcr[1] = val;
+		return;
+	}
+	if (m->modtype == RM_M45 && off == RM_REG_TCR1)
+		m->tcr[0] = val;
+	else if (m->modtype == RM_M77 && off >= RM_REG_DCR && off < RM_REG_IR1)
+		m->dcr[(off - RM_REG_DCR) >> 1] = val;
+}
+
+/*******************************************************************/
+/** Create the M-Modules of the model
+ *
+ * \param nMods		\IN number of M-Modules, max. RM_MAX_MODS
+ * \param modtype	\IN RM_M45, RM_M69 or RM_M77
+ *
+ * \return 			0 or -1 on error
+ */
+int rm_init(unsigned int nMods, unsigned int modtype)
+{
+	unsigned int i;
+
+	if (!nMods || nMods > RM_MAX_MODS)
+		return -1;
+
+	/* only the addresses are used, the window contents never */
+	G_base = RM_ZALLOC(nMods, RM_WINDOW);
+	G_mod = RM_ZALLOC(nMods, sizeof(*G_mod));
+	if (!G_base || !G_mod) {
+		rm_exit();
+		return -1;
+	}
+
+	G_nMods = nMods;
+	for (i = 0; i < nMods; i++)
+		rm_set_mod_type(i, modtype);
+	return 0;
+}
+
+/*******************************************************************/
+/** Free the model
+ *
+ * \return 			-
+ */
+void rm_exit(void)
+{
+	RM_FREE(G_base);
+	RM_FREE(G_mod);
+	G_base = NULL;
+	G_mod = NULL;
+	G_nMods = 0;
+}
+
+/*******************************************************************/
+/** Base address of a M-Module, passed as memBase to the driver
+ *
+ * \param mod		\IN M-Module index
+ *
+ * \return 			base address
+ */
+void *rm_mod_base(unsigned int mod)
+{
+	return G_base + mod * RM_WINDOW;
+}
+
+/*******************************************************************/
+/** Number of UART channels of a M-Module
+ *
+ * \param mod		\IN M-Module index
+ *
+ * \return 			4 or 8
+ */
+unsigned int rm_mod_chans(unsigned int mod)
+{
+	return G_mod[mod].nChan;
+}
+
+/*******************************************************************/
+/** Set the type of a M-Module, resets it to power up state
+ *
+ * \param mod		\IN M-Module index
+ * \param modtype	\IN RM_M45, RM_M69 or RM_M77
+ *
+ * \return 			-
+ */
+void rm_set_mod_type(unsigned int mod, unsigned int modtype)
+{
+	struct rm_mod *m = &G_mod[mod];
+
+	memset(m, 0, sizeof(*m));
+	m->modtype = modtype;
+	m->nChan = modtype == RM_M45 ? 8 : 4;
+}
+
+/*******************************************************************/
+/** Find the M-Module of an address
+ *
+ * \param addr		\IN address within a M-Module window
+ *
+ * \return 			M-Module index or -1
+ */
+int rm_mod_index(volatile void *addr)
+{
+	unsigned long off = (unsigned char *)addr - G_base;
+
+	if ((unsigned char *)addr < G_base || off >= G_nMods * RM_WINDOW)
+		return -1;
+	return off / RM_WINDOW;
+}
+
+/*******************************************************************/
+/** Type of a M-Module
+ *
+ * \param mod		\IN M-Module index
+ *
+ * \return 			RM_M45, RM_M69 or RM_M77
+ */
+unsigned int rm_mod_type(unsigned int mod)
+{
+	return G_mod[mod].modtype;
+}
+
+/*******************************************************************/
+/** Baudrate programmed into a UART
+ *
+ * \param mod		\IN M-Module index
+ * \param ch		\IN channel
+ *
+ * \return 			baudrate, 0 if no divisor is set
+ */
+unsigned int rm_chan_baud(unsigned int mod, unsigned int ch)
+{
+	struct rm_uart *u = &G_mod[mod].uart[ch];
+	unsigned int quot = u->dll | (u->dlm << 8);
+
+	return quot ? RM_UARTCLK / 16 / quot : 0;
+}
+
+/*******************************************************************/
+/** Set the simulated bus time of D16 accesses
+ *
+ * \param rdNs		\IN ns per read
+ * \param wrNs		\IN ns per write
+ *
+ * \return 			-
+ */
+void rm_set_bus_ns(unsigned int rdNs, unsigned int wrNs)
+{
+	G_rdNs = rdNs;
+	G_wrNs = wrNs;
+}
+
+/*******************************************************************/
+/** Receive chars on a UART, i.e. put them into its RX FIFO
+ *
+ * \param mod		\IN M-Module index
+ * \param ch		\IN channel
+ * \param buf		\IN chars
+ * \param len		\IN number of chars
+ * \param lsrErr	\IN UART_LSR_BI/FE/PE set for all chars
+ *
+ * \return 			number of chars stored, the rest was overrun
+ */
+int rm_rx_inject(unsigned int mod, unsigned int ch,
+				 const unsigned char *buf, int len, unsigned char lsrErr)
+{
+	struct rm_mod *m = &G_mod[mod];
+	int i;
+
+	for (i = 0; i < len; i++)
+		if (rm_rx_put(m, &m->uart[ch], buf[i], lsrErr) < 0)
+			break;
+	return i;
+}
+
+/*******************************************************************/
+/** Send chars of a UART, i.e. take them out of its TX FIFO
+ *
+ * \param mod		\IN M-Module index
+ * \param ch		\IN channel
+ * \param buf		\OUT chars sent or NULL
+ * \param max		\IN max. number of chars
+ *
+ * \return 			number of chars sent
+ */
+int rm_tx_drain(unsigned int mod, unsigned int ch, unsigned char *buf, int max)
+{
+	struct rm_uart *u = &G_mod[mod].uart[ch];
+	int n = 0;
+
+	if (u->icr[UART_ACR] & UART_ACR_TXDIS)
+		return 0;
+
+	while (u->txCnt && n < max) {
+		if (buf)
+			buf[n] = u->tx[u->txHead];
+		u->txHead = (u->txHead + 1) % RM_FIFO_SIZE;
+		u->txCnt--;
+		n++;
+	}
+	if (n && !u->txCnt)
+		u->thri = 1;
+	return n;
+}
+
+/*******************************************************************/
+/** Free space in the RX FIFO of a UART
+ *
+ * \param mod		\IN M-Module index
+ * \param ch		\IN channel
+ *
+ * \return 			number of chars that can be received without overrun
+ */
+unsigned int rm_rx_space(unsigned int mod, unsigned int ch)
+{
+	return RM_FIFO_SIZE - G_mod[mod].uart[ch].rxCnt;
+}
+
+/*******************************************************************/
+/** Number of chars in the TX FIFO of a UART
+ *
+ * \param mod		\IN M-Module index
+ * \param ch		\IN channel
+ *
+ * \return 			TX FIFO level
+ */
+unsigned int rm_tx_level(unsigned int mod, unsigned int ch)
+{
+	return G_mod[mod].uart[ch].txCnt;
+}
+
+/*******************************************************************/
+/** Check if the unmasked interrupt of a M-Module is active
+ *
+ * \param mod		\IN M-Module index
+ *
+ * \return 			1 if the M-Module interrupt line is active
+ */
+int rm_mod_irq_pending(unsigned int mod)
+{
+	struct rm_mod *m = &G_mod[mod];
+
+	if ((m->ir[0] & RM_IR_IMASK) && (rm_ir(m, 0) & RM_IR_IRQ))
+		return 1;
+	if (m->modtype == RM_M45 && (m->ir[1] & RM_IR_IMASK) &&
+		(rm_ir(m, 1) & RM_IR_IRQ))
+		return 1;
+	return 0;
+}
+
+/*******************************************************************/
+/** Check if any unmasked M-Module interrupt is active
+ *
+ * \return 			1 if the carrier IRQ line is active
+ */
+int rm_irq_pending(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < G_nMods; i++)
+		if (rm_mod_irq_pending(i))
+			return 1;
+	return 0;
+}
+
+/*******************************************************************/
+/** Get the statistics of one M-Module
+ *
+ * \param mod		\IN M-Module index
+ * \param st		\OUT statistics
+ *
+ * \return 			-
+ */
+void rm_get_mod_stats(unsigned int mod, struct rm_stats *st)
+{
+	*st = G_mod[mod].st;
+}
+
+/*******************************************************************/
+/** Get the statistics summed up over all M-Modules
+ *
+ * \param st		\OUT statistics
+ *
+ * \return 			-
+ */
+void rm_get_stats(struct rm_stats *st)
+{
+	unsigned int i;
+	struct rm_stats *s;
+
+	memset(st, 0, sizeof(*st));
+	for (i = 0; i < G_nMods; i++) {
+		s = &G_mod[i].st;
+		st->rd			+= s->rd;
+		st->wr			+= s->wr;
+		st->uartRd		+= s->uartRd;
+		st->uartWr		+= s->uartWr;
+		st->cpldRd		+= s->cpldRd;
+		st->cpldWr		+= s->cpldWr;
+		st->busNs		+= s->busNs;
+		st->rxBytes		+= s->rxBytes;
+		st->txBytes		+= s->txBytes;
+		st->rxOverrun	+= s->rxOverrun;
+		st->txOverrun	+= s->txOverrun;
+	}
+}
+
+/*******************************************************************/
+/** Clear the statistics of all M-Modules
+ *
+ * \return 			-
+ */
+void rm_clear_stats(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < G_nMods; i++)
+		memset(&G_mod[i].st, 0, sizeof(G_mod[i].st));
+}
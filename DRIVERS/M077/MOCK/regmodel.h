@@ -0,0 +1,84 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  regmodel.h
+ *
+ *      \author  thomas schnuerer
+ *
+ *       \brief  Register model of M45N/M69N/M77 M-Modules for the user
+ *               space build of serial_m77.c and the mock carrier
+ *
+ *     Switches: -
+ */
+/*
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef _REGMODEL_H
+#define _REGMODEL_H
+
+#define RM_MAX_MODS		64			/* M-Modules in the model			*/
+#define RM_MAX_CHAN		8			/* M45N: 8, M69N/M77: 4 UARTs		*/
+#define RM_WINDOW		0x100		/* A08 address space of a M-Module	*/
+#define RM_FIFO_SIZE	128			/* OX16C954 FIFO depth, 950 mode	*/
+#define RM_UARTCLK		18432000	/* 18,432 MHz						*/
+
+/* M-Module types, same IDs as MOD_Mxx in serial_m77.h */
+#define RM_M45			0x7d2d
+#define RM_M69			0x7d45
+#define RM_M77			0x004d
+
+/** MMIO access statistics, of one M-Module or summed up */
+struct rm_stats {
+	unsigned long long	rd;			/* D16 reads						*/
+	unsigned long long	wr;			/* D16 writes						*/
+	unsigned long long	uartRd;		/* reads of OX16C954 registers		*/
+	unsigned long long	uartWr;
+	unsigned long long	cpldRd;		/* reads of IR/DCR/TCR				*/
+	unsigned long long	cpldWr;
+	unsigned long long	busNs;		/* simulated bus time of all accesses */
+	unsigned long long	rxBytes;	/* bytes read from RX FIFOs			*/
+	unsigned long long	txBytes;	/* bytes written to TX FIFOs		*/
+	unsigned long long	rxOverrun;	/* bytes lost, RX FIFO full			*/
+	unsigned long long	txOverrun;	/* bytes lost, THR written with FIFO full */
+};
+
+int rm_init(unsigned int nMods, unsigned int modtype);
+void rm_exit(void);
+void *rm_mod_base(unsigned int mod);
+unsigned int rm_mod_chans(unsigned int mod);
+void rm_set_mod_type(unsigned int mod, unsigned int modtype);
+unsigned int rm_mod_type(unsigned int mod);
+int rm_mod_index(volatile void *addr);
+unsigned int rm_chan_baud(unsigned int mod, unsigned int ch);
+void rm_set_bus_ns(unsigned int rdNs, unsigned int wrNs);
+
+unsigned short rm_read16(volatile void *addr);
+void rm_write16(volatile void *addr, unsigned short val);
+
+int rm_rx_inject(unsigned int mod, unsigned int ch,
+				 const unsigned char *buf, int len, unsigned char lsrErr);
+int rm_tx_drain(unsigned int mod, unsigned int ch, unsigned char *buf, int max);
+unsigned int rm_tx_level(unsigned int mod, unsigned int ch);
+unsigned int rm_rx_space(unsigned int mod, unsigned int ch);
+int rm_mod_irq_pending(unsigned int mod);
+int rm_irq_pending(void);
+
+void rm_get_stats(struct rm_stats *st);
+void rm_get_mod_stats(unsigned int mod, struct rm_stats *st);
+void rm_clear_stats(void);
+
+#endif /* _REGMODEL_H */